@@ -0,0 +1,26 @@
+# Fail the build if the library references a heap allocator.
+#
+# Run as a post-build step with -DNM=<nm> -DLIBRARY=<archive>. Every
+# undefined symbol of every object in the archive is checked against the C
+# and C++ allocation entry points; the driver keeps all of its storage in
+# caller owned structs and fixed pools, so none of them may appear.
+
+execute_process(
+    COMMAND ${NM} -u ${LIBRARY}
+    OUTPUT_VARIABLE symbols
+    RESULT_VARIABLE result
+)
+
+if(NOT result EQUAL 0)
+    message(FATAL_ERROR "adxl343: could not list the symbols of ${LIBRARY}")
+endif()
+
+# malloc family, operator new / delete in all their mangled forms
+set(pattern "[ \t](malloc|calloc|realloc|reallocarray|free|aligned_alloc|posix_memalign|memalign|valloc|pvalloc|strdup|strndup|_Zn[wa][jm][A-Za-z0-9_]*|_Zd[la]Pv[A-Za-z0-9_]*)\n")
+
+string(REGEX MATCHALL "${pattern}" found "${symbols}\n")
+if(found)
+    list(REMOVE_DUPLICATES found)
+    string(REGEX REPLACE "[ \t\n]" "" found "${found}")
+    message(FATAL_ERROR "adxl343: library references heap allocation: ${found}")
+endif()
@@ -1,6 +1,253 @@
 #ifndef ADXL343_H
 #define ADXL343_H
 
-void adxl343_init();
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// I2C addresses, selected by the ALT ADDRESS pin
+#define ADXL343_ADDRESS          0x53
+#define ADXL343_ADDRESS_ALT      0x1D
+
+#define ADXL343_DEVICE_ID        0xE5
+#define ADXL343_FIFO_DEPTH       32
+
+// Register map
+#define ADXL343_REG_DEVID          0x00
+#define ADXL343_REG_THRESH_TAP     0x1D
+#define ADXL343_REG_OFSX           0x1E
+#define ADXL343_REG_OFSY           0x1F
+#define ADXL343_REG_OFSZ           0x20
+#define ADXL343_REG_DUR            0x21
+#define ADXL343_REG_LATENT         0x22
+#define ADXL343_REG_WINDOW         0x23
+#define ADXL343_REG_THRESH_ACT     0x24
+#define ADXL343_REG_THRESH_INACT   0x25
+#define ADXL343_REG_TIME_INACT     0x26
+#define ADXL343_REG_ACT_INACT_CTL  0x27
+#define ADXL343_REG_THRESH_FF      0x28
+#define ADXL343_REG_TIME_FF        0x29
+#define ADXL343_REG_TAP_AXES       0x2A
+#define ADXL343_REG_ACT_TAP_STATUS 0x2B
+#define ADXL343_REG_BW_RATE        0x2C
+#define ADXL343_REG_POWER_CTL      0x2D
+#define ADXL343_REG_INT_ENABLE     0x2E
+#define ADXL343_REG_INT_MAP        0x2F
+#define ADXL343_REG_INT_SOURCE     0x30
+#define ADXL343_REG_DATA_FORMAT    0x31
+#define ADXL343_REG_DATAX0         0x32
+#define ADXL343_REG_DATAX1         0x33
+#define ADXL343_REG_DATAY0         0x34
+#define ADXL343_REG_DATAY1         0x35
+#define ADXL343_REG_DATAZ0         0x36
+#define ADXL343_REG_DATAZ1         0x37
+#define ADXL343_REG_FIFO_CTL       0x38
+#define ADXL343_REG_FIFO_STATUS    0x39
+
+// INT_ENABLE, INT_MAP and INT_SOURCE
+#define ADXL343_INT_DATA_READY   0x80
+#define ADXL343_INT_SINGLE_TAP   0x40
+#define ADXL343_INT_DOUBLE_TAP   0x20
+#define ADXL343_INT_ACTIVITY     0x10
+#define ADXL343_INT_INACTIVITY   0x08
+#define ADXL343_INT_FREE_FALL    0x04
+#define ADXL343_INT_WATERMARK    0x02
+#define ADXL343_INT_OVERRUN      0x01
+
+// ACT_INACT_CTL
+#define ADXL343_ACT_AC           0x80
+#define ADXL343_ACT_X            0x40
+#define ADXL343_ACT_Y            0x20
+#define ADXL343_ACT_Z            0x10
+#define ADXL343_INACT_AC         0x08
+#define ADXL343_INACT_X          0x04
+#define ADXL343_INACT_Y          0x02
+#define ADXL343_INACT_Z          0x01
+
+// TAP_AXES
+#define ADXL343_TAP_SUPPRESS     0x08
+#define ADXL343_TAP_X            0x04
+#define ADXL343_TAP_Y            0x02
+#define ADXL343_TAP_Z            0x01
+
+// ACT_TAP_STATUS
+#define ADXL343_STATUS_ACT_X     0x40
+#define ADXL343_STATUS_ACT_Y     0x20
+#define ADXL343_STATUS_ACT_Z     0x10
+#define ADXL343_STATUS_ASLEEP    0x08
+#define ADXL343_STATUS_TAP_X     0x04
+#define ADXL343_STATUS_TAP_Y     0x02
+#define ADXL343_STATUS_TAP_Z     0x01
+
+// BW_RATE
+#define ADXL343_BW_LOW_POWER     0x10
+#define ADXL343_BW_RATE_MASK     0x0F
+
+// POWER_CTL
+#define ADXL343_POWER_LINK       0x20
+#define ADXL343_POWER_AUTO_SLEEP 0x10
+#define ADXL343_POWER_MEASURE    0x08
+#define ADXL343_POWER_SLEEP      0x04
+#define ADXL343_POWER_WAKEUP_MASK 0x03
+
+// DATA_FORMAT
+#define ADXL343_FORMAT_SELF_TEST 0x80
+#define ADXL343_FORMAT_SPI       0x40
+#define ADXL343_FORMAT_INT_INVERT 0x20
+#define ADXL343_FORMAT_FULL_RES  0x08
+#define ADXL343_FORMAT_JUSTIFY   0x04
+#define ADXL343_FORMAT_RANGE_MASK 0x03
+
+// FIFO_CTL
+#define ADXL343_FIFO_MODE_MASK   0xC0
+#define ADXL343_FIFO_BYPASS      0x00
+#define ADXL343_FIFO_FIFO        0x40
+#define ADXL343_FIFO_STREAM      0x80
+#define ADXL343_FIFO_TRIGGER     0xC0
+#define ADXL343_FIFO_TRIGGER_INT2 0x20
+#define ADXL343_FIFO_SAMPLES_MASK 0x1F
+
+// FIFO_STATUS
+#define ADXL343_FIFO_TRIG        0x80
+#define ADXL343_FIFO_ENTRIES_MASK 0x3F
+
+// Output data rate codes for BW_RATE
+typedef enum {
+    ADXL343_RATE_0_10HZ = 0x00,
+    ADXL343_RATE_0_20HZ = 0x01,
+    ADXL343_RATE_0_39HZ = 0x02,
+    ADXL343_RATE_0_78HZ = 0x03,
+    ADXL343_RATE_1_56HZ = 0x04,
+    ADXL343_RATE_3_13HZ = 0x05,
+    ADXL343_RATE_6_25HZ = 0x06,
+    ADXL343_RATE_12_5HZ = 0x07,
+    ADXL343_RATE_25HZ   = 0x08,
+    ADXL343_RATE_50HZ   = 0x09,
+    ADXL343_RATE_100HZ  = 0x0A,
+    ADXL343_RATE_200HZ  = 0x0B,
+    ADXL343_RATE_400HZ  = 0x0C,
+    ADXL343_RATE_800HZ  = 0x0D,
+    ADXL343_RATE_1600HZ = 0x0E,
+    ADXL343_RATE_3200HZ = 0x0F,
+} adxl343_rate_t;
+
+// Measurement range codes for DATA_FORMAT
+typedef enum {
+    ADXL343_RANGE_2G  = 0x00,
+    ADXL343_RANGE_4G  = 0x01,
+    ADXL343_RANGE_8G  = 0x02,
+    ADXL343_RANGE_16G = 0x03,
+} adxl343_range_t;
+
+// Status codes returned by the driver; bus callbacks return 0 or negative.
+// ADXL343_PENDING is only returned by the non-blocking operations in
+// ADXL343_op.h and ADXL343_selftest.h.
+typedef enum {
+    ADXL343_PENDING = 1,
+    ADXL343_OK = 0,
+    ADXL343_ERROR_BUS = -1,
+    ADXL343_ERROR_DEVICE = -2,
+    ADXL343_ERROR_ARGUMENT = -3,
+    ADXL343_ERROR_STATE = -4,
+} adxl343_status_t;
+
+// Register level bus access. `read` and `write` transfer `len` bytes
+// starting at `reg` of the device at the 7-bit address `addr`; they return 0
+// on success and a negative value on failure. `delay_us` may be NULL when no
+// settling delays are needed, e.g. on a simulated bus.
+typedef struct {
+    int (*read)(void *ctx, uint8_t addr, uint8_t reg, uint8_t *dst, size_t len);
+    int (*write)(void *ctx, uint8_t addr, uint8_t reg, const uint8_t *src, size_t len);
+    void (*delay_us)(void *ctx, uint32_t us);
+    void *ctx;
+} adxl343_bus_t;
+
+// One X/Y/Z sample as read from DATAX0..DATAZ1, in raw LSBs.
+typedef struct {
+    int16_t x;
+    int16_t y;
+    int16_t z;
+} adxl343_sample_t;
+
+// One sensor on a bus. Any number of devices may share a bus as long as
+// their addresses differ, so two sensors fit on one I2C bus with the ALT
+// ADDRESS pin of one of them pulled high (ADXL343_ADDRESS_ALT).
+typedef struct {
+    const adxl343_bus_t *bus;
+    uint8_t address;
+} adxl343_dev_t;
+
+// Handle based access. These behave like the functions without `dev_`
+// below but talk to `dev` rather than the driver's default device.
+void adxl343_dev_set_bus(adxl343_dev_t *dev, const adxl343_bus_t *bus, uint8_t address);
+int adxl343_dev_init(adxl343_dev_t *dev);
+int adxl343_dev_read_reg(adxl343_dev_t *dev, uint8_t reg, uint8_t *value);
+int adxl343_dev_write_reg(adxl343_dev_t *dev, uint8_t reg, uint8_t value);
+int adxl343_dev_read_regs(adxl343_dev_t *dev, uint8_t reg, uint8_t *dst, size_t len);
+int adxl343_dev_write_regs(adxl343_dev_t *dev, uint8_t reg, const uint8_t *src, size_t len);
+int adxl343_dev_update_reg(adxl343_dev_t *dev, uint8_t reg, uint8_t mask, uint8_t value);
+int adxl343_dev_read_sample(adxl343_dev_t *dev, adxl343_sample_t *sample);
+int adxl343_dev_fifo_status(adxl343_dev_t *dev, uint8_t *status);
+int adxl343_dev_read_fifo(adxl343_dev_t *dev, adxl343_sample_t *dst, size_t max);
+int adxl343_dev_read_int_source(adxl343_dev_t *dev, uint8_t *source);
+
+// The device used by the functions without a handle.
+adxl343_dev_t *adxl343_default_device(void);
+
+// Select the bus and address used by the driver. Without a call to this the
+// Pico build talks to i2c_default at ADXL343_ADDRESS.
+void adxl343_set_bus(const adxl343_bus_t *bus, uint8_t address);
+
+// Check the device ID and bring the sensor up measuring at 100 Hz, full
+// resolution +-16 g, FIFO bypassed and interrupts disabled.
+int adxl343_init(void);
+
+int adxl343_read_reg(uint8_t reg, uint8_t *value);
+int adxl343_write_reg(uint8_t reg, uint8_t value);
+int adxl343_read_regs(uint8_t reg, uint8_t *dst, size_t len);
+int adxl343_write_regs(uint8_t reg, const uint8_t *src, size_t len);
+
+// Read-modify-write of the bits in `mask`.
+int adxl343_update_reg(uint8_t reg, uint8_t mask, uint8_t value);
+
+// Read DATAX0..DATAZ1 in one burst. With the FIFO enabled this pops one entry.
+int adxl343_read_sample(adxl343_sample_t *sample);
+
+// Read FIFO_STATUS: entry count in the low six bits, FIFO_TRIG in bit 7.
+int adxl343_fifo_status(uint8_t *status);
+
+// Pop up to `max` entries from the FIFO. Returns the number read, or a
+// negative status on failure.
+int adxl343_read_fifo(adxl343_sample_t *dst, size_t max);
+
+// Read and clear the latched interrupt sources.
+int adxl343_read_int_source(uint8_t *source);
+
+// Nominal output data rate in Hz for a BW_RATE code.
+float adxl343_rate_hz(adxl343_rate_t rate);
+
+// Sample scale in mg per LSB for a DATA_FORMAT value, including the
+// JUSTIFY bit.
+float adxl343_mg_per_lsb(uint8_t data_format);
+
+// Left-justified samples (DATA_FORMAT.JUSTIFY) are Q15 fractions of the
+// selected range: the sensor puts the 10 to 13 significant bits at the top
+// of the register pair, so +-32768 is +-2, 4, 8 or 16 g whatever the
+// resolution, and no per-range scaling is needed downstream. The sensor
+// sign-extends right-justified samples itself, so either way a sample is
+// used as read.
+//
+// Bits a right-justified sample has to move up to become that Q15 value;
+// 0 when `data_format` has JUSTIFY set.
+int adxl343_q15_shift(uint8_t data_format);
+
+// Bring `count` samples read with `data_format` to Q15 in place. Does
+// nothing for left-justified samples.
+void adxl343_to_q15(adxl343_sample_t *samples, size_t count, uint8_t data_format);
+
+// Bits a left-justified sample can move down without losing data: it holds
+// 13 significant bits at most. The fixed-point stages that need the
+// headroom of 13-bit input take Q15 samples this way.
+#define ADXL343_JUSTIFY_SHIFT 3
 
 #endif // ADXL343_H
@@ -1,12 +1,269 @@
 #pragma once
 
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(__cpp_impl_coroutine)
+#include <coroutine>
+#endif
+
 extern "C" {
     #include "ADXL343.h"
 }
 
+#include "ADXL343_regs.hpp"
+
+// Nothing in the library uses the heap, which the build checks. Coroutine
+// frames are taken from a fixed pool inside the library
+#ifndef ADXL343_CORO_FRAMES
+#define ADXL343_CORO_FRAMES 4
+#endif
+
+#ifndef ADXL343_CORO_FRAME_SIZE
+#define ADXL343_CORO_FRAME_SIZE 512
+#endif
+
 class ADXL343 {
 public:
-    // Public C++ API declarations...
+    // Sampling rate while asleep, POWER_CTL wakeup bits
+    enum class WakeupRate : uint8_t {
+        Hz8 = 0,
+        Hz4 = 1,
+        Hz2 = 2,
+        Hz1 = 3,
+    };
+
+    // Axis selection for the activity and inactivity detectors
+    enum class Axes : uint8_t {
+        None = 0,
+        X = 4,
+        Y = 2,
+        Z = 1,
+        All = 7,
+    };
+
+    enum class Coupling : uint8_t {
+        DC = 0,
+        AC = 1,
+    };
+
+    // Complete power management setup. With `autoSleep` the sensor drops to
+    // `wakeup` rate once inactivity is detected and returns to BW_RATE on
+    // activity; auto-sleep only works in link mode with both detectors
+    // running, so configurePower() turns those on whenever autoSleep is set.
+    struct PowerConfig {
+        bool link = false;
+        bool autoSleep = false;
+        WakeupRate wakeup = WakeupRate::Hz8;
+        uint8_t activityThreshold = 0;     // THRESH_ACT, 62.5 mg/LSB
+        uint8_t inactivityThreshold = 0;   // THRESH_INACT, 62.5 mg/LSB
+        uint8_t inactivityTime = 0;        // TIME_INACT, seconds
+        Axes activityAxes = Axes::None;
+        Coupling activityCoupling = Coupling::DC;
+        Axes inactivityAxes = Axes::None;
+        Coupling inactivityCoupling = Coupling::DC;
+    };
+
+    // Drives `dev`, by default the driver's default device. A second
+    // sensor gets its own handle, e.g. one at ADXL343_ADDRESS_ALT.
+    explicit ADXL343(adxl343_dev_t *device = adxl343_default_device());
+    ~ADXL343();
+
+    // Identify and reset the sensor to the driver defaults.
+    int init();
+
+    // Apply `config` in the order the datasheet asks for: standby, the
+    // detector registers as one burst, interrupt enables, then the
+    // POWER_CTL mode bits together with MEASURE in a final write.
+    int configurePower(const PowerConfig &config);
+
+    // Force sleep at `rate` regardless of activity.
+    int sleep(WakeupRate rate);
+
+    // Leave forced or automatic sleep. Passes through standby so the sensor
+    // restarts at the BW_RATE output data rate.
+    int wake();
+
+    // Whether the sensor is currently sampling at the wakeup rate.
+    int asleep(bool &sleeping);
+
+    static uint8_t actInactControl(const PowerConfig &config);
+    static uint8_t powerControl(const PowerConfig &config);
+
+    // Bus the sensor is read over, for the stream checks below.
+    enum class BusType : uint8_t {
+        I2C,
+        SPI,
+    };
+
+    // Bus clocks adxl343_read_fifo() spends per FIFO entry and on the
+    // FIFO_STATUS read in front of each drain. An I2C register read sends
+    // address, register, repeated address and data at nine clocks a byte
+    // plus start, restart and stop; SPI sends a command byte and the data
+    // at eight clocks a byte.
+    static constexpr uint32_t entryClocks(BusType bus) { return bus == BusType::I2C ? 9 * 9 + 3 : 7 * 8; }
+    static constexpr uint32_t statusClocks(BusType bus) { return bus == BusType::I2C ? 4 * 9 + 3 : 2 * 8; }
+
+    // A streaming setup checked at compile time: the FIFO in stream mode
+    // raising WATERMARK at `Watermark` entries, each watermark answered by
+    // one adxl343_read_fifo(). The build fails if the bus clock is out of
+    // spec, if draining takes more bus time than the sensor produces, or if
+    // the FIFO fills before a watermark's worth has been read out:
+    //
+    //     using Fast = ADXL343::Stream<ADXL343_RATE_1600HZ, 16, ADXL343::BusType::I2C, 400000>;
+    //     accel.configureStream<Fast>();
+    //
+    // The checks cover bus time only; interrupt latency has to fit in what
+    // headroomUs leaves.
+    template <adxl343_rate_t Rate, uint8_t Watermark, BusType Bus, uint32_t ClockHz>
+    struct Stream {
+        static_assert(Rate >= ADXL343_RATE_0_10HZ && Rate <= ADXL343_RATE_3200HZ, "not a BW_RATE code");
+        static_assert(Watermark >= 1 && Watermark < ADXL343_FIFO_DEPTH, "watermark must be 1 to 31 entries");
+        static_assert(ClockHz > 0, "bus clock must be set");
+        static_assert(Bus != BusType::I2C || ClockHz <= 400000, "ADXL343 I2C runs at up to 400 kHz");
+        static_assert(Bus != BusType::SPI || ClockHz <= 5000000, "ADXL343 SPI runs at up to 5 MHz");
+
+        // The ODR is 3200 Hz / `scale`; comparisons are multiplied through
+        // by it to stay in integers
+        static constexpr uint64_t scale = 1ull << (ADXL343_RATE_3200HZ - Rate);
+        static constexpr uint64_t blockClocks = Watermark * uint64_t(entryClocks(Bus)) + statusClocks(Bus);
+
+        static_assert(3200 * blockClocks <= Watermark * uint64_t(ClockHz) * scale,
+                      "bus too slow to sustain the output data rate");
+        static_assert(3200 * blockClocks <= (ADXL343_FIFO_DEPTH - Watermark) * uint64_t(ClockHz) * scale,
+                      "FIFO overruns while a watermark block is read; lower the watermark");
+
+        // Share of the bus taken by the stream, rounded up
+        static constexpr uint32_t busLoadPercent =
+            uint32_t((3200 * blockClocks * 100 + Watermark * uint64_t(ClockHz) * scale - 1) /
+                     (Watermark * uint64_t(ClockHz) * scale));
+
+        // Time left after reading a block before the FIFO would overrun
+        static constexpr uint32_t headroomUs =
+            uint32_t(((ADXL343_FIFO_DEPTH - Watermark) * uint64_t(ClockHz) * scale - 3200 * blockClocks) *
+                     1000000 / (3200 * uint64_t(ClockHz)));
+
+        static constexpr adxl343::Writes<2> setup = adxl343::writes(
+            adxl343::Value<adxl343::reg::BwRate>().with<adxl343::reg::BwRate::Rate>(Rate),
+            adxl343::Value<adxl343::reg::FifoCtl>()
+                .with<adxl343::reg::FifoCtl::Mode>(adxl343::FifoMode::Stream)
+                .with<adxl343::reg::FifoCtl::Samples>(Watermark));
+    };
+
+    // Write the rate and FIFO setup of a Stream.
+    template <typename Config>
+    int configureStream() {
+        for (const auto &write : Config::setup.data) {
+            int status = adxl343_dev_write_reg(dev, write[0], write[1]);
+            if (status != ADXL343_OK) {
+                return status;
+            }
+        }
+        return ADXL343_OK;
+    }
+
+#if defined(__cpp_impl_coroutine)
+    // Asynchronous acquisition with C++20 coroutines. An acquisition loop
+    // is written straight through as a coroutine returning Task:
+    //
+    //     ADXL343::Task acquire(ADXL343 &accel, ADXL343::Event &watermark) {
+    //         adxl343_sample_t block[ADXL343_FIFO_DEPTH];
+    //         for (;;) {
+    //             int n = co_await accel.nextBlock(watermark, block, ADXL343_FIFO_DEPTH);
+    //             ...
+    //         }
+    //     }
+    //
+    // The coroutine suspends until its Event is signalled, then drains the
+    // FIFO and carries on with the sample count (or a negative status).
+    // Frames come from a pool of ADXL343_CORO_FRAMES slots of
+    // ADXL343_CORO_FRAME_SIZE bytes, never the heap; when no slot fits the
+    // Task comes back empty. Tasks are created and resumed from the main
+    // loop only.
+
+    class BlockAwaiter;
+    class Task;
+
+    // Wakes a coroutine waiting in nextBlock(). signal() only sets a flag
+    // and may be called from the GPIO or DMA completion interrupt;
+    // dispatch() resumes the waiter from the main loop and returns whether
+    // it did. A signal arriving before the coroutine waits is kept, and a
+    // Task destroyed while it waits is taken off its Event.
+    class Event {
+    public:
+        void signal() { pending = true; }
+        bool dispatch();
+
+    private:
+        friend class BlockAwaiter;
+        friend class Task;
+        volatile bool pending = false;
+        std::coroutine_handle<> waiter;
+    };
+
+    class Task {
+    public:
+        struct promise_type {
+            Task get_return_object() { return Task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+            static Task get_return_object_on_allocation_failure() { return Task(); }
+            std::suspend_never initial_suspend() noexcept { return {}; }
+            std::suspend_always final_suspend() noexcept { return {}; }
+            void return_void() {}
+            void unhandled_exception();
+
+            Event *waiting = nullptr;  // set while suspended in nextBlock()
+
+            static void *operator new(size_t size) noexcept;
+            static void operator delete(void *frame, size_t size) noexcept;
+        };
+
+        Task() = default;
+        Task(Task &&other) noexcept : handle(other.handle) { other.handle = nullptr; }
+        Task &operator=(Task &&other) noexcept;
+        Task(const Task &) = delete;
+        Task &operator=(const Task &) = delete;
+        ~Task();
+
+        // False when no frame could be allocated.
+        explicit operator bool() const { return static_cast<bool>(handle); }
+        bool done() const { return handle && handle.done(); }
+
+        // Frame slots currently free.
+        static size_t framesFree();
+
+    private:
+        explicit Task(std::coroutine_handle<promise_type> h) : handle(h) {}
+        void destroy();
+        std::coroutine_handle<promise_type> handle;
+    };
+
+    class BlockAwaiter {
+    public:
+        BlockAwaiter(adxl343_dev_t *dev, Event &event, adxl343_sample_t *dst, size_t max)
+            : dev(dev), event(event), dst(dst), max(max) {}
+        bool await_ready() noexcept;
+        void await_suspend(std::coroutine_handle<Task::promise_type> waiter) noexcept;
+        int await_resume() noexcept;
+
+    private:
+        adxl343_dev_t *dev;
+        Event &event;
+        std::coroutine_handle<Task::promise_type> suspended;
+        adxl343_sample_t *dst;
+        size_t max;
+    };
+
+    // Wait for `event`, e.g. the FIFO watermark on INT1, then read up to
+    // `max` samples from the FIFO into `dst`.
+    BlockAwaiter nextBlock(Event &event, adxl343_sample_t *dst, size_t max) {
+        return BlockAwaiter(dev, event, dst, max);
+    }
+#endif
+
 private:
-    // Private members...
+    adxl343_dev_t *dev;
 };
+
+constexpr ADXL343::Axes operator|(ADXL343::Axes a, ADXL343::Axes b) {
+    return static_cast<ADXL343::Axes>(static_cast<uint8_t>(a) | static_cast<uint8_t>(b));
+}
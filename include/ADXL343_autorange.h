@@ -0,0 +1,60 @@
+#ifndef ADXL343_AUTORANGE_H
+#define ADXL343_AUTORANGE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ADXL343.h"
+
+// Automatic range selection.
+//
+// The sensor runs at 10-bit resolution, where the 2 g range resolves
+// 3.9 mg per LSB and the 16 g range 31.2 mg. (With FULL_RES the LSB is
+// 3.9 mg in every range, so switching would gain nothing; FULL_RES is
+// cleared.) Every drained block is scanned for its peak: a sample at the
+// rails switches straight to `max_range`, since how far it went past them
+// is unknown; one within 1/8 of full scale raises the range one step; and
+// `hold` consecutive blocks whose peak would sit below 3/4 of the next
+// range down's full scale lower it one step.
+//
+// Like the rate governor, a change is made only once the FIFO has been
+// emptied, and whatever landed while DATA_FORMAT was being written is
+// returned with the old samples, so each call returns samples of one
+// DATA_FORMAT only and reports it; adxl343_mg_per_lsb() of that value is
+// their scale. JUSTIFY, INT_INVERT and SPI are kept as found, so
+// left-justified samples come out as Q15 of whichever range they were
+// taken at.
+//
+// The FIFO watermark is routed to INT1; calling adxl343_autorange_service()
+// whenever INT1 is high is enough to keep up.
+
+typedef struct {
+    adxl343_range_t min_range;
+    adxl343_range_t max_range;
+    uint8_t watermark;        // FIFO entries that raise WATERMARK, 1..31
+    uint16_t hold;            // quiet blocks before stepping down, at least 1
+} adxl343_autorange_config_t;
+
+typedef struct {
+    adxl343_dev_t *dev;
+    adxl343_autorange_config_t config;
+    uint8_t format;           // DATA_FORMAT the sensor is running with
+    adxl343_range_t target;   // range to switch to once the FIFO is empty
+    uint16_t quiet;           // consecutive quiet blocks so far
+    uint32_t switches;
+    uint32_t incidents;       // blocks with at least one sample at the rails
+    uint32_t clipped;         // samples with an axis at the rails
+} adxl343_autorange_t;
+
+// Start `dev` at `max_range` with the FIFO streaming. The sensor must
+// already be initialised.
+int adxl343_autorange_init(adxl343_autorange_t *ar, adxl343_dev_t *dev, const adxl343_autorange_config_t *config);
+
+// Drain the FIFO into `dst` and adjust the range. Returns the number of
+// samples written, all taken with the DATA_FORMAT stored in `*format`, or
+// a negative status. With `max` below the FIFO depth a switch may take
+// several calls.
+int adxl343_autorange_service(adxl343_autorange_t *ar, adxl343_sample_t *dst, size_t max, uint8_t *format);
+
+#endif // ADXL343_AUTORANGE_H
@@ -0,0 +1,39 @@
+#ifndef ADXL343_CAL_H
+#define ADXL343_CAL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ADXL343.h"
+
+// Fixed-point gain, cross-axis and offset correction.
+//
+// Each sample has the offset taken off and is multiplied by a 3x3 matrix
+// in Q14, all in integer arithmetic with 32-bit products, so it runs on a
+// core without an FPU:
+//
+//     corrected = M * (sample - offset)
+//
+// The matrix and offset come from a multi-orientation fit on the host
+// (tools/adxl343_calfit), which writes them out for the DATA_FORMAT the
+// samples will be taken with. The difference is saturated to 16 bits and
+// the rows' absolute sums have to stay below 4, which a calibration of a
+// few percent is far from, so the sums cannot overflow. Results saturate
+// at the int16 limits.
+
+// Fraction bits of the matrix entries: 1.0 is 1 << 14
+#define ADXL343_CAL_FRAC_BITS 14
+
+typedef struct {
+    int16_t m[3][3];          // row major, Q14
+    int16_t offset[3];        // sample LSBs, subtracted first
+} adxl343_cal_t;
+
+// The correction that leaves samples as they are.
+void adxl343_cal_identity(adxl343_cal_t *cal);
+
+// Correct `count` samples in place.
+void adxl343_cal_apply(const adxl343_cal_t *cal, adxl343_sample_t *samples, size_t count);
+
+#endif // ADXL343_CAL_H
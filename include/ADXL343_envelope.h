@@ -0,0 +1,71 @@
+#ifndef ADXL343_ENVELOPE_H
+#define ADXL343_ENVELOPE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ADXL343.h"
+
+// Envelope demodulation of one axis for bearing fault detection.
+//
+//   band-pass -> full-wave rectify -> low-pass -> decimate
+//
+// The band-pass is a Butterworth high-pass / low-pass biquad pair around the
+// structural resonance the defect impacts excite; rectifying and low-passing
+// recovers the impact repetition rate, which shows up as lines at the defect
+// frequencies in the spectrum of the decimated output.
+//
+// Coefficients are designed once at init. The per-sample path is three Q14
+// direct form I biquads with first order error feedback, using only 32-bit
+// multiplies and no division, so it runs cheaply on either M0+ core. The
+// stage keeps no global state; running it on core 1 only needs the sample
+// blocks handed over, e.g. through the inter-core FIFO.
+//
+// Intermediate values are clamped to 13 bits so the 32-bit accumulators
+// cannot overflow. Left-justified Q15 samples (DATA_FORMAT.JUSTIFY) are
+// taken down to 13 bits on the way in, which loses nothing the sensor
+// measured, and the envelope is scaled back up on the way out, saturating
+// at the int16 limit.
+
+typedef struct {
+    int32_t b0, b1, b2, a1, a2; // Q14
+    int32_t x1, x2, y1, y2;
+    int32_t error;
+} adxl343_biquad_t;
+
+typedef struct {
+    float odr_hz;
+    float band_low_hz;    // band-pass lower edge
+    float band_high_hz;   // band-pass upper edge, below ODR / 2
+    float lowpass_hz;     // envelope low-pass, below ODR / (2 * decimation)
+    uint8_t decimation;   // keep one envelope sample in `decimation`
+    uint8_t axis;         // 0 = X, 1 = Y, 2 = Z
+    uint8_t data_format;  // DATA_FORMAT the samples were read with
+} adxl343_envelope_config_t;
+
+typedef struct {
+    adxl343_biquad_t highpass;
+    adxl343_biquad_t lowpass;
+    adxl343_biquad_t smooth;
+    uint8_t decimation;
+    uint8_t phase;
+    uint8_t axis;
+    uint8_t shift;        // ADXL343_JUSTIFY_SHIFT for left-justified input
+} adxl343_envelope_t;
+
+// Design the filters. Returns false if the band edges, envelope low-pass or
+// decimation do not fit the ODR.
+bool adxl343_envelope_init(adxl343_envelope_t *env, const adxl343_envelope_config_t *config);
+
+// Clear the filter state and decimation phase.
+void adxl343_envelope_reset(adxl343_envelope_t *env);
+
+// Demodulate `count` samples, writing at most `max_out` envelope samples (in
+// LSBs of the input) to `out`. Input is consumed in full; with `max_out` of
+// at least count / decimation + 1 nothing is dropped. Returns the number
+// written.
+size_t adxl343_envelope_process(adxl343_envelope_t *env, const adxl343_sample_t *samples, size_t count,
+                                int16_t *out, size_t max_out);
+
+#endif // ADXL343_ENVELOPE_H
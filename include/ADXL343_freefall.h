@@ -0,0 +1,77 @@
+#ifndef ADXL343_FREEFALL_H
+#define ADXL343_FREEFALL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ADXL343.h"
+#include "ADXL343_shock.h"
+
+// Drop logger: free-fall detection handing over to full-rate impact capture.
+//
+// While armed the sensor runs at a low rate with the FIFO bypassed and
+// only FREE_FALL enabled, on INT1: all axes under THRESH_FF for TIME_FF.
+// The service that sees it switches BW_RATE to the capture rate and starts
+// the shock recorder of ADXL343_shock.h, whose FIFO trigger on activity
+// over the impact threshold freezes the end of the fall and the impact at
+// full rate. Once the record is complete the logger re-arms.
+//
+// The fall is taken to have started TIME_FF, less half an armed sample
+// period, before the free-fall interrupt and to end at the trigger sample,
+// placed from its position in the stream since the switch. The start
+// estimate is off by up to half an armed sample period plus the interrupt
+// latency, so a faster armed rate tightens the duration. Use full
+// resolution +-16 g so impacts do not clip the profile.
+
+// Host clock in nanoseconds.
+typedef uint64_t (*adxl343_freefall_clock_t)(void *ctx);
+
+typedef struct {
+    uint8_t threshold;          // THRESH_FF, 62.5 mg/LSB, 300 to 600 mg recommended
+    uint8_t time;               // TIME_FF, 5 ms/LSB, nonzero
+    adxl343_rate_t armed_rate;  // while waiting for a fall
+    adxl343_rate_t capture_rate;
+    adxl343_shock_config_t impact;  // pre-impact history, post samples and
+                                    // THRESH_ACT over 1 g
+    uint32_t timeout_ms;        // give up a fall with no impact after this
+    adxl343_freefall_clock_t clock;
+    void *clock_ctx;
+} adxl343_freefall_config_t;
+
+typedef enum {
+    ADXL343_FREEFALL_ARMED,
+    ADXL343_FREEFALL_CAPTURING,
+} adxl343_freefall_state_t;
+
+typedef struct {
+    adxl343_dev_t *dev;
+    adxl343_freefall_config_t config;
+    adxl343_freefall_state_t state;
+    uint64_t detected_ns;       // free-fall interrupt serviced
+    uint64_t capture_ns;        // FIFO running at the capture rate
+
+    // Last completed drop
+    uint64_t start_ns;          // estimated release
+    uint64_t impact_ns;         // trigger sample
+    uint32_t fall_us;
+    bool timing_lost;           // FIFO overran during the capture, fall_us may be short
+    adxl343_shock_record_t *record;  // valid until the next fall is detected
+
+    uint32_t drops;
+    uint32_t missed;            // falls that timed out without an impact
+    adxl343_shock_t shock;
+} adxl343_freefall_t;
+
+// Program the free-fall detector of `dev` and arm. The sensor must be
+// initialised and measuring. Returns ADXL343_ERROR_ARGUMENT for a zero threshold or
+// time, a capture rate not above the armed rate, a missing clock or an
+// impact configuration the shock recorder rejects.
+int adxl343_freefall_init(adxl343_freefall_t *ff, adxl343_dev_t *dev, const adxl343_freefall_config_t *config);
+
+// Call on INT1, and while capturing at least once every 31 capture sample
+// periods. Returns 1 when a drop has been completed, with its timing and
+// `record` filled in, 0 otherwise or a negative status.
+int adxl343_freefall_service(adxl343_freefall_t *ff);
+
+#endif // ADXL343_FREEFALL_H
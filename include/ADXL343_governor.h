@@ -0,0 +1,53 @@
+#ifndef ADXL343_GOVERNOR_H
+#define ADXL343_GOVERNOR_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ADXL343.h"
+
+// Activity adaptive output data rate.
+//
+// The governor runs the activity and inactivity detectors in link mode, so
+// the sensor alternates between reporting inactivity (nothing above
+// THRESH_INACT for TIME_INACT seconds) and activity (THRESH_ACT exceeded).
+// Inactivity drops BW_RATE to `idle_rate`, activity raises it back to
+// `active_rate`. The FIFO runs in stream mode and is drained completely
+// before every rate change, so samples already buffered are returned at the
+// rate they were taken at and none are discarded.
+//
+// Activity, inactivity and the FIFO watermark are routed to INT1; calling
+// adxl343_governor_service() whenever INT1 is high is enough to keep up.
+
+typedef struct {
+    adxl343_rate_t active_rate;
+    adxl343_rate_t idle_rate;
+    uint8_t threshold_act;    // THRESH_ACT, 62.5 mg/LSB
+    uint8_t threshold_inact;  // THRESH_INACT, 62.5 mg/LSB
+    uint8_t time_inact;       // TIME_INACT, seconds
+    uint8_t axes;             // ACT_INACT_CTL, e.g. all axes ac-coupled
+    uint8_t watermark;        // FIFO entries that raise WATERMARK, 1..31
+} adxl343_governor_config_t;
+
+typedef struct {
+    adxl343_dev_t *dev;
+    adxl343_governor_config_t config;
+    adxl343_rate_t rate;      // rate the sensor is running at
+    bool idle;
+    bool pending;             // a rate change is waiting for the FIFO to empty
+    uint32_t switches;
+} adxl343_governor_t;
+
+// Program the detectors, FIFO and the active rate of `dev`. The sensor must
+// already be initialised.
+int adxl343_governor_init(adxl343_governor_t *gov, adxl343_dev_t *dev, const adxl343_governor_config_t *config);
+
+// Handle activity / inactivity and drain the FIFO into `dst`. Returns the
+// number of samples written, all taken at the rate stored in `*rate`, or a
+// negative status. A rate change happens only once the FIFO has been
+// emptied, and the FIFO is drained again right after BW_RATE is written;
+// with `max` below the FIFO depth it may take several calls.
+int adxl343_governor_service(adxl343_governor_t *gov, adxl343_sample_t *dst, size_t max, adxl343_rate_t *rate);
+
+#endif // ADXL343_GOVERNOR_H
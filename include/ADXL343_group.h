@@ -0,0 +1,57 @@
+#ifndef ADXL343_GROUP_H
+#define ADXL343_GROUP_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ADXL343.h"
+
+// FIFO draining for several sensors sharing a bus.
+//
+// Each sensor runs its FIFO in stream mode on its own. The group reads
+// FIFO_STATUS of every member and works through the entries found in
+// chunks of at most ADXL343_GROUP_CHUNK, always from the FIFO with the most
+// entries left, so no member holds the bus while another FIFO is close to
+// overflowing. Samples are handed to the sink in the order they were taken
+// for each device; order between devices follows the drain schedule.
+
+#define ADXL343_GROUP_MAX_DEVICES 4
+#define ADXL343_GROUP_CHUNK 8
+
+// Receives `count` samples popped from member `index`.
+typedef void (*adxl343_group_sink_t)(void *ctx, size_t index, const adxl343_sample_t *samples, size_t count);
+
+// Host clock in nanoseconds.
+typedef uint64_t (*adxl343_group_clock_t)(void *ctx);
+
+typedef struct {
+    adxl343_dev_t *devices[ADXL343_GROUP_MAX_DEVICES];
+    size_t count;
+    uint8_t level[ADXL343_GROUP_MAX_DEVICES];  // entries seen by the last poll, not yet read
+    uint32_t full[ADXL343_GROUP_MAX_DEVICES];  // polls that found the FIFO full
+    uint64_t polled_ns[ADXL343_GROUP_MAX_DEVICES];  // clock when the level was read
+    adxl343_group_clock_t clock;
+    void *clock_ctx;
+} adxl343_group_t;
+
+void adxl343_group_init(adxl343_group_t *group);
+
+// Optional host clock. With one set, `polled_ns[index]` tells a sink when
+// the FIFO_STATUS read that found its samples completed, which bounds
+// their age far more tightly than the time they reach the sink.
+void adxl343_group_set_clock(adxl343_group_t *group, adxl343_group_clock_t clock, void *ctx);
+
+// Add an initialised device. Returns its index, or ADXL343_ERROR_ARGUMENT
+// when the group is full or another member has the same bus and address.
+int adxl343_group_add(adxl343_group_t *group, adxl343_dev_t *dev);
+
+// Drain the members' FIFOs, fullest first, polling again while a poll
+// still finds a chunk's worth of entries in total. Returns the number of
+// samples delivered or a negative status. One call delivers at most
+// ADXL343_FIFO_DEPTH samples per member in total so that a bus too slow for
+// the configured rates cannot keep it looping; a full FIFO found on the way
+// is counted in `full`.
+int adxl343_group_service(adxl343_group_t *group, adxl343_group_sink_t sink, void *ctx);
+
+#endif // ADXL343_GROUP_H
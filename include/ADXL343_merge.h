@@ -0,0 +1,70 @@
+#ifndef ADXL343_MERGE_H
+#define ADXL343_MERGE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ADXL343.h"
+
+// Timestamp ordered merge of several sample streams.
+//
+// Every channel is one sensor running at a known output data rate. Blocks
+// drained from its FIFO are pushed with the time of the drain; the newest
+// sample of the first block is taken to be that old, and from then on
+// samples are stamped one nominal period apart. A drain arriving more than
+// a FIFO's worth of periods after the stamps re-anchors the channel, which
+// covers overruns and pauses. Stamps never run past the drain time: a block
+// that would is spread evenly up to it, so a sensor whose oscillator runs
+// fast stays within a block of the host clock.
+//
+// Samples come out in timestamp order across all channels, but only up to
+// the oldest "newest stamp" among the channels: anything later could still
+// be preceded by a sample from a channel that has not been drained yet. A
+// channel that never delivers therefore holds the merge back.
+
+#ifndef ADXL343_MERGE_MAX_CHANNELS
+#define ADXL343_MERGE_MAX_CHANNELS 8
+#endif
+
+// Samples buffered per channel
+#ifndef ADXL343_MERGE_DEPTH
+#define ADXL343_MERGE_DEPTH 64
+#endif
+
+typedef struct {
+    uint64_t t_ns;
+    adxl343_sample_t sample;
+    uint8_t channel;
+} adxl343_stamped_t;
+
+typedef struct {
+    adxl343_stamped_t ring[ADXL343_MERGE_DEPTH];
+    uint16_t head;
+    uint16_t count;
+    uint64_t period_ns;
+    uint64_t last_ns;         // stamp of the newest sample pushed
+    bool started;
+    uint32_t dropped;         // samples lost to a full ring
+} adxl343_merge_channel_t;
+
+typedef struct {
+    adxl343_merge_channel_t channels[ADXL343_MERGE_MAX_CHANNELS];
+    size_t count;
+} adxl343_merge_t;
+
+void adxl343_merge_init(adxl343_merge_t *merge);
+
+// Add a channel sampled at `odr_hz`. Returns its index or
+// ADXL343_ERROR_ARGUMENT.
+int adxl343_merge_add(adxl343_merge_t *merge, float odr_hz);
+
+// Stamp and queue `count` samples drained from `channel` at `now_ns`.
+// Returns the number queued; the rest are counted as dropped.
+int adxl343_merge_push(adxl343_merge_t *merge, size_t channel, const adxl343_sample_t *samples, size_t count,
+                       uint64_t now_ns);
+
+// Pop up to `max` samples in timestamp order. Returns the number written.
+size_t adxl343_merge_pop(adxl343_merge_t *merge, adxl343_stamped_t *dst, size_t max);
+
+#endif // ADXL343_MERGE_H
@@ -0,0 +1,82 @@
+#ifndef ADXL343_OFFSET_H
+#define ADXL343_OFFSET_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ADXL343.h"
+
+// Offset calibration into OFSX / OFSY / OFSZ.
+//
+// With the sensor held still in a known orientation, samples drained the
+// usual way are fed to the calibration until `samples` have been
+// averaged. adxl343_offset_finish() then computes each axis' bias against
+// the expected reading and writes the correction to the offset registers,
+// which the sensor adds to every sample itself, so there is no per-sample
+// subtraction left on the host. The registers step in 15.6 mg (1/64 g);
+// the part of the bias below that step is kept as `residual_ug` and can
+// be taken off in software with adxl343_offset_correct() where it
+// matters, e.g. for averages.
+//
+// The offsets in the registers when the calibration starts are taken into
+// account, so they need not be cleared first and a second run refines the
+// first. The registers are volatile; adxl343_offset_save() turns a result
+// into a small checked record for flash or EEPROM and
+// adxl343_offset_load() and adxl343_offset_apply() bring it back at boot.
+
+// Bytes of a saved calibration record
+#define ADXL343_OFFSET_RECORD_SIZE 11
+
+typedef struct {
+    int16_t expected_mg[3];   // reading of a perfect sensor, e.g. {0, 0, 1000} lying flat
+    uint16_t samples;         // samples to average, at least 1
+    uint16_t max_spread_mg;   // largest peak-to-peak per axis still counted as still
+} adxl343_offset_config_t;
+
+typedef struct {
+    int8_t ofs[3];            // OFSX, OFSY, OFSZ codes, 15.6 mg/LSB
+    int16_t residual_ug[3];   // bias left after the registers, ug
+} adxl343_offset_t;
+
+typedef struct {
+    adxl343_dev_t *dev;
+    adxl343_offset_config_t config;
+    uint8_t format;           // DATA_FORMAT the samples are taken with
+    int8_t ofs[3];            // offset registers at the start
+    uint16_t count;
+    int32_t sum[3];
+    int16_t min[3];
+    int16_t max[3];
+} adxl343_offset_cal_t;
+
+// Start a calibration of `dev`, reading DATA_FORMAT and the current
+// offsets. Only samples taken after this call may be fed.
+int adxl343_offset_begin(adxl343_offset_cal_t *cal, adxl343_dev_t *dev, const adxl343_offset_config_t *config);
+
+// Accumulate `count` samples, ignoring those beyond `samples`. Returns true
+// once enough have been fed.
+bool adxl343_offset_feed(adxl343_offset_cal_t *cal, const adxl343_sample_t *samples, size_t count);
+
+// Compute the offsets and write them to the sensor. Returns
+// ADXL343_ERROR_STATE, leaving the registers alone, if fewer than
+// `samples` were fed or the sensor moved, and ADXL343_ERROR_DEVICE if a
+// bias is beyond the +-2 g the registers can take.
+int adxl343_offset_finish(adxl343_offset_cal_t *cal, adxl343_offset_t *result);
+
+// Write saved offsets to OFSX..OFSZ of `dev` in one burst.
+int adxl343_offset_apply(adxl343_dev_t *dev, const adxl343_offset_t *offset);
+
+// Take the residual off `count` samples read with `data_format`, rounded
+// to whole LSBs.
+void adxl343_offset_correct(const adxl343_offset_t *offset, uint8_t data_format, adxl343_sample_t *samples,
+                            size_t count);
+
+// Serialise a calibration into `record`, with a version byte and checksum.
+void adxl343_offset_save(const adxl343_offset_t *offset, uint8_t record[ADXL343_OFFSET_RECORD_SIZE]);
+
+// Restore a calibration saved by adxl343_offset_save(). Returns false,
+// leaving `offset` untouched, if the record is blank or damaged.
+bool adxl343_offset_load(adxl343_offset_t *offset, const uint8_t record[ADXL343_OFFSET_RECORD_SIZE]);
+
+#endif // ADXL343_OFFSET_H
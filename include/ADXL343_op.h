@@ -0,0 +1,120 @@
+#ifndef ADXL343_OP_H
+#define ADXL343_OP_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ADXL343.h"
+
+// Non-blocking operations for cooperative main loops.
+//
+// An operation is started with one of the adxl343_op_begin_*() calls and
+// then advanced by adxl343_op_poll(), which does at most one register
+// transfer per call and never waits for the sensor: where the sensor has
+// to produce data first, the poll reads INT_SOURCE once and returns
+// ADXL343_PENDING if DATA_READY is not set yet. A superloop can therefore
+// interleave sensor work with other peripherals at the granularity of a
+// single I2C transfer.
+//
+//     adxl343_op_begin_init(&op, dev);
+//     for (;;) {
+//         int status = adxl343_op_poll(&op);   // one transfer at most
+//         ...other work...
+//     }
+//
+// The blocking adxl343_dev_init() runs the same init operation to
+// completion.
+
+typedef enum {
+    ADXL343_OP_NONE = 0,
+    ADXL343_OP_INIT,
+    ADXL343_OP_CONFIGURE,
+    ADXL343_OP_DRAIN,
+    ADXL343_OP_SELF_TEST,
+} adxl343_op_kind_t;
+
+// Samples averaged with and without the self-test force
+#define ADXL343_OP_SELF_TEST_SAMPLES 16
+// Samples discarded after switching the self-test force
+#define ADXL343_OP_SELF_TEST_SETTLE 4
+
+// Step machine shared by ADXL343_OP_SELF_TEST and ADXL343_selftest.h:
+// save BW_RATE, DATA_FORMAT and FIFO_CTL, switch to `rate` at full
+// resolution +-16 g, collect a block without and a block with
+// DATA_FORMAT.SELF_TEST, then write the three registers back. Each block
+// starts from an empty FIFO in `fifo_mode`. A transfer that fails once
+// the registers are saved sends the machine through the restore writes,
+// one per step, before its status is returned.
+typedef struct {
+    uint8_t step;
+    uint8_t rate;             // BW_RATE while testing
+    uint8_t fifo_mode;        // ADXL343_FIFO_BYPASS or ADXL343_FIFO_FIFO
+    uint8_t saved[3];         // BW_RATE, DATA_FORMAT, FIFO_CTL
+    int error;                // first failure, returned once restored
+} adxl343_op_self_test_t;
+
+// Gathers block 0 (without the force) or 1 (with it) with at most one
+// transfer per call; ADXL343_PENDING until the block is complete.
+typedef int (*adxl343_op_collect_t)(void *ctx, int block);
+
+typedef struct {
+    adxl343_dev_t *dev;
+    adxl343_op_kind_t kind;
+    uint8_t step;
+    int status;               // last result of adxl343_op_poll()
+    size_t index;             // progress within the current step
+
+    // ADXL343_OP_CONFIGURE
+    const uint8_t (*writes)[2];
+    size_t write_count;
+
+    // ADXL343_OP_DRAIN
+    adxl343_sample_t *dst;
+    size_t max;
+    size_t entries;
+    size_t count;             // samples read
+
+    // ADXL343_OP_SELF_TEST
+    adxl343_op_self_test_t self_test;
+    bool data_ready;          // DATA_READY seen, next poll reads the sample
+    int32_t sum[3];
+    int32_t base[3];
+    int16_t delta[3];         // self-test output change, 3.9 mg/LSB
+} adxl343_op_t;
+
+// Identify the sensor and set it up as adxl343_init() does.
+void adxl343_op_begin_init(adxl343_op_t *op, adxl343_dev_t *dev);
+
+// Write `count` {register, value} pairs in order. The table must stay
+// valid until the operation completes.
+void adxl343_op_begin_configure(adxl343_op_t *op, adxl343_dev_t *dev, const uint8_t (*writes)[2], size_t count);
+
+// Read FIFO_STATUS, then pop the entries it reported, up to `max`, into
+// `dst`. The number read ends up in `count`.
+void adxl343_op_begin_drain(adxl343_op_t *op, adxl343_dev_t *dev, adxl343_sample_t *dst, size_t max);
+
+// Average the output at 100 Hz, full resolution +-16 g, with and without
+// DATA_FORMAT.SELF_TEST and leave the change in `delta`. BW_RATE,
+// DATA_FORMAT and FIFO_CTL are restored afterwards, also when a transfer
+// fails; the FIFO is bypassed meanwhile, so its contents are lost, and
+// waiting for DATA_READY reads INT_SOURCE, which clears latched events.
+// The sensor must be measuring.
+void adxl343_op_begin_self_test(adxl343_op_t *op, adxl343_dev_t *dev);
+
+// Advance the operation by at most one transfer. Returns ADXL343_PENDING
+// while it is in progress, ADXL343_OK once complete (and on every call
+// after) or a negative status if it failed; a failed operation stays
+// failed.
+int adxl343_op_poll(adxl343_op_t *op);
+
+// Set up the shared self-test step machine.
+void adxl343_op_self_test_init(adxl343_op_self_test_t *test, adxl343_rate_t rate, uint8_t fifo_mode);
+
+// Advance it by at most one transfer, calling `collect` with `ctx` for the
+// two blocks. Returns ADXL343_PENDING while it runs, then ADXL343_OK or
+// the first failure.
+int adxl343_op_self_test_step(adxl343_op_self_test_t *test, adxl343_dev_t *dev, adxl343_op_collect_t collect,
+                              void *ctx);
+
+#endif // ADXL343_OP_H
@@ -0,0 +1,39 @@
+#ifndef ADXL343_PACK_H
+#define ADXL343_PACK_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ADXL343.h"
+
+// Packed sample storage for RAM-bound buffers such as long pre-trigger
+// histories.
+//
+// The sensor delivers 10 significant bits per axis in fixed 10-bit mode
+// (and in full resolution at 2 g), and at most 13 in full resolution at
+// 16 g. Storing them in int16s wastes the rest:
+//   packed10 : x, y, z in bits 0-9, 10-19, 20-29 of a uint32_t, 4 bytes
+//              per sample, half again as many samples as int16 storage
+//   packed13 : x, y, z in bits 0-12, 13-25, 26-38 of five bytes, little
+//              endian, a fifth more samples than int16 storage
+// Axes are two's complement within their field. Values outside the field
+// are saturated; the pack functions return how many samples that hit, so
+// a caller can tell when the wrong format was picked. All kernels work in
+// 32-bit arithmetic.
+
+typedef uint32_t adxl343_packed10_t;
+
+typedef struct {
+    uint8_t bytes[5];
+} adxl343_packed13_t;
+
+// Pack `count` samples into `out`. Returns the number of samples with an
+// axis saturated.
+size_t adxl343_pack10(const adxl343_sample_t *in, size_t count, adxl343_packed10_t *out);
+size_t adxl343_pack13(const adxl343_sample_t *in, size_t count, adxl343_packed13_t *out);
+
+void adxl343_unpack10(const adxl343_packed10_t *in, size_t count, adxl343_sample_t *out);
+void adxl343_unpack13(const adxl343_packed13_t *in, size_t count, adxl343_sample_t *out);
+
+#endif // ADXL343_PACK_H
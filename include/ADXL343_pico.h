@@ -0,0 +1,33 @@
+#ifndef ADXL343_PICO_H
+#define ADXL343_PICO_H
+
+#include "hardware/i2c.h"
+
+#include "ADXL343.h"
+#include "ADXL343_group.h"
+#include "ADXL343_merge.h"
+#include "ADXL343_wom.h"
+
+// Bus binding for the Pico SDK I2C driver. Returns a static bus object for
+// i2c0 or i2c1; the controller must already be initialised with i2c_init()
+// and its pins assigned.
+const adxl343_bus_t *adxl343_pico_i2c_bus(i2c_inst_t *i2c);
+
+// Wake-on-motion host hook waiting for INT1 wired to `gpio`. With pico-extras'
+// pico_sleep linked the RP2040 goes dormant running from the XOSC and the
+// clocks are brought back up on wake; otherwise the core idles in WFE,
+// polling the pin once a millisecond.
+const adxl343_wom_host_t *adxl343_pico_wom_host(uint gpio);
+
+// Parallel acquisition on both I2C controllers. Core 1 services `group`,
+// the sensors on the second controller, and queues every drained block with
+// its time; core 0 services its own group meanwhile, so transfers on the two
+// buses overlap instead of taking turns. adxl343_pico_parallel_collect()
+// moves the queued blocks into `merge` as channels `first_channel` onwards
+// and returns the number of samples moved. Blocks that find the queue full
+// are counted by adxl343_pico_parallel_lost(). Requires pico_multicore.
+int adxl343_pico_parallel_start(adxl343_group_t *group, size_t first_channel);
+int adxl343_pico_parallel_collect(adxl343_merge_t *merge);
+uint32_t adxl343_pico_parallel_lost(void);
+
+#endif // ADXL343_PICO_H
@@ -0,0 +1,251 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <type_traits>
+
+extern "C" {
+    #include "ADXL343.h"
+}
+
+// Compile-time description of the ADXL343 register map.
+//
+// Each register is a type carrying its address, reset value and access;
+// each field is a type naming its register, position, width and value
+// type. Values are built with Value<Register>::with<Field>(), which
+// refuses fields of other registers and read-only registers at compile
+// time and folds to a constant when its inputs are:
+//
+//     constexpr uint8_t format = adxl343::Value<adxl343::reg::DataFormat>()
+//         .with<adxl343::reg::DataFormat::FullRes>(true)
+//         .with<adxl343::reg::DataFormat::Range>(ADXL343_RANGE_16G)
+//         .raw;
+//
+// An out-of-range field value is a compile error in a constant expression
+// and is masked to the field width at run time. burst() turns values of
+// consecutive registers into the bytes for one multi-byte write, and
+// writes() turns values of any registers into a table for
+// adxl343_op_begin_configure().
+
+namespace adxl343 {
+
+enum class Access : uint8_t {
+    Read,
+    ReadWrite,
+};
+
+template <uint8_t Address, uint8_t Reset, Access Mode = Access::ReadWrite>
+struct Register {
+    static constexpr uint8_t address = Address;
+    static constexpr uint8_t reset = Reset;
+    static constexpr Access access = Mode;
+};
+
+// `Width` bits of `Reg` from bit `Shift` up, holding values of type `T`.
+template <typename Reg, unsigned Shift, unsigned Width, typename T = uint8_t>
+struct Field {
+    static_assert(Width > 0 && Shift + Width <= 8, "field does not fit in a register");
+
+    using reg = Reg;
+    using type = T;
+    static constexpr unsigned shift = Shift;
+    static constexpr unsigned width = Width;
+    static constexpr uint8_t max = static_cast<uint8_t>((1u << Width) - 1);
+    static constexpr uint8_t mask = static_cast<uint8_t>(max << Shift);
+
+    static constexpr bool fits(T value) { return static_cast<unsigned>(value) <= max; }
+
+    static constexpr T get(uint8_t raw) { return static_cast<T>((raw & mask) >> Shift); }
+
+    static constexpr uint8_t set(uint8_t raw, T value) {
+        return static_cast<uint8_t>((raw & ~mask) | ((static_cast<unsigned>(value) << Shift) & mask));
+    }
+};
+
+// FIFO_CTL mode codes
+enum class FifoMode : uint8_t {
+    Bypass = 0,
+    Fifo = 1,
+    Stream = 2,
+    Trigger = 3,
+};
+
+namespace detail {
+
+// Not constexpr: reaching it during constant evaluation fails the build
+inline void fieldOutOfRange() {}
+
+}
+
+// The contents of register `Reg`, starting from its reset value.
+template <typename Reg>
+struct Value {
+    using reg = Reg;
+    uint8_t raw;
+
+    constexpr Value() : raw(Reg::reset) {}
+    constexpr explicit Value(uint8_t raw) : raw(raw) {}
+
+    template <typename F>
+    constexpr Value with(typename F::type value) const {
+        static_assert(std::is_same<typename F::reg, Reg>::value, "field belongs to another register");
+        static_assert(Reg::access == Access::ReadWrite, "register is read only");
+        if (!F::fits(value)) {
+            detail::fieldOutOfRange();
+        }
+        return Value(F::set(raw, value));
+    }
+
+    template <typename F>
+    constexpr typename F::type get() const {
+        static_assert(std::is_same<typename F::reg, Reg>::value, "field belongs to another register");
+        return F::get(raw);
+    }
+};
+
+// Register values as (address, value) pairs.
+template <size_t N>
+struct Writes {
+    uint8_t data[N][2];
+
+    static constexpr size_t count = N;
+};
+
+template <typename... Regs>
+constexpr Writes<sizeof...(Regs)> writes(Value<Regs>... values) {
+    static_assert(sizeof...(Regs) > 0, "nothing to write");
+    static_assert(((Regs::access == Access::ReadWrite) && ...), "register is read only");
+    return {{{Regs::address, values.raw}...}};
+}
+
+// Bytes of one burst write starting at the first register's address.
+template <size_t N>
+struct Burst {
+    uint8_t address;
+    uint8_t data[N];
+
+    static constexpr size_t count = N;
+};
+
+// Whether the registers follow each other in the map, i.e. can be
+// transferred in one burst.
+template <typename First, typename... Rest>
+constexpr bool consecutive() {
+    unsigned next = First::address;
+    return ((Rest::address == ++next) && ...);
+}
+
+namespace detail {
+
+template <typename First, typename... Rest>
+struct FirstOf {
+    using type = First;
+};
+
+}
+
+template <typename... Regs>
+constexpr Burst<sizeof...(Regs)> burst(Value<Regs>... values) {
+    static_assert(sizeof...(Regs) > 0, "nothing to write");
+    static_assert(consecutive<Regs...>(), "burst registers must be consecutive");
+    static_assert(((Regs::access == Access::ReadWrite) && ...), "register is read only");
+    return {detail::FirstOf<Regs...>::type::address, {values.raw...}};
+}
+
+namespace reg {
+
+// INT_ENABLE, INT_MAP and INT_SOURCE share one layout
+template <typename Reg>
+struct InterruptFields {
+    using DataReady = Field<Reg, 7, 1, bool>;
+    using SingleTap = Field<Reg, 6, 1, bool>;
+    using DoubleTap = Field<Reg, 5, 1, bool>;
+    using Activity = Field<Reg, 4, 1, bool>;
+    using Inactivity = Field<Reg, 3, 1, bool>;
+    using FreeFall = Field<Reg, 2, 1, bool>;
+    using Watermark = Field<Reg, 1, 1, bool>;
+    using Overrun = Field<Reg, 0, 1, bool>;
+};
+
+struct DevId : Register<ADXL343_REG_DEVID, ADXL343_DEVICE_ID, Access::Read> {};
+struct ThreshTap : Register<ADXL343_REG_THRESH_TAP, 0x00> {};
+struct Ofsx : Register<ADXL343_REG_OFSX, 0x00> {};
+struct Ofsy : Register<ADXL343_REG_OFSY, 0x00> {};
+struct Ofsz : Register<ADXL343_REG_OFSZ, 0x00> {};
+struct Dur : Register<ADXL343_REG_DUR, 0x00> {};
+struct Latent : Register<ADXL343_REG_LATENT, 0x00> {};
+struct Window : Register<ADXL343_REG_WINDOW, 0x00> {};
+struct ThreshAct : Register<ADXL343_REG_THRESH_ACT, 0x00> {};
+struct ThreshInact : Register<ADXL343_REG_THRESH_INACT, 0x00> {};
+struct TimeInact : Register<ADXL343_REG_TIME_INACT, 0x00> {};
+
+struct ActInactCtl : Register<ADXL343_REG_ACT_INACT_CTL, 0x00> {
+    using ActAc = Field<ActInactCtl, 7, 1, bool>;
+    using ActAxes = Field<ActInactCtl, 4, 3>;   // X = 4, Y = 2, Z = 1
+    using InactAc = Field<ActInactCtl, 3, 1, bool>;
+    using InactAxes = Field<ActInactCtl, 0, 3>;
+};
+
+struct ThreshFf : Register<ADXL343_REG_THRESH_FF, 0x00> {};
+struct TimeFf : Register<ADXL343_REG_TIME_FF, 0x00> {};
+
+struct TapAxes : Register<ADXL343_REG_TAP_AXES, 0x00> {
+    using Suppress = Field<TapAxes, 3, 1, bool>;
+    using Axes = Field<TapAxes, 0, 3>;
+};
+
+struct ActTapStatus : Register<ADXL343_REG_ACT_TAP_STATUS, 0x00, Access::Read> {
+    using ActAxes = Field<ActTapStatus, 4, 3>;
+    using Asleep = Field<ActTapStatus, 3, 1, bool>;
+    using TapAxes = Field<ActTapStatus, 0, 3>;
+};
+
+struct BwRate : Register<ADXL343_REG_BW_RATE, ADXL343_RATE_100HZ> {
+    using LowPower = Field<BwRate, 4, 1, bool>;
+    using Rate = Field<BwRate, 0, 4, adxl343_rate_t>;
+};
+
+struct PowerCtl : Register<ADXL343_REG_POWER_CTL, 0x00> {
+    using Link = Field<PowerCtl, 5, 1, bool>;
+    using AutoSleep = Field<PowerCtl, 4, 1, bool>;
+    using Measure = Field<PowerCtl, 3, 1, bool>;
+    using Sleep = Field<PowerCtl, 2, 1, bool>;
+    using Wakeup = Field<PowerCtl, 0, 2>;
+};
+
+struct IntEnable : Register<ADXL343_REG_INT_ENABLE, 0x00>, InterruptFields<IntEnable> {};
+struct IntMap : Register<ADXL343_REG_INT_MAP, 0x00>, InterruptFields<IntMap> {};
+struct IntSource : Register<ADXL343_REG_INT_SOURCE, ADXL343_INT_WATERMARK, Access::Read>,
+                   InterruptFields<IntSource> {};
+
+struct DataFormat : Register<ADXL343_REG_DATA_FORMAT, 0x00> {
+    using SelfTest = Field<DataFormat, 7, 1, bool>;
+    using Spi = Field<DataFormat, 6, 1, bool>;
+    using IntInvert = Field<DataFormat, 5, 1, bool>;
+    using FullRes = Field<DataFormat, 3, 1, bool>;
+    using Justify = Field<DataFormat, 2, 1, bool>;
+    using Range = Field<DataFormat, 0, 2, adxl343_range_t>;
+};
+
+struct DataX0 : Register<ADXL343_REG_DATAX0, 0x00, Access::Read> {};
+struct DataX1 : Register<ADXL343_REG_DATAX1, 0x00, Access::Read> {};
+struct DataY0 : Register<ADXL343_REG_DATAY0, 0x00, Access::Read> {};
+struct DataY1 : Register<ADXL343_REG_DATAY1, 0x00, Access::Read> {};
+struct DataZ0 : Register<ADXL343_REG_DATAZ0, 0x00, Access::Read> {};
+struct DataZ1 : Register<ADXL343_REG_DATAZ1, 0x00, Access::Read> {};
+
+struct FifoCtl : Register<ADXL343_REG_FIFO_CTL, 0x00> {
+    using Mode = Field<FifoCtl, 6, 2, FifoMode>;
+    using TriggerInt2 = Field<FifoCtl, 5, 1, bool>;
+    using Samples = Field<FifoCtl, 0, 5>;
+};
+
+struct FifoStatus : Register<ADXL343_REG_FIFO_STATUS, 0x00, Access::Read> {
+    using Trig = Field<FifoStatus, 7, 1, bool>;
+    using Entries = Field<FifoStatus, 0, 6>;
+};
+
+}
+
+}
@@ -0,0 +1,47 @@
+#ifndef ADXL343_RESAMPLE_H
+#define ADXL343_RESAMPLE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ADXL343.h"
+
+// Fractional resampler to an exact output rate.
+//
+// The sensor's oscillator puts its real output data rate a fraction of a
+// percent to a few percent off the BW_RATE nominal. The resampler takes
+// the real rate, e.g. from adxl343_sync_drift_ppm(), and produces samples
+// at exactly `out_hz` by cubic Lagrange interpolation in Farrow form: the
+// four samples around each output instant give a cubic whose coefficients
+// are evaluated with Horner's rule at the fractional position, Q15.
+//
+// The read position advances in Q32 input samples; rounding the ratio to
+// Q32 adds at most 0.04 samples of drift per day at 3200 Hz. The first
+// output lines up with the first input sample, and output j falls on input
+// position j * in_hz / out_hz; it is produced once the sample two past that
+// position has arrived. There is no anti-alias filter, so the output rate
+// should be close to or above the input rate. Left-justified Q15 samples
+// (DATA_FORMAT.JUSTIFY) are taken as they are; outputs saturate at the
+// int16 limits.
+
+typedef struct {
+    uint64_t step;            // input samples per output sample, Q32
+    uint64_t pos;             // next output, Q32, from the interpolated interval
+    adxl343_sample_t window[4];
+    bool primed;
+} adxl343_resampler_t;
+
+// Returns false unless both rates are positive and within a factor of 2^16.
+bool adxl343_resampler_init(adxl343_resampler_t *rs, float in_hz, float out_hz);
+
+// Follow a new estimate of the input rate without disturbing the phase.
+bool adxl343_resampler_set_rate(adxl343_resampler_t *rs, float in_hz, float out_hz);
+
+// Resample `count` samples, writing at most `max_out` outputs to `out`.
+// Input is consumed in full; with `max_out` of at least
+// count * out_hz / in_hz + 1 nothing is dropped. Returns the number written.
+size_t adxl343_resampler_process(adxl343_resampler_t *rs, const adxl343_sample_t *samples, size_t count,
+                                 adxl343_sample_t *out, size_t max_out);
+
+#endif // ADXL343_RESAMPLE_H
@@ -0,0 +1,80 @@
+#ifndef ADXL343_SELFTEST_H
+#define ADXL343_SELFTEST_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ADXL343.h"
+#include "ADXL343_op.h"
+
+// Boot-time self-test with a pass/fail verdict.
+//
+// The sensor is switched to full resolution +-16 g at a high rate and the
+// FIFO, in FIFO mode, collects a block of samples without the self-test
+// force and then a block with DATA_FORMAT.SELF_TEST set. Each block is
+// drained once FIFO_STATUS shows it complete, one FIFO entry per poll, so
+// nothing waits on per-sample DATA_READY and the whole test takes little
+// more than 2 * (settle + samples) output periods plus the polls: about
+// 100 ms with the defaults, against 400 ms for the 100 Hz
+// adxl343_op_begin_self_test(). INT_SOURCE is not read, so latched events
+// survive.
+//
+// Per axis the output change and its standard error come from the means
+// and variances of the two blocks. An axis passes when the change lies
+// within the limits by at least three standard errors and fails when it
+// lies outside them by as much; in between, typically because the part
+// was moved during the test, the result is inconclusive and the test
+// should be repeated.
+//
+// Like the operations of ADXL343_op.h the test is advanced by a poll that
+// does at most one register transfer per call, and it runs on the same
+// step machine as adxl343_op_begin_self_test().
+//
+//     adxl343_selftest_begin(&st, dev, &adxl343_selftest_default);
+//     while ((status = adxl343_selftest_poll(&st)) == ADXL343_PENDING) {
+//         ...other work...
+//     }
+
+typedef struct {
+    adxl343_rate_t rate;      // 100 Hz to 800 Hz, or 3200 Hz
+    uint8_t settle;           // samples discarded after each switch
+    uint8_t samples;          // averaged per block, 2 or more; settle + samples <= 32
+    int16_t min_mg[3];        // accepted output change per axis
+    int16_t max_mg[3];
+} adxl343_selftest_config_t;
+
+// 800 Hz, 4 + 28 samples per block and the datasheet limits at 2.5 V:
+// X +0.20 to +2.10 g, Y -2.10 to -0.20 g, Z +0.30 to +3.40 g
+extern const adxl343_selftest_config_t adxl343_selftest_default;
+
+typedef struct {
+    adxl343_dev_t *dev;
+    adxl343_selftest_config_t config;
+    adxl343_op_self_test_t steps;
+    int status;               // last result of adxl343_selftest_poll()
+    bool filled;              // FIFO_STATUS showed the block complete
+    uint8_t index;            // entries read from the current block
+    int32_t sum[2][3];        // per block: without, with the force
+    int64_t sum_sq[2][3];
+
+    float delta_mg[3];        // output change
+    float sigma_mg[3];        // its standard error
+    uint8_t failed;           // axes outside the limits, bit 0 = X
+    uint8_t uncertain;        // axes neither passed nor failed
+} adxl343_selftest_t;
+
+// Start the test on `dev`, which must be measuring. Returns
+// ADXL343_ERROR_ARGUMENT for a rate the self-test is not specified at, a
+// block that does not fit the FIFO or inverted limits. BW_RATE,
+// DATA_FORMAT and FIFO_CTL are restored afterwards, also when a transfer
+// fails; the FIFO contents are lost.
+int adxl343_selftest_begin(adxl343_selftest_t *st, adxl343_dev_t *dev, const adxl343_selftest_config_t *config);
+
+// Advance the test by at most one transfer. Returns ADXL343_PENDING while
+// it runs, then ADXL343_OK if every axis passed, ADXL343_ERROR_DEVICE if
+// any failed, ADXL343_ERROR_STATE if the result was inconclusive or a bus
+// status; the result sticks on every call after.
+int adxl343_selftest_poll(adxl343_selftest_t *st);
+
+#endif // ADXL343_SELFTEST_H
@@ -0,0 +1,100 @@
+#ifndef ADXL343_SHOCK_H
+#define ADXL343_SHOCK_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ADXL343.h"
+
+// Shock event recorder.
+//
+// The FIFO runs in trigger mode with the activity interrupt routed to INT1
+// as the trigger, so when an impact crosses THRESH_ACT the sensor freezes
+// the samples leading up to it and collects the rest of its 32 entries
+// without overwriting them. Every service call drains the FIFO into a
+// software history ring, which extends the pre-trigger window beyond what
+// the FIFO holds. On the trigger the recorder takes a record from a fixed
+// pool, copies `pre` samples of history, appends `post` samples from the
+// trigger sample on, and then re-arms the FIFO.
+//
+// Only history that is known to be contiguous is copied: after a FIFO
+// overrun or a re-arm the available pre-trigger count restarts from zero,
+// so a record may hold fewer than `pre` leading samples but never a gap.
+//
+// The other interrupt sources are routed to INT2 so they cannot fire the
+// trigger. Record and pool sizes are fixed at compile time.
+
+#ifndef ADXL343_SHOCK_MAX_PRE
+#define ADXL343_SHOCK_MAX_PRE 128
+#endif
+
+#ifndef ADXL343_SHOCK_MAX_POST
+#define ADXL343_SHOCK_MAX_POST 256
+#endif
+
+#ifndef ADXL343_SHOCK_POOL_SIZE
+#define ADXL343_SHOCK_POOL_SIZE 4
+#endif
+
+// Record flags
+#define ADXL343_SHOCK_NO_EDGE   0x01 // no sample over threshold, trigger placed at the first one read
+#define ADXL343_SHOCK_TRUNCATED 0x02 // FIFO overran during capture, record ends early
+
+typedef enum {
+    ADXL343_SHOCK_FREE,
+    ADXL343_SHOCK_CAPTURING,
+    ADXL343_SHOCK_READY,
+    ADXL343_SHOCK_TAKEN,
+} adxl343_shock_state_t;
+
+typedef struct {
+    adxl343_sample_t samples[ADXL343_SHOCK_MAX_PRE + ADXL343_SHOCK_MAX_POST];
+    uint16_t pre;       // samples before the trigger sample, samples[pre] is the trigger
+    uint16_t count;     // valid samples
+    uint8_t flags;
+    uint8_t state;
+    uint32_t sequence;  // event number, for ordering records
+    uint32_t index;     // samples drained since adxl343_shock_init() before the trigger sample
+} adxl343_shock_record_t;
+
+typedef struct {
+    uint16_t pre;       // history samples to keep, up to ADXL343_SHOCK_MAX_PRE
+    uint16_t post;      // samples from the trigger on, 1 to ADXL343_SHOCK_MAX_POST
+    uint8_t threshold;  // THRESH_ACT, 62.5 mg/LSB
+    uint8_t axes;       // ADXL343_ACT_X / _Y / _Z
+} adxl343_shock_config_t;
+
+typedef struct {
+    adxl343_dev_t *dev;
+    adxl343_shock_config_t config;
+    int32_t threshold_lsb;
+
+    adxl343_sample_t history[ADXL343_SHOCK_MAX_PRE];
+    uint16_t history_head;
+    uint16_t history_valid;     // contiguous samples in the ring
+
+    adxl343_shock_record_t pool[ADXL343_SHOCK_POOL_SIZE];
+    adxl343_shock_record_t *active;
+
+    uint32_t events;
+    uint32_t dropped;
+    uint32_t drained;           // samples read since init
+    uint32_t overruns;          // services that found the FIFO overrun
+} adxl343_shock_t;
+
+// Program the activity detector and FIFO trigger mode of `dev`. The sensor
+// must already be initialised and measuring; the current DATA_FORMAT is
+// used to locate the trigger sample.
+int adxl343_shock_init(adxl343_shock_t *rec, adxl343_dev_t *dev, const adxl343_shock_config_t *config);
+
+// Drain the FIFO and advance any capture. Call at least once every 31
+// sample periods, e.g. from the main loop or on the INT1 interrupt.
+int adxl343_shock_service(adxl343_shock_t *rec);
+
+// Oldest completed record, or NULL. The record stays owned by the caller
+// until handed back with adxl343_shock_release().
+adxl343_shock_record_t *adxl343_shock_take(adxl343_shock_t *rec);
+void adxl343_shock_release(adxl343_shock_t *rec, adxl343_shock_record_t *record);
+
+#endif // ADXL343_SHOCK_H
@@ -0,0 +1,85 @@
+#ifndef ADXL343_STATS_H
+#define ADXL343_STATS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ADXL343.h"
+
+// Windowed per-axis vibration statistics.
+//
+// Samples are accumulated in a single pass as integer power sums taken
+// relative to the first sample of the window (the pivot). The pivot keeps
+// the sums small when the signal sits on a large DC level such as gravity,
+// which is what makes the fourth-order sum usable for kurtosis.
+//
+// Left-justified Q15 samples are taken down to 13 bits first, which loses
+// nothing the sensor measured; see adxl343_stats_set_format(). Worst case
+// widths, with deviations limited to 13 bits (|d| <= 8191):
+//   sum1 : n * 2^13  -> int32_t
+//   sum2 : n * 2^26  -> uint64_t
+//   sum3 : n * 2^39  -> int64_t
+//   sum4 : n * 2^52  -> uint64_t, which bounds the window at 4096 samples.
+#define ADXL343_STATS_MAX_WINDOW 4096
+
+typedef struct {
+    int16_t pivot;
+    int16_t min;
+    int16_t max;
+    int32_t sum1;
+    uint64_t sum2;
+    int64_t sum3;
+    uint64_t sum4;
+} adxl343_axis_acc_t;
+
+typedef struct {
+    adxl343_axis_acc_t axis[3];
+    uint16_t window;
+    uint16_t count;
+    uint8_t shift;      // ADXL343_JUSTIFY_SHIFT for left-justified input
+} adxl343_stats_t;
+
+// Per-axis KPIs for one window, in LSBs of the input samples.
+//   mean          DC level
+//   rms           AC RMS, i.e. RMS about the mean
+//   peak          largest excursion from the mean, max(max - mean, mean - min)
+//   peak_to_peak  max - min
+//   crest         peak / rms, 0 when rms is 0
+//   kurtosis      m4 / m2^2 (3.0 for Gaussian noise), 0 when rms is 0
+typedef struct {
+    float mean;
+    float rms;
+    float peak;
+    float peak_to_peak;
+    float crest;
+    float kurtosis;
+} adxl343_axis_stats_t;
+
+typedef struct {
+    adxl343_axis_stats_t axis[3];
+    uint16_t count;
+} adxl343_stats_report_t;
+
+// Start accumulating windows of `window` samples. Windows larger than
+// ADXL343_STATS_MAX_WINDOW are clamped; a window of 0 is treated as 1.
+// Samples are taken to be right-justified.
+void adxl343_stats_init(adxl343_stats_t *stats, uint16_t window);
+
+// Take samples read with `data_format`, i.e. left-justified Q15 when it has
+// JUSTIFY set. Starts a new window.
+void adxl343_stats_set_format(adxl343_stats_t *stats, uint8_t data_format);
+
+// Accumulate up to `count` samples, stopping early when the window fills.
+// Returns the number of samples consumed.
+size_t adxl343_stats_add(adxl343_stats_t *stats, const adxl343_sample_t *samples, size_t count);
+
+// True once the current window holds `window` samples.
+bool adxl343_stats_ready(const adxl343_stats_t *stats);
+
+// Compute the KPIs of the samples accumulated so far and start a new window.
+// May be called before the window fills to flush a partial window. Returns
+// false, leaving `report` untouched, if no samples were accumulated.
+bool adxl343_stats_finish(adxl343_stats_t *stats, adxl343_stats_report_t *report);
+
+#endif // ADXL343_STATS_H
@@ -0,0 +1,106 @@
+#ifndef ADXL343_SYNC_H
+#define ADXL343_SYNC_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ADXL343.h"
+
+// Common timebase for several sensors.
+//
+// Every ADXL343 runs from its own oscillator, so channels set to the same
+// BW_RATE drift apart by up to a few percent. The sync layer estimates
+// each channel's true sample period and phase from the host clock at which
+// its FIFO blocks are drained, maps every sample onto the host timebase
+// and resamples all channels at the same instants into merged frames.
+//
+// A drain time only bounds the newest sample of the block from above; with
+// adxl343_group_t the time of the poll that found the samples is the
+// tightest such bound. Per ADXL343_SYNC_BUCKET_NS the drain that lands
+// closest to its sample is kept as a reference point; the period is the
+// slope across the last ADXL343_SYNC_POINTS reference points, which follows
+// slow oscillator drift with temperature. Frames are interpolated linearly
+// between the two samples around each frame instant.
+//
+// Samples may be right-justified or left-justified Q15 (DATA_FORMAT.JUSTIFY);
+// the interpolation has room for the full 16 bits.
+//
+// The sample index is counted from the blocks pushed, so a FIFO overrun
+// breaks the mapping; call adxl343_sync_restart() for that channel after
+// one.
+
+#ifndef ADXL343_SYNC_MAX_CHANNELS
+#define ADXL343_SYNC_MAX_CHANNELS 8
+#endif
+
+// Samples buffered per channel, enough for the slowest channel to catch up
+#ifndef ADXL343_SYNC_DEPTH
+#define ADXL343_SYNC_DEPTH 64
+#endif
+
+#define ADXL343_SYNC_POINTS 8
+#define ADXL343_SYNC_BUCKET_NS 500000000u
+
+typedef struct {
+    uint64_t k;               // sample index
+    uint64_t t_ns;            // host time it was drained by
+} adxl343_sync_point_t;
+
+typedef struct {
+    adxl343_sample_t ring[ADXL343_SYNC_DEPTH];
+    uint16_t head;
+    uint16_t count;
+    uint64_t first_k;         // index of ring[head]
+    uint64_t next_k;          // index the next pushed sample gets
+
+    int64_t nominal_q12;      // period in ns, Q12
+    int64_t period_q12;       // tracked period in ns, Q12
+    adxl343_sync_point_t points[ADXL343_SYNC_POINTS];
+    uint8_t npoints;
+    uint8_t point_head;       // oldest point
+    adxl343_sync_point_t best;  // closest drain in the open bucket
+    bool have_best;
+    uint64_t bucket_end_ns;
+    uint32_t dropped;         // samples lost to a full ring
+} adxl343_sync_channel_t;
+
+typedef struct {
+    adxl343_sync_channel_t channels[ADXL343_SYNC_MAX_CHANNELS];
+    size_t count;
+    int64_t frame_q12;        // frame period in ns, Q12
+    uint64_t origin_ns;
+    uint64_t next_frame;
+    bool started;
+    uint32_t gaps;            // frames skipped for want of samples
+} adxl343_sync_t;
+
+typedef struct {
+    uint64_t t_ns;
+    adxl343_sample_t channels[ADXL343_SYNC_MAX_CHANNELS];
+} adxl343_frame_t;
+
+// Set up for frames at `frame_hz` on the host timebase.
+int adxl343_sync_init(adxl343_sync_t *sync, float frame_hz);
+
+// Add a channel whose nominal output data rate is `odr_hz`. Returns its
+// index or ADXL343_ERROR_ARGUMENT.
+int adxl343_sync_add(adxl343_sync_t *sync, float odr_hz);
+
+// Queue `count` consecutive samples drained from `channel` by host time
+// `now_ns`. Returns the number queued.
+int adxl343_sync_push(adxl343_sync_t *sync, size_t channel, const adxl343_sample_t *samples, size_t count,
+                      uint64_t now_ns);
+
+// Forget a channel's samples and timing, e.g. after a FIFO overrun.
+void adxl343_sync_restart(adxl343_sync_t *sync, size_t channel);
+
+// Write up to `max` frames that every channel has samples for. Returns the
+// number written.
+size_t adxl343_sync_frames(adxl343_sync_t *sync, adxl343_frame_t *dst, size_t max);
+
+// Tracked rate error of `channel` against its nominal rate, positive when
+// the sensor runs fast.
+float adxl343_sync_drift_ppm(const adxl343_sync_t *sync, size_t channel);
+
+#endif // ADXL343_SYNC_H
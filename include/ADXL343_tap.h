@@ -0,0 +1,76 @@
+#ifndef ADXL343_TAP_H
+#define ADXL343_TAP_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ADXL343.h"
+#include "ADXL343_wom.h"
+
+// Tap and double-tap events from the sensor's own detector.
+//
+// adxl343_tap_init() programs THRESH_TAP, DUR, LATENT, WINDOW and TAP_AXES
+// and routes SINGLE_TAP (and DOUBLE_TAP when LATENT and WINDOW are set) to
+// one interrupt pin. The host only reacts to that pin: adxl343_tap_service()
+// reads ACT_TAP_STATUS through INT_SOURCE in one burst and turns them into
+// events, without touching the data registers or the FIFO, so the sensor
+// can run at a low rate in low power mode while the MCU sleeps.
+//
+//     on INT1: n = adxl343_tap_service(&tap, events, 2);
+//
+// Reading INT_SOURCE clears every latched event, not only the taps; the
+// whole byte is kept in `source` for the caller to dispatch the rest.
+
+// Scale of the timing registers
+#define ADXL343_TAP_US_PER_DUR 625
+#define ADXL343_TAP_US_PER_LATENT 1250
+#define ADXL343_TAP_US_PER_WINDOW 1250
+
+typedef struct {
+    uint8_t threshold;      // THRESH_TAP, 62.5 mg/LSB, nonzero
+    uint8_t duration;       // DUR, longest tap, 625 us/LSB, nonzero
+    uint8_t latent;         // LATENT, 1.25 ms/LSB, from a tap to the window
+    uint8_t window;         // WINDOW, 1.25 ms/LSB; 0 here or in `latent`
+                            // leaves double taps off
+    uint8_t axes;           // TAP_AXES: ADXL343_TAP_X/Y/Z, optionally SUPPRESS
+    uint8_t pin;            // 1 or 2
+} adxl343_tap_config_t;
+
+typedef enum {
+    ADXL343_TAP_SINGLE = 1,
+    ADXL343_TAP_DOUBLE = 2,
+} adxl343_tap_kind_t;
+
+typedef struct {
+    adxl343_tap_kind_t kind;
+    uint8_t axes;           // ACT_TAP_STATUS tap bits, the axes that started it
+} adxl343_tap_event_t;
+
+typedef struct {
+    adxl343_dev_t *dev;
+    uint8_t enabled;        // tap bits set in INT_ENABLE
+    uint8_t source;         // INT_SOURCE at the last service
+    uint32_t singles;
+    uint32_t doubles;
+} adxl343_tap_t;
+
+// Program the detector and enable its interrupts, leaving the other
+// INT_ENABLE and INT_MAP bits alone. Returns ADXL343_ERROR_ARGUMENT for a
+// zero threshold or duration, no axis or an invalid pin.
+int adxl343_tap_init(adxl343_tap_t *tap, adxl343_dev_t *dev, const adxl343_tap_config_t *config);
+
+// Read and decode the interrupt state, one bus transfer. Writes up to
+// `max` events, a single tap before the double tap it began when both are
+// pending, and returns their number or a negative status.
+int adxl343_tap_service(adxl343_tap_t *tap, adxl343_tap_event_t *events, size_t max);
+
+// Sleep the host through `host` until the sensor reports a tap, then
+// return as adxl343_tap_service(). Wake-ups for other events are
+// serviced and slept through again.
+int adxl343_tap_wait(adxl343_tap_t *tap, const adxl343_wom_host_t *host, adxl343_tap_event_t *events, size_t max);
+
+// Disable the tap interrupts again.
+int adxl343_tap_disable(adxl343_tap_t *tap);
+
+#endif // ADXL343_TAP_H
@@ -0,0 +1,172 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "ADXL343_regs.hpp"
+
+// Physical units for the threshold, time and offset registers.
+//
+// Mg, Us, Ms and Hz are distinct types, so a duration cannot end up in a
+// threshold register. encode<Register>() converts a value in the
+// register's unit to its code, rounding to the nearest LSB; a value outside
+// the register's range fails the build when encoded in a constant
+// expression and saturates at run time:
+//
+//     using namespace adxl343::literals;
+//     constexpr auto tap = adxl343::encode<adxl343::reg::ThreshTap>(3_g);    // 0x30
+//     constexpr auto dur = adxl343::encode<adxl343::reg::Dur>(10_ms);        // 0x10
+//
+// LSB weights from the datasheet: THRESH_TAP / ACT / INACT / FF 62.5 mg,
+// OFSX / Y / Z 15.6 mg (1/64 g, signed), DUR 625 us, LATENT and WINDOW
+// 1.25 ms, TIME_FF 5 ms, TIME_INACT 1 s.
+
+namespace adxl343 {
+
+namespace detail {
+
+// Not constexpr: reaching it during constant evaluation fails the build
+inline void unitOutOfRange() {}
+
+// `value` if it is at most `max`; otherwise fails constant evaluation and
+// saturates at run time
+constexpr unsigned long long checked(unsigned long long value, unsigned long long max) {
+    if (value > max) {
+        unitOutOfRange();
+        return max;
+    }
+    return value;
+}
+
+}
+
+// Acceleration in mg.
+struct Mg {
+    int32_t value;
+
+    constexpr Mg operator-() const { return Mg{-value}; }
+};
+
+// Duration in microseconds.
+struct Us {
+    uint32_t value;
+};
+
+// Duration in milliseconds; usable wherever a Us is expected.
+struct Ms {
+    uint32_t value;
+
+    constexpr operator Us() const {
+        return Us{static_cast<uint32_t>(detail::checked(value, UINT32_MAX / 1000) * 1000)};
+    }
+};
+
+// Rate in Hz.
+struct Hz {
+    double value;
+};
+
+namespace literals {
+
+// Values that do not fit the unit's type fail the build like an
+// out-of-range encode() rather than wrapping.
+constexpr Mg operator""_mg(unsigned long long value) {
+    return Mg{static_cast<int32_t>(detail::checked(value, INT32_MAX))};
+}
+constexpr Mg operator""_g(unsigned long long value) {
+    return Mg{static_cast<int32_t>(detail::checked(value, INT32_MAX / 1000) * 1000)};
+}
+constexpr Mg operator""_g(long double value) {
+    long double mg = value * 1000 + 0.5L;
+    if (!(mg <= INT32_MAX)) {
+        detail::unitOutOfRange();
+        mg = INT32_MAX;
+    }
+    return Mg{static_cast<int32_t>(mg)};
+}
+constexpr Us operator""_us(unsigned long long value) {
+    return Us{static_cast<uint32_t>(detail::checked(value, UINT32_MAX))};
+}
+constexpr Ms operator""_ms(unsigned long long value) {
+    return Ms{static_cast<uint32_t>(detail::checked(value, UINT32_MAX))};
+}
+constexpr Us operator""_s(unsigned long long value) {
+    return Us{static_cast<uint32_t>(detail::checked(value, UINT32_MAX / 1000000) * 1000000)};
+}
+constexpr Hz operator""_hz(unsigned long long value) { return Hz{static_cast<double>(value)}; }
+constexpr Hz operator""_hz(long double value) { return Hz{static_cast<double>(value)}; }
+
+}
+
+// Weight of one LSB of `Reg` as `num / den` of `unit`, and whether the
+// code is two's complement.
+template <typename Reg>
+struct Scale;
+
+template <typename Unit, int64_t Num, int64_t Den, bool Signed = false>
+struct ScaleOf {
+    using unit = Unit;
+    static constexpr int64_t num = Num;
+    static constexpr int64_t den = Den;
+    static constexpr bool is_signed = Signed;
+};
+
+template <> struct Scale<reg::ThreshTap> : ScaleOf<Mg, 125, 2> {};
+template <> struct Scale<reg::ThreshAct> : ScaleOf<Mg, 125, 2> {};
+template <> struct Scale<reg::ThreshInact> : ScaleOf<Mg, 125, 2> {};
+template <> struct Scale<reg::ThreshFf> : ScaleOf<Mg, 125, 2> {};
+template <> struct Scale<reg::Ofsx> : ScaleOf<Mg, 125, 8, true> {};
+template <> struct Scale<reg::Ofsy> : ScaleOf<Mg, 125, 8, true> {};
+template <> struct Scale<reg::Ofsz> : ScaleOf<Mg, 125, 8, true> {};
+template <> struct Scale<reg::Dur> : ScaleOf<Us, 625, 1> {};
+template <> struct Scale<reg::Latent> : ScaleOf<Us, 1250, 1> {};
+template <> struct Scale<reg::Window> : ScaleOf<Us, 1250, 1> {};
+template <> struct Scale<reg::TimeFf> : ScaleOf<Us, 5000, 1> {};
+template <> struct Scale<reg::TimeInact> : ScaleOf<Us, 1000000, 1> {};
+
+template <typename Reg>
+constexpr Value<Reg> encode(typename Scale<Reg>::unit value) {
+    using S = Scale<Reg>;
+    constexpr int64_t lo = S::is_signed ? -128 : 0;
+    constexpr int64_t hi = S::is_signed ? 127 : 255;
+
+    // Nearest code, halves away from zero
+    int64_t scaled = 2 * static_cast<int64_t>(value.value) * S::den;
+    int64_t code = scaled >= 0 ? (scaled + S::num) / (2 * S::num) : -((S::num - scaled) / (2 * S::num));
+    if (code < lo || code > hi) {
+        detail::unitOutOfRange();
+        code = code < lo ? lo : hi;
+    }
+    return Value<Reg>(static_cast<uint8_t>(code));
+}
+
+// The value a register code stands for, truncated to whole units.
+template <typename Reg>
+constexpr typename Scale<Reg>::unit decode(Value<Reg> value) {
+    using S = Scale<Reg>;
+    int64_t code = S::is_signed ? static_cast<int8_t>(value.raw) : value.raw;
+    using T = decltype(typename S::unit{}.value);
+    return typename S::unit{static_cast<T>(code * S::num / S::den)};
+}
+
+// BW_RATE code with the output data rate nearest to `hz`. In a constant
+// expression the rate has to be within 3% of one the sensor has, which
+// covers the rounded figures of the datasheet table (0.10 Hz for 0.098 Hz).
+constexpr adxl343_rate_t rate(Hz hz) {
+    int best = ADXL343_RATE_3200HZ;
+    double best_ratio = 0.0;
+    double odr = 3200.0;
+    for (int code = ADXL343_RATE_3200HZ; code >= ADXL343_RATE_0_10HZ; code--) {
+        double ratio = hz.value > odr ? hz.value / odr : odr / hz.value;
+        if (code == ADXL343_RATE_3200HZ || ratio < best_ratio) {
+            best = code;
+            best_ratio = ratio;
+        }
+        odr /= 2;
+    }
+    if (!(best_ratio <= 1.03)) {
+        detail::unitOutOfRange();
+    }
+    return static_cast<adxl343_rate_t>(best);
+}
+
+}
@@ -0,0 +1,75 @@
+#ifndef ADXL343_VELOCITY_H
+#define ADXL343_VELOCITY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ADXL343.h"
+
+// Acceleration to velocity conversion with windowed velocity RMS, for
+// ISO 10816 style severity figures.
+//
+// Per axis the stage runs a first order high-pass on acceleration, which
+// removes gravity and offset so the integrator never sees DC, followed by a
+// leaky trapezoidal integrator with the same corner. The result is a band
+// limited velocity with a second order roll-off below `highpass_hz`; the
+// upper band edge is the sensor bandwidth set by BW_RATE (ODR / 2).
+//
+// The integrator has room for 13-bit input, so left-justified Q15 samples
+// (DATA_FORMAT.JUSTIFY) are taken down to 13 bits first, which loses
+// nothing the sensor measured. Filter state is Q8 fixed point. The squared
+// velocity sum is kept in 64 bits with the same 4096 sample window limit as
+// the statistics accumulator.
+#define ADXL343_VELOCITY_MAX_WINDOW 4096
+
+typedef struct {
+    float odr_hz;         // output data rate of the incoming samples
+    float highpass_hz;    // lower band edge, e.g. 10 Hz for ISO 10816
+    uint16_t window;      // samples per RMS window
+    uint8_t data_format;  // DATA_FORMAT the samples were read with, sets their scale
+} adxl343_velocity_config_t;
+
+typedef struct {
+    int16_t prev_in;
+    int32_t accel;      // high-passed acceleration, Q8 LSB
+    int32_t velocity;   // integrated acceleration, Q8 LSB * sample
+    uint64_t sum_sq;    // sum of velocity^2 >> 8
+} adxl343_velocity_axis_t;
+
+typedef struct {
+    adxl343_velocity_axis_t axis[3];
+    int32_t leak;       // 1 - pole, Q15
+    float scale;        // LSB * sample to mm/s
+    uint16_t window;
+    uint16_t count;
+    uint8_t shift;      // ADXL343_JUSTIFY_SHIFT for left-justified input
+    bool primed;
+} adxl343_velocity_t;
+
+typedef struct {
+    float rms_mm_s[3];
+    uint16_t count;
+} adxl343_velocity_report_t;
+
+// Configure the stage. Returns false if the rates are not usable, i.e. the
+// high-pass corner is not positive or not below a quarter of the ODR. The
+// window is clamped to 1..ADXL343_VELOCITY_MAX_WINDOW.
+bool adxl343_velocity_init(adxl343_velocity_t *vel, const adxl343_velocity_config_t *config);
+
+// Clear the filter state, e.g. after a gap in the sample stream.
+void adxl343_velocity_reset(adxl343_velocity_t *vel);
+
+// Run up to `count` samples through the integrator, stopping early when the
+// window fills. Returns the number of samples consumed.
+size_t adxl343_velocity_add(adxl343_velocity_t *vel, const adxl343_sample_t *samples, size_t count);
+
+// True once the current window holds `window` samples.
+bool adxl343_velocity_ready(const adxl343_velocity_t *vel);
+
+// Report the velocity RMS of the current window and start a new one. The
+// filter state carries over so consecutive windows are continuous. Returns
+// false if the window is empty.
+bool adxl343_velocity_finish(adxl343_velocity_t *vel, adxl343_velocity_report_t *report);
+
+#endif // ADXL343_VELOCITY_H
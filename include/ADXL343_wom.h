@@ -0,0 +1,42 @@
+#ifndef ADXL343_WOM_H
+#define ADXL343_WOM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "ADXL343.h"
+
+// Wake-on-motion: park the host until the sensor sees activity.
+//
+// adxl343_wom_sleep() saves the acquisition setup, arms the activity
+// interrupt on INT1 at a low output data rate, clears any stale latch and
+// hands over to the host's wait hook, which on the Pico puts the RP2040
+// into dormant (or light sleep) until INT1 goes high. On wake the saved
+// registers are restored in three bus writes.
+//
+// LINK, AUTO_SLEEP and SLEEP are cleared while armed, passing through
+// standby if any was set, and put back on wake; in link mode the sensor
+// then starts again by waiting for inactivity. Otherwise the sensor stays
+// in measurement mode. FIFO_CTL is never touched, so there is no turn-on
+// delay and the samples taken around the wake-up event are still in the
+// FIFO when the acquisition loop resumes.
+
+typedef struct {
+    // Block until INT1 is high. Returning early is allowed; the caller
+    // simply treats it as a wake-up.
+    void (*wait_for_interrupt)(void *ctx);
+    void *ctx;
+} adxl343_wom_host_t;
+
+typedef struct {
+    uint8_t threshold;      // THRESH_ACT, 62.5 mg/LSB
+    uint8_t axes;           // activity bits of ACT_INACT_CTL, ADXL343_ACT_AC recommended
+    adxl343_rate_t rate;    // output data rate while waiting
+    bool low_power;         // set BW_RATE.LOW_POWER while waiting
+} adxl343_wom_config_t;
+
+// Arm `dev`, sleep the host and restore. Returns ADXL343_OK once woken and
+// the previous configuration is back in place.
+int adxl343_wom_sleep(adxl343_dev_t *dev, const adxl343_wom_config_t *config, const adxl343_wom_host_t *host);
+
+#endif // ADXL343_WOM_H
@@ -1,7 +1,216 @@
 #include "ADXL343.h"
-// Other necessary includes...
 
-// Implementation of internal functions...
-void adxl343_init() {
-	return;
+#include <string.h>
+
+#include "ADXL343_op.h"
+
+#ifdef ADXL343_PICO_SDK
+#include "ADXL343_pico.h"
+#endif
+
+// Largest burst written through adxl343_write_regs
+#define MAX_WRITE 32
+
+static adxl343_dev_t device = {
+    .bus = NULL,
+    .address = ADXL343_ADDRESS,
+};
+
+adxl343_dev_t *adxl343_default_device(void) {
+#if defined(ADXL343_PICO_SDK) && defined(i2c_default)
+    if (device.bus == NULL) {
+        device.bus = adxl343_pico_i2c_bus(i2c_default);
+    }
+#endif
+    return &device;
+}
+
+void adxl343_dev_set_bus(adxl343_dev_t *dev, const adxl343_bus_t *bus, uint8_t address) {
+    dev->bus = bus;
+    dev->address = address;
+}
+
+int adxl343_dev_init(adxl343_dev_t *dev) {
+    adxl343_op_t op;
+    int status;
+
+    adxl343_op_begin_init(&op, dev);
+    do {
+        status = adxl343_op_poll(&op);
+    } while (status == ADXL343_PENDING);
+    return status;
+}
+
+int adxl343_dev_read_regs(adxl343_dev_t *dev, uint8_t reg, uint8_t *dst, size_t len) {
+    const adxl343_bus_t *bus = dev->bus;
+    if (bus == NULL) {
+        return ADXL343_ERROR_STATE;
+    }
+    if (bus->read(bus->ctx, dev->address, reg, dst, len) < 0) {
+        return ADXL343_ERROR_BUS;
+    }
+    return ADXL343_OK;
+}
+
+int adxl343_dev_write_regs(adxl343_dev_t *dev, uint8_t reg, const uint8_t *src, size_t len) {
+    const adxl343_bus_t *bus = dev->bus;
+    if (bus == NULL) {
+        return ADXL343_ERROR_STATE;
+    }
+    if (len > MAX_WRITE) {
+        return ADXL343_ERROR_ARGUMENT;
+    }
+    if (bus->write(bus->ctx, dev->address, reg, src, len) < 0) {
+        return ADXL343_ERROR_BUS;
+    }
+    return ADXL343_OK;
+}
+
+int adxl343_dev_read_reg(adxl343_dev_t *dev, uint8_t reg, uint8_t *value) {
+    return adxl343_dev_read_regs(dev, reg, value, 1);
+}
+
+int adxl343_dev_write_reg(adxl343_dev_t *dev, uint8_t reg, uint8_t value) {
+    return adxl343_dev_write_regs(dev, reg, &value, 1);
+}
+
+int adxl343_dev_update_reg(adxl343_dev_t *dev, uint8_t reg, uint8_t mask, uint8_t value) {
+    uint8_t current;
+    int status = adxl343_dev_read_reg(dev, reg, &current);
+    if (status != ADXL343_OK) {
+        return status;
+    }
+    return adxl343_dev_write_reg(dev, reg, (uint8_t)((current & ~mask) | (value & mask)));
+}
+
+int adxl343_dev_read_sample(adxl343_dev_t *dev, adxl343_sample_t *sample) {
+    uint8_t raw[6];
+    int status = adxl343_dev_read_regs(dev, ADXL343_REG_DATAX0, raw, sizeof(raw));
+    if (status != ADXL343_OK) {
+        return status;
+    }
+
+    sample->x = (int16_t)(raw[0] | (raw[1] << 8));
+    sample->y = (int16_t)(raw[2] | (raw[3] << 8));
+    sample->z = (int16_t)(raw[4] | (raw[5] << 8));
+
+    return ADXL343_OK;
+}
+
+int adxl343_dev_fifo_status(adxl343_dev_t *dev, uint8_t *status) {
+    return adxl343_dev_read_reg(dev, ADXL343_REG_FIFO_STATUS, status);
+}
+
+int adxl343_dev_read_fifo(adxl343_dev_t *dev, adxl343_sample_t *dst, size_t max) {
+    uint8_t fifo;
+    int status = adxl343_dev_fifo_status(dev, &fifo);
+    if (status != ADXL343_OK) {
+        return status;
+    }
+
+    size_t entries = fifo & ADXL343_FIFO_ENTRIES_MASK;
+    if (entries > max) {
+        entries = max;
+    }
+
+    // Each entry has to be popped with its own burst of the data registers
+    for (size_t i = 0; i < entries; i++) {
+        status = adxl343_dev_read_sample(dev, &dst[i]);
+        if (status != ADXL343_OK) {
+            return status;
+        }
+    }
+
+    return (int)entries;
+}
+
+int adxl343_dev_read_int_source(adxl343_dev_t *dev, uint8_t *source) {
+    return adxl343_dev_read_reg(dev, ADXL343_REG_INT_SOURCE, source);
+}
+
+void adxl343_set_bus(const adxl343_bus_t *bus, uint8_t address) {
+    adxl343_dev_set_bus(&device, bus, address);
+}
+
+int adxl343_init(void) {
+    return adxl343_dev_init(adxl343_default_device());
+}
+
+int adxl343_read_regs(uint8_t reg, uint8_t *dst, size_t len) {
+    return adxl343_dev_read_regs(adxl343_default_device(), reg, dst, len);
+}
+
+int adxl343_write_regs(uint8_t reg, const uint8_t *src, size_t len) {
+    return adxl343_dev_write_regs(adxl343_default_device(), reg, src, len);
+}
+
+int adxl343_read_reg(uint8_t reg, uint8_t *value) {
+    return adxl343_dev_read_reg(adxl343_default_device(), reg, value);
+}
+
+int adxl343_write_reg(uint8_t reg, uint8_t value) {
+    return adxl343_dev_write_reg(adxl343_default_device(), reg, value);
+}
+
+int adxl343_update_reg(uint8_t reg, uint8_t mask, uint8_t value) {
+    return adxl343_dev_update_reg(adxl343_default_device(), reg, mask, value);
+}
+
+int adxl343_read_sample(adxl343_sample_t *sample) {
+    return adxl343_dev_read_sample(adxl343_default_device(), sample);
+}
+
+int adxl343_fifo_status(uint8_t *status) {
+    return adxl343_dev_fifo_status(adxl343_default_device(), status);
+}
+
+int adxl343_read_fifo(adxl343_sample_t *dst, size_t max) {
+    return adxl343_dev_read_fifo(adxl343_default_device(), dst, max);
+}
+
+int adxl343_read_int_source(uint8_t *source) {
+    return adxl343_dev_read_int_source(adxl343_default_device(), source);
+}
+
+float adxl343_rate_hz(adxl343_rate_t rate) {
+    // Each code doubles the rate of the one below, 100 Hz at 0x0A
+    int shift = (int)(rate & ADXL343_BW_RATE_MASK) - ADXL343_RATE_100HZ;
+    return shift >= 0 ? 100.0f * (float)(1 << shift) : 100.0f / (float)(1 << -shift);
+}
+
+float adxl343_mg_per_lsb(uint8_t data_format) {
+    uint8_t range = data_format & ADXL343_FORMAT_RANGE_MASK;
+    if (data_format & ADXL343_FORMAT_JUSTIFY) {
+        // Full scale over the 16-bit register pair
+        return 2000.0f * (float)(1 << range) / 32768.0f;
+    }
+    if (data_format & ADXL343_FORMAT_FULL_RES) {
+        return 1000.0f / 256.0f;
+    }
+    return 1000.0f / (float)(256 >> range);
+}
+
+int adxl343_q15_shift(uint8_t data_format) {
+    if (data_format & ADXL343_FORMAT_JUSTIFY) {
+        return 0;
+    }
+    // 10 bits, or in full resolution one more per range step
+    int bits = 10;
+    if (data_format & ADXL343_FORMAT_FULL_RES) {
+        bits += data_format & ADXL343_FORMAT_RANGE_MASK;
+    }
+    return 16 - bits;
+}
+
+void adxl343_to_q15(adxl343_sample_t *samples, size_t count, uint8_t data_format) {
+    int shift = adxl343_q15_shift(data_format);
+    if (shift == 0) {
+        return;
+    }
+    int32_t scale = 1 << shift;
+    for (size_t i = 0; i < count; i++) {
+        samples[i].x = (int16_t)(samples[i].x * scale);
+        samples[i].y = (int16_t)(samples[i].y * scale);
+        samples[i].z = (int16_t)(samples[i].z * scale);
+    }
 }
@@ -0,0 +1,154 @@
+#include "ADXL343_autorange.h"
+
+// 10-bit samples span -512..511
+#define LIMIT 512
+#define HIGH (LIMIT * 7 / 8)
+#define LOW (LIMIT * 3 / 8)
+
+static int set_range(adxl343_autorange_t *ar, adxl343_range_t range) {
+    uint8_t format = (uint8_t)((ar->format & ~ADXL343_FORMAT_RANGE_MASK) | range);
+    int status = adxl343_dev_write_reg(ar->dev, ADXL343_REG_DATA_FORMAT, format);
+    if (status == ADXL343_OK) {
+        ar->format = format;
+    }
+    return status;
+}
+
+static int32_t magnitude(int16_t v) {
+    return v < 0 ? -(int32_t)v : v;
+}
+
+// Count clipped samples of a block taken with the current format and
+// return its peak magnitude in 10-bit LSBs
+static int32_t scan(adxl343_autorange_t *ar, const adxl343_sample_t *s, size_t count) {
+    int shift = (ar->format & ADXL343_FORMAT_JUSTIFY) ? 16 - 10 : 0;
+    int32_t rail = (LIMIT - 1) << shift;
+    int32_t peak = 0;
+    uint32_t clipped = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        int32_t x = magnitude(s[i].x);
+        int32_t y = magnitude(s[i].y);
+        int32_t z = magnitude(s[i].z);
+        int32_t m = x > y ? x : y;
+        m = m > z ? m : z;
+        if (m >= rail) {
+            clipped++;
+        }
+        if (m > peak) {
+            peak = m;
+        }
+    }
+
+    ar->clipped += clipped;
+    if (clipped > 0) {
+        ar->incidents++;
+    }
+    return peak >> shift;
+}
+
+static void decide(adxl343_autorange_t *ar, int32_t peak) {
+    adxl343_range_t range = (adxl343_range_t)(ar->format & ADXL343_FORMAT_RANGE_MASK);
+
+    if (peak >= LIMIT - 1) {
+        // Clipped: the real peak is unknown, so make room for anything
+        ar->quiet = 0;
+        ar->target = ar->config.max_range;
+    } else if (peak >= HIGH) {
+        ar->quiet = 0;
+        ar->target = range < ar->config.max_range ? (adxl343_range_t)(range + 1) : range;
+    } else if (peak < LOW && range > ar->config.min_range && ar->target == range) {
+        if (++ar->quiet >= ar->config.hold) {
+            ar->quiet = 0;
+            ar->target = (adxl343_range_t)(range - 1);
+        }
+    } else if (peak >= LOW) {
+        ar->quiet = 0;
+    }
+}
+
+int adxl343_autorange_init(adxl343_autorange_t *ar, adxl343_dev_t *dev, const adxl343_autorange_config_t *config) {
+    if (config->watermark == 0 || config->watermark > ADXL343_FIFO_SAMPLES_MASK || config->hold == 0 ||
+        config->min_range > config->max_range || config->max_range > ADXL343_RANGE_16G) {
+        return ADXL343_ERROR_ARGUMENT;
+    }
+
+    uint8_t format;
+    int status = adxl343_dev_read_reg(dev, ADXL343_REG_DATA_FORMAT, &format);
+    if (status != ADXL343_OK) {
+        return status;
+    }
+
+    ar->dev = dev;
+    ar->config = *config;
+    ar->format = (uint8_t)(format & ~(ADXL343_FORMAT_FULL_RES | ADXL343_FORMAT_SELF_TEST));
+    ar->target = config->max_range;
+    ar->quiet = 0;
+    ar->switches = 0;
+    ar->incidents = 0;
+    ar->clipped = 0;
+
+    const uint8_t interrupts = ADXL343_INT_WATERMARK;
+
+    status = adxl343_dev_write_reg(dev, ADXL343_REG_INT_ENABLE, 0);
+    if (status == ADXL343_OK) {
+        status = set_range(ar, config->max_range);
+    }
+    if (status == ADXL343_OK) {
+        status = adxl343_dev_write_reg(dev, ADXL343_REG_FIFO_CTL, ADXL343_FIFO_BYPASS);
+    }
+    if (status == ADXL343_OK) {
+        status = adxl343_dev_write_reg(dev, ADXL343_REG_FIFO_CTL, ADXL343_FIFO_STREAM | config->watermark);
+    }
+    if (status == ADXL343_OK) {
+        status = adxl343_dev_write_reg(dev, ADXL343_REG_INT_MAP, (uint8_t)~interrupts);
+    }
+    if (status == ADXL343_OK) {
+        status = adxl343_dev_write_reg(dev, ADXL343_REG_INT_ENABLE, interrupts);
+    }
+
+    return status;
+}
+
+int adxl343_autorange_service(adxl343_autorange_t *ar, adxl343_sample_t *dst, size_t max, uint8_t *format) {
+    *format = ar->format;
+    int count = adxl343_dev_read_fifo(ar->dev, dst, max);
+    if (count < 0) {
+        return count;
+    }
+    if (count > 0) {
+        decide(ar, scan(ar, dst, (size_t)count));
+    }
+
+    adxl343_range_t range = (adxl343_range_t)(ar->format & ADXL343_FORMAT_RANGE_MASK);
+    if (ar->target == range) {
+        return count;
+    }
+
+    uint8_t fifo;
+    int status = adxl343_dev_fifo_status(ar->dev, &fifo);
+    if (status != ADXL343_OK) {
+        return status;
+    }
+    if (fifo & ADXL343_FIFO_ENTRIES_MASK) {
+        // Samples at the old range are still queued, switch on a later call
+        return count;
+    }
+
+    status = set_range(ar, ar->target);
+    if (status != ADXL343_OK) {
+        return status;
+    }
+    ar->switches++;
+
+    // Anything that landed while DATA_FORMAT was being written was taken
+    // at the old range, so it belongs with this batch; it only counts
+    // towards the clipping statistics.
+    int late = adxl343_dev_read_fifo(ar->dev, &dst[count], max - (size_t)count);
+    if (late < 0) {
+        return late;
+    }
+    scan(ar, &dst[count], (size_t)late);
+
+    return count + late;
+}
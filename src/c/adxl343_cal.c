@@ -0,0 +1,41 @@
+#include "ADXL343_cal.h"
+
+#define ONE (1 << ADXL343_CAL_FRAC_BITS)
+#define HALF (1 << (ADXL343_CAL_FRAC_BITS - 1))
+
+void adxl343_cal_identity(adxl343_cal_t *cal) {
+    for (int r = 0; r < 3; r++) {
+        for (int c = 0; c < 3; c++) {
+            cal->m[r][c] = (int16_t)(r == c ? ONE : 0);
+        }
+        cal->offset[r] = 0;
+    }
+}
+
+static int32_t saturate(int32_t v) {
+    if (v > INT16_MAX) {
+        return INT16_MAX;
+    }
+    if (v < INT16_MIN) {
+        return INT16_MIN;
+    }
+    return v;
+}
+
+void adxl343_cal_apply(const adxl343_cal_t *cal, adxl343_sample_t *samples, size_t count) {
+    // Hoisted so the loop keeps them in registers
+    const int32_t m00 = cal->m[0][0], m01 = cal->m[0][1], m02 = cal->m[0][2];
+    const int32_t m10 = cal->m[1][0], m11 = cal->m[1][1], m12 = cal->m[1][2];
+    const int32_t m20 = cal->m[2][0], m21 = cal->m[2][1], m22 = cal->m[2][2];
+    const int32_t ox = cal->offset[0], oy = cal->offset[1], oz = cal->offset[2];
+
+    for (size_t i = 0; i < count; i++) {
+        int32_t x = saturate(samples[i].x - ox);
+        int32_t y = saturate(samples[i].y - oy);
+        int32_t z = saturate(samples[i].z - oz);
+
+        samples[i].x = (int16_t)saturate((m00 * x + m01 * y + m02 * z + HALF) >> ADXL343_CAL_FRAC_BITS);
+        samples[i].y = (int16_t)saturate((m10 * x + m11 * y + m12 * z + HALF) >> ADXL343_CAL_FRAC_BITS);
+        samples[i].z = (int16_t)saturate((m20 * x + m21 * y + m22 * z + HALF) >> ADXL343_CAL_FRAC_BITS);
+    }
+}
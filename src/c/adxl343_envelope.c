@@ -0,0 +1,116 @@
+#include "ADXL343_envelope.h"
+
+#include <math.h>
+#include <string.h>
+
+#define Q14_ONE 16384.0
+#define SAMPLE_LIMIT 8191
+
+typedef enum {
+    BIQUAD_LOWPASS,
+    BIQUAD_HIGHPASS,
+} biquad_kind_t;
+
+// Butterworth (Q = 1/sqrt(2)) sections from the RBJ audio EQ cookbook.
+static void biquad_design(adxl343_biquad_t *bq, biquad_kind_t kind, double fc, double fs) {
+    double w0 = 2.0 * M_PI * fc / fs;
+    double cw = cos(w0);
+    double alpha = sin(w0) / (2.0 * M_SQRT1_2);
+    double a0 = 1.0 + alpha;
+    double b0 = kind == BIQUAD_LOWPASS ? (1.0 - cw) / 2.0 : (1.0 + cw) / 2.0;
+    double b1 = kind == BIQUAD_LOWPASS ? 1.0 - cw : -(1.0 + cw);
+
+    bq->b0 = (int32_t)lround(b0 / a0 * Q14_ONE);
+    bq->b1 = (int32_t)lround(b1 / a0 * Q14_ONE);
+    bq->b2 = bq->b0;
+    bq->a1 = (int32_t)lround(-2.0 * cw / a0 * Q14_ONE);
+    bq->a2 = (int32_t)lround((1.0 - alpha) / a0 * Q14_ONE);
+}
+
+static void biquad_reset(adxl343_biquad_t *bq) {
+    bq->x1 = bq->x2 = bq->y1 = bq->y2 = 0;
+    bq->error = 0;
+}
+
+static inline int32_t biquad_step(adxl343_biquad_t *bq, int32_t x) {
+    // Carry the bits dropped by the previous shift into this sum so the
+    // rounding error is shaped away from the low frequencies.
+    int32_t acc = bq->error + bq->b0 * x + bq->b1 * bq->x1 + bq->b2 * bq->x2
+                  - bq->a1 * bq->y1 - bq->a2 * bq->y2;
+    int32_t y = acc >> 14;
+    bq->error = acc - (y << 14);
+
+    if (y > SAMPLE_LIMIT) {
+        y = SAMPLE_LIMIT;
+    } else if (y < -SAMPLE_LIMIT) {
+        y = -SAMPLE_LIMIT;
+    }
+
+    bq->x2 = bq->x1;
+    bq->x1 = x;
+    bq->y2 = bq->y1;
+    bq->y1 = y;
+
+    return y;
+}
+
+bool adxl343_envelope_init(adxl343_envelope_t *env, const adxl343_envelope_config_t *config) {
+    float nyquist = config->odr_hz / 2.0f;
+
+    if (config->decimation == 0 || config->axis > 2 || !(config->odr_hz > 0.0f)) {
+        return false;
+    }
+    if (!(config->band_low_hz > 0.0f) || config->band_low_hz >= config->band_high_hz ||
+        config->band_high_hz >= nyquist) {
+        return false;
+    }
+    if (!(config->lowpass_hz > 0.0f) || config->lowpass_hz >= nyquist / config->decimation) {
+        return false;
+    }
+
+    biquad_design(&env->highpass, BIQUAD_HIGHPASS, config->band_low_hz, config->odr_hz);
+    biquad_design(&env->lowpass, BIQUAD_LOWPASS, config->band_high_hz, config->odr_hz);
+    biquad_design(&env->smooth, BIQUAD_LOWPASS, config->lowpass_hz, config->odr_hz);
+    env->decimation = config->decimation;
+    env->axis = config->axis;
+    env->shift = (config->data_format & ADXL343_FORMAT_JUSTIFY) ? ADXL343_JUSTIFY_SHIFT : 0;
+    adxl343_envelope_reset(env);
+
+    return true;
+}
+
+void adxl343_envelope_reset(adxl343_envelope_t *env) {
+    biquad_reset(&env->highpass);
+    biquad_reset(&env->lowpass);
+    biquad_reset(&env->smooth);
+    env->phase = 0;
+}
+
+size_t adxl343_envelope_process(adxl343_envelope_t *env, const adxl343_sample_t *samples, size_t count,
+                                int16_t *out, size_t max_out) {
+    size_t written = 0;
+    const int16_t *in = env->axis == 0 ? &samples[0].x : env->axis == 1 ? &samples[0].y : &samples[0].z;
+    const size_t stride = sizeof(adxl343_sample_t) / sizeof(int16_t);
+
+    for (size_t i = 0; i < count; i++, in += stride) {
+        int32_t x = *in >> env->shift;
+        if (x > SAMPLE_LIMIT) {
+            x = SAMPLE_LIMIT;
+        } else if (x < -SAMPLE_LIMIT) {
+            x = -SAMPLE_LIMIT;
+        }
+
+        int32_t band = biquad_step(&env->lowpass, biquad_step(&env->highpass, x));
+        int32_t level = biquad_step(&env->smooth, band < 0 ? -band : band);
+
+        if (++env->phase >= env->decimation) {
+            env->phase = 0;
+            if (written < max_out) {
+                level *= 1 << env->shift;
+                out[written++] = (int16_t)(level > INT16_MAX ? INT16_MAX : level < INT16_MIN ? INT16_MIN : level);
+            }
+        }
+    }
+
+    return written;
+}
@@ -0,0 +1,123 @@
+#include "ADXL343_freefall.h"
+
+#define NS_PER_TIME_FF 5000000ull
+
+static int arm(adxl343_freefall_t *ff) {
+    uint8_t source;
+
+    // Quiet first; free fall is then the only source on INT1
+    int status = adxl343_dev_write_reg(ff->dev, ADXL343_REG_INT_ENABLE, 0);
+    if (status == ADXL343_OK) {
+        status = adxl343_dev_write_reg(ff->dev, ADXL343_REG_BW_RATE, (uint8_t)ff->config.armed_rate);
+    }
+    if (status == ADXL343_OK) {
+        status = adxl343_dev_write_reg(ff->dev, ADXL343_REG_FIFO_CTL, ADXL343_FIFO_BYPASS);
+    }
+    if (status == ADXL343_OK) {
+        status = adxl343_dev_write_reg(ff->dev, ADXL343_REG_INT_MAP, (uint8_t)~ADXL343_INT_FREE_FALL);
+    }
+    if (status == ADXL343_OK) {
+        status = adxl343_dev_read_int_source(ff->dev, &source);
+    }
+    if (status == ADXL343_OK) {
+        status = adxl343_dev_write_reg(ff->dev, ADXL343_REG_INT_ENABLE, ADXL343_INT_FREE_FALL);
+    }
+    if (status == ADXL343_OK) {
+        ff->state = ADXL343_FREEFALL_ARMED;
+    }
+    return status;
+}
+
+int adxl343_freefall_init(adxl343_freefall_t *ff, adxl343_dev_t *dev, const adxl343_freefall_config_t *config) {
+    const adxl343_shock_config_t *impact = &config->impact;
+    if (config->threshold == 0 || config->time == 0 || config->capture_rate <= config->armed_rate ||
+        config->capture_rate > ADXL343_RATE_3200HZ || config->clock == NULL ||
+        impact->pre > ADXL343_SHOCK_MAX_PRE || impact->post == 0 || impact->post > ADXL343_SHOCK_MAX_POST ||
+        (impact->axes & ~(ADXL343_ACT_X | ADXL343_ACT_Y | ADXL343_ACT_Z)) || impact->axes == 0) {
+        return ADXL343_ERROR_ARGUMENT;
+    }
+
+    ff->dev = dev;
+    ff->config = *config;
+    ff->record = NULL;
+    ff->drops = 0;
+    ff->missed = 0;
+
+    const uint8_t detector[] = {config->threshold, config->time};
+    int status = adxl343_dev_write_regs(ff->dev, ADXL343_REG_THRESH_FF, detector, sizeof(detector));
+    if (status != ADXL343_OK) {
+        return status;
+    }
+    return arm(ff);
+}
+
+static uint64_t now_ns(const adxl343_freefall_t *ff) {
+    return ff->config.clock(ff->config.clock_ctx);
+}
+
+// Free fall seen: switch to the capture rate and hand the FIFO to the
+// shock recorder
+static int start_capture(adxl343_freefall_t *ff) {
+    ff->detected_ns = now_ns(ff);
+
+    int status = adxl343_dev_write_reg(ff->dev, ADXL343_REG_BW_RATE, (uint8_t)ff->config.capture_rate);
+    if (status == ADXL343_OK) {
+        status = adxl343_shock_init(&ff->shock, ff->dev, &ff->config.impact);
+    }
+    if (status != ADXL343_OK) {
+        return status;
+    }
+    ff->capture_ns = now_ns(ff);
+    ff->record = NULL;
+    ff->state = ADXL343_FREEFALL_CAPTURING;
+    return ADXL343_OK;
+}
+
+static uint64_t period_ns(adxl343_rate_t rate) {
+    return (uint64_t)(1e9f / adxl343_rate_hz(rate));
+}
+
+static void finish(adxl343_freefall_t *ff, adxl343_shock_record_t *record) {
+    uint64_t capture_period = period_ns(ff->config.capture_rate);
+
+    // The first sample after the switch lands somewhere in the first
+    // period; take the middle
+    ff->impact_ns = ff->capture_ns + record->index * capture_period + capture_period / 2;
+
+    // TIME_FF is counted in whole samples from the first one under the
+    // threshold, which was taken up to an armed period after the release
+    ff->start_ns = ff->detected_ns - ff->config.time * NS_PER_TIME_FF + period_ns(ff->config.armed_rate) / 2;
+    ff->fall_us = (uint32_t)((ff->impact_ns - ff->start_ns) / 1000u);
+    ff->timing_lost = ff->shock.overruns != 0;
+    ff->record = record;
+    ff->drops++;
+}
+
+int adxl343_freefall_service(adxl343_freefall_t *ff) {
+    if (ff->state == ADXL343_FREEFALL_ARMED) {
+        uint8_t source;
+        int status = adxl343_dev_read_int_source(ff->dev, &source);
+        if (status != ADXL343_OK || !(source & ADXL343_INT_FREE_FALL)) {
+            return status;
+        }
+        return start_capture(ff);
+    }
+
+    int status = adxl343_shock_service(&ff->shock);
+    if (status != ADXL343_OK) {
+        return status;
+    }
+
+    adxl343_shock_record_t *record = adxl343_shock_take(&ff->shock);
+    if (record != NULL) {
+        finish(ff, record);
+        status = arm(ff);
+        return status == ADXL343_OK ? 1 : status;
+    }
+
+    if (now_ns(ff) - ff->detected_ns > (uint64_t)ff->config.timeout_ms * 1000000u) {
+        ff->missed++;
+        return arm(ff);
+    }
+    return 0;
+}
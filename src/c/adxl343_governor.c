@@ -0,0 +1,113 @@
+#include "ADXL343_governor.h"
+
+int adxl343_governor_init(adxl343_governor_t *gov, adxl343_dev_t *dev, const adxl343_governor_config_t *config) {
+    if (config->watermark == 0 || config->watermark > ADXL343_FIFO_SAMPLES_MASK ||
+        config->active_rate > ADXL343_RATE_3200HZ || config->idle_rate > ADXL343_RATE_3200HZ) {
+        return ADXL343_ERROR_ARGUMENT;
+    }
+
+    gov->dev = dev;
+    gov->config = *config;
+    gov->rate = config->active_rate;
+    gov->idle = false;
+    gov->pending = false;
+    gov->switches = 0;
+
+    // Reconfigure in standby; link mode restarts waiting for inactivity
+    uint8_t power;
+    int status = adxl343_dev_read_reg(dev, ADXL343_REG_POWER_CTL, &power);
+    if (status != ADXL343_OK) {
+        return status;
+    }
+
+    const uint8_t thresholds[] = {
+        config->threshold_act,
+        config->threshold_inact,
+        config->time_inact,
+        config->axes,
+    };
+    const uint8_t interrupts = ADXL343_INT_ACTIVITY | ADXL343_INT_INACTIVITY | ADXL343_INT_WATERMARK;
+
+    status = adxl343_dev_write_reg(dev, ADXL343_REG_POWER_CTL, 0);
+    if (status == ADXL343_OK) {
+        status = adxl343_dev_write_reg(dev, ADXL343_REG_INT_ENABLE, 0);
+    }
+    if (status == ADXL343_OK) {
+        status = adxl343_dev_write_regs(dev, ADXL343_REG_THRESH_ACT, thresholds, sizeof(thresholds));
+    }
+    if (status == ADXL343_OK) {
+        status = adxl343_dev_write_reg(dev, ADXL343_REG_BW_RATE, config->active_rate);
+    }
+    if (status == ADXL343_OK) {
+        status = adxl343_dev_write_reg(dev, ADXL343_REG_FIFO_CTL, ADXL343_FIFO_BYPASS);
+    }
+    if (status == ADXL343_OK) {
+        status = adxl343_dev_write_reg(dev, ADXL343_REG_FIFO_CTL, ADXL343_FIFO_STREAM | config->watermark);
+    }
+    if (status == ADXL343_OK) {
+        status = adxl343_dev_write_reg(dev, ADXL343_REG_INT_MAP, (uint8_t)~interrupts);
+    }
+    if (status == ADXL343_OK) {
+        status = adxl343_dev_write_reg(dev, ADXL343_REG_INT_ENABLE, interrupts);
+    }
+    if (status == ADXL343_OK) {
+        power = (uint8_t)((power & ~ADXL343_POWER_SLEEP) | ADXL343_POWER_LINK | ADXL343_POWER_MEASURE);
+        status = adxl343_dev_write_reg(dev, ADXL343_REG_POWER_CTL, power);
+    }
+
+    return status;
+}
+
+int adxl343_governor_service(adxl343_governor_t *gov, adxl343_sample_t *dst, size_t max, adxl343_rate_t *rate) {
+    uint8_t source;
+    int status = adxl343_dev_read_int_source(gov->dev, &source);
+    if (status != ADXL343_OK) {
+        return status;
+    }
+
+    // Link mode alternates the two events. Both latched means a round trip
+    // since the last call, which ends in the state the governor is already
+    // in, so only a lone event changes it.
+    uint8_t events = source & (ADXL343_INT_ACTIVITY | ADXL343_INT_INACTIVITY);
+    if (events == ADXL343_INT_INACTIVITY && !gov->idle) {
+        gov->idle = true;
+        gov->pending = gov->config.idle_rate != gov->rate;
+    } else if (events == ADXL343_INT_ACTIVITY && gov->idle) {
+        gov->idle = false;
+        gov->pending = gov->config.active_rate != gov->rate;
+    }
+
+    *rate = gov->rate;
+    int count = adxl343_dev_read_fifo(gov->dev, dst, max);
+    if (count < 0 || !gov->pending) {
+        return count;
+    }
+
+    uint8_t fifo;
+    status = adxl343_dev_fifo_status(gov->dev, &fifo);
+    if (status != ADXL343_OK) {
+        return status;
+    }
+    if (fifo & ADXL343_FIFO_ENTRIES_MASK) {
+        // Samples at the old rate are still queued, switch on a later call
+        return count;
+    }
+
+    adxl343_rate_t next = gov->idle ? gov->config.idle_rate : gov->config.active_rate;
+    status = adxl343_dev_write_reg(gov->dev, ADXL343_REG_BW_RATE, next);
+    if (status != ADXL343_OK) {
+        return status;
+    }
+    gov->rate = next;
+    gov->pending = false;
+    gov->switches++;
+
+    // Anything that landed while the rate was being written is from the
+    // old rate, so it belongs with this batch.
+    int late = adxl343_dev_read_fifo(gov->dev, &dst[count], max - (size_t)count);
+    if (late < 0) {
+        return late;
+    }
+
+    return count + late;
+}
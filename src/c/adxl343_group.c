@@ -0,0 +1,118 @@
+#include "ADXL343_group.h"
+
+void adxl343_group_init(adxl343_group_t *group) {
+    group->count = 0;
+    group->clock = NULL;
+    group->clock_ctx = NULL;
+    for (size_t i = 0; i < ADXL343_GROUP_MAX_DEVICES; i++) {
+        group->devices[i] = NULL;
+        group->level[i] = 0;
+        group->full[i] = 0;
+        group->polled_ns[i] = 0;
+    }
+}
+
+void adxl343_group_set_clock(adxl343_group_t *group, adxl343_group_clock_t clock, void *ctx) {
+    group->clock = clock;
+    group->clock_ctx = ctx;
+}
+
+int adxl343_group_add(adxl343_group_t *group, adxl343_dev_t *dev) {
+    if (group->count == ADXL343_GROUP_MAX_DEVICES) {
+        return ADXL343_ERROR_ARGUMENT;
+    }
+    for (size_t i = 0; i < group->count; i++) {
+        if (group->devices[i]->bus == dev->bus && group->devices[i]->address == dev->address) {
+            return ADXL343_ERROR_ARGUMENT;
+        }
+    }
+
+    group->devices[group->count] = dev;
+    group->level[group->count] = 0;
+    group->full[group->count] = 0;
+    return (int)group->count++;
+}
+
+// Refresh every member's FIFO level; returns the total entries seen.
+static int poll(adxl343_group_t *group) {
+    int total = 0;
+
+    for (size_t i = 0; i < group->count; i++) {
+        uint8_t fifo;
+        int status = adxl343_dev_fifo_status(group->devices[i], &fifo);
+        if (status != ADXL343_OK) {
+            return status;
+        }
+
+        if (group->clock != NULL) {
+            group->polled_ns[i] = group->clock(group->clock_ctx);
+        }
+
+        uint8_t level = fifo & ADXL343_FIFO_ENTRIES_MASK;
+        if (level >= ADXL343_FIFO_DEPTH) {
+            group->full[i]++;
+        }
+        group->level[i] = level;
+        total += level;
+    }
+
+    return total;
+}
+
+static int fullest(const adxl343_group_t *group) {
+    int index = -1;
+    uint8_t most = 0;
+
+    for (size_t i = 0; i < group->count; i++) {
+        if (group->level[i] > most) {
+            most = group->level[i];
+            index = (int)i;
+        }
+    }
+    return index;
+}
+
+int adxl343_group_service(adxl343_group_t *group, adxl343_group_sink_t sink, void *ctx) {
+    size_t budget = group->count * ADXL343_FIFO_DEPTH;
+    size_t delivered = 0;
+
+    while (delivered < budget) {
+        int seen = poll(group);
+        if (seen < 0) {
+            return seen;
+        }
+
+        // Work through what the poll found, a chunk at a time from the
+        // FIFO with the most entries left, without polling in between
+        int index;
+        while ((index = fullest(group)) >= 0 && delivered < budget) {
+            size_t count = group->level[index];
+            if (count > ADXL343_GROUP_CHUNK) {
+                count = ADXL343_GROUP_CHUNK;
+            }
+            if (count > budget - delivered) {
+                count = budget - delivered;
+            }
+
+            adxl343_sample_t chunk[ADXL343_GROUP_CHUNK];
+            for (size_t i = 0; i < count; i++) {
+                int status = adxl343_dev_read_sample(group->devices[index], &chunk[i]);
+                if (status != ADXL343_OK) {
+                    return status;
+                }
+            }
+
+            sink(ctx, (size_t)index, chunk, count);
+            group->level[index] = (uint8_t)(group->level[index] - count);
+            delivered += count;
+        }
+
+        // Stragglers that arrived meanwhile wait for the next call rather
+        // than costing a poll of every member each
+        if (seen < ADXL343_GROUP_CHUNK) {
+            break;
+        }
+    }
+
+    return (int)delivered;
+}
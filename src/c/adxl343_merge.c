@@ -0,0 +1,101 @@
+#include "ADXL343_merge.h"
+
+void adxl343_merge_init(adxl343_merge_t *merge) {
+    merge->count = 0;
+}
+
+int adxl343_merge_add(adxl343_merge_t *merge, float odr_hz) {
+    if (merge->count == ADXL343_MERGE_MAX_CHANNELS || !(odr_hz > 0.0f)) {
+        return ADXL343_ERROR_ARGUMENT;
+    }
+
+    adxl343_merge_channel_t *ch = &merge->channels[merge->count];
+    ch->head = 0;
+    ch->count = 0;
+    ch->period_ns = (uint64_t)(1e9 / (double)odr_hz + 0.5);
+    ch->last_ns = 0;
+    ch->started = false;
+    ch->dropped = 0;
+    return (int)merge->count++;
+}
+
+int adxl343_merge_push(adxl343_merge_t *merge, size_t channel, const adxl343_sample_t *samples, size_t count,
+                       uint64_t now_ns) {
+    if (channel >= merge->count) {
+        return ADXL343_ERROR_ARGUMENT;
+    }
+    adxl343_merge_channel_t *ch = &merge->channels[channel];
+    if (count == 0) {
+        return 0;
+    }
+
+    // Anchor so the newest sample of this block lands at `now_ns`
+    uint64_t span = (uint64_t)count * ch->period_ns;
+    uint64_t gap = (uint64_t)ADXL343_FIFO_DEPTH * ch->period_ns;
+    if (!ch->started || now_ns > ch->last_ns + span + gap) {
+        ch->last_ns = now_ns >= span ? now_ns - span : 0;
+        ch->started = true;
+    }
+
+    // A sensor running fast would be stamped past the drain; squeeze the
+    // block in between the previous stamp and `now_ns` instead
+    uint64_t from_ns = ch->last_ns;
+    bool ahead = ch->last_ns + span > now_ns;
+    uint64_t room = now_ns > from_ns ? now_ns - from_ns : 0;
+
+    size_t queued = 0;
+    for (size_t i = 0; i < count; i++) {
+        ch->last_ns = ahead ? from_ns + room * (i + 1) / count : ch->last_ns + ch->period_ns;
+        if (ch->count == ADXL343_MERGE_DEPTH) {
+            ch->dropped++;
+            continue;
+        }
+        adxl343_stamped_t *slot = &ch->ring[(ch->head + ch->count) % ADXL343_MERGE_DEPTH];
+        slot->t_ns = ch->last_ns;
+        slot->sample = samples[i];
+        slot->channel = (uint8_t)channel;
+        ch->count++;
+        queued++;
+    }
+
+    return (int)queued;
+}
+
+size_t adxl343_merge_pop(adxl343_merge_t *merge, adxl343_stamped_t *dst, size_t max) {
+    if (merge->count == 0) {
+        return 0;
+    }
+
+    // Nothing past the channel that has been drained least recently
+    uint64_t horizon = UINT64_MAX;
+    for (size_t i = 0; i < merge->count; i++) {
+        const adxl343_merge_channel_t *ch = &merge->channels[i];
+        if (!ch->started) {
+            return 0;
+        }
+        if (ch->last_ns < horizon) {
+            horizon = ch->last_ns;
+        }
+    }
+
+    size_t n = 0;
+    while (n < max) {
+        adxl343_merge_channel_t *next = NULL;
+        for (size_t i = 0; i < merge->count; i++) {
+            adxl343_merge_channel_t *ch = &merge->channels[i];
+            if (ch->count > 0 && ch->ring[ch->head].t_ns <= horizon &&
+                (next == NULL || ch->ring[ch->head].t_ns < next->ring[next->head].t_ns)) {
+                next = ch;
+            }
+        }
+        if (next == NULL) {
+            break;
+        }
+
+        dst[n++] = next->ring[next->head];
+        next->head = (uint16_t)((next->head + 1) % ADXL343_MERGE_DEPTH);
+        next->count--;
+    }
+
+    return n;
+}
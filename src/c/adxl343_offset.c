@@ -0,0 +1,139 @@
+#include "ADXL343_offset.h"
+
+#define MG_PER_OFFSET 15.625f
+#define RECORD_VERSION 0x01
+
+int adxl343_offset_begin(adxl343_offset_cal_t *cal, adxl343_dev_t *dev, const adxl343_offset_config_t *config) {
+    if (config->samples == 0) {
+        return ADXL343_ERROR_ARGUMENT;
+    }
+
+    uint8_t ofs[3];
+    int status = adxl343_dev_read_reg(dev, ADXL343_REG_DATA_FORMAT, &cal->format);
+    if (status == ADXL343_OK) {
+        status = adxl343_dev_read_regs(dev, ADXL343_REG_OFSX, ofs, sizeof(ofs));
+    }
+    if (status != ADXL343_OK) {
+        return status;
+    }
+
+    cal->dev = dev;
+    cal->config = *config;
+    cal->count = 0;
+    for (int i = 0; i < 3; i++) {
+        cal->ofs[i] = (int8_t)ofs[i];
+        cal->sum[i] = 0;
+        cal->min[i] = INT16_MAX;
+        cal->max[i] = INT16_MIN;
+    }
+    return ADXL343_OK;
+}
+
+bool adxl343_offset_feed(adxl343_offset_cal_t *cal, const adxl343_sample_t *samples, size_t count) {
+    for (size_t n = 0; n < count && cal->count < cal->config.samples; n++) {
+        const int16_t v[3] = {samples[n].x, samples[n].y, samples[n].z};
+        for (int i = 0; i < 3; i++) {
+            cal->sum[i] += v[i];
+            if (v[i] < cal->min[i]) {
+                cal->min[i] = v[i];
+            }
+            if (v[i] > cal->max[i]) {
+                cal->max[i] = v[i];
+            }
+        }
+        cal->count++;
+    }
+    return cal->count >= cal->config.samples;
+}
+
+static int32_t round_to_int(float v) {
+    return (int32_t)(v >= 0.0f ? v + 0.5f : v - 0.5f);
+}
+
+int adxl343_offset_finish(adxl343_offset_cal_t *cal, adxl343_offset_t *result) {
+    if (cal->count < cal->config.samples) {
+        return ADXL343_ERROR_STATE;
+    }
+
+    float scale = adxl343_mg_per_lsb(cal->format);
+    adxl343_offset_t offset;
+    for (int i = 0; i < 3; i++) {
+        if ((float)(cal->max[i] - cal->min[i]) * scale > (float)cal->config.max_spread_mg) {
+            return ADXL343_ERROR_STATE;
+        }
+
+        // Bias as measured, with the old offsets applied; the registers
+        // have to move by minus that
+        float bias_mg = (float)cal->sum[i] / (float)cal->count * scale - (float)cal->config.expected_mg[i];
+        int32_t code = cal->ofs[i] + round_to_int(-bias_mg / MG_PER_OFFSET);
+        if (code < INT8_MIN || code > INT8_MAX) {
+            return ADXL343_ERROR_DEVICE;
+        }
+        offset.ofs[i] = (int8_t)code;
+        float residual_mg = bias_mg + (float)(code - cal->ofs[i]) * MG_PER_OFFSET;
+        offset.residual_ug[i] = (int16_t)round_to_int(residual_mg * 1000.0f);
+    }
+
+    int status = adxl343_offset_apply(cal->dev, &offset);
+    if (status != ADXL343_OK) {
+        return status;
+    }
+    *result = offset;
+    return ADXL343_OK;
+}
+
+int adxl343_offset_apply(adxl343_dev_t *dev, const adxl343_offset_t *offset) {
+    const uint8_t ofs[3] = {(uint8_t)offset->ofs[0], (uint8_t)offset->ofs[1], (uint8_t)offset->ofs[2]};
+    return adxl343_dev_write_regs(dev, ADXL343_REG_OFSX, ofs, sizeof(ofs));
+}
+
+void adxl343_offset_correct(const adxl343_offset_t *offset, uint8_t data_format, adxl343_sample_t *samples,
+                            size_t count) {
+    float lsb_per_ug = 1.0f / (adxl343_mg_per_lsb(data_format) * 1000.0f);
+    int16_t dx = (int16_t)round_to_int((float)offset->residual_ug[0] * lsb_per_ug);
+    int16_t dy = (int16_t)round_to_int((float)offset->residual_ug[1] * lsb_per_ug);
+    int16_t dz = (int16_t)round_to_int((float)offset->residual_ug[2] * lsb_per_ug);
+    if (dx == 0 && dy == 0 && dz == 0) {
+        return;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        samples[i].x = (int16_t)(samples[i].x - dx);
+        samples[i].y = (int16_t)(samples[i].y - dy);
+        samples[i].z = (int16_t)(samples[i].z - dz);
+    }
+}
+
+// CRC-8, polynomial 0x07
+static uint8_t crc8(const uint8_t *data, size_t len) {
+    uint8_t crc = 0;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (uint8_t)((crc & 0x80) ? (crc << 1) ^ 0x07 : crc << 1);
+        }
+    }
+    return crc;
+}
+
+void adxl343_offset_save(const adxl343_offset_t *offset, uint8_t record[ADXL343_OFFSET_RECORD_SIZE]) {
+    record[0] = RECORD_VERSION;
+    for (int i = 0; i < 3; i++) {
+        uint16_t residual = (uint16_t)offset->residual_ug[i];
+        record[1 + i] = (uint8_t)offset->ofs[i];
+        record[4 + 2 * i] = (uint8_t)residual;
+        record[5 + 2 * i] = (uint8_t)(residual >> 8);
+    }
+    record[10] = crc8(record, 10);
+}
+
+bool adxl343_offset_load(adxl343_offset_t *offset, const uint8_t record[ADXL343_OFFSET_RECORD_SIZE]) {
+    if (record[0] != RECORD_VERSION || crc8(record, 10) != record[10]) {
+        return false;
+    }
+    for (int i = 0; i < 3; i++) {
+        offset->ofs[i] = (int8_t)record[1 + i];
+        offset->residual_ug[i] = (int16_t)(record[4 + 2 * i] | (record[5 + 2 * i] << 8));
+    }
+    return true;
+}
@@ -0,0 +1,285 @@
+#include "ADXL343_op.h"
+
+static const uint8_t init_sequence[][2] = {
+    // Standby while reconfiguring, measurement last
+    {ADXL343_REG_POWER_CTL, 0},
+    {ADXL343_REG_INT_ENABLE, 0},
+    {ADXL343_REG_BW_RATE, ADXL343_RATE_100HZ},
+    {ADXL343_REG_DATA_FORMAT, ADXL343_FORMAT_FULL_RES | ADXL343_RANGE_16G},
+    {ADXL343_REG_FIFO_CTL, ADXL343_FIFO_BYPASS},
+    {ADXL343_REG_POWER_CTL, ADXL343_POWER_MEASURE},
+};
+
+#define SELF_TEST_FORMAT (ADXL343_FORMAT_FULL_RES | ADXL343_RANGE_16G)
+
+enum {
+    SELF_TEST_SAVE_RATE,
+    SELF_TEST_SAVE_FORMAT,
+    SELF_TEST_SAVE_FIFO,
+    SELF_TEST_RATE,
+    SELF_TEST_FORMAT_OFF,
+    SELF_TEST_CLEAR_OFF,
+    SELF_TEST_START_OFF,
+    SELF_TEST_COLLECT_OFF,
+    SELF_TEST_FORMAT_ON,
+    SELF_TEST_CLEAR_ON,
+    SELF_TEST_START_ON,
+    SELF_TEST_COLLECT_ON,
+    SELF_TEST_RESTORE_FORMAT,
+    SELF_TEST_RESTORE_RATE,
+    SELF_TEST_RESTORE_CLEAR,
+    SELF_TEST_RESTORE_FIFO,
+    SELF_TEST_DONE,
+};
+
+static void begin(adxl343_op_t *op, adxl343_dev_t *dev, adxl343_op_kind_t kind) {
+    op->dev = dev;
+    op->kind = kind;
+    op->step = 0;
+    op->status = ADXL343_PENDING;
+    op->index = 0;
+    op->count = 0;
+    op->data_ready = false;
+}
+
+void adxl343_op_begin_init(adxl343_op_t *op, adxl343_dev_t *dev) {
+    begin(op, dev, ADXL343_OP_INIT);
+    op->writes = init_sequence;
+    op->write_count = sizeof(init_sequence) / sizeof(init_sequence[0]);
+}
+
+void adxl343_op_begin_configure(adxl343_op_t *op, adxl343_dev_t *dev, const uint8_t (*writes)[2], size_t count) {
+    begin(op, dev, ADXL343_OP_CONFIGURE);
+    op->writes = writes;
+    op->write_count = count;
+}
+
+void adxl343_op_begin_drain(adxl343_op_t *op, adxl343_dev_t *dev, adxl343_sample_t *dst, size_t max) {
+    begin(op, dev, ADXL343_OP_DRAIN);
+    op->dst = dst;
+    op->max = max;
+    op->entries = 0;
+}
+
+void adxl343_op_begin_self_test(adxl343_op_t *op, adxl343_dev_t *dev) {
+    begin(op, dev, ADXL343_OP_SELF_TEST);
+    adxl343_op_self_test_init(&op->self_test, ADXL343_RATE_100HZ, ADXL343_FIFO_BYPASS);
+}
+
+// One write from the table per call; ADXL343_OK once all are written
+static int step_writes(adxl343_op_t *op) {
+    if (op->index == op->write_count) {
+        return ADXL343_OK;
+    }
+    int status = adxl343_dev_write_reg(op->dev, op->writes[op->index][0], op->writes[op->index][1]);
+    if (status != ADXL343_OK) {
+        return status;
+    }
+    op->index++;
+    return op->index == op->write_count ? ADXL343_OK : ADXL343_PENDING;
+}
+
+static int poll_init(adxl343_op_t *op) {
+    if (op->step == 0) {
+        uint8_t id;
+        int status = adxl343_dev_read_reg(op->dev, ADXL343_REG_DEVID, &id);
+        if (status != ADXL343_OK) {
+            return status;
+        }
+        if (id != ADXL343_DEVICE_ID) {
+            return ADXL343_ERROR_DEVICE;
+        }
+        op->step = 1;
+        return ADXL343_PENDING;
+    }
+    return step_writes(op);
+}
+
+static int poll_drain(adxl343_op_t *op) {
+    if (op->step == 0) {
+        uint8_t fifo;
+        int status = adxl343_dev_fifo_status(op->dev, &fifo);
+        if (status != ADXL343_OK) {
+            return status;
+        }
+        op->entries = fifo & ADXL343_FIFO_ENTRIES_MASK;
+        if (op->entries > op->max) {
+            op->entries = op->max;
+        }
+        op->step = 1;
+        return op->entries == 0 ? ADXL343_OK : ADXL343_PENDING;
+    }
+
+    int status = adxl343_dev_read_sample(op->dev, &op->dst[op->count]);
+    if (status != ADXL343_OK) {
+        return status;
+    }
+    op->count++;
+    return op->count == op->entries ? ADXL343_OK : ADXL343_PENDING;
+}
+
+// Average settle + ADXL343_OP_SELF_TEST_SAMPLES samples into `sum`, one
+// transfer per call: INT_SOURCE until DATA_READY, then the sample
+static int step_average(adxl343_op_t *op) {
+    if (!op->data_ready) {
+        uint8_t source;
+        int status = adxl343_dev_read_int_source(op->dev, &source);
+        if (status != ADXL343_OK) {
+            return status;
+        }
+        op->data_ready = (source & ADXL343_INT_DATA_READY) != 0;
+        return ADXL343_PENDING;
+    }
+
+    adxl343_sample_t s;
+    int status = adxl343_dev_read_sample(op->dev, &s);
+    if (status != ADXL343_OK) {
+        return status;
+    }
+    op->data_ready = false;
+
+    if (op->index == 0) {
+        op->sum[0] = op->sum[1] = op->sum[2] = 0;
+    }
+    if (op->index >= ADXL343_OP_SELF_TEST_SETTLE) {
+        op->sum[0] += s.x;
+        op->sum[1] += s.y;
+        op->sum[2] += s.z;
+    }
+    op->index++;
+    if (op->index < ADXL343_OP_SELF_TEST_SETTLE + ADXL343_OP_SELF_TEST_SAMPLES) {
+        return ADXL343_PENDING;
+    }
+    op->index = 0;
+    return ADXL343_OK;
+}
+
+static int32_t average(int32_t sum) {
+    int32_t half = ADXL343_OP_SELF_TEST_SAMPLES / 2;
+    return (sum >= 0 ? sum + half : sum - half) / ADXL343_OP_SELF_TEST_SAMPLES;
+}
+
+static int collect_average(void *ctx, int block) {
+    adxl343_op_t *op = (adxl343_op_t *)ctx;
+    int status = step_average(op);
+    if (status != ADXL343_OK) {
+        return status;
+    }
+    for (int i = 0; i < 3; i++) {
+        if (block == 0) {
+            op->base[i] = average(op->sum[i]);
+        } else {
+            op->delta[i] = (int16_t)(average(op->sum[i]) - op->base[i]);
+        }
+    }
+    return ADXL343_OK;
+}
+
+void adxl343_op_self_test_init(adxl343_op_self_test_t *test, adxl343_rate_t rate, uint8_t fifo_mode) {
+    test->step = SELF_TEST_SAVE_RATE;
+    test->rate = (uint8_t)rate;
+    test->fifo_mode = fifo_mode;
+    test->error = ADXL343_OK;
+}
+
+// In bypass the FIFO is emptied once and stays that way
+static bool self_test_skips(const adxl343_op_self_test_t *test) {
+    if (test->fifo_mode != ADXL343_FIFO_BYPASS) {
+        return false;
+    }
+    return test->step == SELF_TEST_START_OFF || test->step == SELF_TEST_CLEAR_ON ||
+           test->step == SELF_TEST_START_ON || test->step == SELF_TEST_RESTORE_CLEAR;
+}
+
+int adxl343_op_self_test_step(adxl343_op_self_test_t *test, adxl343_dev_t *dev, adxl343_op_collect_t collect,
+                              void *ctx) {
+    static const uint8_t saved_regs[3] = {ADXL343_REG_BW_RATE, ADXL343_REG_DATA_FORMAT, ADXL343_REG_FIFO_CTL};
+    int status;
+
+    switch (test->step) {
+    case SELF_TEST_SAVE_RATE:
+    case SELF_TEST_SAVE_FORMAT:
+    case SELF_TEST_SAVE_FIFO:
+        status = adxl343_dev_read_reg(dev, saved_regs[test->step], &test->saved[test->step]);
+        if (status != ADXL343_OK) {
+            // Nothing changed yet
+            return status;
+        }
+        break;
+    case SELF_TEST_RATE:
+        status = adxl343_dev_write_reg(dev, ADXL343_REG_BW_RATE, test->rate);
+        break;
+    case SELF_TEST_FORMAT_OFF:
+        status = adxl343_dev_write_reg(dev, ADXL343_REG_DATA_FORMAT, SELF_TEST_FORMAT);
+        break;
+    case SELF_TEST_FORMAT_ON:
+        status = adxl343_dev_write_reg(dev, ADXL343_REG_DATA_FORMAT, SELF_TEST_FORMAT | ADXL343_FORMAT_SELF_TEST);
+        break;
+    case SELF_TEST_CLEAR_OFF:
+    case SELF_TEST_CLEAR_ON:
+    case SELF_TEST_RESTORE_CLEAR:
+        // Passing through bypass empties the FIFO
+        status = adxl343_dev_write_reg(dev, ADXL343_REG_FIFO_CTL, ADXL343_FIFO_BYPASS);
+        break;
+    case SELF_TEST_START_OFF:
+    case SELF_TEST_START_ON:
+        status = adxl343_dev_write_reg(dev, ADXL343_REG_FIFO_CTL, test->fifo_mode);
+        break;
+    case SELF_TEST_COLLECT_OFF:
+    case SELF_TEST_COLLECT_ON:
+        status = collect(ctx, test->step == SELF_TEST_COLLECT_ON);
+        if (status == ADXL343_PENDING) {
+            return status;
+        }
+        break;
+    case SELF_TEST_RESTORE_FORMAT:
+        status = adxl343_dev_write_reg(dev, ADXL343_REG_DATA_FORMAT, test->saved[1]);
+        break;
+    case SELF_TEST_RESTORE_RATE:
+        status = adxl343_dev_write_reg(dev, ADXL343_REG_BW_RATE, test->saved[0]);
+        break;
+    case SELF_TEST_RESTORE_FIFO:
+        status = adxl343_dev_write_reg(dev, ADXL343_REG_FIFO_CTL, test->saved[2]);
+        break;
+    default:
+        return ADXL343_ERROR_STATE;
+    }
+
+    // After a failure the remaining restore writes are still tried, and
+    // the first status is what the caller sees
+    if (status != ADXL343_OK && test->error == ADXL343_OK) {
+        test->error = status;
+        if (test->step < SELF_TEST_RESTORE_FORMAT) {
+            test->step = SELF_TEST_RESTORE_FORMAT - 1;
+        }
+    }
+    do {
+        test->step++;
+    } while (self_test_skips(test));
+    return test->step == SELF_TEST_DONE ? test->error : ADXL343_PENDING;
+}
+
+int adxl343_op_poll(adxl343_op_t *op) {
+    if (op->status != ADXL343_PENDING) {
+        return op->status;
+    }
+
+    switch (op->kind) {
+    case ADXL343_OP_INIT:
+        op->status = poll_init(op);
+        break;
+    case ADXL343_OP_CONFIGURE:
+        op->status = step_writes(op);
+        break;
+    case ADXL343_OP_DRAIN:
+        op->status = poll_drain(op);
+        break;
+    case ADXL343_OP_SELF_TEST:
+        op->status = adxl343_op_self_test_step(&op->self_test, op->dev, collect_average, op);
+        break;
+    default:
+        op->status = ADXL343_ERROR_STATE;
+        break;
+    }
+    return op->status;
+}
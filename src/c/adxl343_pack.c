@@ -0,0 +1,77 @@
+#include "ADXL343_pack.h"
+
+#define MASK10 0x3FFu
+#define MASK13 0x1FFFu
+
+// Clamp to lo..hi and keep the field's bits of the two's complement,
+// flagging saturation in `*clipped`
+static uint32_t field(int16_t v, int32_t lo, int32_t hi, uint32_t mask, bool *clipped) {
+    int32_t x = v;
+    if (x < lo) {
+        x = lo;
+        *clipped = true;
+    } else if (x > hi) {
+        x = hi;
+        *clipped = true;
+    }
+    return (uint32_t)x & mask;
+}
+
+// Sign extend the low `bits` of a field that has been shifted to the top
+// of the word
+static int16_t top(uint32_t w, int bits) {
+    return (int16_t)((int32_t)w >> (32 - bits));
+}
+
+size_t adxl343_pack10(const adxl343_sample_t *in, size_t count, adxl343_packed10_t *out) {
+    size_t clipped = 0;
+    for (size_t i = 0; i < count; i++) {
+        bool c = false;
+        uint32_t x = field(in[i].x, -512, 511, MASK10, &c);
+        uint32_t y = field(in[i].y, -512, 511, MASK10, &c);
+        uint32_t z = field(in[i].z, -512, 511, MASK10, &c);
+        out[i] = x | y << 10 | z << 20;
+        clipped += c ? 1 : 0;
+    }
+    return clipped;
+}
+
+void adxl343_unpack10(const adxl343_packed10_t *in, size_t count, adxl343_sample_t *out) {
+    for (size_t i = 0; i < count; i++) {
+        uint32_t w = in[i];
+        out[i].x = top(w << 22, 10);
+        out[i].y = top(w << 12, 10);
+        out[i].z = top(w << 2, 10);
+    }
+}
+
+size_t adxl343_pack13(const adxl343_sample_t *in, size_t count, adxl343_packed13_t *out) {
+    size_t clipped = 0;
+    for (size_t i = 0; i < count; i++) {
+        bool c = false;
+        uint32_t x = field(in[i].x, -4096, 4095, MASK13, &c);
+        uint32_t y = field(in[i].y, -4096, 4095, MASK13, &c);
+        uint32_t z = field(in[i].z, -4096, 4095, MASK13, &c);
+
+        // Bits 0-31 in one word, the top seven bits of z in the fifth byte
+        uint32_t lo = x | y << 13 | z << 26;
+        out[i].bytes[0] = (uint8_t)lo;
+        out[i].bytes[1] = (uint8_t)(lo >> 8);
+        out[i].bytes[2] = (uint8_t)(lo >> 16);
+        out[i].bytes[3] = (uint8_t)(lo >> 24);
+        out[i].bytes[4] = (uint8_t)(z >> 6);
+        clipped += c ? 1 : 0;
+    }
+    return clipped;
+}
+
+void adxl343_unpack13(const adxl343_packed13_t *in, size_t count, adxl343_sample_t *out) {
+    for (size_t i = 0; i < count; i++) {
+        const uint8_t *b = in[i].bytes;
+        uint32_t lo = (uint32_t)b[0] | (uint32_t)b[1] << 8 | (uint32_t)b[2] << 16 | (uint32_t)b[3] << 24;
+        uint32_t z = lo >> 26 | (uint32_t)b[4] << 6;
+        out[i].x = top(lo << 19, 13);
+        out[i].y = top(lo << 6, 13);
+        out[i].z = top(z << 19, 13);
+    }
+}
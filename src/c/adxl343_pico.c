@@ -0,0 +1,188 @@
+#include "ADXL343_pico.h"
+
+#include "pico/stdlib.h"
+
+#if LIB_PICO_SLEEP
+#include "hardware/clocks.h"
+#include "pico/sleep.h"
+#endif
+
+#if LIB_PICO_MULTICORE
+#include "pico/multicore.h"
+#include "pico/util/queue.h"
+#endif
+
+#define MAX_WRITE 32
+
+// Drained blocks in flight from core 1 to core 0
+#define PARALLEL_QUEUE 32
+
+// Core 1 polls its bus this often; a 32 entry FIFO lasts 10 ms at 3200 Hz
+#define PARALLEL_POLL_US 1000
+
+static int pico_read(void *ctx, uint8_t addr, uint8_t reg, uint8_t *dst, size_t len) {
+    i2c_inst_t *i2c = (i2c_inst_t *)ctx;
+
+    if (i2c_write_blocking(i2c, addr, &reg, 1, true) != 1) {
+        return ADXL343_ERROR_BUS;
+    }
+    if (i2c_read_blocking(i2c, addr, dst, len, false) != (int)len) {
+        return ADXL343_ERROR_BUS;
+    }
+    return ADXL343_OK;
+}
+
+static int pico_write(void *ctx, uint8_t addr, uint8_t reg, const uint8_t *src, size_t len) {
+    i2c_inst_t *i2c = (i2c_inst_t *)ctx;
+    uint8_t buf[MAX_WRITE + 1];
+
+    if (len > MAX_WRITE) {
+        return ADXL343_ERROR_ARGUMENT;
+    }
+
+    // Register address and data in a single transfer so the device
+    // auto-increments through consecutive registers.
+    buf[0] = reg;
+    for (size_t i = 0; i < len; i++) {
+        buf[i + 1] = src[i];
+    }
+    if (i2c_write_blocking(i2c, addr, buf, len + 1, false) != (int)(len + 1)) {
+        return ADXL343_ERROR_BUS;
+    }
+    return ADXL343_OK;
+}
+
+static void pico_delay_us(void *ctx, uint32_t us) {
+    (void)ctx;
+    sleep_us(us);
+}
+
+static adxl343_bus_t buses[2] = {
+    {pico_read, pico_write, pico_delay_us, NULL},
+    {pico_read, pico_write, pico_delay_us, NULL},
+};
+
+const adxl343_bus_t *adxl343_pico_i2c_bus(i2c_inst_t *i2c) {
+    adxl343_bus_t *bus = &buses[i2c_hw_index(i2c)];
+    bus->ctx = i2c;
+    return bus;
+}
+
+static void pico_wait_for_interrupt(void *ctx) {
+    uint gpio = (uint)(uintptr_t)ctx;
+
+    if (gpio_get(gpio)) {
+        return;
+    }
+#if LIB_PICO_SLEEP
+    // Level sensitive: an edge between the check above and dormant entry
+    // would be missed while INT1 stays latched high
+    sleep_run_from_xosc();
+    sleep_goto_dormant_until_pin(gpio, false, true);
+    clocks_init();
+#else
+    while (!gpio_get(gpio)) {
+        best_effort_wfe_or_timeout(make_timeout_time_ms(1));
+    }
+#endif
+}
+
+static adxl343_wom_host_t wom_host = {pico_wait_for_interrupt, NULL};
+
+const adxl343_wom_host_t *adxl343_pico_wom_host(uint gpio) {
+    gpio_init(gpio);
+    gpio_set_dir(gpio, GPIO_IN);
+    wom_host.ctx = (void *)(uintptr_t)gpio;
+    return &wom_host;
+}
+
+#if LIB_PICO_MULTICORE
+
+typedef struct {
+    uint64_t t_ns;
+    uint8_t channel;
+    uint8_t count;
+    adxl343_sample_t samples[ADXL343_GROUP_CHUNK];
+} parallel_block_t;
+
+static queue_t parallel_blocks;
+static adxl343_group_t *parallel_group;
+static size_t parallel_first;
+static volatile uint32_t parallel_lost;
+
+static uint64_t parallel_clock(void *ctx) {
+    (void)ctx;
+    return time_us_64() * 1000u;
+}
+
+static void parallel_sink(void *ctx, size_t index, const adxl343_sample_t *samples, size_t count) {
+    (void)ctx;
+    parallel_block_t block = {
+        .t_ns = parallel_group->polled_ns[index],
+        .channel = (uint8_t)(parallel_first + index),
+        .count = (uint8_t)count,
+    };
+    for (size_t i = 0; i < count; i++) {
+        block.samples[i] = samples[i];
+    }
+    if (!queue_try_add(&parallel_blocks, &block)) {
+        parallel_lost += count;
+    }
+}
+
+static void parallel_core1(void) {
+    for (;;) {
+        adxl343_group_service(parallel_group, parallel_sink, NULL);
+        sleep_us(PARALLEL_POLL_US);
+    }
+}
+
+int adxl343_pico_parallel_start(adxl343_group_t *group, size_t first_channel) {
+    if (first_channel + group->count > ADXL343_MERGE_MAX_CHANNELS) {
+        return ADXL343_ERROR_ARGUMENT;
+    }
+    parallel_group = group;
+    parallel_first = first_channel;
+    adxl343_group_set_clock(group, parallel_clock, NULL);
+    parallel_lost = 0;
+    queue_init(&parallel_blocks, sizeof(parallel_block_t), PARALLEL_QUEUE);
+    multicore_launch_core1(parallel_core1);
+    return ADXL343_OK;
+}
+
+int adxl343_pico_parallel_collect(adxl343_merge_t *merge) {
+    parallel_block_t block;
+    int moved = 0;
+
+    while (queue_try_remove(&parallel_blocks, &block)) {
+        int status = adxl343_merge_push(merge, block.channel, block.samples, block.count, block.t_ns);
+        if (status < 0) {
+            return status;
+        }
+        moved += status;
+    }
+    return moved;
+}
+
+uint32_t adxl343_pico_parallel_lost(void) {
+    return parallel_lost;
+}
+
+#else
+
+int adxl343_pico_parallel_start(adxl343_group_t *group, size_t first_channel) {
+    (void)group;
+    (void)first_channel;
+    return ADXL343_ERROR_STATE;
+}
+
+int adxl343_pico_parallel_collect(adxl343_merge_t *merge) {
+    (void)merge;
+    return ADXL343_ERROR_STATE;
+}
+
+uint32_t adxl343_pico_parallel_lost(void) {
+    return 0;
+}
+
+#endif
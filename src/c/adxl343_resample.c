@@ -0,0 +1,83 @@
+#include "ADXL343_resample.h"
+
+#define ONE (1ull << 32)
+
+// Largest ratio either way between the two rates
+#define MAX_RATIO 65536.0
+
+bool adxl343_resampler_set_rate(adxl343_resampler_t *rs, float in_hz, float out_hz) {
+    if (!(in_hz > 0.0f) || !(out_hz > 0.0f)) {
+        return false;
+    }
+    double ratio = (double)in_hz / (double)out_hz;
+    if (ratio > MAX_RATIO || ratio < 1.0 / MAX_RATIO) {
+        return false;
+    }
+    rs->step = (uint64_t)(ratio * (double)ONE + 0.5);
+    return true;
+}
+
+bool adxl343_resampler_init(adxl343_resampler_t *rs, float in_hz, float out_hz) {
+    if (!adxl343_resampler_set_rate(rs, in_hz, out_hz)) {
+        return false;
+    }
+    // The first interval interpolated spans input samples 0 and 1, which
+    // is reached after the third sample
+    rs->pos = 2 * ONE;
+    rs->primed = false;
+    return true;
+}
+
+// Cubic through xm1, x0, x1, x2 at x0 + mu, mu in Q15. The Farrow
+// coefficients are kept at six times their value so they stay integral.
+static int16_t interpolate(int32_t xm1, int32_t x0, int32_t x1, int32_t x2, int32_t mu) {
+    int32_t c1 = 6 * x1 - 2 * xm1 - 3 * x0 - x2;
+    int32_t c2 = 3 * (xm1 + x1) - 6 * x0;
+    int32_t c3 = (x2 - xm1) + 3 * (x0 - x1);
+
+    int64_t acc = ((int64_t)c3 * mu) >> 15;
+    acc = ((acc + c2) * mu) >> 15;
+    acc = ((acc + c1) * mu) >> 15;
+
+    int64_t y6 = 6 * (int64_t)x0 + acc;
+    int64_t y = y6 >= 0 ? (y6 + 3) / 6 : -((-y6 + 3) / 6);
+    if (y > INT16_MAX) {
+        return INT16_MAX;
+    }
+    if (y < INT16_MIN) {
+        return INT16_MIN;
+    }
+    return (int16_t)y;
+}
+
+size_t adxl343_resampler_process(adxl343_resampler_t *rs, const adxl343_sample_t *samples, size_t count,
+                                 adxl343_sample_t *out, size_t max_out) {
+    adxl343_sample_t *w = rs->window;
+    size_t written = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        if (!rs->primed) {
+            // Hold the first sample backwards in time
+            w[1] = w[2] = w[3] = samples[i];
+            rs->primed = true;
+        }
+        w[0] = w[1];
+        w[1] = w[2];
+        w[2] = w[3];
+        w[3] = samples[i];
+
+        while (rs->pos < ONE) {
+            int32_t mu = (int32_t)(rs->pos >> 17);
+            if (written < max_out) {
+                out[written].x = interpolate(w[0].x, w[1].x, w[2].x, w[3].x, mu);
+                out[written].y = interpolate(w[0].y, w[1].y, w[2].y, w[3].y, mu);
+                out[written].z = interpolate(w[0].z, w[1].z, w[2].z, w[3].z, mu);
+                written++;
+            }
+            rs->pos += rs->step;
+        }
+        rs->pos -= ONE;
+    }
+
+    return written;
+}
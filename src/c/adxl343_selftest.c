@@ -0,0 +1,122 @@
+#include <math.h>
+
+#include "ADXL343_selftest.h"
+
+#define TEST_FORMAT (ADXL343_FORMAT_FULL_RES | ADXL343_RANGE_16G)
+// Standard errors of margin for a verdict
+#define SIGMAS 3.0f
+
+const adxl343_selftest_config_t adxl343_selftest_default = {
+    .rate = ADXL343_RATE_800HZ,
+    .settle = 4,
+    .samples = 28,
+    .min_mg = {200, -2100, 300},
+    .max_mg = {2100, -200, 3400},
+};
+
+int adxl343_selftest_begin(adxl343_selftest_t *st, adxl343_dev_t *dev, const adxl343_selftest_config_t *config) {
+    bool rate_ok = (config->rate >= ADXL343_RATE_100HZ && config->rate <= ADXL343_RATE_800HZ) ||
+                   config->rate == ADXL343_RATE_3200HZ;
+    if (!rate_ok || config->samples < 2 || config->settle + config->samples > ADXL343_FIFO_DEPTH) {
+        return ADXL343_ERROR_ARGUMENT;
+    }
+    for (int i = 0; i < 3; i++) {
+        if (config->min_mg[i] > config->max_mg[i]) {
+            return ADXL343_ERROR_ARGUMENT;
+        }
+    }
+
+    st->dev = dev;
+    st->config = *config;
+    adxl343_op_self_test_init(&st->steps, config->rate, ADXL343_FIFO_FIFO);
+    st->status = ADXL343_PENDING;
+    st->filled = false;
+    st->index = 0;
+    st->failed = 0;
+    st->uncertain = 0;
+    return ADXL343_OK;
+}
+
+// Wait for the FIFO to hold a whole block, then pop it one entry per call,
+// accumulating all but the settle entries into block `b`
+static int collect(void *ctx, int b) {
+    adxl343_selftest_t *st = (adxl343_selftest_t *)ctx;
+    uint8_t block = (uint8_t)(st->config.settle + st->config.samples);
+
+    if (!st->filled) {
+        uint8_t fifo;
+        int status = adxl343_dev_fifo_status(st->dev, &fifo);
+        if (status != ADXL343_OK) {
+            return status;
+        }
+        st->filled = (fifo & ADXL343_FIFO_ENTRIES_MASK) >= block;
+        st->index = 0;
+        for (int i = 0; i < 3; i++) {
+            st->sum[b][i] = 0;
+            st->sum_sq[b][i] = 0;
+        }
+        return ADXL343_PENDING;
+    }
+
+    adxl343_sample_t s;
+    int status = adxl343_dev_read_sample(st->dev, &s);
+    if (status != ADXL343_OK) {
+        return status;
+    }
+    if (st->index >= st->config.settle) {
+        const int16_t v[3] = {s.x, s.y, s.z};
+        for (int i = 0; i < 3; i++) {
+            st->sum[b][i] += v[i];
+            st->sum_sq[b][i] += (int32_t)v[i] * v[i];
+        }
+    }
+    st->index++;
+    if (st->index < block) {
+        return ADXL343_PENDING;
+    }
+    st->filled = false;
+    return ADXL343_OK;
+}
+
+// Output change and standard error per axis, then the verdict
+static int evaluate(adxl343_selftest_t *st) {
+    float n = (float)st->config.samples;
+    float lsb_mg = adxl343_mg_per_lsb(TEST_FORMAT);
+
+    for (int i = 0; i < 3; i++) {
+        float mean[2], var[2];
+        for (int b = 0; b < 2; b++) {
+            // n * sum of squares - sum^2 is exact in 64 bits
+            int64_t spread = (int64_t)st->config.samples * st->sum_sq[b][i] - (int64_t)st->sum[b][i] * st->sum[b][i];
+            mean[b] = (float)st->sum[b][i] / n;
+            var[b] = (float)spread / (n * (n - 1.0f));
+        }
+        st->delta_mg[i] = (mean[1] - mean[0]) * lsb_mg;
+        st->sigma_mg[i] = sqrtf((var[0] + var[1]) / n) * lsb_mg;
+
+        float low = st->delta_mg[i] - SIGMAS * st->sigma_mg[i];
+        float high = st->delta_mg[i] + SIGMAS * st->sigma_mg[i];
+        if (high < st->config.min_mg[i] || low > st->config.max_mg[i]) {
+            st->failed |= (uint8_t)(1u << i);
+        } else if (low < st->config.min_mg[i] || high > st->config.max_mg[i]) {
+            st->uncertain |= (uint8_t)(1u << i);
+        }
+    }
+
+    if (st->failed) {
+        return ADXL343_ERROR_DEVICE;
+    }
+    return st->uncertain ? ADXL343_ERROR_STATE : ADXL343_OK;
+}
+
+static int step(adxl343_selftest_t *st) {
+    int status = adxl343_op_self_test_step(&st->steps, st->dev, collect, st);
+    return status == ADXL343_OK ? evaluate(st) : status;
+}
+
+int adxl343_selftest_poll(adxl343_selftest_t *st) {
+    if (st->status == ADXL343_PENDING) {
+        st->status = step(st);
+    }
+    return st->status;
+}
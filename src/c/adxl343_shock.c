@@ -0,0 +1,208 @@
+#include "ADXL343_shock.h"
+
+#include <string.h>
+
+#define MG_PER_THRESH 62.5f
+#define PRE_TRIGGER_SAMPLES (ADXL343_FIFO_DEPTH - 1)
+
+static int arm(adxl343_dev_t *dev) {
+    uint8_t source;
+    int status = adxl343_dev_read_int_source(dev, &source);
+    if (status != ADXL343_OK) {
+        return status;
+    }
+
+    // Passing through bypass clears FIFO_TRIG
+    status = adxl343_dev_write_reg(dev, ADXL343_REG_FIFO_CTL, ADXL343_FIFO_BYPASS);
+    if (status != ADXL343_OK) {
+        return status;
+    }
+    return adxl343_dev_write_reg(dev, ADXL343_REG_FIFO_CTL, ADXL343_FIFO_TRIGGER | PRE_TRIGGER_SAMPLES);
+}
+
+static bool over_threshold(const adxl343_shock_t *rec, const adxl343_sample_t *s) {
+    int32_t t = rec->threshold_lsb;
+    uint8_t axes = rec->config.axes;
+
+    return ((axes & ADXL343_ACT_X) && (s->x > t || s->x < -t)) ||
+           ((axes & ADXL343_ACT_Y) && (s->y > t || s->y < -t)) ||
+           ((axes & ADXL343_ACT_Z) && (s->z > t || s->z < -t));
+}
+
+static void history_push(adxl343_shock_t *rec, const adxl343_sample_t *s) {
+    rec->history[rec->history_head] = *s;
+    rec->history_head = (uint16_t)((rec->history_head + 1) % ADXL343_SHOCK_MAX_PRE);
+    if (rec->history_valid < ADXL343_SHOCK_MAX_PRE) {
+        rec->history_valid++;
+    }
+}
+
+static void start_record(adxl343_shock_t *rec) {
+    adxl343_shock_record_t *record = NULL;
+
+    for (size_t i = 0; i < ADXL343_SHOCK_POOL_SIZE; i++) {
+        if (rec->pool[i].state == ADXL343_SHOCK_FREE) {
+            record = &rec->pool[i];
+            break;
+        }
+    }
+    rec->events++;
+    if (record == NULL) {
+        rec->dropped++;
+        return;
+    }
+
+    uint16_t pre = rec->config.pre < rec->history_valid ? rec->config.pre : rec->history_valid;
+    for (uint16_t i = 0; i < pre; i++) {
+        uint16_t at = (uint16_t)((rec->history_head + ADXL343_SHOCK_MAX_PRE - pre + i) % ADXL343_SHOCK_MAX_PRE);
+        record->samples[i] = rec->history[at];
+    }
+    record->pre = pre;
+    record->count = pre;
+    record->flags = 0;
+    record->state = ADXL343_SHOCK_CAPTURING;
+    record->sequence = rec->events;
+    record->index = rec->drained;
+    rec->active = record;
+}
+
+int adxl343_shock_init(adxl343_shock_t *rec, adxl343_dev_t *dev, const adxl343_shock_config_t *config) {
+    if (config->pre > ADXL343_SHOCK_MAX_PRE || config->post == 0 || config->post > ADXL343_SHOCK_MAX_POST ||
+        (config->axes & ~(ADXL343_ACT_X | ADXL343_ACT_Y | ADXL343_ACT_Z)) || config->axes == 0) {
+        return ADXL343_ERROR_ARGUMENT;
+    }
+
+    memset(rec, 0, sizeof(*rec));
+    rec->dev = dev;
+    rec->config = *config;
+
+    uint8_t format;
+    int status = adxl343_dev_read_reg(dev, ADXL343_REG_DATA_FORMAT, &format);
+    if (status != ADXL343_OK) {
+        return status;
+    }
+    rec->threshold_lsb = (int32_t)(config->threshold * MG_PER_THRESH / adxl343_mg_per_lsb(format));
+
+    // Activity is the only source on INT1, which is the FIFO trigger
+    const uint8_t setup[][2] = {
+        {ADXL343_REG_INT_ENABLE, 0},
+        {ADXL343_REG_THRESH_ACT, config->threshold},
+        {ADXL343_REG_ACT_INACT_CTL, config->axes},
+        {ADXL343_REG_INT_MAP, (uint8_t)~ADXL343_INT_ACTIVITY},
+        {ADXL343_REG_INT_ENABLE, ADXL343_INT_ACTIVITY},
+    };
+    for (size_t i = 0; i < sizeof(setup) / sizeof(setup[0]); i++) {
+        status = adxl343_dev_write_reg(dev, setup[i][0], setup[i][1]);
+        if (status != ADXL343_OK) {
+            return status;
+        }
+    }
+
+    return arm(dev);
+}
+
+int adxl343_shock_service(adxl343_shock_t *rec) {
+    adxl343_sample_t batch[ADXL343_FIFO_DEPTH];
+    uint8_t source;
+    uint8_t fifo;
+
+    int status = adxl343_dev_read_int_source(rec->dev, &source);
+    if (status != ADXL343_OK) {
+        return status;
+    }
+    status = adxl343_dev_fifo_status(rec->dev, &fifo);
+    if (status != ADXL343_OK) {
+        return status;
+    }
+
+    int count = adxl343_dev_read_fifo(rec->dev, batch, fifo & ADXL343_FIFO_ENTRIES_MASK);
+    if (count < 0) {
+        return count;
+    }
+
+    // An overrun before the trigger means samples were lost ahead of this
+    // batch. After the trigger the FIFO stops filling when full, so the
+    // batch is intact but whatever follows it is not.
+    bool overrun = (source & ADXL343_INT_OVERRUN) != 0;
+    bool rearm = false;
+    if (overrun) {
+        rec->overruns++;
+        rec->history_valid = 0;
+        if (rec->active != NULL) {
+            rec->active->flags |= ADXL343_SHOCK_TRUNCATED;
+            rec->active->state = ADXL343_SHOCK_READY;
+            rec->active = NULL;
+            rearm = true;
+        }
+    }
+
+    // The trigger sample is in this batch if FIFO_TRIG was already set when
+    // its entries were counted and no capture is running yet.
+    int edge = -1;
+    if (!rearm && (fifo & ADXL343_FIFO_TRIG) && rec->active == NULL) {
+        for (int i = 0; i < count && edge < 0; i++) {
+            if (over_threshold(rec, &batch[i])) {
+                edge = i;
+            }
+        }
+        if (edge < 0) {
+            edge = 0;
+        }
+        rearm = true;
+    }
+
+    for (int i = 0; i < count; i++) {
+        if (i == edge) {
+            start_record(rec);
+            if (rec->active != NULL && !over_threshold(rec, &batch[i])) {
+                rec->active->flags |= ADXL343_SHOCK_NO_EDGE;
+            }
+        }
+
+        adxl343_shock_record_t *record = rec->active;
+        if (record != NULL) {
+            record->samples[record->count++] = batch[i];
+            if (record->count == record->pre + rec->config.post) {
+                record->state = ADXL343_SHOCK_READY;
+                rec->active = NULL;
+                rearm = true;
+            }
+        }
+        history_push(rec, &batch[i]);
+        rec->drained++;
+    }
+
+    if (overrun && rec->active != NULL) {
+        rec->active->flags |= ADXL343_SHOCK_TRUNCATED;
+        rec->active->state = ADXL343_SHOCK_READY;
+        rec->active = NULL;
+    }
+
+    if (rearm && rec->active == NULL) {
+        // Whatever arrives between the drain and the re-arm is discarded
+        rec->history_valid = 0;
+        return arm(rec->dev);
+    }
+
+    return ADXL343_OK;
+}
+
+adxl343_shock_record_t *adxl343_shock_take(adxl343_shock_t *rec) {
+    adxl343_shock_record_t *oldest = NULL;
+
+    for (size_t i = 0; i < ADXL343_SHOCK_POOL_SIZE; i++) {
+        adxl343_shock_record_t *r = &rec->pool[i];
+        if (r->state == ADXL343_SHOCK_READY && (oldest == NULL || r->sequence < oldest->sequence)) {
+            oldest = r;
+        }
+    }
+    if (oldest != NULL) {
+        oldest->state = ADXL343_SHOCK_TAKEN;
+    }
+    return oldest;
+}
+
+void adxl343_shock_release(adxl343_shock_t *rec, adxl343_shock_record_t *record) {
+    (void)rec;
+    record->state = ADXL343_SHOCK_FREE;
+}
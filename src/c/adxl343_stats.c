@@ -0,0 +1,128 @@
+#include "ADXL343_stats.h"
+
+#include <math.h>
+#include <string.h>
+
+#define STATS_MAX_DEVIATION 8191
+
+static void axis_reset(adxl343_axis_acc_t *acc) {
+    memset(acc, 0, sizeof(*acc));
+}
+
+static void axis_add(adxl343_axis_acc_t *acc, int16_t value, bool first, uint8_t shift) {
+    if (first) {
+        acc->pivot = value;
+        acc->min = value;
+        acc->max = value;
+    } else if (value < acc->min) {
+        acc->min = value;
+    } else if (value > acc->max) {
+        acc->max = value;
+    }
+
+    // Clamp so out-of-spec input cannot overflow the power sums.
+    int32_t d = ((int32_t)value - acc->pivot) >> shift;
+    if (d > STATS_MAX_DEVIATION) {
+        d = STATS_MAX_DEVIATION;
+    } else if (d < -STATS_MAX_DEVIATION) {
+        d = -STATS_MAX_DEVIATION;
+    }
+
+    uint32_t d2 = (uint32_t)(d * d);
+    acc->sum1 += d;
+    acc->sum2 += d2;
+    acc->sum3 += (int64_t)d2 * d;
+    acc->sum4 += (uint64_t)d2 * d2;
+}
+
+static void axis_finish(const adxl343_axis_acc_t *acc, uint16_t count, uint8_t shift, adxl343_axis_stats_t *out) {
+    double n = count;
+    double scale = (double)(1 << shift);
+    double mu = acc->sum1 / n;
+    double s2 = (double)acc->sum2 / n;
+    double s3 = (double)acc->sum3 / n;
+    double s4 = (double)acc->sum4 / n;
+    double mu2 = mu * mu;
+
+    // Central moments from the raw moments about the pivot.
+    double m2 = s2 - mu2;
+    double m4 = s4 - 4.0 * mu * s3 + 6.0 * mu2 * s2 - 3.0 * mu2 * mu2;
+    if (m2 < 0.0) {
+        m2 = 0.0;
+    }
+    if (m4 < 0.0) {
+        m4 = 0.0;
+    }
+
+    double mean = acc->pivot + mu * scale;
+    double rms = sqrt(m2) * scale;
+    double above = acc->max - mean;
+    double below = mean - acc->min;
+    double peak = above > below ? above : below;
+
+    out->mean = (float)mean;
+    out->rms = (float)rms;
+    out->peak = (float)peak;
+    out->peak_to_peak = (float)(acc->max - acc->min);
+    out->crest = rms > 0.0 ? (float)(peak / rms) : 0.0f;
+    out->kurtosis = m2 > 0.0 ? (float)(m4 / (m2 * m2)) : 0.0f;
+}
+
+void adxl343_stats_init(adxl343_stats_t *stats, uint16_t window) {
+    if (window == 0) {
+        window = 1;
+    } else if (window > ADXL343_STATS_MAX_WINDOW) {
+        window = ADXL343_STATS_MAX_WINDOW;
+    }
+
+    for (int i = 0; i < 3; i++) {
+        axis_reset(&stats->axis[i]);
+    }
+    stats->window = window;
+    stats->count = 0;
+    stats->shift = 0;
+}
+
+void adxl343_stats_set_format(adxl343_stats_t *stats, uint8_t data_format) {
+    for (int i = 0; i < 3; i++) {
+        axis_reset(&stats->axis[i]);
+    }
+    stats->count = 0;
+    stats->shift = (data_format & ADXL343_FORMAT_JUSTIFY) ? ADXL343_JUSTIFY_SHIFT : 0;
+}
+
+size_t adxl343_stats_add(adxl343_stats_t *stats, const adxl343_sample_t *samples, size_t count) {
+    size_t room = (size_t)(stats->window - stats->count);
+    if (count > room) {
+        count = room;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        bool first = stats->count == 0;
+        axis_add(&stats->axis[0], samples[i].x, first, stats->shift);
+        axis_add(&stats->axis[1], samples[i].y, first, stats->shift);
+        axis_add(&stats->axis[2], samples[i].z, first, stats->shift);
+        stats->count++;
+    }
+
+    return count;
+}
+
+bool adxl343_stats_ready(const adxl343_stats_t *stats) {
+    return stats->count >= stats->window;
+}
+
+bool adxl343_stats_finish(adxl343_stats_t *stats, adxl343_stats_report_t *report) {
+    if (stats->count == 0) {
+        return false;
+    }
+
+    for (int i = 0; i < 3; i++) {
+        axis_finish(&stats->axis[i], stats->count, stats->shift, &report->axis[i]);
+        axis_reset(&stats->axis[i]);
+    }
+    report->count = stats->count;
+    stats->count = 0;
+
+    return true;
+}
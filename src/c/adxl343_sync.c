@@ -0,0 +1,243 @@
+#include "ADXL343_sync.h"
+
+#define Q12 4096
+#define Q16 65536
+
+// A tracked period further than this from nominal is a broken mapping
+#define MAX_ERROR_PPM 50000
+
+static int64_t period_q12(float hz) {
+    return (int64_t)(1e9 * Q12 / (double)hz + 0.5);
+}
+
+static void clear_timing(adxl343_sync_channel_t *ch) {
+    ch->period_q12 = ch->nominal_q12;
+    ch->npoints = 0;
+    ch->point_head = 0;
+    ch->have_best = false;
+}
+
+int adxl343_sync_init(adxl343_sync_t *sync, float frame_hz) {
+    if (!(frame_hz > 0.0f)) {
+        return ADXL343_ERROR_ARGUMENT;
+    }
+    sync->count = 0;
+    sync->frame_q12 = period_q12(frame_hz);
+    sync->origin_ns = 0;
+    sync->next_frame = 0;
+    sync->started = false;
+    sync->gaps = 0;
+    return ADXL343_OK;
+}
+
+int adxl343_sync_add(adxl343_sync_t *sync, float odr_hz) {
+    if (sync->count == ADXL343_SYNC_MAX_CHANNELS || !(odr_hz > 0.0f)) {
+        return ADXL343_ERROR_ARGUMENT;
+    }
+
+    adxl343_sync_channel_t *ch = &sync->channels[sync->count];
+    ch->nominal_q12 = period_q12(odr_hz);
+    ch->dropped = 0;
+    ch->head = 0;
+    ch->count = 0;
+    ch->first_k = 0;
+    ch->next_k = 0;
+    clear_timing(ch);
+    return (int)sync->count++;
+}
+
+void adxl343_sync_restart(adxl343_sync_t *sync, size_t channel) {
+    adxl343_sync_channel_t *ch = &sync->channels[channel];
+    ch->head = 0;
+    ch->count = 0;
+    ch->first_k = ch->next_k;
+    clear_timing(ch);
+}
+
+// Offset of point `a` against point `b` along the period: negative when
+// `a` was drained closer to its sample
+static int64_t lag_diff(const adxl343_sync_channel_t *ch, const adxl343_sync_point_t *a,
+                        const adxl343_sync_point_t *b) {
+    return (int64_t)(a->t_ns - b->t_ns) - (int64_t)(a->k - b->k) * ch->period_q12 / Q12;
+}
+
+static const adxl343_sync_point_t *reference(const adxl343_sync_channel_t *ch) {
+    if (ch->npoints > 0) {
+        return &ch->points[(ch->point_head + ch->npoints - 1) % ADXL343_SYNC_POINTS];
+    }
+    return ch->have_best ? &ch->best : NULL;
+}
+
+static void close_bucket(adxl343_sync_channel_t *ch) {
+    if (ch->npoints == ADXL343_SYNC_POINTS) {
+        ch->point_head = (uint8_t)((ch->point_head + 1) % ADXL343_SYNC_POINTS);
+        ch->npoints--;
+    }
+    ch->points[(ch->point_head + ch->npoints) % ADXL343_SYNC_POINTS] = ch->best;
+    ch->npoints++;
+
+    if (ch->npoints < 2) {
+        return;
+    }
+    const adxl343_sync_point_t *oldest = &ch->points[ch->point_head];
+    int64_t period = (int64_t)(ch->best.t_ns - oldest->t_ns) * Q12 / (int64_t)(ch->best.k - oldest->k);
+    int64_t limit = ch->nominal_q12 / (1000000 / MAX_ERROR_PPM);
+    if (period < ch->nominal_q12 - limit || period > ch->nominal_q12 + limit) {
+        // Samples went missing; start over from this point
+        ch->points[0] = ch->best;
+        ch->point_head = 0;
+        ch->npoints = 1;
+        ch->period_q12 = ch->nominal_q12;
+        return;
+    }
+    ch->period_q12 = period;
+}
+
+static void track(adxl343_sync_channel_t *ch, uint64_t k, uint64_t now_ns) {
+    adxl343_sync_point_t point = {k, now_ns};
+
+    if (ch->have_best && now_ns >= ch->bucket_end_ns) {
+        close_bucket(ch);
+        ch->have_best = false;
+    }
+    if (!ch->have_best) {
+        ch->best = point;
+        ch->have_best = true;
+        ch->bucket_end_ns = now_ns + ADXL343_SYNC_BUCKET_NS;
+    } else if (lag_diff(ch, &point, &ch->best) < 0) {
+        ch->best = point;
+    }
+}
+
+int adxl343_sync_push(adxl343_sync_t *sync, size_t channel, const adxl343_sample_t *samples, size_t count,
+                      uint64_t now_ns) {
+    if (channel >= sync->count) {
+        return ADXL343_ERROR_ARGUMENT;
+    }
+    adxl343_sync_channel_t *ch = &sync->channels[channel];
+    if (count == 0) {
+        return 0;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        if (ch->count == ADXL343_SYNC_DEPTH) {
+            ch->head = (uint16_t)((ch->head + 1) % ADXL343_SYNC_DEPTH);
+            ch->count--;
+            ch->first_k++;
+            ch->dropped++;
+        }
+        ch->ring[(ch->head + ch->count) % ADXL343_SYNC_DEPTH] = samples[i];
+        ch->count++;
+    }
+    ch->next_k += count;
+    track(ch, ch->next_k - 1, now_ns);
+
+    return (int)count;
+}
+
+static uint64_t time_of(const adxl343_sync_channel_t *ch, uint64_t k) {
+    const adxl343_sync_point_t *ref = reference(ch);
+    return ref->t_ns + (uint64_t)((int64_t)(k - ref->k) * ch->period_q12 / Q12);
+}
+
+// Position of host time `t_ns` in samples, Q16, relative to the reference
+static int64_t position_q16(const adxl343_sync_channel_t *ch, uint64_t t_ns, const adxl343_sync_point_t *ref) {
+    // Whole samples first and the fraction from the remainder, so that
+    // `dt` scaled to Q28 never has to fit in 64 bits
+    int64_t dt_q12 = (int64_t)(t_ns - ref->t_ns) * Q12;
+    int64_t whole = dt_q12 / ch->period_q12;
+    int64_t rem = dt_q12 % ch->period_q12;
+    // Floor rather than truncate so the fraction below is never negative
+    if (rem < 0) {
+        whole--;
+        rem += ch->period_q12;
+    }
+    return whole * Q16 + rem * Q16 / ch->period_q12;
+}
+
+// The fraction drops to Q15 so a full-scale step of left-justified samples
+// still fits the 32-bit product
+static int16_t lerp(int16_t a, int16_t b, int32_t frac) {
+    return (int16_t)(a + (((int32_t)(b - a) * (frac >> 1) + (1 << 14)) >> 15));
+}
+
+size_t adxl343_sync_frames(adxl343_sync_t *sync, adxl343_frame_t *dst, size_t max) {
+    if (sync->count == 0) {
+        return 0;
+    }
+    for (size_t c = 0; c < sync->count; c++) {
+        const adxl343_sync_channel_t *ch = &sync->channels[c];
+        if (ch->count < 2 || reference(ch) == NULL) {
+            return 0;
+        }
+    }
+
+    // The first frame waits for the channel that started last
+    if (!sync->started) {
+        uint64_t origin = 0;
+        for (size_t c = 0; c < sync->count; c++) {
+            uint64_t t = time_of(&sync->channels[c], sync->channels[c].first_k);
+            origin = t > origin ? t : origin;
+        }
+        sync->origin_ns = origin;
+        sync->next_frame = 0;
+        sync->started = true;
+    }
+
+    size_t n = 0;
+    while (n < max) {
+        uint64_t t = sync->origin_ns + (uint64_t)((int64_t)sync->next_frame * sync->frame_q12 / Q12);
+        uint64_t index[ADXL343_SYNC_MAX_CHANNELS];
+        int32_t frac[ADXL343_SYNC_MAX_CHANNELS];
+        bool ready = true;
+        bool missing = false;
+
+        for (size_t c = 0; c < sync->count && ready; c++) {
+            const adxl343_sync_channel_t *ch = &sync->channels[c];
+            const adxl343_sync_point_t *ref = reference(ch);
+            int64_t pos = position_q16(ch, t, ref);
+            int64_t k = (int64_t)ref->k + (pos >> 16);
+
+            if (k + 1 >= (int64_t)ch->next_k) {
+                ready = false;
+            } else if (k < (int64_t)ch->first_k) {
+                missing = true;
+            }
+            index[c] = (uint64_t)k;
+            frac[c] = (int32_t)(pos & (Q16 - 1));
+        }
+        if (!ready) {
+            break;
+        }
+        sync->next_frame++;
+        if (missing) {
+            sync->gaps++;
+            continue;
+        }
+
+        adxl343_frame_t *frame = &dst[n++];
+        frame->t_ns = t;
+        for (size_t c = 0; c < sync->count; c++) {
+            adxl343_sync_channel_t *ch = &sync->channels[c];
+
+            // Samples before the pair used are no longer needed
+            while (ch->first_k < index[c]) {
+                ch->head = (uint16_t)((ch->head + 1) % ADXL343_SYNC_DEPTH);
+                ch->count--;
+                ch->first_k++;
+            }
+            const adxl343_sample_t *a = &ch->ring[ch->head];
+            const adxl343_sample_t *b = &ch->ring[(ch->head + 1) % ADXL343_SYNC_DEPTH];
+            frame->channels[c].x = lerp(a->x, b->x, frac[c]);
+            frame->channels[c].y = lerp(a->y, b->y, frac[c]);
+            frame->channels[c].z = lerp(a->z, b->z, frac[c]);
+        }
+    }
+
+    return n;
+}
+
+float adxl343_sync_drift_ppm(const adxl343_sync_t *sync, size_t channel) {
+    const adxl343_sync_channel_t *ch = &sync->channels[channel];
+    return (float)(((double)ch->nominal_q12 / (double)ch->period_q12 - 1.0) * 1e6);
+}
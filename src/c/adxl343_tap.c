@@ -0,0 +1,105 @@
+#include "ADXL343_tap.h"
+
+#define TAP_BITS (ADXL343_INT_SINGLE_TAP | ADXL343_INT_DOUBLE_TAP)
+#define TAP_STATUS_BITS (ADXL343_STATUS_TAP_X | ADXL343_STATUS_TAP_Y | ADXL343_STATUS_TAP_Z)
+// ACT_TAP_STATUS .. INT_SOURCE, read as one burst
+#define STATUS_LEN (ADXL343_REG_INT_SOURCE - ADXL343_REG_ACT_TAP_STATUS + 1)
+
+int adxl343_tap_init(adxl343_tap_t *tap, adxl343_dev_t *dev, const adxl343_tap_config_t *config) {
+    uint8_t tap_axes = ADXL343_TAP_X | ADXL343_TAP_Y | ADXL343_TAP_Z;
+    if (config->threshold == 0 || config->duration == 0 || !(config->axes & tap_axes) ||
+        (config->axes & ~(tap_axes | ADXL343_TAP_SUPPRESS)) || (config->pin != 1 && config->pin != 2)) {
+        return ADXL343_ERROR_ARGUMENT;
+    }
+
+    // INT_ENABLE, INT_MAP
+    uint8_t control[2];
+    int status = adxl343_dev_read_regs(dev, ADXL343_REG_INT_ENABLE, control, sizeof(control));
+    if (status != ADXL343_OK) {
+        return status;
+    }
+
+    uint8_t enabled = ADXL343_INT_SINGLE_TAP;
+    if (config->latent != 0 && config->window != 0) {
+        enabled |= ADXL343_INT_DOUBLE_TAP;
+    }
+    const uint8_t timing[] = {config->duration, config->latent, config->window};
+    uint8_t map = (uint8_t)(config->pin == 2 ? control[1] | TAP_BITS : control[1] & ~TAP_BITS);
+
+    // Taps off while the detector changes, routed before they come back on
+    status = adxl343_dev_write_reg(dev, ADXL343_REG_INT_ENABLE, (uint8_t)(control[0] & ~TAP_BITS));
+    if (status == ADXL343_OK) {
+        status = adxl343_dev_write_reg(dev, ADXL343_REG_THRESH_TAP, config->threshold);
+    }
+    if (status == ADXL343_OK) {
+        status = adxl343_dev_write_regs(dev, ADXL343_REG_DUR, timing, sizeof(timing));
+    }
+    if (status == ADXL343_OK) {
+        status = adxl343_dev_write_reg(dev, ADXL343_REG_TAP_AXES, config->axes);
+    }
+    if (status == ADXL343_OK) {
+        status = adxl343_dev_write_reg(dev, ADXL343_REG_INT_MAP, map);
+    }
+    if (status == ADXL343_OK) {
+        status = adxl343_dev_write_reg(dev, ADXL343_REG_INT_ENABLE, (uint8_t)((control[0] & ~TAP_BITS) | enabled));
+    }
+    if (status != ADXL343_OK) {
+        return status;
+    }
+
+    tap->dev = dev;
+    tap->enabled = enabled;
+    tap->source = 0;
+    tap->singles = 0;
+    tap->doubles = 0;
+    return ADXL343_OK;
+}
+
+int adxl343_tap_service(adxl343_tap_t *tap, adxl343_tap_event_t *events, size_t max) {
+    // ACT_TAP_STATUS comes first in the burst, before INT_SOURCE is cleared
+    uint8_t regs[STATUS_LEN];
+    int status = adxl343_dev_read_regs(tap->dev, ADXL343_REG_ACT_TAP_STATUS, regs, sizeof(regs));
+    if (status != ADXL343_OK) {
+        return status;
+    }
+    tap->source = regs[STATUS_LEN - 1];
+
+    uint8_t axes = regs[0] & TAP_STATUS_BITS;
+    uint8_t taps = tap->source & tap->enabled;
+    size_t count = 0;
+    if (taps & ADXL343_INT_SINGLE_TAP) {
+        tap->singles++;
+        if (count < max) {
+            events[count++] = (adxl343_tap_event_t){ADXL343_TAP_SINGLE, axes};
+        }
+    }
+    if (taps & ADXL343_INT_DOUBLE_TAP) {
+        tap->doubles++;
+        if (count < max) {
+            events[count++] = (adxl343_tap_event_t){ADXL343_TAP_DOUBLE, axes};
+        }
+    }
+    return (int)count;
+}
+
+int adxl343_tap_wait(adxl343_tap_t *tap, const adxl343_wom_host_t *host, adxl343_tap_event_t *events, size_t max) {
+    for (;;) {
+        host->wait_for_interrupt(host->ctx);
+        int count = adxl343_tap_service(tap, events, max);
+        if (count != 0 || (tap->source & tap->enabled)) {
+            return count;
+        }
+    }
+}
+
+int adxl343_tap_disable(adxl343_tap_t *tap) {
+    uint8_t enable;
+    int status = adxl343_dev_read_reg(tap->dev, ADXL343_REG_INT_ENABLE, &enable);
+    if (status == ADXL343_OK) {
+        status = adxl343_dev_write_reg(tap->dev, ADXL343_REG_INT_ENABLE, (uint8_t)(enable & ~TAP_BITS));
+    }
+    if (status == ADXL343_OK) {
+        tap->enabled = 0;
+    }
+    return status;
+}
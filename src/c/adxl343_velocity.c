@@ -0,0 +1,117 @@
+#include "ADXL343_velocity.h"
+
+#include <math.h>
+#include <string.h>
+
+#define VELOCITY_LIMIT (1L << 30)
+#define STANDARD_GRAVITY_MM_S2 9806.65f
+
+static int32_t decay(int32_t state, int32_t k) {
+    return state - (int32_t)(((int64_t)state * k) >> 15);
+}
+
+static void axis_step(adxl343_velocity_axis_t *axis, int16_t in, int32_t k) {
+    int32_t prev_accel = axis->accel;
+
+    // DC blocker: y[n] = x[n] - x[n-1] + p * y[n-1]
+    axis->accel = decay(axis->accel, k) + (((int32_t)in - axis->prev_in) << 8);
+    axis->prev_in = in;
+
+    // Leaky trapezoidal integrator: v[n] = p * v[n-1] + (y[n] + y[n-1]) / 2
+    int32_t v = decay(axis->velocity, k) + ((axis->accel + prev_accel) >> 1);
+    if (v > VELOCITY_LIMIT) {
+        v = VELOCITY_LIMIT;
+    } else if (v < -VELOCITY_LIMIT) {
+        v = -VELOCITY_LIMIT;
+    }
+    axis->velocity = v;
+
+    // A full window at the limit is 2^52 * 4096, one past the top of the
+    // sum; saturate rather than wrap
+    uint64_t sq = ((uint64_t)((int64_t)v * v)) >> 8;
+    axis->sum_sq = axis->sum_sq > UINT64_MAX - sq ? UINT64_MAX : axis->sum_sq + sq;
+}
+
+bool adxl343_velocity_init(adxl343_velocity_t *vel, const adxl343_velocity_config_t *config) {
+    if (!(config->odr_hz > 0.0f) || !(config->highpass_hz > 0.0f) ||
+        config->highpass_hz >= config->odr_hz / 4.0f) {
+        return false;
+    }
+
+    uint16_t window = config->window;
+    if (window == 0) {
+        window = 1;
+    } else if (window > ADXL343_VELOCITY_MAX_WINDOW) {
+        window = ADXL343_VELOCITY_MAX_WINDOW;
+    }
+
+    double pole = exp(-2.0 * M_PI * config->highpass_hz / config->odr_hz);
+    vel->leak = (int32_t)lround((1.0 - pole) * 32768.0);
+    if (vel->leak < 1) {
+        vel->leak = 1;
+    }
+    vel->shift = (config->data_format & ADXL343_FORMAT_JUSTIFY) ? ADXL343_JUSTIFY_SHIFT : 0;
+    float mg_per_lsb = adxl343_mg_per_lsb(config->data_format) * (float)(1 << vel->shift);
+    vel->scale = mg_per_lsb * 1e-3f * STANDARD_GRAVITY_MM_S2 / config->odr_hz;
+    vel->window = window;
+    adxl343_velocity_reset(vel);
+
+    return true;
+}
+
+void adxl343_velocity_reset(adxl343_velocity_t *vel) {
+    memset(vel->axis, 0, sizeof(vel->axis));
+    vel->count = 0;
+    vel->primed = false;
+}
+
+size_t adxl343_velocity_add(adxl343_velocity_t *vel, const adxl343_sample_t *samples, size_t count) {
+    size_t room = (size_t)(vel->window - vel->count);
+    if (count > room) {
+        count = room;
+    }
+    if (count == 0) {
+        return 0;
+    }
+
+    const uint8_t shift = vel->shift;
+
+    // Seed the previous input with the first sample so a static offset such
+    // as gravity does not ring the filters at start-up.
+    if (!vel->primed) {
+        vel->axis[0].prev_in = (int16_t)(samples[0].x >> shift);
+        vel->axis[1].prev_in = (int16_t)(samples[0].y >> shift);
+        vel->axis[2].prev_in = (int16_t)(samples[0].z >> shift);
+        vel->primed = true;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        axis_step(&vel->axis[0], (int16_t)(samples[i].x >> shift), vel->leak);
+        axis_step(&vel->axis[1], (int16_t)(samples[i].y >> shift), vel->leak);
+        axis_step(&vel->axis[2], (int16_t)(samples[i].z >> shift), vel->leak);
+    }
+    vel->count += (uint16_t)count;
+
+    return count;
+}
+
+bool adxl343_velocity_ready(const adxl343_velocity_t *vel) {
+    return vel->count >= vel->window;
+}
+
+bool adxl343_velocity_finish(adxl343_velocity_t *vel, adxl343_velocity_report_t *report) {
+    if (vel->count == 0) {
+        return false;
+    }
+
+    for (int i = 0; i < 3; i++) {
+        // sum_sq holds (v * 2^8)^2 / 2^8 = v^2 * 2^8
+        double mean_sq = (double)vel->axis[i].sum_sq / ((double)vel->count * 256.0);
+        report->rms_mm_s[i] = (float)sqrt(mean_sq) * vel->scale;
+        vel->axis[i].sum_sq = 0;
+    }
+    report->count = vel->count;
+    vel->count = 0;
+
+    return true;
+}
@@ -0,0 +1,76 @@
+#include "ADXL343_wom.h"
+
+// Registers saved across the dormant period, read and written as bursts
+#define DETECTORS_LEN 4   // THRESH_ACT .. ACT_INACT_CTL
+#define CONTROL_LEN 4     // BW_RATE .. INT_MAP
+
+int adxl343_wom_sleep(adxl343_dev_t *dev, const adxl343_wom_config_t *config, const adxl343_wom_host_t *host) {
+    uint8_t detectors[DETECTORS_LEN];
+    uint8_t control[CONTROL_LEN];
+    uint8_t source;
+
+    if ((config->axes & ~(ADXL343_ACT_AC | ADXL343_ACT_X | ADXL343_ACT_Y | ADXL343_ACT_Z)) ||
+        !(config->axes & (ADXL343_ACT_X | ADXL343_ACT_Y | ADXL343_ACT_Z)) || config->rate > ADXL343_RATE_3200HZ) {
+        return ADXL343_ERROR_ARGUMENT;
+    }
+
+    int status = adxl343_dev_read_regs(dev, ADXL343_REG_THRESH_ACT, detectors, sizeof(detectors));
+    if (status == ADXL343_OK) {
+        status = adxl343_dev_read_regs(dev, ADXL343_REG_BW_RATE, control, sizeof(control));
+    }
+    if (status != ADXL343_OK) {
+        return status;
+    }
+
+    // Only the activity part of ACT_INACT_CTL changes
+    const uint8_t armed_detectors[DETECTORS_LEN] = {
+        config->threshold,
+        detectors[1],
+        detectors[2],
+        (uint8_t)((detectors[3] & 0x0F) | config->axes),
+    };
+    const uint8_t armed_rate = (uint8_t)(config->rate | (config->low_power ? ADXL343_BW_LOW_POWER : 0));
+    // Armed without LINK, AUTO_SLEEP or SLEEP: in link mode activity is only
+    // looked for after inactivity, which is not enabled while armed
+    const uint8_t sleep_bits = ADXL343_POWER_LINK | ADXL343_POWER_AUTO_SLEEP | ADXL343_POWER_SLEEP;
+    const uint8_t power = (uint8_t)((control[1] & ADXL343_POWER_WAKEUP_MASK) | ADXL343_POWER_MEASURE);
+
+    // Quiet the interrupts, route activity alone to INT1, then enable it.
+    // Clearing those bits while measuring can leave the sensor at the
+    // wakeup rate or waiting for inactivity, so such a setup passes through
+    // standby first.
+    status = adxl343_dev_write_reg(dev, ADXL343_REG_INT_ENABLE, 0);
+    if (status == ADXL343_OK && (control[1] & sleep_bits)) {
+        status = adxl343_dev_write_reg(dev, ADXL343_REG_POWER_CTL, 0);
+    }
+    if (status == ADXL343_OK) {
+        status = adxl343_dev_write_regs(dev, ADXL343_REG_THRESH_ACT, armed_detectors, sizeof(armed_detectors));
+    }
+    if (status == ADXL343_OK) {
+        status = adxl343_dev_write_reg(dev, ADXL343_REG_INT_MAP, (uint8_t)~ADXL343_INT_ACTIVITY);
+    }
+    if (status == ADXL343_OK) {
+        status = adxl343_dev_read_int_source(dev, &source);
+    }
+    if (status == ADXL343_OK) {
+        const uint8_t armed_control[] = {armed_rate, power, ADXL343_INT_ACTIVITY};
+        status = adxl343_dev_write_regs(dev, ADXL343_REG_BW_RATE, armed_control, sizeof(armed_control));
+    }
+    if (status != ADXL343_OK) {
+        return status;
+    }
+
+    host->wait_for_interrupt(host->ctx);
+
+    // INT_MAP goes back first so nothing lands on the wrong pin once the
+    // acquisition enables are restored
+    status = adxl343_dev_write_reg(dev, ADXL343_REG_INT_MAP, control[3]);
+    if (status == ADXL343_OK) {
+        status = adxl343_dev_write_regs(dev, ADXL343_REG_THRESH_ACT, detectors, sizeof(detectors));
+    }
+    if (status == ADXL343_OK) {
+        status = adxl343_dev_write_regs(dev, ADXL343_REG_BW_RATE, control, CONTROL_LEN - 1);
+    }
+
+    return status;
+}
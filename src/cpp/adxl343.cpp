@@ -4,10 +4,210 @@ extern "C" {
 
 #include "ADXL343.hpp"
 
-ADXL343::ADXL343() {
-    adxl343_initialize();
+#if defined(__cpp_impl_coroutine)
+#include <exception>
+#endif
+
+ADXL343::ADXL343(adxl343_dev_t *device) : dev(device) {
 }
 
 ADXL343::~ADXL343() {
-    // Destructor implementation
 }
+
+int ADXL343::init() {
+    return adxl343_dev_init(dev);
+}
+
+using namespace adxl343;
+
+uint8_t ADXL343::actInactControl(const PowerConfig &config) {
+    return Value<reg::ActInactCtl>()
+        .with<reg::ActInactCtl::ActAc>(config.activityCoupling == Coupling::AC)
+        .with<reg::ActInactCtl::ActAxes>(static_cast<uint8_t>(config.activityAxes))
+        .with<reg::ActInactCtl::InactAc>(config.inactivityCoupling == Coupling::AC)
+        .with<reg::ActInactCtl::InactAxes>(static_cast<uint8_t>(config.inactivityAxes))
+        .raw;
+}
+
+uint8_t ADXL343::powerControl(const PowerConfig &config) {
+    return Value<reg::PowerCtl>()
+        .with<reg::PowerCtl::Link>(config.link || config.autoSleep)
+        .with<reg::PowerCtl::AutoSleep>(config.autoSleep)
+        .with<reg::PowerCtl::Wakeup>(static_cast<uint8_t>(config.wakeup))
+        .raw;
+}
+
+int ADXL343::configurePower(const PowerConfig &config) {
+    if (config.autoSleep && (config.activityAxes == Axes::None || config.inactivityAxes == Axes::None)) {
+        return ADXL343_ERROR_ARGUMENT;
+    }
+
+    // Standby first: clearing SLEEP or AUTO_SLEEP while measuring can leave
+    // the sensor at the wakeup rate.
+    int status = adxl343_dev_write_reg(dev, reg::PowerCtl::address, 0);
+    if (status != ADXL343_OK) {
+        return status;
+    }
+
+    const uint8_t detectors[] = {
+        config.activityThreshold,
+        config.inactivityThreshold,
+        config.inactivityTime,
+        actInactControl(config),
+    };
+    static_assert(consecutive<reg::ThreshAct, reg::ThreshInact, reg::TimeInact, reg::ActInactCtl>(),
+                  "detector registers are written as one burst");
+    status = adxl343_dev_write_regs(dev, reg::ThreshAct::address, detectors, sizeof(detectors));
+    if (status != ADXL343_OK) {
+        return status;
+    }
+
+    if (config.autoSleep) {
+        constexpr uint8_t both = reg::IntEnable::Activity::mask | reg::IntEnable::Inactivity::mask;
+        status = adxl343_dev_update_reg(dev, reg::IntEnable::address, both, both);
+        if (status != ADXL343_OK) {
+            return status;
+        }
+    }
+
+    Value<reg::PowerCtl> power(powerControl(config));
+    return adxl343_dev_write_reg(dev, reg::PowerCtl::address, power.with<reg::PowerCtl::Measure>(true).raw);
+}
+
+int ADXL343::sleep(WakeupRate rate) {
+    Value<reg::PowerCtl> power;
+    int status = adxl343_dev_read_reg(dev, reg::PowerCtl::address, &power.raw);
+    if (status != ADXL343_OK) {
+        return status;
+    }
+
+    power = power.with<reg::PowerCtl::Wakeup>(static_cast<uint8_t>(rate))
+        .with<reg::PowerCtl::Sleep>(true)
+        .with<reg::PowerCtl::Measure>(true);
+    return adxl343_dev_write_reg(dev, reg::PowerCtl::address, power.raw);
+}
+
+int ADXL343::wake() {
+    Value<reg::PowerCtl> power;
+    int status = adxl343_dev_read_reg(dev, reg::PowerCtl::address, &power.raw);
+    if (status != ADXL343_OK) {
+        return status;
+    }
+
+    power = power.with<reg::PowerCtl::Sleep>(false).with<reg::PowerCtl::Measure>(false);
+    status = adxl343_dev_write_reg(dev, reg::PowerCtl::address, power.raw);
+    if (status != ADXL343_OK) {
+        return status;
+    }
+    return adxl343_dev_write_reg(dev, reg::PowerCtl::address, power.with<reg::PowerCtl::Measure>(true).raw);
+}
+
+int ADXL343::asleep(bool &sleeping) {
+    Value<reg::ActTapStatus> status_reg;
+    int status = adxl343_dev_read_reg(dev, reg::ActTapStatus::address, &status_reg.raw);
+    if (status != ADXL343_OK) {
+        return status;
+    }
+
+    sleeping = status_reg.get<reg::ActTapStatus::Asleep>();
+    return ADXL343_OK;
+}
+
+#if defined(__cpp_impl_coroutine)
+
+namespace {
+
+alignas(alignof(max_align_t)) unsigned char frames[ADXL343_CORO_FRAMES][ADXL343_CORO_FRAME_SIZE];
+bool frameUsed[ADXL343_CORO_FRAMES];
+
+}
+
+bool ADXL343::Event::dispatch() {
+    if (!pending || !waiter) {
+        return false;
+    }
+    pending = false;
+    std::coroutine_handle<> resume = waiter;
+    waiter = nullptr;
+    resume.resume();
+    return true;
+}
+
+bool ADXL343::BlockAwaiter::await_ready() noexcept {
+    if (event.pending) {
+        event.pending = false;
+        return true;
+    }
+    return false;
+}
+
+void ADXL343::BlockAwaiter::await_suspend(std::coroutine_handle<Task::promise_type> waiter) noexcept {
+    event.waiter = waiter;
+    waiter.promise().waiting = &event;
+    suspended = waiter;
+}
+
+int ADXL343::BlockAwaiter::await_resume() noexcept {
+    if (suspended) {
+        suspended.promise().waiting = nullptr;
+    }
+    return adxl343_dev_read_fifo(dev, dst, max);
+}
+
+void ADXL343::Task::promise_type::unhandled_exception() {
+    std::terminate();
+}
+
+void *ADXL343::Task::promise_type::operator new(size_t size) noexcept {
+    if (size > ADXL343_CORO_FRAME_SIZE) {
+        return nullptr;
+    }
+    for (size_t i = 0; i < ADXL343_CORO_FRAMES; i++) {
+        if (!frameUsed[i]) {
+            frameUsed[i] = true;
+            return frames[i];
+        }
+    }
+    return nullptr;
+}
+
+void ADXL343::Task::promise_type::operator delete(void *frame, size_t size) noexcept {
+    (void)size;
+    size_t index = static_cast<size_t>(static_cast<unsigned char *>(frame) - frames[0]) / ADXL343_CORO_FRAME_SIZE;
+    frameUsed[index] = false;
+}
+
+// A frame destroyed while it waits is taken off its Event first, so a
+// later dispatch() does not resume freed memory
+void ADXL343::Task::destroy() {
+    if (handle) {
+        if (handle.promise().waiting != nullptr) {
+            handle.promise().waiting->waiter = nullptr;
+        }
+        handle.destroy();
+        handle = nullptr;
+    }
+}
+
+ADXL343::Task &ADXL343::Task::operator=(Task &&other) noexcept {
+    if (this != &other) {
+        destroy();
+        handle = other.handle;
+        other.handle = nullptr;
+    }
+    return *this;
+}
+
+ADXL343::Task::~Task() {
+    destroy();
+}
+
+size_t ADXL343::Task::framesFree() {
+    size_t free = 0;
+    for (size_t i = 0; i < ADXL343_CORO_FRAMES; i++) {
+        free += frameUsed[i] ? 0 : 1;
+    }
+    return free;
+}
+
+#endif
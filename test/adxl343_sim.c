@@ -0,0 +1,651 @@
+#include "adxl343_sim.h"
+
+#include <math.h>
+#include <string.h>
+
+#define NS_PER_S 1000000000.0
+#define MG_PER_THRESH 62.5
+#define MG_PER_OFFSET 15.6
+#define NS_PER_DUR 625000ull
+#define NS_PER_LATENT 1250000ull
+#define NS_PER_WINDOW 1250000ull
+#define NS_PER_FREE_FALL 5000000ull
+
+#define EVENT_BITS (ADXL343_INT_SINGLE_TAP | ADXL343_INT_DOUBLE_TAP | ADXL343_INT_ACTIVITY | \
+                    ADXL343_INT_INACTIVITY | ADXL343_INT_FREE_FALL)
+
+static uint64_t period_ns(const adxl343_sim_t *sim) {
+    return (uint64_t)llround(NS_PER_S / adxl343_sim_odr_hz(sim));
+}
+
+static void set_asleep(adxl343_sim_t *sim, bool asleep) {
+    sim->asleep = asleep;
+    if (asleep) {
+        sim->regs[ADXL343_REG_ACT_TAP_STATUS] |= ADXL343_STATUS_ASLEEP;
+    } else {
+        sim->regs[ADXL343_REG_ACT_TAP_STATUS] &= (uint8_t)~ADXL343_STATUS_ASLEEP;
+    }
+}
+
+static bool auto_sleep(const adxl343_sim_t *sim) {
+    uint8_t power = sim->regs[ADXL343_REG_POWER_CTL];
+    return (power & ADXL343_POWER_LINK) && (power & ADXL343_POWER_AUTO_SLEEP);
+}
+
+static bool measuring(const adxl343_sim_t *sim) {
+    return (sim->regs[ADXL343_REG_POWER_CTL] & ADXL343_POWER_MEASURE) != 0;
+}
+
+static uint8_t fifo_mode(const adxl343_sim_t *sim) {
+    return sim->regs[ADXL343_REG_FIFO_CTL] & ADXL343_FIFO_MODE_MASK;
+}
+
+static void fifo_clear(adxl343_sim_t *sim) {
+    sim->fifo_head = 0;
+    sim->fifo_count = 0;
+    sim->triggered = false;
+}
+
+static void fifo_push(adxl343_sim_t *sim, const adxl343_sample_t *s) {
+    uint8_t mode = fifo_mode(sim);
+
+    if (mode == ADXL343_FIFO_BYPASS) {
+        return;
+    }
+    if (sim->fifo_count == ADXL343_FIFO_DEPTH) {
+        sim->regs[ADXL343_REG_INT_SOURCE] |= ADXL343_INT_OVERRUN;
+        if (mode == ADXL343_FIFO_FIFO || (mode == ADXL343_FIFO_TRIGGER && sim->triggered)) {
+            return;
+        }
+        // Stream, or trigger mode before the trigger: drop the oldest
+        sim->fifo_head = (uint8_t)((sim->fifo_head + 1) % ADXL343_FIFO_DEPTH);
+        sim->fifo_count--;
+    }
+    sim->fifo[(sim->fifo_head + sim->fifo_count) % ADXL343_FIFO_DEPTH] = *s;
+    sim->fifo_count++;
+}
+
+static void fifo_pop(adxl343_sim_t *sim) {
+    if (sim->fifo_count > 0) {
+        sim->fifo_head = (uint8_t)((sim->fifo_head + 1) % ADXL343_FIFO_DEPTH);
+        sim->fifo_count--;
+    }
+}
+
+static const adxl343_sample_t *output(const adxl343_sim_t *sim) {
+    if (fifo_mode(sim) != ADXL343_FIFO_BYPASS && sim->fifo_count > 0) {
+        return &sim->fifo[sim->fifo_head];
+    }
+    return &sim->latest;
+}
+
+// Refresh the level-triggered bits of INT_SOURCE from the FIFO state.
+static void update_levels(adxl343_sim_t *sim) {
+    uint8_t *source = &sim->regs[ADXL343_REG_INT_SOURCE];
+    uint8_t samples = sim->regs[ADXL343_REG_FIFO_CTL] & ADXL343_FIFO_SAMPLES_MASK;
+
+    if (fifo_mode(sim) != ADXL343_FIFO_BYPASS) {
+        if (sim->fifo_count > 0) {
+            *source |= ADXL343_INT_DATA_READY;
+        } else {
+            *source &= (uint8_t)~ADXL343_INT_DATA_READY;
+        }
+        if (sim->fifo_count >= samples && samples > 0) {
+            *source |= ADXL343_INT_WATERMARK;
+        } else {
+            *source &= (uint8_t)~ADXL343_INT_WATERMARK;
+        }
+    }
+}
+
+static int16_t to_lsb(const adxl343_sim_t *sim, double mg) {
+    uint8_t format = sim->regs[ADXL343_REG_DATA_FORMAT];
+    uint8_t range = format & ADXL343_FORMAT_RANGE_MASK;
+    bool full_res = (format & ADXL343_FORMAT_FULL_RES) != 0;
+    int bits = full_res ? 10 + range : 10;
+    double lsb_per_g = full_res ? 256.0 : (double)(256 >> range);
+    long limit = 1L << (bits - 1);
+
+    long v = lround(mg * lsb_per_g / 1000.0);
+    if (v >= limit) {
+        v = limit - 1;
+    } else if (v < -limit) {
+        v = -limit;
+    }
+    if (format & ADXL343_FORMAT_JUSTIFY) {
+        v *= 1L << (16 - bits);
+    }
+    return (int16_t)v;
+}
+
+static const uint8_t act_bits[3] = {ADXL343_ACT_X, ADXL343_ACT_Y, ADXL343_ACT_Z};
+static const uint8_t inact_bits[3] = {ADXL343_INACT_X, ADXL343_INACT_Y, ADXL343_INACT_Z};
+
+static void arm_activity(adxl343_sim_t *sim, const double mg[3]) {
+    // AC coupled detection compares against the acceleration at arming
+    memcpy(sim->activity_ref, mg, sizeof(sim->activity_ref));
+    sim->activity_armed = true;
+}
+
+static void arm_inactivity(adxl343_sim_t *sim, const double mg[3]) {
+    memcpy(sim->inactivity_ref, mg, sizeof(sim->inactivity_ref));
+    sim->inactive_ns = 0;
+    sim->inactivity_fired = false;
+    sim->inactivity_armed = true;
+}
+
+static void detect_activity(adxl343_sim_t *sim, const double mg[3]) {
+    uint8_t ctl = sim->regs[ADXL343_REG_ACT_INACT_CTL];
+    double threshold = sim->regs[ADXL343_REG_THRESH_ACT] * MG_PER_THRESH;
+    static const uint8_t status_bits[3] = {ADXL343_STATUS_ACT_X, ADXL343_STATUS_ACT_Y, ADXL343_STATUS_ACT_Z};
+    uint8_t hits = 0;
+
+    if (!sim->activity_armed) {
+        arm_activity(sim, mg);
+    }
+    for (int i = 0; i < 3; i++) {
+        if (!(ctl & act_bits[i])) {
+            continue;
+        }
+        double v = (ctl & ADXL343_ACT_AC) ? mg[i] - sim->activity_ref[i] : mg[i];
+        if (fabs(v) > threshold) {
+            hits |= status_bits[i];
+        }
+    }
+    if (!hits) {
+        return;
+    }
+
+    uint8_t *status = &sim->regs[ADXL343_REG_ACT_TAP_STATUS];
+    *status = (uint8_t)((*status & ~(ADXL343_STATUS_ACT_X | ADXL343_STATUS_ACT_Y | ADXL343_STATUS_ACT_Z)) | hits);
+    sim->regs[ADXL343_REG_INT_SOURCE] |= ADXL343_INT_ACTIVITY;
+
+    if (sim->regs[ADXL343_REG_POWER_CTL] & ADXL343_POWER_LINK) {
+        sim->linked_inactive = false;
+        sim->activity_armed = false;
+        arm_inactivity(sim, mg);
+    }
+    if (auto_sleep(sim) && !(sim->regs[ADXL343_REG_POWER_CTL] & ADXL343_POWER_SLEEP)) {
+        set_asleep(sim, false);
+    }
+}
+
+static void detect_inactivity(adxl343_sim_t *sim, const double mg[3]) {
+    uint8_t ctl = sim->regs[ADXL343_REG_ACT_INACT_CTL];
+    double threshold = sim->regs[ADXL343_REG_THRESH_INACT] * MG_PER_THRESH;
+    bool quiet = true;
+
+    if (!sim->inactivity_armed) {
+        arm_inactivity(sim, mg);
+    }
+    for (int i = 0; i < 3; i++) {
+        if (!(ctl & inact_bits[i])) {
+            continue;
+        }
+        double v = (ctl & ADXL343_INACT_AC) ? mg[i] - sim->inactivity_ref[i] : mg[i];
+        if (fabs(v) > threshold) {
+            quiet = false;
+        }
+    }
+    if (!quiet) {
+        // Motion restarts the timer and, ac coupled, moves the reference
+        arm_inactivity(sim, mg);
+        return;
+    }
+
+    sim->inactive_ns += period_ns(sim);
+    if (sim->inactivity_fired || sim->inactive_ns < sim->regs[ADXL343_REG_TIME_INACT] * 1000000000ull) {
+        return;
+    }
+    sim->inactivity_fired = true;
+    sim->regs[ADXL343_REG_INT_SOURCE] |= ADXL343_INT_INACTIVITY;
+
+    if (sim->regs[ADXL343_REG_POWER_CTL] & ADXL343_POWER_LINK) {
+        sim->linked_inactive = true;
+        sim->inactivity_armed = false;
+        arm_activity(sim, mg);
+    }
+    if (auto_sleep(sim)) {
+        set_asleep(sim, true);
+    }
+}
+
+// In link mode activity is only looked for after inactivity and the other
+// way round; otherwise both detectors run whenever enabled.
+static void detect_motion(adxl343_sim_t *sim, const double mg[3]) {
+    uint8_t enable = sim->regs[ADXL343_REG_INT_ENABLE];
+    bool link = (sim->regs[ADXL343_REG_POWER_CTL] & ADXL343_POWER_LINK) != 0;
+    bool want_act = (enable & ADXL343_INT_ACTIVITY) && (!link || sim->linked_inactive);
+    bool want_inact = (enable & ADXL343_INT_INACTIVITY) && (!link || !sim->linked_inactive);
+
+    if (want_act) {
+        detect_activity(sim, mg);
+    } else if (!link) {
+        sim->activity_armed = false;
+    }
+    if (want_inact) {
+        detect_inactivity(sim, mg);
+    } else if (!link) {
+        sim->inactivity_armed = false;
+    }
+}
+
+enum {
+    TAP_IDLE,
+    TAP_ABOVE,     // over THRESH_TAP, timing against DUR
+    TAP_WAIT,      // too long or suppressed, waiting to drop below
+    TAP_LATENT,    // after a first tap, before the window opens
+    TAP_WINDOW,    // waiting for a second tap
+};
+
+// Tap status bits of the enabled axes over THRESH_TAP
+static uint8_t tap_hits(const adxl343_sim_t *sim, const double mg[3]) {
+    static const uint8_t axis_bits[3] = {ADXL343_TAP_X, ADXL343_TAP_Y, ADXL343_TAP_Z};
+    static const uint8_t status_bits[3] = {ADXL343_STATUS_TAP_X, ADXL343_STATUS_TAP_Y, ADXL343_STATUS_TAP_Z};
+    double threshold = sim->regs[ADXL343_REG_THRESH_TAP] * MG_PER_THRESH;
+    uint8_t hits = 0;
+
+    for (int i = 0; i < 3; i++) {
+        if ((sim->regs[ADXL343_REG_TAP_AXES] & axis_bits[i]) && fabs(mg[i]) > threshold) {
+            hits |= status_bits[i];
+        }
+    }
+    return hits;
+}
+
+// A tap is a stretch over THRESH_TAP no longer than DUR, detected when the
+// acceleration drops back. With DOUBLE_TAP enabled and LATENT and WINDOW
+// set, a second tap starting once LATENT has passed and within WINDOW
+// after that makes a double tap; with TAP_AXES.SUPPRESS, acceleration over
+// the threshold during LATENT cancels it. ACT_TAP_STATUS reports the axes
+// that started the last tap.
+static void detect_tap(adxl343_sim_t *sim, const double mg[3]) {
+    uint8_t enable = sim->regs[ADXL343_REG_INT_ENABLE];
+    uint64_t latent_ns = sim->regs[ADXL343_REG_LATENT] * NS_PER_LATENT;
+    uint64_t window_ns = sim->regs[ADXL343_REG_WINDOW] * NS_PER_WINDOW;
+
+    if (!(enable & (ADXL343_INT_SINGLE_TAP | ADXL343_INT_DOUBLE_TAP))) {
+        sim->tap_state = TAP_IDLE;
+        return;
+    }
+    uint8_t hits = tap_hits(sim, mg);
+
+    if (sim->tap_state == TAP_LATENT) {
+        if (hits && (sim->regs[ADXL343_REG_TAP_AXES] & ADXL343_TAP_SUPPRESS)) {
+            sim->tap_state = TAP_WAIT;
+            return;
+        }
+        if (sim->now_ns - sim->tap_start_ns < latent_ns) {
+            return;
+        }
+        sim->tap_state = TAP_WINDOW;
+        sim->tap_start_ns += latent_ns;
+    }
+    if (sim->tap_state == TAP_WINDOW && sim->now_ns - sim->tap_start_ns > window_ns) {
+        sim->tap_state = TAP_IDLE;
+    }
+
+    switch (sim->tap_state) {
+    case TAP_IDLE:
+    case TAP_WINDOW:
+        if (hits) {
+            sim->tap_second = sim->tap_state == TAP_WINDOW;
+            sim->tap_state = TAP_ABOVE;
+            sim->tap_start_ns = sim->now_ns;
+            sim->tap_axes = hits;
+        }
+        return;
+    case TAP_WAIT:
+        if (!hits) {
+            sim->tap_state = TAP_IDLE;
+        }
+        return;
+    default:
+        break;
+    }
+
+    // TAP_ABOVE
+    if (sim->now_ns - sim->tap_start_ns > sim->regs[ADXL343_REG_DUR] * NS_PER_DUR) {
+        sim->tap_state = hits ? TAP_WAIT : TAP_IDLE;
+        return;
+    }
+    if (hits) {
+        return;
+    }
+
+    uint8_t *status = &sim->regs[ADXL343_REG_ACT_TAP_STATUS];
+    *status = (uint8_t)((*status & ~(ADXL343_STATUS_TAP_X | ADXL343_STATUS_TAP_Y | ADXL343_STATUS_TAP_Z)) |
+                        sim->tap_axes);
+    if (sim->tap_second) {
+        sim->regs[ADXL343_REG_INT_SOURCE] |= enable & ADXL343_INT_DOUBLE_TAP;
+        sim->tap_state = TAP_IDLE;
+        return;
+    }
+    sim->regs[ADXL343_REG_INT_SOURCE] |= enable & ADXL343_INT_SINGLE_TAP;
+    if ((enable & ADXL343_INT_DOUBLE_TAP) && latent_ns > 0 && window_ns > 0) {
+        sim->tap_state = TAP_LATENT;
+        sim->tap_start_ns = sim->now_ns;
+    } else {
+        sim->tap_state = TAP_IDLE;
+    }
+}
+
+// FREE_FALL once all three axes have stayed under THRESH_FF for TIME_FF;
+// it fires once per fall and re-arms when an axis rises again
+static void detect_free_fall(adxl343_sim_t *sim, const double mg[3]) {
+    double threshold = sim->regs[ADXL343_REG_THRESH_FF] * MG_PER_THRESH;
+
+    if (!(sim->regs[ADXL343_REG_INT_ENABLE] & ADXL343_INT_FREE_FALL) || fabs(mg[0]) >= threshold ||
+        fabs(mg[1]) >= threshold || fabs(mg[2]) >= threshold) {
+        sim->falling_ns = 0;
+        sim->fall_fired = false;
+        return;
+    }
+    sim->falling_ns += period_ns(sim);
+    if (!sim->fall_fired && sim->falling_ns >= sim->regs[ADXL343_REG_TIME_FF] * NS_PER_FREE_FALL) {
+        sim->fall_fired = true;
+        sim->regs[ADXL343_REG_INT_SOURCE] |= ADXL343_INT_FREE_FALL;
+    }
+}
+
+static void check_trigger(adxl343_sim_t *sim) {
+    uint8_t ctl = sim->regs[ADXL343_REG_FIFO_CTL];
+
+    if ((ctl & ADXL343_FIFO_MODE_MASK) != ADXL343_FIFO_TRIGGER || sim->triggered) {
+        return;
+    }
+    if (!adxl343_sim_int_pin(sim, (ctl & ADXL343_FIFO_TRIGGER_INT2) ? 2 : 1) ||
+        !(sim->regs[ADXL343_REG_INT_SOURCE] & EVENT_BITS)) {
+        return;
+    }
+
+    // Keep the last `samples` entries before the trigger, then fill up
+    uint8_t keep = ctl & ADXL343_FIFO_SAMPLES_MASK;
+    while (sim->fifo_count > keep) {
+        fifo_pop(sim);
+    }
+    sim->triggered = true;
+}
+
+// Roughly normal with unit variance: the sum of twelve uniform variates
+static double gaussian(adxl343_sim_t *sim) {
+    double sum = 0.0;
+    for (int i = 0; i < 12; i++) {
+        // xorshift32
+        uint32_t x = sim->noise_state;
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        sim->noise_state = x;
+        sum += (double)x / 4294967296.0;
+    }
+    return sum - 6.0;
+}
+
+static void produce_sample(adxl343_sim_t *sim, double t) {
+    double mg[3] = {0.0, 0.0, 0.0};
+
+    if (sim->source != NULL) {
+        sim->source(sim->source_ctx, t, mg);
+    }
+    for (int i = 0; i < 3; i++) {
+        if (sim->noise_mg > 0.0) {
+            mg[i] += sim->noise_mg * gaussian(sim);
+        }
+        mg[i] += (int8_t)sim->regs[ADXL343_REG_OFSX + i] * MG_PER_OFFSET;
+        if (sim->regs[ADXL343_REG_DATA_FORMAT] & ADXL343_FORMAT_SELF_TEST) {
+            mg[i] += sim->self_test_mg[i];
+        }
+    }
+
+    adxl343_sample_t s = {
+        .x = to_lsb(sim, mg[0]),
+        .y = to_lsb(sim, mg[1]),
+        .z = to_lsb(sim, mg[2]),
+    };
+    sim->latest = s;
+    sim->regs[ADXL343_REG_INT_SOURCE] |= ADXL343_INT_DATA_READY;
+    fifo_push(sim, &s);
+    sim->samples++;
+
+    detect_motion(sim, mg);
+    detect_tap(sim, mg);
+    detect_free_fall(sim, mg);
+    update_levels(sim);
+    check_trigger(sim);
+}
+
+void adxl343_sim_init(adxl343_sim_t *sim, uint8_t address) {
+    memset(sim, 0, sizeof(*sim));
+    sim->address = address;
+    sim->regs[ADXL343_REG_DEVID] = ADXL343_DEVICE_ID;
+    sim->regs[ADXL343_REG_BW_RATE] = ADXL343_RATE_100HZ;
+    sim->regs[ADXL343_REG_INT_SOURCE] = ADXL343_INT_DATA_READY;
+
+    // Mid-range of the datasheet self-test output change
+    sim->self_test_mg[0] = 1000.0;
+    sim->self_test_mg[1] = -1000.0;
+    sim->self_test_mg[2] = 1500.0;
+    sim->noise_state = 0x2545F491u;
+}
+
+void adxl343_sim_pulses(void *ctx, double t, double mg[3]) {
+    const adxl343_sim_pulses_t *p = (const adxl343_sim_pulses_t *)ctx;
+
+    for (int i = 0; i < 3; i++) {
+        mg[i] = p->base_mg[i];
+    }
+    for (size_t n = 0; n < p->count; n++) {
+        double dt = t - p->pulses[n].t;
+        if (dt < 0.0 || dt >= p->pulses[n].width_s) {
+            continue;
+        }
+        double shape = sin(M_PI * dt / p->pulses[n].width_s);
+        for (int i = 0; i < 3; i++) {
+            mg[i] += p->pulses[n].mg[i] * shape;
+        }
+    }
+}
+
+void adxl343_sim_drop(void *ctx, double t, double mg[3]) {
+    const adxl343_sim_drop_t *d = (const adxl343_sim_drop_t *)ctx;
+    double dt = t - d->release_s - d->fall_s;
+
+    for (int i = 0; i < 3; i++) {
+        if (t >= d->release_s && dt < 0.0) {
+            mg[i] = 0.0;
+        } else if (dt >= 0.0 && dt < d->impact_s) {
+            mg[i] = d->rest_mg[i] + d->impact_mg[i] * sin(M_PI * dt / d->impact_s);
+        } else {
+            mg[i] = d->rest_mg[i];
+        }
+    }
+}
+
+void adxl343_sim_set_source(adxl343_sim_t *sim, adxl343_sim_source_t source, void *ctx) {
+    sim->source = source;
+    sim->source_ctx = ctx;
+}
+
+void adxl343_sim_advance_ns(adxl343_sim_t *sim, uint64_t ns) {
+    uint64_t end = sim->now_ns + ns;
+
+    while (measuring(sim) && sim->next_sample_ns <= end) {
+        sim->now_ns = sim->next_sample_ns;
+        produce_sample(sim, (double)sim->now_ns / NS_PER_S);
+        sim->next_sample_ns += period_ns(sim);
+    }
+    sim->now_ns = end;
+}
+
+void adxl343_sim_advance_us(adxl343_sim_t *sim, uint64_t us) {
+    adxl343_sim_advance_ns(sim, us * 1000u);
+}
+
+bool adxl343_sim_int_pin(const adxl343_sim_t *sim, int pin) {
+    uint8_t active = sim->regs[ADXL343_REG_INT_SOURCE] & sim->regs[ADXL343_REG_INT_ENABLE];
+    uint8_t map = sim->regs[ADXL343_REG_INT_MAP];
+    bool level = (pin == 2 ? (active & map) : (active & ~map)) != 0;
+
+    return (sim->regs[ADXL343_REG_DATA_FORMAT] & ADXL343_FORMAT_INT_INVERT) ? !level : level;
+}
+
+double adxl343_sim_odr_hz(const adxl343_sim_t *sim) {
+    double hz;
+    if (sim->asleep) {
+        hz = 8.0 / (double)(1 << (sim->regs[ADXL343_REG_POWER_CTL] & ADXL343_POWER_WAKEUP_MASK));
+    } else {
+        hz = adxl343_rate_hz((adxl343_rate_t)(sim->regs[ADXL343_REG_BW_RATE] & ADXL343_BW_RATE_MASK));
+    }
+    return hz * (1.0 + sim->clock_ppm * 1e-6);
+}
+
+static uint8_t read_register(adxl343_sim_t *sim, uint8_t reg) {
+    const adxl343_sample_t *s = output(sim);
+
+    switch (reg) {
+    case ADXL343_REG_DATAX0: return (uint8_t)(s->x & 0xFF);
+    case ADXL343_REG_DATAX1: return (uint8_t)((uint16_t)s->x >> 8);
+    case ADXL343_REG_DATAY0: return (uint8_t)(s->y & 0xFF);
+    case ADXL343_REG_DATAY1: return (uint8_t)((uint16_t)s->y >> 8);
+    case ADXL343_REG_DATAZ0: return (uint8_t)(s->z & 0xFF);
+    case ADXL343_REG_DATAZ1: return (uint8_t)((uint16_t)s->z >> 8);
+    case ADXL343_REG_FIFO_STATUS:
+        return (uint8_t)(sim->fifo_count | (sim->triggered ? ADXL343_FIFO_TRIG : 0));
+    default:
+        return reg < sizeof(sim->regs) ? sim->regs[reg] : 0;
+    }
+}
+
+static void sim_read(adxl343_sim_t *sim, uint8_t reg, uint8_t *dst, size_t len) {
+    bool data = false;
+    bool source = false;
+
+    for (size_t i = 0; i < len; i++) {
+        uint8_t r = (uint8_t)(reg + i);
+        dst[i] = read_register(sim, r);
+        data |= r == ADXL343_REG_DATAZ1;
+        source |= r == ADXL343_REG_INT_SOURCE;
+    }
+
+    if (source) {
+        sim->regs[ADXL343_REG_INT_SOURCE] &= (uint8_t)~(EVENT_BITS | ADXL343_INT_OVERRUN);
+    }
+    if (data) {
+        if (fifo_mode(sim) == ADXL343_FIFO_BYPASS) {
+            sim->regs[ADXL343_REG_INT_SOURCE] &= (uint8_t)~ADXL343_INT_DATA_READY;
+        } else {
+            fifo_pop(sim);
+        }
+        update_levels(sim);
+    }
+}
+
+static void sim_write(adxl343_sim_t *sim, uint8_t reg, const uint8_t *src, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        uint8_t r = (uint8_t)(reg + i);
+        uint8_t old = sim->regs[r];
+
+        switch (r) {
+        case ADXL343_REG_DEVID:
+        case ADXL343_REG_ACT_TAP_STATUS:
+        case ADXL343_REG_INT_SOURCE:
+        case ADXL343_REG_FIFO_STATUS:
+            continue;
+        default:
+            if (r >= ADXL343_REG_DATAX0 && r <= ADXL343_REG_DATAZ1) {
+                continue;
+            }
+            break;
+        }
+        sim->regs[r] = src[i];
+
+        if (r == ADXL343_REG_BW_RATE && measuring(sim) && sim->next_sample_ns > sim->now_ns + period_ns(sim)) {
+            // A faster rate takes over from the next of its own periods
+            sim->next_sample_ns = sim->now_ns + period_ns(sim);
+        }
+        if (r == ADXL343_REG_FIFO_CTL && (src[i] & ADXL343_FIFO_MODE_MASK) == ADXL343_FIFO_BYPASS) {
+            fifo_clear(sim);
+        }
+        if (r == ADXL343_REG_POWER_CTL) {
+            bool was_measuring = (old & ADXL343_POWER_MEASURE) != 0;
+            bool measure = (src[i] & ADXL343_POWER_MEASURE) != 0;
+
+            if (!measure) {
+                set_asleep(sim, false);
+            } else if (!was_measuring) {
+                set_asleep(sim, (src[i] & ADXL343_POWER_SLEEP) != 0);
+                sim->next_sample_ns = sim->now_ns + period_ns(sim);
+                sim->linked_inactive = false;
+                sim->activity_armed = false;
+                sim->inactivity_armed = false;
+                sim->tap_state = TAP_IDLE;
+            } else if (src[i] & ADXL343_POWER_SLEEP) {
+                set_asleep(sim, true);
+            }
+        }
+    }
+    update_levels(sim);
+}
+
+static adxl343_sim_t *route(adxl343_sim_bus_t *bus, uint8_t addr) {
+    for (size_t i = 0; i < bus->count; i++) {
+        if (bus->devices[i]->address == addr) {
+            return bus->devices[i];
+        }
+    }
+    return NULL;
+}
+
+static void account(adxl343_sim_bus_t *bus, size_t bytes) {
+    bus->transactions++;
+    bus->bytes += bytes;
+    if (bus->clock_hz > 0.0) {
+        uint64_t ns = (uint64_t)llround(((double)bytes * 9.0 + 3.0) * NS_PER_S / bus->clock_hz);
+        for (size_t i = 0; i < bus->count; i++) {
+            adxl343_sim_advance_ns(bus->devices[i], ns);
+        }
+    }
+}
+
+static int bus_read(void *ctx, uint8_t addr, uint8_t reg, uint8_t *dst, size_t len) {
+    adxl343_sim_bus_t *bus = (adxl343_sim_bus_t *)ctx;
+    adxl343_sim_t *sim = route(bus, addr);
+
+    if (sim == NULL) {
+        return -1;
+    }
+    account(bus, 3 + len);
+    sim_read(sim, reg, dst, len);
+    return 0;
+}
+
+static int bus_write(void *ctx, uint8_t addr, uint8_t reg, const uint8_t *src, size_t len) {
+    adxl343_sim_bus_t *bus = (adxl343_sim_bus_t *)ctx;
+    adxl343_sim_t *sim = route(bus, addr);
+
+    if (sim == NULL) {
+        return -1;
+    }
+    account(bus, 2 + len);
+    sim_write(sim, reg, src, len);
+    return 0;
+}
+
+void adxl343_sim_bus_init(adxl343_sim_bus_t *bus) {
+    memset(bus, 0, sizeof(*bus));
+    bus->bus.read = bus_read;
+    bus->bus.write = bus_write;
+    bus->bus.delay_us = NULL;
+    bus->bus.ctx = bus;
+}
+
+void adxl343_sim_bus_attach(adxl343_sim_bus_t *bus, adxl343_sim_t *sim) {
+    if (bus->count < ADXL343_SIM_MAX_DEVICES) {
+        bus->devices[bus->count++] = sim;
+    }
+}
+
+double adxl343_sim_bus_time_s(const adxl343_sim_bus_t *bus, double clock_hz) {
+    return ((double)bus->bytes * 9.0 + (double)bus->transactions * 3.0) / clock_hz;
+}
@@ -0,0 +1,139 @@
+#ifndef ADXL343_SIM_H
+#define ADXL343_SIM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ADXL343.h"
+
+// Register level ADXL343 model for host tests.
+//
+// The model keeps a virtual clock and produces one sample per ODR period
+// while POWER_CTL.MEASURE is set, taking the acceleration in mg from a
+// caller supplied source. Samples go through the offset registers and the
+// DATA_FORMAT range, resolution and justification into the data registers
+// and the 32 entry FIFO, which implements bypass, FIFO, stream and trigger
+// modes. DATA_READY, WATERMARK, OVERRUN, ACTIVITY and INACTIVITY (dc or ac
+// coupled, optionally linked) are modelled along with INT_ENABLE / INT_MAP
+// routing to the two interrupt pins, as are SINGLE_TAP and DOUBLE_TAP
+// following THRESH_TAP, DUR, LATENT, WINDOW and TAP_AXES at the sample
+// rate, and FREE_FALL following THRESH_FF and TIME_FF. A change to a
+// faster BW_RATE takes effect within one period of the new rate.
+//
+// Sleep follows POWER_CTL: while asleep, either forced by SLEEP or entered
+// through AUTO_SLEEP on inactivity in link mode, samples come at the wakeup
+// rate and ACT_TAP_STATUS.ASLEEP is set. Activity ends automatic sleep.
+// Clearing SLEEP or AUTO_SLEEP while measuring does not wake the model; as
+// the datasheet warns, it has to pass through standby.
+//
+// Setting DATA_FORMAT.SELF_TEST adds `self_test_mg` to the acceleration;
+// a faulty part can be modelled by changing it. `noise_mg` adds white
+// noise of that rms to every axis, from a fixed seed so that runs repeat.
+// `clock_ppm` skews the internal oscillator so that several models on one
+// virtual clock drift apart the way real parts do.
+
+#define ADXL343_SIM_MAX_DEVICES 4
+
+// Acceleration at time `t` seconds, in mg per axis.
+typedef void (*adxl343_sim_source_t)(void *ctx, double t, double mg[3]);
+
+// Half-sine pulses, e.g. taps, on a constant acceleration: the source
+// adxl343_sim_pulses() with an adxl343_sim_pulses_t context.
+typedef struct {
+    double t;               // start, seconds
+    double width_s;
+    double mg[3];           // peak
+} adxl343_sim_pulse_t;
+
+typedef struct {
+    double base_mg[3];
+    const adxl343_sim_pulse_t *pulses;
+    size_t count;
+} adxl343_sim_pulses_t;
+
+void adxl343_sim_pulses(void *ctx, double t, double mg[3]);
+
+// A drop: at rest until `release_s`, 0 g for `fall_s`, then a half-sine
+// impact of `impact_s` on top of the rest acceleration. The source
+// adxl343_sim_drop() with an adxl343_sim_drop_t context.
+typedef struct {
+    double rest_mg[3];
+    double release_s;
+    double fall_s;
+    double impact_mg[3];    // peak
+    double impact_s;
+} adxl343_sim_drop_t;
+
+void adxl343_sim_drop(void *ctx, double t, double mg[3]);
+
+typedef struct {
+    uint8_t address;
+    uint8_t regs[64];
+
+    adxl343_sample_t fifo[ADXL343_FIFO_DEPTH];
+    uint8_t fifo_head;
+    uint8_t fifo_count;
+    bool triggered;
+    adxl343_sample_t latest;
+
+    bool activity_armed;
+    double activity_ref[3];
+    bool inactivity_armed;
+    bool inactivity_fired;
+    double inactivity_ref[3];
+    uint64_t inactive_ns;
+    bool linked_inactive;   // link mode: inactivity seen, waiting for activity
+    bool asleep;
+
+    uint8_t tap_state;
+    bool tap_second;        // timing the second tap of a double
+    uint64_t tap_start_ns;  // start of the current tap state
+    uint8_t tap_axes;       // status bits of the axes that started the tap
+    uint64_t falling_ns;    // all axes under THRESH_FF for this long
+    bool fall_fired;
+
+    uint64_t now_ns;
+    uint64_t next_sample_ns;
+    uint64_t samples;
+    double clock_ppm;       // oscillator error, positive runs fast
+    double self_test_mg[3]; // force added while DATA_FORMAT.SELF_TEST is set
+    double noise_mg;        // rms, per axis
+    uint32_t noise_state;
+
+    adxl343_sim_source_t source;
+    void *source_ctx;
+} adxl343_sim_t;
+
+// A bus shared by up to ADXL343_SIM_MAX_DEVICES models, routed by address.
+// `bus` is what gets handed to the driver.
+typedef struct {
+    adxl343_bus_t bus;
+    adxl343_sim_t *devices[ADXL343_SIM_MAX_DEVICES];
+    size_t count;
+    uint64_t transactions;
+    uint64_t bytes;          // on-wire bytes including address and register
+    double clock_hz;         // when set, transfers advance the devices' clocks
+} adxl343_sim_bus_t;
+
+void adxl343_sim_init(adxl343_sim_t *sim, uint8_t address);
+void adxl343_sim_set_source(adxl343_sim_t *sim, adxl343_sim_source_t source, void *ctx);
+
+// Run the virtual clock forward, producing any samples that fall due.
+void adxl343_sim_advance_ns(adxl343_sim_t *sim, uint64_t ns);
+void adxl343_sim_advance_us(adxl343_sim_t *sim, uint64_t us);
+
+// Level of INT1 (pin 1) or INT2 (pin 2), honouring INT_INVERT.
+bool adxl343_sim_int_pin(const adxl343_sim_t *sim, int pin);
+
+// Current output data rate in Hz, including the oscillator error.
+double adxl343_sim_odr_hz(const adxl343_sim_t *sim);
+
+void adxl343_sim_bus_init(adxl343_sim_bus_t *bus);
+void adxl343_sim_bus_attach(adxl343_sim_bus_t *bus, adxl343_sim_t *sim);
+
+// Time spent on the wire so far at `clock_hz`, counting nine clocks per byte
+// plus start and stop conditions.
+double adxl343_sim_bus_time_s(const adxl343_sim_bus_t *bus, double clock_hz);
+
+#endif // ADXL343_SIM_H
@@ -0,0 +1,90 @@
+// Cost of the fixed-point calibration stage on random 13-bit samples,
+// against the same correction in double precision. Reports time and, on
+// x86, time stamp counter cycles per sample.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAVE_TSC 1
+#endif
+
+#include "ADXL343_cal.h"
+
+#define SAMPLES 4096
+#define REPEATS 2000
+
+static adxl343_sample_t samples[SAMPLES];
+static adxl343_sample_t work[SAMPLES];
+static double reference[SAMPLES][3];
+
+static const adxl343_cal_t cal = {
+    .m = {{16875, 197, -131}, {197, 15974, 246}, {-131, 246, 16679}},
+    .offset = {10, -6, 15},
+};
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static void apply_double(void) {
+    const double one = 1 << ADXL343_CAL_FRAC_BITS;
+    for (size_t i = 0; i < SAMPLES; i++) {
+        double d[3] = {samples[i].x - cal.offset[0], samples[i].y - cal.offset[1], samples[i].z - cal.offset[2]};
+        for (int r = 0; r < 3; r++) {
+            reference[i][r] = (cal.m[r][0] * d[0] + cal.m[r][1] * d[1] + cal.m[r][2] * d[2]) / one;
+        }
+    }
+}
+
+static void measure(const char *name, bool fixed) {
+    double start = now_s();
+#ifdef HAVE_TSC
+    uint64_t tsc = __rdtsc();
+#endif
+    for (int r = 0; r < REPEATS; r++) {
+        if (fixed) {
+            // In place, so the copy of the input is part of the cost
+            memcpy(work, samples, sizeof(work));
+            adxl343_cal_apply(&cal, work, SAMPLES);
+        } else {
+            apply_double();
+        }
+    }
+    double per = (now_s() - start) * 1e9 / ((double)SAMPLES * REPEATS);
+#ifdef HAVE_TSC
+    double cycles = (double)(__rdtsc() - tsc) / ((double)SAMPLES * REPEATS);
+    printf("%-7s %6.2f ns/sample  %6.2f cycles/sample\n", name, per, cycles);
+#else
+    printf("%-7s %6.2f ns/sample\n", name, per);
+#endif
+}
+
+int main(void) {
+    srand(1);
+    for (size_t i = 0; i < SAMPLES; i++) {
+        samples[i].x = (int16_t)(rand() % 8192 - 4096);
+        samples[i].y = (int16_t)(rand() % 8192 - 4096);
+        samples[i].z = (int16_t)(rand() % 8192 - 4096);
+    }
+
+    measure("q14", true);
+    measure("double", false);
+
+    // Sanity: within rounding of the double result
+    for (size_t i = 0; i < SAMPLES; i++) {
+        const int16_t got[3] = {work[i].x, work[i].y, work[i].z};
+        for (int r = 0; r < 3; r++) {
+            double diff = got[r] - reference[i][r];
+            if (diff > 0.5001 || diff < -0.5001) {
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,61 @@
+// CPU cost of the envelope pipeline: time to demodulate a synthetic
+// faulty bearing signal, reported per input sample and as the share of one
+// core needed to keep up at each ODR. Both are figures for the host running
+// the benchmark, not for the Cortex-M0+.
+
+#include <stdio.h>
+#include <time.h>
+
+#include "ADXL343_envelope.h"
+#include "fault_signal.h"
+
+#define ODR_HZ 3200.0
+#define BLOCK 32
+#define BLOCKS 4000
+
+static adxl343_sample_t input[BLOCK * BLOCKS];
+static int16_t output[BLOCK];
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+int main(void) {
+    static const float rates[] = {400.0f, 800.0f, 1600.0f, 3200.0f};
+    adxl343_envelope_t env;
+    fault_signal_t sig;
+    adxl343_envelope_config_t config = {
+        .odr_hz = (float)ODR_HZ,
+        .band_low_hz = 700.0f,
+        .band_high_hz = 1300.0f,
+        .lowpass_hz = 300.0f,
+        .decimation = 4,
+        .axis = 2,
+    };
+
+    fault_signal_init(&sig, ODR_HZ, 87.3);
+    fault_signal_fill(&sig, input, BLOCK * BLOCKS);
+    adxl343_envelope_init(&env, &config);
+
+    size_t produced = 0;
+    int repeats = 25;
+    double start = now_s();
+    for (int r = 0; r < repeats; r++) {
+        for (size_t b = 0; b < BLOCKS; b++) {
+            produced += adxl343_envelope_process(&env, &input[b * BLOCK], BLOCK, output, BLOCK);
+        }
+    }
+    double elapsed = now_s() - start;
+    double samples = (double)repeats * BLOCK * BLOCKS;
+    double ns_per_sample = elapsed * 1e9 / samples;
+
+    printf("envelope: %.0f samples in %.3f s, %zu envelope samples\n", samples, elapsed, produced);
+    printf("envelope: %.1f ns per input sample on the host\n", ns_per_sample);
+    for (size_t i = 0; i < sizeof(rates) / sizeof(rates[0]); i++) {
+        printf("envelope: %6.0f Hz ODR uses %.4f%% of one host core\n", rates[i], ns_per_sample * rates[i] * 1e-7);
+    }
+
+    return 0;
+}
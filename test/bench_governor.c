@@ -0,0 +1,123 @@
+// Day-long activity trace through the simulator, comparing a sensor left at
+// full rate with the activity adaptive governor. Reports samples processed,
+// I2C bus time and a modelled average current for sensor plus MCU.
+//
+// Current model, all assumptions:
+//   sensor  typical IDD vs ODR from the ADXL343 datasheet, normal power
+//   MCU     25 mA while the bus is busy, 1.5 mA asleep otherwise
+
+#include <math.h>
+#include <stdio.h>
+
+#include "ADXL343_governor.h"
+#include "adxl343_sim.h"
+
+#define DAY_S (24.0 * 3600.0)
+#define BURSTS 24
+#define BURST_S 180.0           // 24 x 3 min = 5% of the day active
+#define BUS_HZ 400000.0
+#define STEP_US 5000
+#define MCU_ACTIVE_MA 25.0
+#define MCU_SLEEP_MA 1.5
+
+typedef struct {
+    const char *name;
+    uint64_t samples;
+    double bus_s;
+    double sensor_mah;
+} result_t;
+
+static double sensor_ua(adxl343_rate_t rate) {
+    static const double table[16] = {
+        23, 23, 23, 23, 34, 40, 45, 50, 60, 90, 140, 140, 140, 140, 90, 140,
+    };
+    return table[rate & ADXL343_BW_RATE_MASK];
+}
+
+static bool moving(double t) {
+    double period = DAY_S / BURSTS;
+    return fmod(t, period) < BURST_S;
+}
+
+static uint32_t hash(uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdull;
+    x ^= x >> 33;
+    return (uint32_t)x;
+}
+
+static void source(void *ctx, double t, double mg[3]) {
+    (void)ctx;
+    uint32_t h = hash((uint64_t)(t * 1e6));
+    double noise = ((double)(h & 0xFFFF) / 65536.0 - 0.5) * 20.0;
+
+    mg[0] = noise;
+    mg[1] = moving(t) ? 400.0 * sin(2.0 * M_PI * 49.0 * t) : 0.0;
+    mg[2] = 1000.0 + (moving(t) ? 300.0 * sin(2.0 * M_PI * 98.0 * t) : 0.0) + noise;
+}
+
+static result_t run(const char *name, bool governed) {
+    adxl343_sim_t sim;
+    adxl343_sim_bus_t bus;
+    adxl343_governor_t gov;
+    adxl343_sample_t batch[32];
+    result_t result = {name, 0, 0.0, 0.0};
+    adxl343_governor_config_t config = {
+        .active_rate = ADXL343_RATE_800HZ,
+        .idle_rate = governed ? ADXL343_RATE_12_5HZ : ADXL343_RATE_800HZ,
+        .threshold_act = 4,
+        .threshold_inact = 2,
+        .time_inact = 5,
+        .axes = ADXL343_ACT_AC | ADXL343_ACT_X | ADXL343_ACT_Y | ADXL343_ACT_Z |
+                ADXL343_INACT_AC | ADXL343_INACT_X | ADXL343_INACT_Y | ADXL343_INACT_Z,
+        .watermark = 16,
+    };
+
+    adxl343_sim_init(&sim, ADXL343_ADDRESS);
+    adxl343_sim_set_source(&sim, source, NULL);
+    adxl343_sim_bus_init(&bus);
+    adxl343_sim_bus_attach(&bus, &sim);
+    adxl343_set_bus(&bus.bus, ADXL343_ADDRESS);
+    adxl343_init();
+    adxl343_governor_init(&gov, adxl343_default_device(), &config);
+
+    double ua_s = 0.0;
+    while ((double)sim.now_ns / 1e9 < DAY_S) {
+        adxl343_sim_advance_us(&sim, STEP_US);
+        ua_s += sensor_ua(gov.rate) * STEP_US * 1e-6;
+        while (adxl343_sim_int_pin(&sim, 1)) {
+            adxl343_rate_t rate;
+            int n = adxl343_governor_service(&gov, batch, 32, &rate);
+            if (n <= 0) {
+                break;
+            }
+            result.samples += (uint64_t)n;
+        }
+    }
+
+    result.bus_s = adxl343_sim_bus_time_s(&bus, BUS_HZ);
+    result.sensor_mah = ua_s / 3600.0 / 1000.0;
+    return result;
+}
+
+static void report(const result_t *r) {
+    double duty = r->bus_s / DAY_S;
+    double mcu_ma = MCU_SLEEP_MA + (MCU_ACTIVE_MA - MCU_SLEEP_MA) * duty;
+    double sensor_ma = r->sensor_mah / 24.0;
+
+    printf("%-10s %12llu samples  bus %8.1f s (%.3f%%)  sensor %6.1f uA  mcu %6.3f mA  total %6.3f mA\n",
+           r->name, (unsigned long long)r->samples, r->bus_s, duty * 100.0, sensor_ma * 1000.0, mcu_ma,
+           mcu_ma + sensor_ma);
+}
+
+int main(void) {
+    result_t fixed = run("fixed", false);
+    result_t governed = run("governor", true);
+
+    printf("24 h trace, %d bursts of %.0f s, 800 Hz active, 12.5 Hz idle, I2C at %.0f kHz\n", BURSTS, BURST_S,
+           BUS_HZ / 1000.0);
+    report(&fixed);
+    report(&governed);
+
+    return 0;
+}
@@ -0,0 +1,90 @@
+// Throughput of the packed sample kernels on random 10-bit samples.
+// Reports time and, on x86, time stamp counter cycles per sample, with the
+// bytes each format stores.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAVE_TSC 1
+#endif
+
+#include "ADXL343_pack.h"
+
+#define SAMPLES 4096
+#define REPEATS 2000
+
+static adxl343_sample_t samples[SAMPLES];
+static adxl343_sample_t unpacked[SAMPLES];
+static adxl343_packed10_t p10[SAMPLES];
+static adxl343_packed13_t p13[SAMPLES];
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+typedef enum {
+    PACK10,
+    UNPACK10,
+    PACK13,
+    UNPACK13,
+} kernel_t;
+
+static void run(kernel_t kernel) {
+    switch (kernel) {
+    case PACK10:
+        adxl343_pack10(samples, SAMPLES, p10);
+        break;
+    case UNPACK10:
+        adxl343_unpack10(p10, SAMPLES, unpacked);
+        break;
+    case PACK13:
+        adxl343_pack13(samples, SAMPLES, p13);
+        break;
+    case UNPACK13:
+        adxl343_unpack13(p13, SAMPLES, unpacked);
+        break;
+    }
+}
+
+static void measure(const char *name, kernel_t kernel, size_t bytes) {
+    run(kernel);
+    double start = now_s();
+#ifdef HAVE_TSC
+    uint64_t tsc = __rdtsc();
+#endif
+    for (int r = 0; r < REPEATS; r++) {
+        run(kernel);
+    }
+    double per = (now_s() - start) * 1e9 / ((double)SAMPLES * REPEATS);
+#ifdef HAVE_TSC
+    double cycles = (double)(__rdtsc() - tsc) / ((double)SAMPLES * REPEATS);
+    printf("%-10s %zu bytes/sample  %6.2f ns/sample  %6.2f cycles/sample  %7.1f Msamples/s\n", name, bytes, per,
+           cycles, 1e3 / per);
+#else
+    printf("%-10s %zu bytes/sample  %6.2f ns/sample  %7.1f Msamples/s\n", name, bytes, per, 1e3 / per);
+#endif
+}
+
+int main(void) {
+    srand(1);
+    for (size_t i = 0; i < SAMPLES; i++) {
+        samples[i].x = (int16_t)(rand() % 1024 - 512);
+        samples[i].y = (int16_t)(rand() % 1024 - 512);
+        samples[i].z = (int16_t)(rand() % 1024 - 512);
+    }
+
+    printf("int16      %zu bytes/sample\n", sizeof(adxl343_sample_t));
+    measure("pack10", PACK10, sizeof(adxl343_packed10_t));
+    measure("unpack10", UNPACK10, sizeof(adxl343_packed10_t));
+    measure("pack13", PACK13, sizeof(adxl343_packed13_t));
+    measure("unpack13", UNPACK13, sizeof(adxl343_packed13_t));
+
+    // Sanity: the last unpack reproduces the input
+    return memcmp(unpacked, samples, sizeof(samples)) == 0 ? 0 : 1;
+}
@@ -0,0 +1,177 @@
+// Aggregate output data rate for one to four sensors, all on one I2C bus or
+// split across the RP2040's two controllers serviced concurrently. For each
+// layout the highest BW_RATE that runs for a second without a full FIFO,
+// a FIFO overrun or a lost sample is reported, with every stream pushed
+// through the timestamp merge and checked for order.
+//
+// Four sensors on one bus need more addresses than the ALT ADDRESS pin
+// gives, e.g. through an address translator; the simulator simply uses
+// distinct addresses. Wire time is modelled at 400 kHz.
+
+#include <math.h>
+#include <stdio.h>
+
+#include "ADXL343_group.h"
+#include "ADXL343_merge.h"
+#include "adxl343_sim.h"
+
+#define BUS_HZ 400000.0
+#define RUN_US 1000000
+#define STEP_US 2000
+#define MAX_SENSORS 4
+
+static const uint8_t addresses[MAX_SENSORS] = {ADXL343_ADDRESS, ADXL343_ADDRESS_ALT, 0x54, 0x1E};
+
+typedef struct {
+    adxl343_merge_t *merge;
+    size_t first;
+    const adxl343_sim_t *clock;
+} feed_t;
+
+static void source(void *ctx, double t, double mg[3]) {
+    (void)ctx;
+    mg[0] = 200.0 * sin(2.0 * M_PI * 37.0 * t);
+    mg[1] = 0.0;
+    mg[2] = 1000.0;
+}
+
+static void feed(void *ctx, size_t index, const adxl343_sample_t *samples, size_t count) {
+    const feed_t *f = ctx;
+    adxl343_merge_push(f->merge, f->first + index, samples, count, f->clock->now_ns);
+}
+
+static void advance_to(adxl343_sim_t *sims, int sensors, uint64_t ns) {
+    for (int i = 0; i < sensors; i++) {
+        if (sims[i].now_ns < ns) {
+            adxl343_sim_advance_ns(&sims[i], ns - sims[i].now_ns);
+        }
+    }
+}
+
+// Returns true if `sensors` sensors at `rate` keep up on `buses` buses;
+// `busy` receives the busiest bus's utilisation.
+static bool run(int sensors, int buses, adxl343_rate_t rate, double *busy) {
+    static adxl343_sim_t sims[MAX_SENSORS];
+    static adxl343_merge_t merge;
+    adxl343_sim_bus_t bus[2];
+    adxl343_dev_t devs[MAX_SENSORS];
+    adxl343_group_t groups[2];
+    feed_t feeds[2];
+
+    adxl343_merge_init(&merge);
+    for (int b = 0; b < buses; b++) {
+        adxl343_sim_bus_init(&bus[b]);
+        bus[b].clock_hz = BUS_HZ;
+        adxl343_group_init(&groups[b]);
+    }
+
+    // Sensors alternate between the buses; merge channels follow group order
+    for (int b = 0; b < buses; b++) {
+        feeds[b] = (feed_t){&merge, merge.count, NULL};
+        for (int i = b; i < sensors; i += buses) {
+            adxl343_sim_init(&sims[i], addresses[i]);
+            adxl343_sim_set_source(&sims[i], source, NULL);
+            adxl343_sim_bus_attach(&bus[b], &sims[i]);
+            adxl343_dev_set_bus(&devs[i], &bus[b].bus, addresses[i]);
+            adxl343_dev_init(&devs[i]);
+            adxl343_dev_write_reg(&devs[i], ADXL343_REG_POWER_CTL, 0);
+            adxl343_dev_write_reg(&devs[i], ADXL343_REG_BW_RATE, rate);
+            adxl343_dev_write_reg(&devs[i], ADXL343_REG_FIFO_CTL, ADXL343_FIFO_STREAM | 16);
+            adxl343_dev_write_reg(&devs[i], ADXL343_REG_POWER_CTL, ADXL343_POWER_MEASURE);
+            adxl343_group_add(&groups[b], &devs[i]);
+            adxl343_merge_add(&merge, adxl343_rate_hz(rate));
+            if (feeds[b].clock == NULL) {
+                feeds[b].clock = &sims[i];
+            }
+        }
+    }
+
+    uint64_t start = 0;
+    for (int i = 0; i < sensors; i++) {
+        start = sims[i].now_ns > start ? sims[i].now_ns : start;
+    }
+    advance_to(sims, sensors, start);
+
+    uint64_t wire_start[2];
+    for (int b = 0; b < buses; b++) {
+        wire_start[b] = bus[b].bytes * 9 + bus[b].transactions * 3;
+    }
+
+    adxl343_stamped_t out[64];
+    uint64_t last_t = 0;
+    bool ordered = true;
+    uint64_t delivered = 0;
+    uint64_t wall = start;
+
+    while (wall < start + (uint64_t)RUN_US * 1000u) {
+        // Each bus's transfers only move the clocks of its own sensors, so
+        // two buses overlap while one bus serialises everything
+        wall += STEP_US * 1000u;
+        for (int b = 0; b < buses; b++) {
+            adxl343_group_service(&groups[b], feed, &feeds[b]);
+        }
+        for (int i = 0; i < sensors; i++) {
+            wall = sims[i].now_ns > wall ? sims[i].now_ns : wall;
+        }
+        advance_to(sims, sensors, wall);
+
+        size_t n;
+        while ((n = adxl343_merge_pop(&merge, out, 64)) > 0) {
+            for (size_t i = 0; i < n; i++) {
+                ordered = ordered && out[i].t_ns >= last_t;
+                last_t = out[i].t_ns;
+            }
+            delivered += n;
+        }
+    }
+
+    bool ok = ordered;
+    uint64_t produced = 0;
+    for (int b = 0; b < buses; b++) {
+        for (size_t i = 0; i < groups[b].count; i++) {
+            ok = ok && groups[b].full[i] == 0;
+        }
+    }
+    for (size_t c = 0; c < merge.count; c++) {
+        ok = ok && merge.channels[c].dropped == 0;
+        delivered += merge.channels[c].count;
+    }
+    for (int i = 0; i < sensors; i++) {
+        ok = ok && !(sims[i].regs[ADXL343_REG_INT_SOURCE] & ADXL343_INT_OVERRUN);
+        produced += sims[i].samples - sims[i].fifo_count;
+    }
+    ok = ok && produced == delivered;
+
+    *busy = 0.0;
+    for (int b = 0; b < buses; b++) {
+        double clocks = (double)(bus[b].bytes * 9 + bus[b].transactions * 3 - wire_start[b]);
+        double utilisation = clocks / BUS_HZ / ((double)(wall - start) / 1e9);
+        *busy = utilisation > *busy ? utilisation : *busy;
+    }
+    return ok;
+}
+
+int main(void) {
+    printf("I2C at %.0f kHz, FIFO stream mode, serviced every %d ms\n", BUS_HZ / 1000.0, STEP_US / 1000);
+    printf("sensors  buses  max ODR/sensor  aggregate ODR  busiest bus\n");
+
+    for (int sensors = 1; sensors <= MAX_SENSORS; sensors++) {
+        for (int buses = 1; buses <= 2; buses++) {
+            if (buses > sensors) {
+                continue;
+            }
+            int rate;
+            double busy = 0.0;
+            for (rate = ADXL343_RATE_3200HZ; rate >= ADXL343_RATE_25HZ; rate--) {
+                if (run(sensors, buses, (adxl343_rate_t)rate, &busy)) {
+                    break;
+                }
+            }
+            float odr = adxl343_rate_hz((adxl343_rate_t)rate);
+            printf("%7d  %5d  %11.0f Hz  %10.0f Hz  %9.0f%%\n", sensors, buses, odr, odr * (float)sensors,
+                   busy * 100.0);
+        }
+    }
+
+    return 0;
+}
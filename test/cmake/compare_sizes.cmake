@@ -0,0 +1,43 @@
+# Compare the code size of <name>_macro and <name>_typed functions.
+#
+# Run with -DNM=<nm> -DBINARY=<executable>. Prints both sizes for every
+# pair found and fails if any typed accessor is larger than the masks and
+# shifts it replaces.
+
+execute_process(
+    COMMAND ${NM} -S ${BINARY}
+    OUTPUT_VARIABLE symbols
+    RESULT_VARIABLE result
+)
+if(NOT result EQUAL 0)
+    message(FATAL_ERROR "could not list the symbols of ${BINARY}")
+endif()
+
+string(REGEX MATCHALL "[0-9a-fA-F]+ [0-9a-fA-F]+ [Tt] [a-z]+_macro" macros "${symbols}")
+if(NOT macros)
+    message(FATAL_ERROR "no accessor pairs in ${BINARY}")
+endif()
+
+set(larger "")
+foreach(entry ${macros})
+    string(REGEX REPLACE "^[0-9a-fA-F]+ ([0-9a-fA-F]+) [Tt] ([a-z]+)_macro$" "\\1;\\2" parts "${entry}")
+    list(GET parts 0 macro_hex)
+    list(GET parts 1 name)
+
+    string(REGEX MATCH "[0-9a-fA-F]+ ([0-9a-fA-F]+) [Tt] ${name}_typed" typed "${symbols}")
+    if(NOT typed)
+        message(FATAL_ERROR "${name}_typed missing")
+    endif()
+    set(typed_hex ${CMAKE_MATCH_1})
+
+    math(EXPR macro_size "0x${macro_hex}")
+    math(EXPR typed_size "0x${typed_hex}")
+    message(STATUS "${name}: macro ${macro_size} bytes, typed ${typed_size} bytes")
+    if(typed_size GREATER macro_size)
+        list(APPEND larger ${name})
+    endif()
+endforeach()
+
+if(larger)
+    message(FATAL_ERROR "typed accessors larger than the macros: ${larger}")
+endif()
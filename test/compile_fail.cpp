@@ -0,0 +1,69 @@
+// Configurations that must not build. test/CMakeLists.txt compiles this
+// file once per case with COMPILE_FAIL_<case> defined and expects the
+// compiler to stop with the matching diagnostic.
+
+#include "ADXL343.hpp"
+#include "ADXL343_units.hpp"
+
+using namespace adxl343;
+using namespace adxl343::literals;
+
+#if defined(COMPILE_FAIL_I2C_3200HZ_100KHZ)
+using Config = ADXL343::Stream<ADXL343_RATE_3200HZ, 16, ADXL343::BusType::I2C, 100000>;
+#elif defined(COMPILE_FAIL_I2C_1600HZ_100KHZ)
+using Config = ADXL343::Stream<ADXL343_RATE_1600HZ, 16, ADXL343::BusType::I2C, 100000>;
+#elif defined(COMPILE_FAIL_SPI_3200HZ_100KHZ)
+using Config = ADXL343::Stream<ADXL343_RATE_3200HZ, 16, ADXL343::BusType::SPI, 100000>;
+#elif defined(COMPILE_FAIL_WATERMARK_HEADROOM)
+using Config = ADXL343::Stream<ADXL343_RATE_800HZ, 31, ADXL343::BusType::I2C, 400000>;
+#elif defined(COMPILE_FAIL_WATERMARK_ZERO)
+using Config = ADXL343::Stream<ADXL343_RATE_100HZ, 0, ADXL343::BusType::I2C, 100000>;
+#elif defined(COMPILE_FAIL_I2C_CLOCK)
+using Config = ADXL343::Stream<ADXL343_RATE_100HZ, 16, ADXL343::BusType::I2C, 1000000>;
+#elif defined(COMPILE_FAIL_SPI_CLOCK)
+using Config = ADXL343::Stream<ADXL343_RATE_100HZ, 16, ADXL343::BusType::SPI, 8000000>;
+#elif defined(COMPILE_FAIL_FOREIGN_FIELD)
+constexpr uint8_t value = Value<reg::DataFormat>().with<reg::FifoCtl::Samples>(16).raw;
+#elif defined(COMPILE_FAIL_READ_ONLY)
+constexpr uint8_t value = Value<reg::FifoStatus>().with<reg::FifoStatus::Entries>(1).raw;
+#elif defined(COMPILE_FAIL_OUT_OF_RANGE)
+constexpr uint8_t value = Value<reg::FifoCtl>().with<reg::FifoCtl::Samples>(32).raw;
+#elif defined(COMPILE_FAIL_BURST_GAP)
+constexpr auto value = burst(Value<reg::BwRate>(), Value<reg::IntEnable>());
+#elif defined(COMPILE_FAIL_THRESHOLD_RANGE)
+constexpr auto value = encode<reg::ThreshTap>(16_g);
+#elif defined(COMPILE_FAIL_THRESHOLD_NEGATIVE)
+constexpr auto value = encode<reg::ThreshAct>(-100_mg);
+#elif defined(COMPILE_FAIL_OFFSET_RANGE)
+constexpr auto value = encode<reg::Ofsx>(2100_mg);
+#elif defined(COMPILE_FAIL_DURATION_RANGE)
+constexpr auto value = encode<reg::Dur>(200_ms);
+#elif defined(COMPILE_FAIL_SECONDS_WRAP)
+constexpr auto value = encode<reg::TimeInact>(4295_s);
+#elif defined(COMPILE_FAIL_MS_TO_US_WRAP)
+constexpr auto value = encode<reg::Latent>(4294968_ms);
+#elif defined(COMPILE_FAIL_MS_WRAP)
+constexpr auto value = encode<reg::Latent>(4294967296_ms);
+#elif defined(COMPILE_FAIL_US_WRAP)
+constexpr auto value = encode<reg::Dur>(4294967296_us);
+#elif defined(COMPILE_FAIL_G_WRAP)
+constexpr auto value = encode<reg::ThreshTap>(4294968_g);
+#elif defined(COMPILE_FAIL_G_FRACTION_WRAP)
+constexpr auto value = encode<reg::ThreshTap>(4294968.0_g);
+#elif defined(COMPILE_FAIL_MG_WRAP)
+constexpr auto value = encode<reg::ThreshTap>(4294967296_mg);
+#elif defined(COMPILE_FAIL_WRONG_UNIT)
+constexpr auto value = encode<reg::ThreshTap>(10_ms);
+#elif defined(COMPILE_FAIL_ODR_UNKNOWN)
+constexpr auto value = rate(1000_hz);
+#else
+#error "no COMPILE_FAIL_ case selected"
+#endif
+
+#if defined(COMPILE_FAIL_I2C_3200HZ_100KHZ) || defined(COMPILE_FAIL_I2C_1600HZ_100KHZ) || \
+    defined(COMPILE_FAIL_SPI_3200HZ_100KHZ) || defined(COMPILE_FAIL_WATERMARK_HEADROOM) || \
+    defined(COMPILE_FAIL_WATERMARK_ZERO) || defined(COMPILE_FAIL_I2C_CLOCK) || defined(COMPILE_FAIL_SPI_CLOCK)
+const uint32_t load = Config::busLoadPercent;
+#else
+const void *use = &value;
+#endif
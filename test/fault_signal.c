@@ -0,0 +1,64 @@
+#include "fault_signal.h"
+
+#include <math.h>
+
+static double noise(fault_signal_t *sig) {
+    // Sum of uniforms, roughly Gaussian with unit variance
+    double sum = 0.0;
+    for (int i = 0; i < 4; i++) {
+        sig->seed = sig->seed * 1664525u + 1013904223u;
+        sum += (double)(sig->seed >> 8) / (double)(1u << 24) - 0.5;
+    }
+    return sum * sqrt(3.0);
+}
+
+void fault_signal_init(fault_signal_t *sig, double odr_hz, double fault_hz) {
+    sig->odr_hz = odr_hz;
+    sig->shaft_hz = 24.7;
+    sig->shaft_lsb = 150.0;
+    sig->fault_hz = fault_hz;
+    sig->impact_lsb = 400.0;
+    sig->resonance_hz = 1000.0;
+    sig->decay_s = 0.0015;
+    sig->noise_lsb = 8.0;
+    sig->seed = 1;
+    sig->index = 0;
+}
+
+void fault_signal_fill(fault_signal_t *sig, adxl343_sample_t *dst, size_t count) {
+    for (size_t i = 0; i < count; i++, sig->index++) {
+        double t = (double)sig->index / sig->odr_hz;
+        double v = 256.0 + sig->shaft_lsb * sin(2.0 * M_PI * sig->shaft_hz * t);
+
+        if (sig->fault_hz > 0.0) {
+            double since = fmod(t, 1.0 / sig->fault_hz);
+            v += sig->impact_lsb * exp(-since / sig->decay_s) * sin(2.0 * M_PI * sig->resonance_hz * since);
+        }
+        v += sig->noise_lsb * noise(sig);
+
+        dst[i].x = 0;
+        dst[i].y = 0;
+        dst[i].z = (int16_t)lround(v);
+    }
+}
+
+double fault_signal_tone(const int16_t *x, size_t count, double rate_hz, double freq_hz) {
+    double coeff = 2.0 * cos(2.0 * M_PI * freq_hz / rate_hz);
+    double s1 = 0.0;
+    double s2 = 0.0;
+    double mean = 0.0;
+
+    for (size_t i = 0; i < count; i++) {
+        mean += x[i];
+    }
+    mean /= (double)count;
+
+    for (size_t i = 0; i < count; i++) {
+        double s = (x[i] - mean) + coeff * s1 - s2;
+        s2 = s1;
+        s1 = s;
+    }
+
+    double power = s1 * s1 + s2 * s2 - coeff * s1 * s2;
+    return sqrt(power > 0.0 ? power : 0.0) / (double)count;
+}
@@ -0,0 +1,32 @@
+#ifndef FAULT_SIGNAL_H
+#define FAULT_SIGNAL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ADXL343.h"
+
+// Synthetic rolling element bearing signal on the Z axis, in raw LSBs at
+// 256 LSB/g: gravity, a shaft 1x tone, broadband noise and, when
+// `fault_hz` is non-zero, impacts at the defect rate each ringing a damped
+// structural resonance.
+typedef struct {
+    double odr_hz;
+    double shaft_hz;
+    double shaft_lsb;
+    double fault_hz;
+    double impact_lsb;
+    double resonance_hz;
+    double decay_s;
+    double noise_lsb;
+    uint32_t seed;
+    uint64_t index;
+} fault_signal_t;
+
+void fault_signal_init(fault_signal_t *sig, double odr_hz, double fault_hz);
+void fault_signal_fill(fault_signal_t *sig, adxl343_sample_t *dst, size_t count);
+
+// Magnitude of the DFT of `x` at `freq_hz` (Goertzel), normalised by length.
+double fault_signal_tone(const int16_t *x, size_t count, double rate_hz, double freq_hz);
+
+#endif // FAULT_SIGNAL_H
@@ -0,0 +1,280 @@
+#include <errno.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "unity.h"
+#include "ADXL343_envelope.h"
+#include "ADXL343_group.h"
+#include "ADXL343_merge.h"
+#include "ADXL343_op.h"
+#include "ADXL343_resample.h"
+#include "ADXL343_stats.h"
+#include "ADXL343_sync.h"
+#include "ADXL343_velocity.h"
+#include "adxl343_sim.h"
+
+// The allocator is replaced for the whole process by a bump arena that
+// counts calls while `armed`. Nothing is ever given back; the arena only
+// has to carry stdio and the test harness.
+#define ARENA_SIZE (1u << 20)
+#define ALIGN 16
+
+static _Alignas(ALIGN) unsigned char arena[ARENA_SIZE];
+static size_t arena_used;
+static volatile bool armed;
+static volatile unsigned long calls;
+
+static void *arena_alloc(size_t size, size_t align) {
+    if (align < ALIGN) {
+        align = ALIGN;
+    }
+    size_t start = (arena_used + ALIGN + align - 1) & ~(align - 1);
+    if (size > ARENA_SIZE || start + size > ARENA_SIZE) {
+        errno = ENOMEM;
+        return NULL;
+    }
+    arena_used = start + size;
+    ((size_t *)(arena + start))[-1] = size;
+    return arena + start;
+}
+
+static void count(void) {
+    if (armed) {
+        calls++;
+    }
+}
+
+void *malloc(size_t size) {
+    count();
+    return arena_alloc(size, ALIGN);
+}
+
+void *calloc(size_t n, size_t size) {
+    count();
+    if (size && n > ARENA_SIZE / size) {
+        errno = ENOMEM;
+        return NULL;
+    }
+    void *p = arena_alloc(n * size, ALIGN);
+    if (p) {
+        memset(p, 0, n * size);
+    }
+    return p;
+}
+
+void *realloc(void *old, size_t size) {
+    count();
+    void *p = arena_alloc(size, ALIGN);
+    if (p && old) {
+        size_t old_size = ((size_t *)old)[-1];
+        memcpy(p, old, old_size < size ? old_size : size);
+    }
+    return p;
+}
+
+void free(void *p) {
+    if (p) {
+        count();
+    }
+}
+
+void *aligned_alloc(size_t align, size_t size) {
+    count();
+    return arena_alloc(size, align);
+}
+
+void *memalign(size_t align, size_t size) {
+    count();
+    return arena_alloc(size, align);
+}
+
+int posix_memalign(void **p, size_t align, size_t size) {
+    count();
+    *p = arena_alloc(size, align);
+    return *p ? 0 : ENOMEM;
+}
+
+// Three sensors at 800 Hz on one bus. The first two are drained as a group
+// into the merge, the frame synchroniser and a chain of processing stages
+// on sensor 0; the third is drained with the non-blocking operation.
+#define SENSORS 3
+#define GROUPED 2
+#define ODR_HZ 800.0f
+#define STEP_US 5000
+
+static const uint8_t addresses[SENSORS] = {ADXL343_ADDRESS, ADXL343_ADDRESS_ALT, 0x54};
+
+static adxl343_sim_t sims[SENSORS];
+static adxl343_sim_bus_t bus;
+static adxl343_dev_t devs[SENSORS];
+static adxl343_group_t group;
+static adxl343_merge_t merge;
+static adxl343_sync_t sync;
+static adxl343_stats_t stats;
+static adxl343_velocity_t velocity;
+static adxl343_envelope_t envelope;
+static adxl343_resampler_t resampler;
+static adxl343_op_t op;
+
+typedef struct {
+    size_t stamped;
+    size_t frames;
+    size_t envelope;
+    size_t resampled;
+    size_t reports;
+    size_t drained;
+} totals_t;
+
+static totals_t totals;
+
+static void source(void *ctx, double t, double mg[3]) {
+    (void)ctx;
+    mg[0] = 300.0 * sin(2.0 * M_PI * 120.0 * t) * (1.0 + sin(2.0 * M_PI * 7.0 * t));
+    mg[1] = 50.0 * sin(2.0 * M_PI * 20.0 * t);
+    mg[2] = 1000.0;
+}
+
+static uint64_t sim_clock(void *ctx) {
+    return ((const adxl343_sim_t *)ctx)->now_ns;
+}
+
+static void sink(void *ctx, size_t index, const adxl343_sample_t *samples, size_t count) {
+    (void)ctx;
+    adxl343_merge_push(&merge, index, samples, count, group.polled_ns[index]);
+    adxl343_sync_push(&sync, index, samples, count, group.polled_ns[index]);
+    if (index != 0) {
+        return;
+    }
+
+    int16_t env[ADXL343_GROUP_CHUNK + 1];
+    adxl343_sample_t out[ADXL343_GROUP_CHUNK + 2];
+    totals.envelope += adxl343_envelope_process(&envelope, samples, count, env, ADXL343_GROUP_CHUNK + 1);
+    totals.resampled += adxl343_resampler_process(&resampler, samples, count, out, ADXL343_GROUP_CHUNK + 2);
+
+    for (size_t done = 0; done < count;) {
+        done += adxl343_stats_add(&stats, samples + done, count - done);
+        if (adxl343_stats_ready(&stats)) {
+            adxl343_stats_report_t report;
+            totals.reports += adxl343_stats_finish(&stats, &report);
+        }
+    }
+    for (size_t done = 0; done < count;) {
+        done += adxl343_velocity_add(&velocity, samples + done, count - done);
+        if (adxl343_velocity_ready(&velocity)) {
+            adxl343_velocity_report_t report;
+            totals.reports += adxl343_velocity_finish(&velocity, &report);
+        }
+    }
+}
+
+// One pass of the main loop: service the group, empty the outputs and
+// drain sensor 2.
+static void loop_once(void) {
+    TEST_ASSERT_TRUE(adxl343_group_service(&group, sink, NULL) >= 0);
+
+    adxl343_stamped_t stamped[32];
+    size_t n;
+    while ((n = adxl343_merge_pop(&merge, stamped, 32)) > 0) {
+        totals.stamped += n;
+    }
+    adxl343_frame_t frames[32];
+    while ((n = adxl343_sync_frames(&sync, frames, 32)) > 0) {
+        totals.frames += n;
+    }
+
+    adxl343_sample_t block[ADXL343_FIFO_DEPTH];
+    adxl343_op_begin_drain(&op, &devs[2], block, ADXL343_FIFO_DEPTH);
+    while (adxl343_op_poll(&op) == ADXL343_PENDING) {
+    }
+    totals.drained += op.count;
+
+    for (int i = 0; i < SENSORS; i++) {
+        adxl343_sim_advance_us(&sims[i], STEP_US);
+    }
+}
+
+void setUp(void) {
+    adxl343_sim_bus_init(&bus);
+    adxl343_group_init(&group);
+    adxl343_merge_init(&merge);
+    adxl343_sync_init(&sync, 500.0f);
+    for (int i = 0; i < SENSORS; i++) {
+        adxl343_sim_init(&sims[i], addresses[i]);
+        adxl343_sim_set_source(&sims[i], source, NULL);
+        adxl343_sim_bus_attach(&bus, &sims[i]);
+        adxl343_dev_set_bus(&devs[i], &bus.bus, addresses[i]);
+        TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_dev_init(&devs[i]));
+        adxl343_dev_write_reg(&devs[i], ADXL343_REG_BW_RATE, ADXL343_RATE_800HZ);
+        adxl343_dev_write_reg(&devs[i], ADXL343_REG_FIFO_CTL, ADXL343_FIFO_STREAM);
+    }
+    for (int i = 0; i < GROUPED; i++) {
+        TEST_ASSERT_EQUAL(i, adxl343_group_add(&group, &devs[i]));
+        TEST_ASSERT_EQUAL(i, adxl343_merge_add(&merge, ODR_HZ));
+        TEST_ASSERT_EQUAL(i, adxl343_sync_add(&sync, ODR_HZ));
+    }
+    adxl343_group_set_clock(&group, sim_clock, &sims[0]);
+
+    adxl343_stats_init(&stats, 800);
+    adxl343_velocity_config_t vc = {.odr_hz = ODR_HZ, .highpass_hz = 10.0f, .window = 800};
+    TEST_ASSERT_TRUE(adxl343_velocity_init(&velocity, &vc));
+    adxl343_envelope_config_t ec = {
+        .odr_hz = ODR_HZ,
+        .band_low_hz = 80.0f,
+        .band_high_hz = 200.0f,
+        .lowpass_hz = 20.0f,
+        .decimation = 4,
+        .axis = 0,
+    };
+    TEST_ASSERT_TRUE(adxl343_envelope_init(&envelope, &ec));
+    TEST_ASSERT_TRUE(adxl343_resampler_init(&resampler, ODR_HZ, 500.0f));
+
+    memset(&totals, 0, sizeof totals);
+    calls = 0;
+}
+
+void tearDown(void) {
+    armed = false;
+}
+
+void test_counter_sees_allocations(void) {
+    // Through a volatile pointer so the pair cannot be optimised away
+    void *(*volatile alloc)(size_t) = malloc;
+    armed = true;
+    void *p = alloc(32);
+    free(p);
+    armed = false;
+    TEST_ASSERT_NOT_NULL(p);
+    TEST_ASSERT_EQUAL(2, calls);
+}
+
+void test_steady_state_does_not_allocate(void) {
+    // One second to fill the pipelines, then ten seconds counted
+    for (int i = 0; i < 200; i++) {
+        loop_once();
+    }
+    totals_t warm = totals;
+
+    armed = true;
+    for (int i = 0; i < 2000; i++) {
+        loop_once();
+    }
+    armed = false;
+
+    TEST_ASSERT_EQUAL(0, calls);
+
+    // And the stages really ran
+    TEST_ASSERT_TRUE(totals.stamped - warm.stamped > 10000);
+    TEST_ASSERT_TRUE(totals.frames - warm.frames > 4000);
+    TEST_ASSERT_TRUE(totals.envelope - warm.envelope > 1500);
+    TEST_ASSERT_TRUE(totals.resampled - warm.resampled > 4000);
+    TEST_ASSERT_TRUE(totals.reports - warm.reports >= 18);
+    TEST_ASSERT_TRUE(totals.drained - warm.drained > 7900);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_counter_sees_allocations);
+    RUN_TEST(test_steady_state_does_not_allocate);
+    return UNITY_END();
+}
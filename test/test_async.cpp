@@ -0,0 +1,237 @@
+#include <math.h>
+#include <stdlib.h>
+
+#include <new>
+
+extern "C" {
+    #include "unity.h"
+    #include "adxl343_sim.h"
+}
+
+#include "ADXL343.hpp"
+
+// Any heap use by the coroutines would show up here
+static size_t heap_calls;
+
+void *operator new(size_t size) {
+    heap_calls++;
+    void *p = malloc(size);
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void *p) noexcept {
+    free(p);
+}
+
+void operator delete(void *p, size_t) noexcept {
+    free(p);
+}
+
+// X carries the sample counter, so gaps show as steps other than one
+static adxl343_sim_t sim;
+static adxl343_sim_bus_t bus;
+
+static void counter(void *ctx, double t, double mg[3]) {
+    (void)ctx;
+    mg[0] = fmod(floor(t * 800.0 + 0.5), 1000.0) * 1000.0 / 256.0;
+    mg[1] = 0.0;
+    mg[2] = 1000.0;
+}
+
+struct Collected {
+    size_t blocks = 0;
+    size_t samples = 0;
+    size_t gaps = 0;
+    int16_t last = -1;
+    int error = 0;
+    bool finished = false;
+};
+
+static ADXL343::Task acquire(ADXL343 &accel, ADXL343::Event &watermark, Collected &out, size_t blocks) {
+    adxl343_sample_t block[ADXL343_FIFO_DEPTH];
+
+    while (out.blocks < blocks) {
+        int n = co_await accel.nextBlock(watermark, block, ADXL343_FIFO_DEPTH);
+        if (n < 0) {
+            out.error = n;
+            co_return;
+        }
+        for (int i = 0; i < n; i++) {
+            if (out.last >= 0 && block[i].x != (out.last + 1) % 1000) {
+                out.gaps++;
+            }
+            out.last = block[i].x;
+        }
+        out.samples += static_cast<size_t>(n);
+        out.blocks++;
+    }
+    out.finished = true;
+}
+
+static ADXL343::Task idle(ADXL343::Event &event) {
+    adxl343_sample_t block[1];
+    ADXL343 accel;
+    co_await accel.nextBlock(event, block, 1);
+}
+
+// Host event loop: 1 ms ticks, INT1 edge sets the event, the loop
+// dispatches it. Returns the number of resumes.
+static size_t run_loop(ADXL343::Event &watermark, int ms) {
+    size_t resumes = 0;
+    bool was_high = false;
+    for (int t = 0; t < ms; t++) {
+        adxl343_sim_advance_us(&sim, 1000);
+        bool high = adxl343_sim_int_pin(&sim, 1);
+        if (high && !was_high) {
+            watermark.signal();
+        }
+        was_high = high;
+        resumes += watermark.dispatch() ? 1 : 0;
+        // The FIFO drain lowers INT1 again before the next tick
+        was_high = adxl343_sim_int_pin(&sim, 1);
+    }
+    return resumes;
+}
+
+void setUp(void) {
+    adxl343_sim_init(&sim, ADXL343_ADDRESS);
+    adxl343_sim_set_source(&sim, counter, NULL);
+    adxl343_sim_bus_init(&bus);
+    adxl343_sim_bus_attach(&bus, &sim);
+    adxl343_set_bus(&bus.bus, ADXL343_ADDRESS);
+
+    ADXL343 accel;
+    TEST_ASSERT_EQUAL(ADXL343_OK, accel.init());
+    adxl343_write_reg(ADXL343_REG_POWER_CTL, 0);
+    adxl343_write_reg(ADXL343_REG_BW_RATE, ADXL343_RATE_800HZ);
+    adxl343_write_reg(ADXL343_REG_FIFO_CTL, ADXL343_FIFO_STREAM | 16);
+    adxl343_write_reg(ADXL343_REG_INT_MAP, 0);
+    adxl343_write_reg(ADXL343_REG_INT_ENABLE, ADXL343_INT_WATERMARK);
+    adxl343_write_reg(ADXL343_REG_POWER_CTL, ADXL343_POWER_MEASURE);
+    heap_calls = 0;
+}
+
+void tearDown(void) {
+}
+
+void test_loop_runs_straight_through(void) {
+    ADXL343 accel;
+    ADXL343::Event watermark;
+    Collected out;
+
+    {
+        ADXL343::Task task = acquire(accel, watermark, out, 50);
+        TEST_ASSERT_TRUE(static_cast<bool>(task));
+        TEST_ASSERT_FALSE(task.done());
+
+        size_t resumes = run_loop(watermark, 2000);
+        TEST_ASSERT_TRUE(task.done());
+        TEST_ASSERT_EQUAL(50, resumes);
+    }
+
+    TEST_ASSERT_TRUE(out.finished);
+    TEST_ASSERT_EQUAL(0, out.error);
+    TEST_ASSERT_EQUAL(0, out.gaps);
+    TEST_ASSERT_EQUAL(50, out.blocks);
+    TEST_ASSERT_TRUE(out.samples >= 50 * 16);
+    TEST_ASSERT_EQUAL(0, heap_calls);
+    TEST_ASSERT_EQUAL(ADXL343_CORO_FRAMES, ADXL343::Task::framesFree());
+}
+
+void test_waits_without_interrupt(void) {
+    ADXL343 accel;
+    ADXL343::Event watermark;
+    Collected out;
+
+    // Watermark disabled: the coroutine must stay suspended
+    adxl343_write_reg(ADXL343_REG_INT_ENABLE, 0);
+    ADXL343::Task task = acquire(accel, watermark, out, 1);
+    TEST_ASSERT_EQUAL(0, run_loop(watermark, 100));
+    TEST_ASSERT_FALSE(task.done());
+    TEST_ASSERT_EQUAL(0, out.blocks);
+
+    // An early signal is kept until the coroutine gets to it
+    watermark.signal();
+    TEST_ASSERT_TRUE(watermark.dispatch());
+    TEST_ASSERT_TRUE(task.done());
+    TEST_ASSERT_EQUAL(ADXL343_FIFO_DEPTH, out.samples);
+}
+
+void test_second_sensor_drains_its_own_fifo(void) {
+    adxl343_sim_t alt;
+    adxl343_sim_init(&alt, ADXL343_ADDRESS_ALT);
+    adxl343_sim_set_source(&alt, counter, NULL);
+    adxl343_sim_bus_attach(&bus, &alt);
+    adxl343_dev_t dev;
+    adxl343_dev_set_bus(&dev, &bus.bus, ADXL343_ADDRESS_ALT);
+
+    ADXL343 second(&dev);
+    TEST_ASSERT_EQUAL(ADXL343_OK, second.init());
+    adxl343_dev_write_reg(&dev, ADXL343_REG_FIFO_CTL, ADXL343_FIFO_STREAM | 16);
+
+    ADXL343::Event watermark;
+    Collected out;
+    ADXL343::Task task = acquire(second, watermark, out, 1);
+    adxl343_sim_advance_us(&sim, 400000);
+    adxl343_sim_advance_us(&alt, 400000);
+    watermark.signal();
+    TEST_ASSERT_TRUE(watermark.dispatch());
+    TEST_ASSERT_TRUE(task.done());
+
+    // Both FIFOs were full; only the second one was read
+    TEST_ASSERT_EQUAL(ADXL343_FIFO_DEPTH, out.samples);
+    TEST_ASSERT_EQUAL(0, alt.fifo_count);
+    TEST_ASSERT_EQUAL(ADXL343_FIFO_DEPTH, sim.fifo_count);
+}
+
+void test_frame_pool_is_bounded(void) {
+    ADXL343::Event events[ADXL343_CORO_FRAMES + 1];
+    ADXL343::Task tasks[ADXL343_CORO_FRAMES + 1];
+
+    for (size_t i = 0; i < ADXL343_CORO_FRAMES; i++) {
+        tasks[i] = idle(events[i]);
+        TEST_ASSERT_TRUE(static_cast<bool>(tasks[i]));
+    }
+    TEST_ASSERT_EQUAL(0, ADXL343::Task::framesFree());
+
+    tasks[ADXL343_CORO_FRAMES] = idle(events[ADXL343_CORO_FRAMES]);
+    TEST_ASSERT_FALSE(static_cast<bool>(tasks[ADXL343_CORO_FRAMES]));
+
+    // Destroying a suspended task returns its slot
+    tasks[0] = ADXL343::Task();
+    TEST_ASSERT_EQUAL(1, ADXL343::Task::framesFree());
+    tasks[0] = idle(events[0]);
+    TEST_ASSERT_TRUE(static_cast<bool>(tasks[0]));
+    TEST_ASSERT_EQUAL(0, heap_calls);
+}
+
+void test_destroyed_task_is_not_resumed(void) {
+    ADXL343::Event event;
+    {
+        ADXL343::Task task = idle(event);
+        TEST_ASSERT_TRUE(static_cast<bool>(task));
+    }
+    event.signal();
+    TEST_ASSERT_FALSE(event.dispatch());
+
+    // Nor one replaced by move assignment while it waits
+    ADXL343::Event other;
+    ADXL343::Task task = idle(event);
+    task = idle(other);
+    event.signal();
+    TEST_ASSERT_FALSE(event.dispatch());
+    TEST_ASSERT_EQUAL(ADXL343_CORO_FRAMES - 1, ADXL343::Task::framesFree());
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_loop_runs_straight_through);
+    RUN_TEST(test_waits_without_interrupt);
+    RUN_TEST(test_second_sensor_drains_its_own_fifo);
+    RUN_TEST(test_frame_pool_is_bounded);
+    RUN_TEST(test_destroyed_task_is_not_resumed);
+    return UNITY_END();
+}
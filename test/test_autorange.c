@@ -0,0 +1,254 @@
+#include <math.h>
+#include <string.h>
+
+#include "unity.h"
+#include "ADXL343_autorange.h"
+#include "adxl343_sim.h"
+
+#define ODR_HZ 800.0
+#define SHOCK_S 0.004
+#define MAX_SHOCKS 8
+#define X_MG -700.0
+
+// X holds a constant so the scale reported with each batch can be checked;
+// Z sits at 1 g with half-sine impacts on top.
+typedef struct {
+    double at[MAX_SHOCKS];
+    size_t count;
+    double mg;
+} shocks_t;
+
+static adxl343_sim_t sim;
+static adxl343_sim_bus_t bus;
+static adxl343_dev_t dev;
+static shocks_t shocks;
+static adxl343_autorange_t ar;
+static adxl343_sample_t batch[64];
+
+static uint64_t returned;
+static uint64_t mistagged;
+
+static void source(void *ctx, double t, double mg[3]) {
+    const shocks_t *s = (const shocks_t *)ctx;
+    mg[0] = X_MG;
+    mg[1] = 0.0;
+    mg[2] = 1000.0;
+    for (size_t i = 0; i < s->count; i++) {
+        double dt = t - s->at[i];
+        if (dt >= 0.0 && dt < SHOCK_S) {
+            mg[2] += s->mg * sin(M_PI * dt / SHOCK_S);
+        }
+    }
+}
+
+static const adxl343_autorange_config_t config = {
+    .min_range = ADXL343_RANGE_2G,
+    .max_range = ADXL343_RANGE_16G,
+    .watermark = 16,
+    .hold = 25, // 0.5 s at 800 Hz
+};
+
+void setUp(void) {
+    memset(&shocks, 0, sizeof(shocks));
+    returned = 0;
+    mistagged = 0;
+    adxl343_sim_init(&sim, ADXL343_ADDRESS);
+    adxl343_sim_set_source(&sim, source, &shocks);
+    adxl343_sim_bus_init(&bus);
+    adxl343_sim_bus_attach(&bus, &sim);
+    adxl343_dev_set_bus(&dev, &bus.bus, ADXL343_ADDRESS);
+
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_dev_init(&dev));
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_dev_write_reg(&dev, ADXL343_REG_BW_RATE, ADXL343_RATE_800HZ));
+}
+
+void tearDown(void) {
+}
+
+static void service(size_t max) {
+    uint8_t format;
+    int n = adxl343_autorange_service(&ar, batch, max, &format);
+    TEST_ASSERT_TRUE(n >= 0);
+
+    // Within one 10-bit LSB, also when left-justified
+    float scale = adxl343_mg_per_lsb(format);
+    float lsb = adxl343_mg_per_lsb((uint8_t)(format & ~ADXL343_FORMAT_JUSTIFY));
+    for (int i = 0; i < n; i++) {
+        if (fabsf((float)batch[i].x * scale - (float)X_MG) > lsb) {
+            mistagged++;
+        }
+    }
+    returned += (uint64_t)n;
+}
+
+// Advance in 1 ms steps, servicing whenever INT1 is raised
+static void run_until(double until) {
+    while ((double)sim.now_ns / 1e9 < until) {
+        adxl343_sim_advance_us(&sim, 1000);
+        if (adxl343_sim_int_pin(&sim, 1)) {
+            service(sizeof(batch) / sizeof(batch[0]));
+        }
+    }
+}
+
+static adxl343_range_t range(void) {
+    uint8_t format;
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_dev_read_reg(&dev, ADXL343_REG_DATA_FORMAT, &format));
+    TEST_ASSERT_EQUAL_HEX8(ar.format, format);
+    return (adxl343_range_t)(format & ADXL343_FORMAT_RANGE_MASK);
+}
+
+void test_starts_at_max_range_without_full_res(void) {
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_autorange_init(&ar, &dev, &config));
+    TEST_ASSERT_EQUAL(ADXL343_RANGE_16G, range());
+    TEST_ASSERT_EQUAL(0, ar.format & ADXL343_FORMAT_FULL_RES);
+}
+
+void test_quiet_sensor_steps_down_to_min_range(void) {
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_autorange_init(&ar, &dev, &config));
+
+    // One step per `hold` blocks of 20 ms
+    run_until(1.1);
+    TEST_ASSERT_EQUAL(ADXL343_RANGE_4G, range());
+    run_until(2.0);
+    TEST_ASSERT_EQUAL(ADXL343_RANGE_2G, range());
+    TEST_ASSERT_EQUAL(3, ar.switches);
+    TEST_ASSERT_EQUAL(0, ar.incidents);
+
+    run_until(4.0);
+    TEST_ASSERT_EQUAL(3, ar.switches);
+}
+
+void test_clipping_impact_switches_to_max_range(void) {
+    shocks.mg = 5000.0;
+    shocks.at[shocks.count++] = 2.5003;
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_autorange_init(&ar, &dev, &config));
+    run_until(2.4);
+    TEST_ASSERT_EQUAL(ADXL343_RANGE_2G, range());
+
+    // Clipped at 2 g, up to 16 g within the next block
+    run_until(2.5003 + 0.045);
+    TEST_ASSERT_EQUAL(ADXL343_RANGE_16G, range());
+    TEST_ASSERT_EQUAL(1, ar.incidents);
+    TEST_ASSERT_TRUE(ar.clipped > 0);
+    TEST_ASSERT_TRUE(ar.clipped <= 4);
+}
+
+void test_repeated_impacts_settle_on_a_range_that_holds_them(void) {
+    shocks.mg = 5000.0;
+    for (size_t i = 0; i < MAX_SHOCKS; i++) {
+        shocks.at[shocks.count++] = 2.5003 + 0.3 * (double)i;
+    }
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_autorange_init(&ar, &dev, &config));
+    run_until(5.0);
+
+    // Clips once at 2 g, then 5 g peaks keep 8 g from stepping down
+    TEST_ASSERT_EQUAL(1, ar.incidents);
+    TEST_ASSERT_EQUAL(ADXL343_RANGE_8G, range());
+}
+
+void test_no_samples_dropped_or_mistagged_across_switches(void) {
+    shocks.mg = 12000.0;
+    shocks.at[shocks.count++] = 2.5003;
+    shocks.at[shocks.count++] = 4.7117;
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_autorange_init(&ar, &dev, &config));
+    run_until(8.0);
+
+    TEST_ASSERT_TRUE(ar.switches >= 8);
+    TEST_ASSERT_EQUAL_UINT64(sim.samples, returned + sim.fifo_count);
+    TEST_ASSERT_EQUAL_UINT64(0, mistagged);
+}
+
+void test_left_justified_samples_are_q15_of_their_range(void) {
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_dev_write_reg(&dev, ADXL343_REG_DATA_FORMAT,
+                                                        ADXL343_FORMAT_FULL_RES | ADXL343_FORMAT_JUSTIFY));
+    shocks.mg = 5000.0;
+    shocks.at[shocks.count++] = 2.5003;
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_autorange_init(&ar, &dev, &config));
+    TEST_ASSERT_EQUAL_HEX8(ADXL343_FORMAT_JUSTIFY | ADXL343_RANGE_16G, ar.format);
+
+    run_until(2.4);
+    TEST_ASSERT_EQUAL(ADXL343_RANGE_2G, range());
+    run_until(3.0);
+    TEST_ASSERT_EQUAL(1, ar.incidents);
+    TEST_ASSERT_EQUAL(ADXL343_RANGE_16G, range());
+    TEST_ASSERT_EQUAL_UINT64(0, mistagged);
+}
+
+void test_switch_waits_for_fifo_to_drain(void) {
+    shocks.mg = 5000.0;
+    shocks.at[shocks.count++] = 2.5003;
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_autorange_init(&ar, &dev, &config));
+    run_until(2.5);
+    TEST_ASSERT_EQUAL(ADXL343_RANGE_2G, range());
+
+    // The impact lands in a FIFO drained only two samples per call
+    adxl343_sim_advance_us(&sim, 2540000 - sim.now_ns / 1000);
+    uint32_t switches = ar.switches;
+    while (ar.target != ADXL343_RANGE_16G) {
+        service(2);
+    }
+    TEST_ASSERT_EQUAL(switches, ar.switches);
+    while (ar.switches == switches) {
+        TEST_ASSERT_EQUAL(ADXL343_RANGE_2G, range());
+        service(2);
+    }
+    TEST_ASSERT_EQUAL(ADXL343_RANGE_16G, range());
+    TEST_ASSERT_EQUAL(0, sim.fifo_count);
+    TEST_ASSERT_EQUAL_UINT64(0, mistagged);
+}
+
+void test_second_sensor_ranges_on_its_own(void) {
+    adxl343_sim_t alt;
+    adxl343_dev_t alt_dev;
+    adxl343_sim_init(&alt, ADXL343_ADDRESS_ALT);
+    adxl343_sim_set_source(&alt, source, &shocks);
+    adxl343_sim_bus_attach(&bus, &alt);
+    adxl343_dev_set_bus(&alt_dev, &bus.bus, ADXL343_ADDRESS_ALT);
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_dev_init(&alt_dev));
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_dev_write_reg(&alt_dev, ADXL343_REG_BW_RATE, ADXL343_RATE_800HZ));
+    uint8_t format = sim.regs[ADXL343_REG_DATA_FORMAT];
+
+    // The quiet second sensor steps down while the first is left alone
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_autorange_init(&ar, &alt_dev, &config));
+    while ((double)alt.now_ns / 1e9 < 2.0) {
+        adxl343_sim_advance_us(&alt, 1000);
+        if (adxl343_sim_int_pin(&alt, 1)) {
+            uint8_t batch_format;
+            int n = adxl343_autorange_service(&ar, batch, sizeof(batch) / sizeof(batch[0]), &batch_format);
+            TEST_ASSERT_TRUE(n >= 0);
+        }
+    }
+
+    TEST_ASSERT_EQUAL(3, ar.switches);
+    TEST_ASSERT_EQUAL_HEX8(ADXL343_RANGE_2G, alt.regs[ADXL343_REG_DATA_FORMAT] & ADXL343_FORMAT_RANGE_MASK);
+    TEST_ASSERT_EQUAL_HEX8(format, sim.regs[ADXL343_REG_DATA_FORMAT]);
+    TEST_ASSERT_EQUAL_HEX8(0, sim.regs[ADXL343_REG_INT_ENABLE]);
+}
+
+void test_invalid_config_is_rejected(void) {
+    adxl343_autorange_config_t bad = config;
+    bad.watermark = 0;
+    TEST_ASSERT_EQUAL(ADXL343_ERROR_ARGUMENT, adxl343_autorange_init(&ar, &dev, &bad));
+    bad = config;
+    bad.hold = 0;
+    TEST_ASSERT_EQUAL(ADXL343_ERROR_ARGUMENT, adxl343_autorange_init(&ar, &dev, &bad));
+    bad = config;
+    bad.min_range = ADXL343_RANGE_8G;
+    bad.max_range = ADXL343_RANGE_4G;
+    TEST_ASSERT_EQUAL(ADXL343_ERROR_ARGUMENT, adxl343_autorange_init(&ar, &dev, &bad));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_starts_at_max_range_without_full_res);
+    RUN_TEST(test_quiet_sensor_steps_down_to_min_range);
+    RUN_TEST(test_clipping_impact_switches_to_max_range);
+    RUN_TEST(test_repeated_impacts_settle_on_a_range_that_holds_them);
+    RUN_TEST(test_no_samples_dropped_or_mistagged_across_switches);
+    RUN_TEST(test_left_justified_samples_are_q15_of_their_range);
+    RUN_TEST(test_switch_waits_for_fifo_to_drain);
+    RUN_TEST(test_second_sensor_ranges_on_its_own);
+    RUN_TEST(test_invalid_config_is_rejected);
+    return UNITY_END();
+}
@@ -0,0 +1,260 @@
+#include <math.h>
+#include <string.h>
+
+#include "unity.h"
+#include "ADXL343_cal.h"
+#include "adxl343_calfit.h"
+#include "adxl343_sim.h"
+
+#define FORMAT (ADXL343_FORMAT_FULL_RES | ADXL343_RANGE_16G)
+
+// A part with per-axis gain error, cross-axis sensitivity and bias: it
+// reads D * g + b for the gravity vector g in mg, with a few mg of dither
+// so averages resolve below one LSB.
+static adxl343_sim_t sim;
+static adxl343_sim_bus_t bus;
+static double gain[3][3];
+static double bias[3];
+static double gravity[3];
+
+static const double symmetric[3][3] = {
+    {1.030, 0.012, -0.008},
+    {0.012, 0.975, 0.015},
+    {-0.008, 0.015, 1.018},
+};
+static const double diagonal[3][3] = {
+    {1.030, 0.0, 0.0},
+    {0.0, 0.975, 0.0},
+    {0.0, 0.0, 1.018},
+};
+
+static void source(void *ctx, double t, double mg[3]) {
+    (void)ctx;
+    double dither = 5.0 * sin(2.0 * M_PI * 37.0 * t);
+    for (int r = 0; r < 3; r++) {
+        mg[r] = bias[r] + dither;
+        for (int c = 0; c < 3; c++) {
+            mg[r] += gain[r][c] * gravity[c];
+        }
+    }
+}
+
+void setUp(void) {
+    memcpy(gain, symmetric, sizeof(gain));
+    bias[0] = 40.0;
+    bias[1] = -25.0;
+    bias[2] = 60.0;
+    adxl343_sim_init(&sim, ADXL343_ADDRESS);
+    adxl343_sim_set_source(&sim, source, NULL);
+    adxl343_sim_bus_init(&bus);
+    adxl343_sim_bus_attach(&bus, &sim);
+    adxl343_set_bus(&bus.bus, ADXL343_ADDRESS);
+
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_init());
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_write_reg(ADXL343_REG_BW_RATE, ADXL343_RATE_800HZ));
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_write_reg(ADXL343_REG_FIFO_CTL, ADXL343_FIFO_STREAM));
+}
+
+void tearDown(void) {
+}
+
+static void orient(double x, double y, double z) {
+    double n = sqrt(x * x + y * y + z * z);
+    gravity[0] = 1000.0 * x / n;
+    gravity[1] = 1000.0 * y / n;
+    gravity[2] = 1000.0 * z / n;
+}
+
+// Hold the sensor in the current orientation and average 64 samples, mg
+static void capture(double mg[3]) {
+    adxl343_sample_t block[ADXL343_FIFO_DEPTH];
+    double sum[3] = {0.0, 0.0, 0.0};
+
+    adxl343_sim_advance_us(&sim, 10000);
+    adxl343_read_fifo(block, ADXL343_FIFO_DEPTH);
+    for (int b = 0; b < 2; b++) {
+        adxl343_sim_advance_us(&sim, 40000);
+        TEST_ASSERT_EQUAL(ADXL343_FIFO_DEPTH, adxl343_read_fifo(block, ADXL343_FIFO_DEPTH));
+        for (int i = 0; i < ADXL343_FIFO_DEPTH; i++) {
+            sum[0] += block[i].x;
+            sum[1] += block[i].y;
+            sum[2] += block[i].z;
+        }
+    }
+    for (int i = 0; i < 3; i++) {
+        mg[i] = sum[i] / (2 * ADXL343_FIFO_DEPTH) * adxl343_mg_per_lsb(FORMAT);
+    }
+}
+
+// Six faces, then the eight corners of the cube
+static const double orientations[14][3] = {
+    {1, 0, 0}, {-1, 0, 0}, {0, 1, 0}, {0, -1, 0}, {0, 0, 1}, {0, 0, -1},
+    {1, 1, 1}, {1, 1, -1}, {1, -1, 1}, {1, -1, -1}, {-1, 1, 1}, {-1, 1, -1}, {-1, -1, 1}, {-1, -1, -1},
+};
+
+static void capture_all(double readings[][3], size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        orient(orientations[i][0], orientations[i][1], orientations[i][2]);
+        capture(readings[i]);
+    }
+}
+
+void test_fit_recovers_gain_cross_axis_and_offset(void) {
+    double readings[14][3];
+    adxl343_calfit_t fit;
+    capture_all(readings, 14);
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_calfit_fit((const double (*)[3])readings, 14, &fit));
+    TEST_ASSERT_TRUE(fit.full);
+    TEST_ASSERT_TRUE(fit.rms_mg < 1.0);
+
+    for (int i = 0; i < 3; i++) {
+        TEST_ASSERT_FLOAT_WITHIN(1.5f, (float)bias[i], (float)fit.offset_mg[i]);
+    }
+
+    // A symmetric distortion is undone completely, also in orientations
+    // the fit never saw
+    const double unseen[][3] = {{1, 2, 3}, {-3, 1, 0.5}, {0.2, -1, -2}, {2, -2, 1}};
+    for (size_t k = 0; k < sizeof(unseen) / sizeof(unseen[0]); k++) {
+        double mg[3], out[3];
+        orient(unseen[k][0], unseen[k][1], unseen[k][2]);
+        capture(mg);
+        adxl343_calfit_apply(&fit, mg, out);
+        for (int i = 0; i < 3; i++) {
+            TEST_ASSERT_FLOAT_WITHIN(2.0f, (float)gravity[i], (float)out[i]);
+        }
+    }
+}
+
+void test_any_distortion_comes_out_at_one_g(void) {
+    // Not symmetric: corrected up to a common rotation
+    gain[0][1] = 0.025;
+    gain[1][0] = -0.010;
+    gain[2][0] = 0.020;
+
+    double readings[14][3];
+    adxl343_calfit_t fit;
+    capture_all(readings, 14);
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_calfit_fit((const double (*)[3])readings, 14, &fit));
+    TEST_ASSERT_TRUE(fit.rms_mg < 1.0);
+
+    double mg[3], out[3];
+    orient(-1, 2, 3);
+    capture(mg);
+    adxl343_calfit_apply(&fit, mg, out);
+    TEST_ASSERT_FLOAT_WITHIN(2.0f, 1000.0f, (float)sqrt(out[0] * out[0] + out[1] * out[1] + out[2] * out[2]));
+}
+
+void test_six_positions_fit_gain_and_offset_per_axis(void) {
+    memcpy(gain, diagonal, sizeof(gain));
+
+    double readings[6][3];
+    adxl343_calfit_t fit;
+    capture_all(readings, 6);
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_calfit_fit((const double (*)[3])readings, 6, &fit));
+    TEST_ASSERT_FALSE(fit.full);
+
+    for (int i = 0; i < 3; i++) {
+        TEST_ASSERT_FLOAT_WITHIN(0.002f, (float)(1.0 / diagonal[i][i]), (float)fit.m[i][i]);
+        TEST_ASSERT_FLOAT_WITHIN(1.5f, (float)bias[i], (float)fit.offset_mg[i]);
+        for (int j = 0; j < 3; j++) {
+            if (j != i) {
+                TEST_ASSERT_EQUAL_FLOAT(0.0f, (float)fit.m[i][j]);
+            }
+        }
+    }
+}
+
+void test_orientations_that_do_not_determine_a_fit_are_refused(void) {
+    double readings[14][3];
+    adxl343_calfit_t fit;
+    capture_all(readings, 14);
+    TEST_ASSERT_EQUAL(ADXL343_ERROR_ARGUMENT, adxl343_calfit_fit((const double (*)[3])readings, 5, &fit));
+
+    // Nine orientations around the Z axis only
+    double flat[9][3];
+    for (int i = 0; i < 9; i++) {
+        orient(cos(2.0 * M_PI * i / 9.0), sin(2.0 * M_PI * i / 9.0), 0.0);
+        capture(flat[i]);
+    }
+    TEST_ASSERT_EQUAL(ADXL343_ERROR_ARGUMENT, adxl343_calfit_fit((const double (*)[3])flat, 9, &fit));
+}
+
+// The fixed-point stage against the host fit on live samples and across
+// the whole input range
+void test_device_stage_matches_host_fit(void) {
+    double readings[14][3];
+    adxl343_calfit_t fit;
+    adxl343_cal_t cal;
+    capture_all(readings, 14);
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_calfit_fit((const double (*)[3])readings, 14, &fit));
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_calfit_to_device(&fit, FORMAT, &cal));
+
+    double lsb = adxl343_mg_per_lsb(FORMAT);
+    adxl343_sample_t block[ADXL343_FIFO_DEPTH];
+    size_t checked = 0;
+    for (int v = -4096; v < 4096; v += 37) {
+        for (size_t i = 0; i < ADXL343_FIFO_DEPTH; i++) {
+            block[i].x = (int16_t)v;
+            block[i].y = (int16_t)((3 * v + 997 * (int)i) % 4096);
+            block[i].z = (int16_t)(-v / 2 + (int)i * 61);
+        }
+        adxl343_sample_t raw[ADXL343_FIFO_DEPTH];
+        memcpy(raw, block, sizeof(raw));
+        adxl343_cal_apply(&cal, block, ADXL343_FIFO_DEPTH);
+
+        for (size_t i = 0; i < ADXL343_FIFO_DEPTH; i++) {
+            double mg[3] = {raw[i].x * lsb, raw[i].y * lsb, raw[i].z * lsb};
+            double out[3];
+            adxl343_calfit_apply(&fit, mg, out);
+            // Offset rounding to one LSB plus the Q14 matrix
+            TEST_ASSERT_FLOAT_WITHIN(1.5f, (float)(out[0] / lsb), (float)block[i].x);
+            TEST_ASSERT_FLOAT_WITHIN(1.5f, (float)(out[1] / lsb), (float)block[i].y);
+            TEST_ASSERT_FLOAT_WITHIN(1.5f, (float)(out[2] / lsb), (float)block[i].z);
+            checked++;
+        }
+    }
+    TEST_ASSERT_TRUE(checked > 5000);
+
+    // Live samples come out at 1 g
+    orient(2, -1, 1);
+    adxl343_sim_advance_us(&sim, 50000);
+    adxl343_read_fifo(block, ADXL343_FIFO_DEPTH);
+    adxl343_sim_advance_us(&sim, 40000);
+    TEST_ASSERT_EQUAL(ADXL343_FIFO_DEPTH, adxl343_read_fifo(block, ADXL343_FIFO_DEPTH));
+    adxl343_cal_apply(&cal, block, ADXL343_FIFO_DEPTH);
+    for (size_t i = 0; i < ADXL343_FIFO_DEPTH; i++) {
+        double x = block[i].x * lsb, y = block[i].y * lsb, z = block[i].z * lsb;
+        TEST_ASSERT_FLOAT_WITHIN(12.0f, 1000.0f, (float)sqrt(x * x + y * y + z * z));
+    }
+}
+
+void test_identity_and_saturation(void) {
+    adxl343_cal_t cal;
+    adxl343_sample_t s[3] = {{INT16_MIN, INT16_MAX, 0}, {1, -1, 1234}, {-4096, 4095, -7}};
+    adxl343_sample_t copy[3];
+    memcpy(copy, s, sizeof(s));
+
+    adxl343_cal_identity(&cal);
+    adxl343_cal_apply(&cal, s, 3);
+    TEST_ASSERT_EQUAL_MEMORY(copy, s, sizeof(s));
+
+    // Gain above one and an offset push full-scale inputs past int16
+    cal.m[0][0] = (int16_t)(1.5 * (1 << ADXL343_CAL_FRAC_BITS));
+    cal.m[1][1] = (int16_t)(1.5 * (1 << ADXL343_CAL_FRAC_BITS));
+    cal.offset[2] = -100;
+    adxl343_cal_apply(&cal, s, 1);
+    TEST_ASSERT_EQUAL_INT16(INT16_MIN, s[0].x);
+    TEST_ASSERT_EQUAL_INT16(INT16_MAX, s[0].y);
+    TEST_ASSERT_EQUAL_INT16(100, s[0].z);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_fit_recovers_gain_cross_axis_and_offset);
+    RUN_TEST(test_any_distortion_comes_out_at_one_g);
+    RUN_TEST(test_six_positions_fit_gain_and_offset_per_axis);
+    RUN_TEST(test_orientations_that_do_not_determine_a_fit_are_refused);
+    RUN_TEST(test_device_stage_matches_host_fit);
+    RUN_TEST(test_identity_and_saturation);
+    return UNITY_END();
+}
@@ -0,0 +1,162 @@
+#include <math.h>
+
+#include "unity.h"
+#include "ADXL343_envelope.h"
+#include "fault_signal.h"
+
+#define ODR_HZ 3200.0
+#define DECIMATION 4
+#define SECONDS 4
+#define INPUT_SAMPLES (3200 * SECONDS)
+#define BPFO_HZ 87.3
+
+static adxl343_sample_t input[INPUT_SAMPLES];
+static int16_t envelope[INPUT_SAMPLES / DECIMATION + 1];
+
+static const adxl343_envelope_config_t config = {
+    .odr_hz = (float)ODR_HZ,
+    .band_low_hz = 700.0f,
+    .band_high_hz = 1300.0f,
+    .lowpass_hz = 300.0f,
+    .decimation = DECIMATION,
+    .axis = 2,
+};
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+static size_t demodulate(double fault_hz) {
+    adxl343_envelope_t env;
+    fault_signal_t sig;
+
+    TEST_ASSERT_TRUE(adxl343_envelope_init(&env, &config));
+    fault_signal_init(&sig, ODR_HZ, fault_hz);
+    fault_signal_fill(&sig, input, INPUT_SAMPLES);
+
+    size_t n = 0;
+    for (size_t i = 0; i < INPUT_SAMPLES; i += 32) {
+        n += adxl343_envelope_process(&env, &input[i], 32, &envelope[n], sizeof(envelope) / sizeof(envelope[0]) - n);
+    }
+    return n;
+}
+
+void test_fault_rate_dominates_envelope_spectrum(void) {
+    size_t n = demodulate(BPFO_HZ);
+    double rate = ODR_HZ / DECIMATION;
+
+    TEST_ASSERT_EQUAL(INPUT_SAMPLES / DECIMATION, n);
+
+    // Skip the filter start-up
+    const int16_t *x = &envelope[200];
+    n -= 200;
+
+    double line = fault_signal_tone(x, n, rate, BPFO_HZ);
+    double harmonic = fault_signal_tone(x, n, rate, 2.0 * BPFO_HZ);
+    double shaft = fault_signal_tone(x, n, rate, 24.7);
+    double floor = fault_signal_tone(x, n, rate, 61.0);
+
+    TEST_ASSERT_TRUE(line > 10.0 * floor);
+    TEST_ASSERT_TRUE(harmonic > 5.0 * floor);
+    TEST_ASSERT_TRUE(line > 10.0 * shaft);
+}
+
+void test_healthy_bearing_has_no_defect_line(void) {
+    size_t faulty_n = demodulate(BPFO_HZ);
+    double rate = ODR_HZ / DECIMATION;
+    double faulty = fault_signal_tone(&envelope[200], faulty_n - 200, rate, BPFO_HZ);
+
+    size_t healthy_n = demodulate(0.0);
+    double healthy = fault_signal_tone(&envelope[200], healthy_n - 200, rate, BPFO_HZ);
+
+    TEST_ASSERT_TRUE(faulty > 20.0 * healthy);
+}
+
+void test_out_of_band_tone_is_rejected(void) {
+    adxl343_envelope_t env;
+    TEST_ASSERT_TRUE(adxl343_envelope_init(&env, &config));
+
+    size_t n = 0;
+    for (size_t i = 0; i < INPUT_SAMPLES; i++) {
+        input[i].x = 0;
+        input[i].y = 0;
+        input[i].z = (int16_t)lround(256.0 + 2000.0 * sin(2.0 * M_PI * 60.0 * i / ODR_HZ));
+    }
+    n = adxl343_envelope_process(&env, input, INPUT_SAMPLES, envelope, sizeof(envelope) / sizeof(envelope[0]));
+
+    int16_t peak = 0;
+    for (size_t i = 400; i < n; i++) {
+        peak = envelope[i] > peak ? envelope[i] : peak;
+    }
+    TEST_ASSERT_TRUE(peak < 20);
+}
+
+void test_in_band_tone_envelope_tracks_amplitude(void) {
+    adxl343_envelope_t env;
+    TEST_ASSERT_TRUE(adxl343_envelope_init(&env, &config));
+
+    for (size_t i = 0; i < INPUT_SAMPLES; i++) {
+        input[i].x = 0;
+        input[i].y = 0;
+        input[i].z = (int16_t)lround(1000.0 * sin(2.0 * M_PI * 1000.0 * i / ODR_HZ));
+    }
+    size_t n = adxl343_envelope_process(&env, input, INPUT_SAMPLES, envelope, sizeof(envelope) / sizeof(envelope[0]));
+
+    // Mean of a rectified sine is 2/pi of its amplitude; allow for the
+    // droop of the two second order band edges at mid band.
+    double mean = 0.0;
+    for (size_t i = 400; i < n; i++) {
+        mean += envelope[i];
+    }
+    mean /= (double)(n - 400);
+    TEST_ASSERT_FLOAT_WITHIN(0.08 * 2000.0 / M_PI, 2000.0 / M_PI, mean);
+}
+
+void test_decimation_phase_carries_across_blocks(void) {
+    adxl343_envelope_t env;
+    TEST_ASSERT_TRUE(adxl343_envelope_init(&env, &config));
+
+    size_t n = 0;
+    for (int i = 0; i < 10; i++) {
+        n += adxl343_envelope_process(&env, input, 3, envelope, 8);
+    }
+    TEST_ASSERT_EQUAL(30 / DECIMATION, n);
+    TEST_ASSERT_EQUAL(0, adxl343_envelope_process(&env, input, 16, envelope, 0));
+}
+
+void test_invalid_config_is_rejected(void) {
+    adxl343_envelope_t env;
+    adxl343_envelope_config_t bad = config;
+
+    bad.band_high_hz = 1700.0f;
+    TEST_ASSERT_FALSE(adxl343_envelope_init(&env, &bad));
+
+    bad = config;
+    bad.band_low_hz = 1400.0f;
+    TEST_ASSERT_FALSE(adxl343_envelope_init(&env, &bad));
+
+    bad = config;
+    bad.lowpass_hz = 450.0f;
+    TEST_ASSERT_FALSE(adxl343_envelope_init(&env, &bad));
+
+    bad = config;
+    bad.decimation = 0;
+    TEST_ASSERT_FALSE(adxl343_envelope_init(&env, &bad));
+
+    bad = config;
+    bad.axis = 3;
+    TEST_ASSERT_FALSE(adxl343_envelope_init(&env, &bad));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_fault_rate_dominates_envelope_spectrum);
+    RUN_TEST(test_healthy_bearing_has_no_defect_line);
+    RUN_TEST(test_out_of_band_tone_is_rejected);
+    RUN_TEST(test_in_band_tone_envelope_tracks_amplitude);
+    RUN_TEST(test_decimation_phase_carries_across_blocks);
+    RUN_TEST(test_invalid_config_is_rejected);
+    return UNITY_END();
+}
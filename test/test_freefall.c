@@ -0,0 +1,230 @@
+#include "unity.h"
+#include "ADXL343_freefall.h"
+#include "adxl343_sim.h"
+
+#define BUS_HZ 400000.0
+#define RELEASE_S 0.5
+
+// The host sleeps until INT1 while armed and, while capturing, also wakes
+// on a 5 ms tick; the virtual clock runs in 50 us steps meanwhile and
+// every transfer costs its wire time at 400 kHz.
+static adxl343_sim_t sim;
+static adxl343_sim_bus_t bus;
+static adxl343_dev_t dev;
+static adxl343_sim_drop_t drop;
+static adxl343_freefall_t ff;
+static adxl343_freefall_config_t config;
+
+static uint64_t clock_ns(void *ctx) {
+    return ((const adxl343_sim_t *)ctx)->now_ns;
+}
+
+static double now_s(void) {
+    return (double)sim.now_ns / 1e9;
+}
+
+// Service on every wake-up until a drop completes or `end_s` passes
+static int run_until(double end_s) {
+    while (now_s() < end_s) {
+        uint64_t tick = sim.now_ns + 5000000u;
+        while (!adxl343_sim_int_pin(&sim, 1) && now_s() < end_s &&
+               (ff.state == ADXL343_FREEFALL_ARMED || sim.now_ns < tick)) {
+            adxl343_sim_advance_us(&sim, 50);
+        }
+        int status = adxl343_freefall_service(&ff);
+        if (status != 0) {
+            return status;
+        }
+    }
+    return 0;
+}
+
+// Released at RELEASE_S, `fall_s` weightless, then a 12 g, 5 ms impact on Z
+static void drop_for(double fall_s) {
+    drop = (adxl343_sim_drop_t){
+        .rest_mg = {0.0, 0.0, 1000.0},
+        .release_s = RELEASE_S,
+        .fall_s = fall_s,
+        .impact_mg = {0.0, 0.0, 12000.0},
+        .impact_s = 0.005,
+    };
+}
+
+void setUp(void) {
+    adxl343_sim_init(&sim, ADXL343_ADDRESS);
+    drop_for(0.4515);
+    adxl343_sim_set_source(&sim, adxl343_sim_drop, &drop);
+    adxl343_sim_bus_init(&bus);
+    adxl343_sim_bus_attach(&bus, &sim);
+    bus.clock_hz = BUS_HZ;
+    adxl343_dev_set_bus(&dev, &bus.bus, ADXL343_ADDRESS);
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_dev_init(&dev));
+
+    // 437 mg for 100 ms armed at 100 Hz; impacts over 2 g at 1600 Hz
+    config = (adxl343_freefall_config_t){
+        .threshold = 7,
+        .time = 20,
+        .armed_rate = ADXL343_RATE_100HZ,
+        .capture_rate = ADXL343_RATE_1600HZ,
+        .impact = {.pre = 64, .post = 64, .threshold = 32,
+                   .axes = ADXL343_ACT_X | ADXL343_ACT_Y | ADXL343_ACT_Z},
+        .timeout_ms = 2000,
+        .clock = clock_ns,
+        .clock_ctx = &sim,
+    };
+}
+
+void tearDown(void) {}
+
+void test_one_metre_drop(void) {
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_freefall_init(&ff, &dev, &config));
+    TEST_ASSERT_EQUAL_HEX8(ADXL343_RATE_100HZ, sim.regs[ADXL343_REG_BW_RATE]);
+    TEST_ASSERT_EQUAL_HEX8(ADXL343_INT_FREE_FALL, sim.regs[ADXL343_REG_INT_ENABLE]);
+
+    TEST_ASSERT_EQUAL(1, run_until(2.0));
+    TEST_ASSERT_EQUAL(1, ff.drops);
+    TEST_ASSERT_FALSE(ff.timing_lost);
+
+    // Start within half an armed period, impact within one capture period
+    double impact_s = RELEASE_S + drop.fall_s;
+    TEST_ASSERT_FLOAT_WITHIN(0.0055, RELEASE_S, (double)ff.start_ns / 1e9);
+    TEST_ASSERT_FLOAT_WITHIN(0.0007, impact_s, (double)ff.impact_ns / 1e9);
+    TEST_ASSERT_INT_WITHIN(6000, 451500, ff.fall_us);
+
+    // The end of the fall, then the impact at full rate
+    const adxl343_shock_record_t *r = ff.record;
+    TEST_ASSERT_NOT_NULL(r);
+    TEST_ASSERT_EQUAL(64, r->pre);
+    TEST_ASSERT_EQUAL(128, r->count);
+    for (int i = 0; i < r->pre; i++) {
+        TEST_ASSERT_INT_WITHIN(2, 0, r->samples[i].z);
+    }
+    int over = 0;
+    int16_t peak = 0;
+    for (int i = r->pre; i < r->count; i++) {
+        over += r->samples[i].z > 512;
+        peak = r->samples[i].z > peak ? r->samples[i].z : peak;
+    }
+    TEST_ASSERT_TRUE(r->samples[r->pre].z > 512);
+    TEST_ASSERT_TRUE(over >= 6);
+    TEST_ASSERT_INT_WITHIN(40, 13 * 256, peak);
+
+    // Armed again
+    TEST_ASSERT_EQUAL(ADXL343_FREEFALL_ARMED, ff.state);
+    TEST_ASSERT_EQUAL_HEX8(ADXL343_RATE_100HZ, sim.regs[ADXL343_REG_BW_RATE]);
+    TEST_ASSERT_EQUAL_HEX8(ADXL343_INT_FREE_FALL, sim.regs[ADXL343_REG_INT_ENABLE]);
+    TEST_ASSERT_EQUAL_HEX8(ADXL343_FIFO_BYPASS, sim.regs[ADXL343_REG_FIFO_CTL]);
+}
+
+void test_fall_duration_across_heights(void) {
+    // 0.2 m to 2 m at different phases to the sample clock, armed at
+    // 100 Hz and then at 400 Hz
+    static const double falls[] = {0.202, 0.319, 0.4515, 0.553, 0.639};
+    static const adxl343_rate_t armed[] = {ADXL343_RATE_100HZ, ADXL343_RATE_400HZ};
+    static const uint32_t tolerance_us[] = {6000, 2000};
+
+    for (size_t a = 0; a < 2; a++) {
+        for (size_t f = 0; f < sizeof(falls) / sizeof(falls[0]); f++) {
+            setUp();
+            drop_for(falls[f]);
+            drop.release_s += 0.0021 * (double)f;
+            config.armed_rate = armed[a];
+            TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_freefall_init(&ff, &dev, &config));
+            TEST_ASSERT_EQUAL(1, run_until(2.0));
+            TEST_ASSERT_INT_WITHIN(tolerance_us[a], (uint32_t)(falls[f] * 1e6), ff.fall_us);
+            TEST_ASSERT_FLOAT_WITHIN(0.0007, drop.release_s + falls[f], (double)ff.impact_ns / 1e9);
+        }
+    }
+}
+
+void test_short_dip_is_not_a_fall(void) {
+    // Weightless for 60 ms, under TIME_FF
+    drop_for(0.06);
+    drop.impact_mg[2] = 3000.0;
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_freefall_init(&ff, &dev, &config));
+    TEST_ASSERT_EQUAL(0, run_until(1.5));
+    TEST_ASSERT_EQUAL(ADXL343_FREEFALL_ARMED, ff.state);
+    TEST_ASSERT_EQUAL_HEX8(ADXL343_RATE_100HZ, sim.regs[ADXL343_REG_BW_RATE]);
+    TEST_ASSERT_EQUAL(0, ff.drops);
+}
+
+void test_caught_fall_times_out_and_rearms(void) {
+    // Caught without an impact over 2 g
+    drop_for(0.3);
+    drop.impact_mg[2] = 500.0;
+    config.timeout_ms = 500;
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_freefall_init(&ff, &dev, &config));
+    TEST_ASSERT_EQUAL(0, run_until(1.5));
+    TEST_ASSERT_EQUAL(1, ff.missed);
+    TEST_ASSERT_EQUAL(0, ff.drops);
+    TEST_ASSERT_NULL(ff.record);
+    TEST_ASSERT_EQUAL(ADXL343_FREEFALL_ARMED, ff.state);
+    TEST_ASSERT_EQUAL_HEX8(ADXL343_RATE_100HZ, sim.regs[ADXL343_REG_BW_RATE]);
+
+    // and catches the next one
+    drop.release_s = 2.0;
+    drop.impact_mg[2] = 12000.0;
+    TEST_ASSERT_EQUAL(1, run_until(3.0));
+    TEST_ASSERT_INT_WITHIN(6000, 300000, ff.fall_us);
+}
+
+void test_second_sensor_logs_its_own_drops(void) {
+    // The logger runs on a second sensor; the first one is left alone
+    adxl343_sim_t alt;
+    adxl343_dev_t alt_dev;
+    uint8_t bw_rate = sim.regs[ADXL343_REG_BW_RATE];
+    uint8_t int_enable = sim.regs[ADXL343_REG_INT_ENABLE];
+    uint8_t fifo_ctl = sim.regs[ADXL343_REG_FIFO_CTL];
+    adxl343_sim_init(&alt, ADXL343_ADDRESS_ALT);
+    adxl343_sim_set_source(&alt, adxl343_sim_drop, &drop);
+    adxl343_sim_bus_attach(&bus, &alt);
+    adxl343_dev_set_bus(&alt_dev, &bus.bus, ADXL343_ADDRESS_ALT);
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_dev_init(&alt_dev));
+    config.clock_ctx = &alt;
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_freefall_init(&ff, &alt_dev, &config));
+
+    int status = 0;
+    uint64_t tick = 0;
+    while (status == 0 && (double)alt.now_ns / 1e9 < 2.0) {
+        adxl343_sim_advance_us(&alt, 50);
+        bool due = ff.state == ADXL343_FREEFALL_CAPTURING && alt.now_ns >= tick;
+        if (adxl343_sim_int_pin(&alt, 1) || due) {
+            status = adxl343_freefall_service(&ff);
+            tick = alt.now_ns + 5000000u;
+        }
+    }
+
+    TEST_ASSERT_EQUAL(1, status);
+    TEST_ASSERT_EQUAL(1, ff.drops);
+    TEST_ASSERT_INT_WITHIN(6000, 451500, ff.fall_us);
+    TEST_ASSERT_EQUAL_HEX8(ADXL343_INT_FREE_FALL, alt.regs[ADXL343_REG_INT_ENABLE]);
+    TEST_ASSERT_EQUAL_HEX8(bw_rate, sim.regs[ADXL343_REG_BW_RATE]);
+    TEST_ASSERT_EQUAL_HEX8(int_enable, sim.regs[ADXL343_REG_INT_ENABLE]);
+    TEST_ASSERT_EQUAL_HEX8(fifo_ctl, sim.regs[ADXL343_REG_FIFO_CTL]);
+}
+
+void test_invalid_config_is_rejected(void) {
+    adxl343_freefall_config_t bad = config;
+    bad.time = 0;
+    TEST_ASSERT_EQUAL(ADXL343_ERROR_ARGUMENT, adxl343_freefall_init(&ff, &dev, &bad));
+    bad = config;
+    bad.capture_rate = ADXL343_RATE_100HZ;
+    TEST_ASSERT_EQUAL(ADXL343_ERROR_ARGUMENT, adxl343_freefall_init(&ff, &dev, &bad));
+    bad = config;
+    bad.clock = NULL;
+    TEST_ASSERT_EQUAL(ADXL343_ERROR_ARGUMENT, adxl343_freefall_init(&ff, &dev, &bad));
+    bad = config;
+    bad.impact.post = 0;
+    TEST_ASSERT_EQUAL(ADXL343_ERROR_ARGUMENT, adxl343_freefall_init(&ff, &dev, &bad));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_one_metre_drop);
+    RUN_TEST(test_fall_duration_across_heights);
+    RUN_TEST(test_short_dip_is_not_a_fall);
+    RUN_TEST(test_caught_fall_times_out_and_rearms);
+    RUN_TEST(test_second_sensor_logs_its_own_drops);
+    RUN_TEST(test_invalid_config_is_rejected);
+    return UNITY_END();
+}
@@ -0,0 +1,211 @@
+#include <math.h>
+#include <string.h>
+
+#include "unity.h"
+#include "ADXL343_governor.h"
+#include "adxl343_sim.h"
+
+// X carries the BW_RATE code the sample was taken at so the rate reported
+// with each batch can be checked; Z vibrates during the motion windows.
+static adxl343_sim_t sim;
+static adxl343_sim_bus_t bus;
+static adxl343_dev_t dev;
+static adxl343_governor_t gov;
+static adxl343_sample_t batch[64];
+
+static uint64_t returned;
+static uint64_t mistagged;
+
+static bool moving(double t) {
+    return (t >= 5.0 && t < 7.0) || (t >= 20.0 && t < 21.0);
+}
+
+static void source(void *ctx, double t, double mg[3]) {
+    const adxl343_sim_t *s = (const adxl343_sim_t *)ctx;
+    mg[0] = (s->regs[ADXL343_REG_BW_RATE] & ADXL343_BW_RATE_MASK) * 1000.0 / 256.0;
+    mg[1] = 0.0;
+    mg[2] = 1000.0 + (moving(t) ? 600.0 * sin(2.0 * M_PI * 30.0 * t) : 0.0);
+}
+
+static const adxl343_governor_config_t config = {
+    .active_rate = ADXL343_RATE_800HZ,
+    .idle_rate = ADXL343_RATE_12_5HZ,
+    .threshold_act = 4,
+    .threshold_inact = 2,
+    .time_inact = 2,
+    .axes = ADXL343_ACT_AC | ADXL343_ACT_X | ADXL343_ACT_Y | ADXL343_ACT_Z |
+            ADXL343_INACT_AC | ADXL343_INACT_X | ADXL343_INACT_Y | ADXL343_INACT_Z,
+    .watermark = 16,
+};
+
+void setUp(void) {
+    returned = 0;
+    mistagged = 0;
+    adxl343_sim_init(&sim, ADXL343_ADDRESS);
+    adxl343_sim_set_source(&sim, source, &sim);
+    adxl343_sim_bus_init(&bus);
+    adxl343_sim_bus_attach(&bus, &sim);
+    adxl343_dev_set_bus(&dev, &bus.bus, ADXL343_ADDRESS);
+
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_dev_init(&dev));
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_governor_init(&gov, &dev, &config));
+}
+
+void tearDown(void) {
+}
+
+static void service(void) {
+    adxl343_rate_t rate;
+    int n = adxl343_governor_service(&gov, batch, sizeof(batch) / sizeof(batch[0]), &rate);
+    TEST_ASSERT_TRUE(n >= 0);
+
+    for (int i = 0; i < n; i++) {
+        if (batch[i].x != (int16_t)rate) {
+            mistagged++;
+        }
+    }
+    returned += (uint64_t)n;
+}
+
+// Advance in 1 ms steps, servicing whenever INT1 is raised, until `until`
+// seconds. Returns the first time the governor reports `rate`, or -1.
+static double run_until(double until, adxl343_rate_t rate) {
+    double seen = -1.0;
+    while ((double)sim.now_ns / 1e9 < until) {
+        adxl343_sim_advance_us(&sim, 1000);
+        if (adxl343_sim_int_pin(&sim, 1)) {
+            service();
+        }
+        if (seen < 0.0 && gov.rate == rate) {
+            seen = (double)sim.now_ns / 1e9;
+        }
+    }
+    return seen;
+}
+
+void test_quiet_sensor_drops_to_idle_rate(void) {
+    TEST_ASSERT_EQUAL(ADXL343_RATE_800HZ, gov.rate);
+
+    double idle_at = run_until(4.0, ADXL343_RATE_12_5HZ);
+
+    TEST_ASSERT_FLOAT_WITHIN(0.05, 2.0, idle_at);
+    uint8_t bw;
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_dev_read_reg(&dev, ADXL343_REG_BW_RATE, &bw));
+    TEST_ASSERT_EQUAL(ADXL343_RATE_12_5HZ, bw);
+    TEST_ASSERT_TRUE(gov.idle);
+}
+
+void test_motion_ramps_back_to_active_rate(void) {
+    run_until(4.9, ADXL343_RATE_12_5HZ);
+    TEST_ASSERT_EQUAL(ADXL343_RATE_12_5HZ, gov.rate);
+
+    // Detected on the first idle-rate sample of the motion
+    double active_at = run_until(6.0, ADXL343_RATE_800HZ);
+    TEST_ASSERT_TRUE(active_at >= 5.0);
+    TEST_ASSERT_TRUE(active_at <= 5.0 + 1.0 / 12.5 + 0.002);
+
+    // Back to idle TIME_INACT after the motion stops
+    double idle_at = run_until(10.0, ADXL343_RATE_12_5HZ);
+    TEST_ASSERT_FLOAT_WITHIN(0.05, 9.0, idle_at);
+}
+
+void test_no_samples_dropped_across_switches(void) {
+    run_until(25.0, ADXL343_RATE_3200HZ);
+
+    // idle, active, idle, active, idle
+    TEST_ASSERT_EQUAL(5, gov.switches);
+    TEST_ASSERT_EQUAL_UINT64(sim.samples, returned + sim.fifo_count);
+    TEST_ASSERT_EQUAL_UINT64(0, mistagged);
+}
+
+void test_switch_waits_for_fifo_to_drain(void) {
+    run_until(2.5, ADXL343_RATE_3200HZ);
+    TEST_ASSERT_EQUAL(ADXL343_RATE_12_5HZ, gov.rate);
+    uint32_t switches = gov.switches;
+
+    // Motion while the FIFO holds old-rate samples and only two fit per call
+    adxl343_sim_advance_us(&sim, 5500000 - sim.now_ns / 1000);
+    adxl343_rate_t rate;
+    int n = adxl343_governor_service(&gov, batch, 2, &rate);
+    TEST_ASSERT_EQUAL(2, n);
+    TEST_ASSERT_EQUAL(ADXL343_RATE_12_5HZ, rate);
+    TEST_ASSERT_EQUAL(switches, gov.switches);
+    TEST_ASSERT_TRUE(gov.pending);
+
+    while (gov.pending) {
+        n = adxl343_governor_service(&gov, batch, 2, &rate);
+        TEST_ASSERT_TRUE(n >= 0);
+        TEST_ASSERT_EQUAL(ADXL343_RATE_12_5HZ, rate);
+        for (int i = 0; i < n; i++) {
+            TEST_ASSERT_EQUAL(ADXL343_RATE_12_5HZ, batch[i].x);
+        }
+    }
+    TEST_ASSERT_EQUAL(ADXL343_RATE_800HZ, gov.rate);
+}
+
+// Quiet long enough for inactivity, then moving from 2.5 s on
+static void late_motion(void *ctx, double t, double mg[3]) {
+    source(ctx, t, mg);
+    if (t >= 2.5) {
+        mg[2] = 1000.0 + 600.0 * sin(2.0 * M_PI * 30.0 * t);
+    }
+}
+
+void test_round_trip_between_services_keeps_state(void) {
+    adxl343_sim_set_source(&sim, late_motion, &sim);
+
+    // Inactivity at 2 s and activity at 2.5 s are both latched by the
+    // first service at 3 s
+    adxl343_sim_advance_us(&sim, 3000000);
+    TEST_ASSERT_TRUE(adxl343_sim_int_pin(&sim, 1));
+    service();
+    TEST_ASSERT_FALSE(gov.idle);
+    TEST_ASSERT_FALSE(gov.pending);
+
+    run_until(4.0, ADXL343_RATE_12_5HZ);
+    TEST_ASSERT_EQUAL(ADXL343_RATE_800HZ, gov.rate);
+    TEST_ASSERT_EQUAL(0, gov.switches);
+}
+
+void test_second_sensor_is_governed_on_its_own(void) {
+    adxl343_sim_t alt;
+    adxl343_dev_t alt_dev;
+    adxl343_sim_init(&alt, ADXL343_ADDRESS_ALT);
+    adxl343_sim_set_source(&alt, source, &alt);
+    adxl343_sim_bus_attach(&bus, &alt);
+    adxl343_dev_set_bus(&alt_dev, &bus.bus, ADXL343_ADDRESS_ALT);
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_dev_init(&alt_dev));
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_governor_init(&gov, &alt_dev, &config));
+
+    // The quiet second sensor drops to the idle rate; the first keeps its own
+    while ((double)alt.now_ns / 1e9 < 3.0) {
+        adxl343_sim_advance_us(&alt, 1000);
+        if (adxl343_sim_int_pin(&alt, 1)) {
+            adxl343_rate_t rate;
+            TEST_ASSERT_TRUE(adxl343_governor_service(&gov, batch, sizeof(batch) / sizeof(batch[0]), &rate) >= 0);
+        }
+    }
+    TEST_ASSERT_EQUAL(1, gov.switches);
+    TEST_ASSERT_EQUAL_HEX8(ADXL343_RATE_12_5HZ, alt.regs[ADXL343_REG_BW_RATE]);
+    TEST_ASSERT_EQUAL_HEX8(ADXL343_RATE_800HZ, sim.regs[ADXL343_REG_BW_RATE]);
+}
+
+void test_invalid_config_is_rejected(void) {
+    adxl343_governor_config_t bad = config;
+    bad.watermark = 0;
+    TEST_ASSERT_EQUAL(ADXL343_ERROR_ARGUMENT, adxl343_governor_init(&gov, &dev, &bad));
+    bad.watermark = 32;
+    TEST_ASSERT_EQUAL(ADXL343_ERROR_ARGUMENT, adxl343_governor_init(&gov, &dev, &bad));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_quiet_sensor_drops_to_idle_rate);
+    RUN_TEST(test_motion_ramps_back_to_active_rate);
+    RUN_TEST(test_no_samples_dropped_across_switches);
+    RUN_TEST(test_switch_waits_for_fifo_to_drain);
+    RUN_TEST(test_round_trip_between_services_keeps_state);
+    RUN_TEST(test_second_sensor_is_governed_on_its_own);
+    RUN_TEST(test_invalid_config_is_rejected);
+    return UNITY_END();
+}
@@ -0,0 +1,182 @@
+#include <math.h>
+
+#include "unity.h"
+#include "ADXL343_group.h"
+#include "adxl343_sim.h"
+
+// Each sensor reports its own sample counter on X, so gaps and reordering
+// show up as a step other than one between consecutive samples.
+#define COUNTER_WRAP 1000
+
+typedef struct {
+    double odr_hz;
+} counter_t;
+
+typedef struct {
+    int16_t last[2];
+    size_t received[2];
+    size_t gaps;
+    size_t calls;
+    size_t order[16];
+} sink_t;
+
+static adxl343_sim_t sims[2];
+static counter_t counters[2];
+static adxl343_sim_bus_t bus;
+static adxl343_dev_t devs[2];
+static adxl343_group_t group;
+static sink_t sink;
+
+static void counter_source(void *ctx, double t, double mg[3]) {
+    const counter_t *counter = ctx;
+    double k = floor(t * counter->odr_hz + 0.5);
+    mg[0] = fmod(k, COUNTER_WRAP) * 1000.0 / 256.0;
+    mg[1] = 0.0;
+    mg[2] = 1000.0;
+}
+
+static void record(void *ctx, size_t index, const adxl343_sample_t *samples, size_t count) {
+    sink_t *s = ctx;
+    if (s->calls < sizeof(s->order) / sizeof(s->order[0])) {
+        s->order[s->calls] = index;
+    }
+    s->calls++;
+
+    for (size_t i = 0; i < count; i++) {
+        if (s->received[index] > 0 && samples[i].x != (s->last[index] + 1) % COUNTER_WRAP) {
+            s->gaps++;
+        }
+        s->last[index] = samples[i].x;
+        s->received[index]++;
+    }
+}
+
+static void advance_us(uint64_t us) {
+    adxl343_sim_advance_us(&sims[0], us);
+    adxl343_sim_advance_us(&sims[1], us);
+}
+
+static void start(adxl343_dev_t *dev, adxl343_rate_t rate) {
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_dev_init(dev));
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_dev_write_reg(dev, ADXL343_REG_POWER_CTL, 0));
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_dev_write_reg(dev, ADXL343_REG_BW_RATE, rate));
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_dev_write_reg(dev, ADXL343_REG_FIFO_CTL, ADXL343_FIFO_STREAM | 16));
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_dev_write_reg(dev, ADXL343_REG_POWER_CTL, ADXL343_POWER_MEASURE));
+}
+
+void setUp(void) {
+    const uint8_t addresses[2] = {ADXL343_ADDRESS, ADXL343_ADDRESS_ALT};
+
+    adxl343_sim_bus_init(&bus);
+    bus.clock_hz = 400000.0;
+    adxl343_group_init(&group);
+    sink = (sink_t){0};
+
+    for (int i = 0; i < 2; i++) {
+        adxl343_sim_init(&sims[i], addresses[i]);
+        adxl343_sim_set_source(&sims[i], counter_source, &counters[i]);
+        adxl343_sim_bus_attach(&bus, &sims[i]);
+        adxl343_dev_set_bus(&devs[i], &bus.bus, addresses[i]);
+    }
+}
+
+void tearDown(void) {
+}
+
+void test_devices_are_independent(void) {
+    start(&devs[0], ADXL343_RATE_800HZ);
+    start(&devs[1], ADXL343_RATE_200HZ);
+
+    TEST_ASSERT_EQUAL_HEX8(ADXL343_RATE_800HZ, sims[0].regs[ADXL343_REG_BW_RATE]);
+    TEST_ASSERT_EQUAL_HEX8(ADXL343_RATE_200HZ, sims[1].regs[ADXL343_REG_BW_RATE]);
+
+    uint8_t rate;
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_dev_read_reg(&devs[1], ADXL343_REG_BW_RATE, &rate));
+    TEST_ASSERT_EQUAL_HEX8(ADXL343_RATE_200HZ, rate);
+
+    adxl343_dev_t missing;
+    adxl343_dev_set_bus(&missing, &bus.bus, 0x2A);
+    TEST_ASSERT_EQUAL(ADXL343_ERROR_BUS, adxl343_dev_init(&missing));
+}
+
+void test_add_rejects_duplicates_and_overflow(void) {
+    TEST_ASSERT_EQUAL(0, adxl343_group_add(&group, &devs[0]));
+    TEST_ASSERT_EQUAL(1, adxl343_group_add(&group, &devs[1]));
+
+    adxl343_dev_t same = devs[1];
+    TEST_ASSERT_EQUAL(ADXL343_ERROR_ARGUMENT, adxl343_group_add(&group, &same));
+
+    adxl343_dev_t others[2];
+    adxl343_dev_set_bus(&others[0], &bus.bus, 0x10);
+    adxl343_dev_set_bus(&others[1], &bus.bus, 0x11);
+    TEST_ASSERT_EQUAL(2, adxl343_group_add(&group, &others[0]));
+    TEST_ASSERT_EQUAL(3, adxl343_group_add(&group, &others[1]));
+    TEST_ASSERT_EQUAL(ADXL343_ERROR_ARGUMENT, adxl343_group_add(&group, &same));
+}
+
+void test_fuller_fifo_is_drained_first(void) {
+    counters[0].odr_hz = 100.0;
+    counters[1].odr_hz = 800.0;
+    start(&devs[0], ADXL343_RATE_100HZ);
+    start(&devs[1], ADXL343_RATE_800HZ);
+    adxl343_group_add(&group, &devs[0]);
+    adxl343_group_add(&group, &devs[1]);
+
+    // 3 entries on the first sensor, 24 on the second
+    advance_us(30000);
+    TEST_ASSERT_TRUE(adxl343_group_service(&group, record, &sink) > 0);
+    TEST_ASSERT_EQUAL(1, sink.order[0]);
+    TEST_ASSERT_EQUAL(0, sink.gaps);
+}
+
+void test_drains_interleave(void) {
+    counters[0].odr_hz = 800.0;
+    counters[1].odr_hz = 800.0;
+    start(&devs[0], ADXL343_RATE_800HZ);
+    start(&devs[1], ADXL343_RATE_800HZ);
+    adxl343_group_add(&group, &devs[0]);
+    adxl343_group_add(&group, &devs[1]);
+
+    // Both FIFOs hold about 24 entries: chunks alternate rather than one
+    // sensor being emptied while the other keeps filling
+    advance_us(30000);
+    TEST_ASSERT_TRUE(adxl343_group_service(&group, record, &sink) > 0);
+    TEST_ASSERT_TRUE(sink.calls >= 4);
+    TEST_ASSERT_NOT_EQUAL(sink.order[0], sink.order[1]);
+    TEST_ASSERT_NOT_EQUAL(sink.order[1], sink.order[2]);
+    TEST_ASSERT_EQUAL(0, sink.gaps);
+}
+
+void test_paired_sensors_run_without_loss(void) {
+    counters[0].odr_hz = 800.0;
+    counters[1].odr_hz = 400.0;
+    start(&devs[0], ADXL343_RATE_800HZ);
+    start(&devs[1], ADXL343_RATE_400HZ);
+    adxl343_group_add(&group, &devs[0]);
+    adxl343_group_add(&group, &devs[1]);
+
+    // Two seconds serviced every 15 ms, 400 kHz wire time included
+    for (int i = 0; i < 134; i++) {
+        advance_us(15000);
+        TEST_ASSERT_TRUE(adxl343_group_service(&group, record, &sink) >= 0);
+    }
+
+    TEST_ASSERT_EQUAL(0, sink.gaps);
+    TEST_ASSERT_EQUAL(0, group.full[0]);
+    TEST_ASSERT_EQUAL(0, group.full[1]);
+    TEST_ASSERT_FALSE(sims[0].regs[ADXL343_REG_INT_SOURCE] & ADXL343_INT_OVERRUN);
+    TEST_ASSERT_FALSE(sims[1].regs[ADXL343_REG_INT_SOURCE] & ADXL343_INT_OVERRUN);
+    TEST_ASSERT_EQUAL(sims[0].samples - sims[0].fifo_count, sink.received[0]);
+    TEST_ASSERT_EQUAL(sims[1].samples - sims[1].fifo_count, sink.received[1]);
+    TEST_ASSERT_TRUE(sink.received[0] >= 1600);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_devices_are_independent);
+    RUN_TEST(test_add_rejects_duplicates_and_overflow);
+    RUN_TEST(test_fuller_fifo_is_drained_first);
+    RUN_TEST(test_drains_interleave);
+    RUN_TEST(test_paired_sensors_run_without_loss);
+    return UNITY_END();
+}
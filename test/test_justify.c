@@ -0,0 +1,222 @@
+#include <math.h>
+#include <stdlib.h>
+
+#include "unity.h"
+#include "ADXL343_envelope.h"
+#include "ADXL343_stats.h"
+#include "ADXL343_sync.h"
+#include "ADXL343_velocity.h"
+#include "adxl343_sim.h"
+
+#define STAGE_ODR_HZ 3200.0
+#define STAGE_SAMPLES 3200
+#define FULL_RES_16G (ADXL343_FORMAT_FULL_RES | ADXL343_RANGE_16G)
+
+static adxl343_sim_t sim;
+static adxl343_sim_bus_t bus;
+static double level_mg;
+
+static void source(void *ctx, double t, double mg[3]) {
+    (void)ctx;
+    (void)t;
+    mg[0] = level_mg;
+    mg[1] = -level_mg / 3.0;
+    mg[2] = 1000.0;
+}
+
+// The same near full-scale vibration as 13-bit samples and as the sensor's
+// left-justified readings of it
+static adxl343_sample_t right13[STAGE_SAMPLES];
+static adxl343_sample_t left15[STAGE_SAMPLES];
+
+static void fill_stage_input(void) {
+    for (int i = 0; i < STAGE_SAMPLES; i++) {
+        double t = i / STAGE_ODR_HZ;
+        double v = 3000.0 * sin(2.0 * M_PI * 1000.0 * t) * (0.6 + 0.4 * sin(2.0 * M_PI * 37.0 * t));
+        right13[i].x = (int16_t)lround(v + 256.0);
+        right13[i].y = (int16_t)lround(800.0 * sin(2.0 * M_PI * 50.0 * t));
+        right13[i].z = (int16_t)lround(-v / 2.0 - 256.0);
+        left15[i].x = (int16_t)(right13[i].x * 8);
+        left15[i].y = (int16_t)(right13[i].y * 8);
+        left15[i].z = (int16_t)(right13[i].z * 8);
+    }
+}
+
+void setUp(void) {
+    level_mg = 0.0;
+    adxl343_sim_init(&sim, ADXL343_ADDRESS);
+    adxl343_sim_set_source(&sim, source, NULL);
+    adxl343_sim_bus_init(&bus);
+    adxl343_sim_bus_attach(&bus, &sim);
+    adxl343_set_bus(&bus.bus, ADXL343_ADDRESS);
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_init());
+}
+
+void tearDown(void) {
+}
+
+void test_scale_of_left_justified_samples(void) {
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 2000.0f / 32768.0f, adxl343_mg_per_lsb(ADXL343_FORMAT_JUSTIFY | ADXL343_RANGE_2G));
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 16000.0f / 32768.0f,
+                             adxl343_mg_per_lsb(ADXL343_FORMAT_JUSTIFY | ADXL343_FORMAT_FULL_RES | ADXL343_RANGE_16G));
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 1000.0f / 256.0f, adxl343_mg_per_lsb(ADXL343_FORMAT_FULL_RES | ADXL343_RANGE_16G));
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 1000.0f / 32.0f, adxl343_mg_per_lsb(ADXL343_RANGE_16G));
+
+    TEST_ASSERT_EQUAL(0, adxl343_q15_shift(ADXL343_FORMAT_JUSTIFY | ADXL343_RANGE_4G));
+    TEST_ASSERT_EQUAL(6, adxl343_q15_shift(ADXL343_RANGE_16G));
+    TEST_ASSERT_EQUAL(6, adxl343_q15_shift(ADXL343_FORMAT_FULL_RES | ADXL343_RANGE_2G));
+    TEST_ASSERT_EQUAL(4, adxl343_q15_shift(ADXL343_FORMAT_FULL_RES | ADXL343_RANGE_8G));
+    TEST_ASSERT_EQUAL(3, adxl343_q15_shift(ADXL343_FORMAT_FULL_RES | ADXL343_RANGE_16G));
+}
+
+// In every resolution and range, a right-justified sample brought to Q15
+// equals the sensor's own left-justified reading
+void test_right_justified_converts_to_left_justified(void) {
+    for (uint8_t full_res = 0; full_res <= ADXL343_FORMAT_FULL_RES; full_res += ADXL343_FORMAT_FULL_RES) {
+        for (uint8_t range = ADXL343_RANGE_2G; range <= ADXL343_RANGE_16G; range++) {
+            uint8_t format = (uint8_t)(full_res | range);
+            level_mg = 0.7 * 2000.0 * (double)(1 << range);
+
+            adxl343_sample_t right, left;
+            adxl343_write_reg(ADXL343_REG_DATA_FORMAT, format);
+            adxl343_sim_advance_us(&sim, 20000);
+            TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_read_sample(&right));
+            adxl343_write_reg(ADXL343_REG_DATA_FORMAT, (uint8_t)(format | ADXL343_FORMAT_JUSTIFY));
+            adxl343_sim_advance_us(&sim, 20000);
+            TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_read_sample(&left));
+
+            adxl343_to_q15(&right, 1, format);
+            TEST_ASSERT_EQUAL_INT16(left.x, right.x);
+            TEST_ASSERT_EQUAL_INT16(left.y, right.y);
+            TEST_ASSERT_EQUAL_INT16(left.z, right.z);
+
+            // 0.7 of full scale either way
+            TEST_ASSERT_INT_WITHIN(64 << adxl343_q15_shift(format), 22938, left.x);
+            TEST_ASSERT_FLOAT_WITHIN(0.5f * adxl343_mg_per_lsb(format), (float)level_mg,
+                                     (float)left.x * adxl343_mg_per_lsb((uint8_t)(format | ADXL343_FORMAT_JUSTIFY)));
+
+            adxl343_to_q15(&left, 1, (uint8_t)(format | ADXL343_FORMAT_JUSTIFY));
+            TEST_ASSERT_EQUAL_INT16(right.x, left.x);
+        }
+    }
+}
+
+// Frames interpolated between full-scale Q15 samples of opposite sign come
+// out between them; y carries the same signal at 13 bits as a reference
+void test_sync_interpolates_full_scale_steps(void) {
+    adxl343_sync_t sync;
+    adxl343_frame_t frames[16];
+    adxl343_sample_t block[8];
+
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_sync_init(&sync, 500.0f));
+    TEST_ASSERT_EQUAL(0, adxl343_sync_add(&sync, 800.0f));
+
+    size_t checked = 0;
+    uint64_t k = 0;
+    for (int b = 0; b < 400; b++) {
+        for (size_t i = 0; i < 8; i++, k++) {
+            block[i].x = (k & 1) ? INT16_MAX : INT16_MIN;
+            block[i].y = (k & 1) ? 4095 : -4096;
+            block[i].z = 0;
+        }
+        uint64_t now_ns = (k - 1) * 1250000ull + 20000;
+        TEST_ASSERT_EQUAL(8, adxl343_sync_push(&sync, 0, block, 8, now_ns));
+
+        size_t n;
+        while ((n = adxl343_sync_frames(&sync, frames, 16)) > 0) {
+            for (size_t i = 0; i < n; i++) {
+                TEST_ASSERT_INT_WITHIN(16, frames[i].channels[0].y * 8, frames[i].channels[0].x);
+                checked++;
+            }
+        }
+    }
+    TEST_ASSERT_TRUE(checked > 1000);
+}
+
+// The fixed-point stages take Q15 input in its own LSBs
+void test_stats_of_left_justified_samples(void) {
+    adxl343_stats_t stats;
+    adxl343_stats_report_t right, left;
+    fill_stage_input();
+
+    adxl343_stats_init(&stats, STAGE_SAMPLES);
+    TEST_ASSERT_EQUAL(STAGE_SAMPLES, adxl343_stats_add(&stats, right13, STAGE_SAMPLES));
+    TEST_ASSERT_TRUE(adxl343_stats_finish(&stats, &right));
+    adxl343_stats_set_format(&stats, ADXL343_FORMAT_JUSTIFY | FULL_RES_16G);
+    TEST_ASSERT_EQUAL(STAGE_SAMPLES, adxl343_stats_add(&stats, left15, STAGE_SAMPLES));
+    TEST_ASSERT_TRUE(adxl343_stats_finish(&stats, &left));
+
+    for (int a = 0; a < 3; a++) {
+        TEST_ASSERT_FLOAT_WITHIN(0.01f, right.axis[a].mean * 8.0f, left.axis[a].mean);
+        TEST_ASSERT_FLOAT_WITHIN(0.01f, right.axis[a].rms * 8.0f, left.axis[a].rms);
+        TEST_ASSERT_FLOAT_WITHIN(0.01f, right.axis[a].peak * 8.0f, left.axis[a].peak);
+        TEST_ASSERT_FLOAT_WITHIN(1e-4f, right.axis[a].kurtosis, left.axis[a].kurtosis);
+    }
+    TEST_ASSERT_TRUE(left.axis[0].rms > 10000.0f);
+}
+
+void test_velocity_of_left_justified_samples(void) {
+    adxl343_velocity_t right, left;
+    adxl343_velocity_report_t right_report, left_report;
+    fill_stage_input();
+
+    adxl343_velocity_config_t config = {
+        .odr_hz = (float)STAGE_ODR_HZ,
+        .highpass_hz = 10.0f,
+        .window = STAGE_SAMPLES,
+        .data_format = FULL_RES_16G,
+    };
+    TEST_ASSERT_TRUE(adxl343_velocity_init(&right, &config));
+    config.data_format |= ADXL343_FORMAT_JUSTIFY;
+    TEST_ASSERT_TRUE(adxl343_velocity_init(&left, &config));
+
+    TEST_ASSERT_EQUAL(STAGE_SAMPLES, adxl343_velocity_add(&right, right13, STAGE_SAMPLES));
+    TEST_ASSERT_EQUAL(STAGE_SAMPLES, adxl343_velocity_add(&left, left15, STAGE_SAMPLES));
+    TEST_ASSERT_TRUE(adxl343_velocity_finish(&right, &right_report));
+    TEST_ASSERT_TRUE(adxl343_velocity_finish(&left, &left_report));
+
+    for (int a = 0; a < 3; a++) {
+        TEST_ASSERT_TRUE(right_report.rms_mm_s[a] > 1.0f);
+        TEST_ASSERT_FLOAT_WITHIN(right_report.rms_mm_s[a] * 1e-5f, right_report.rms_mm_s[a], left_report.rms_mm_s[a]);
+    }
+}
+
+void test_envelope_of_left_justified_samples(void) {
+    static int16_t right[STAGE_SAMPLES / 4 + 1];
+    static int16_t left[STAGE_SAMPLES / 4 + 1];
+    adxl343_envelope_t env;
+    fill_stage_input();
+
+    adxl343_envelope_config_t config = {
+        .odr_hz = (float)STAGE_ODR_HZ,
+        .band_low_hz = 700.0f,
+        .band_high_hz = 1300.0f,
+        .lowpass_hz = 300.0f,
+        .decimation = 4,
+        .axis = 0,
+        .data_format = FULL_RES_16G,
+    };
+    TEST_ASSERT_TRUE(adxl343_envelope_init(&env, &config));
+    size_t n = adxl343_envelope_process(&env, right13, STAGE_SAMPLES, right, STAGE_SAMPLES / 4 + 1);
+    config.data_format |= ADXL343_FORMAT_JUSTIFY;
+    TEST_ASSERT_TRUE(adxl343_envelope_init(&env, &config));
+    TEST_ASSERT_EQUAL(n, adxl343_envelope_process(&env, left15, STAGE_SAMPLES, left, STAGE_SAMPLES / 4 + 1));
+
+    int16_t peak = 0;
+    for (size_t i = 0; i < n; i++) {
+        TEST_ASSERT_EQUAL_INT16(right[i] * 8, left[i]);
+        peak = left[i] > peak ? left[i] : peak;
+    }
+    TEST_ASSERT_TRUE(peak > 8 * 1000);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_scale_of_left_justified_samples);
+    RUN_TEST(test_right_justified_converts_to_left_justified);
+    RUN_TEST(test_sync_interpolates_full_scale_steps);
+    RUN_TEST(test_stats_of_left_justified_samples);
+    RUN_TEST(test_velocity_of_left_justified_samples);
+    RUN_TEST(test_envelope_of_left_justified_samples);
+    return UNITY_END();
+}
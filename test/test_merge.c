@@ -0,0 +1,181 @@
+#include "unity.h"
+#include "ADXL343_merge.h"
+#include "adxl343_sim.h"
+
+static adxl343_merge_t merge;
+static adxl343_sample_t block[32];
+
+static void fill(int16_t first, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        block[i] = (adxl343_sample_t){(int16_t)(first + i), 0, 0};
+    }
+}
+
+void setUp(void) {
+    adxl343_merge_init(&merge);
+}
+
+void tearDown(void) {
+}
+
+void test_add_rejects_bad_channels(void) {
+    TEST_ASSERT_EQUAL(ADXL343_ERROR_ARGUMENT, adxl343_merge_add(&merge, 0.0f));
+    for (int i = 0; i < ADXL343_MERGE_MAX_CHANNELS; i++) {
+        TEST_ASSERT_EQUAL(i, adxl343_merge_add(&merge, 100.0f));
+    }
+    TEST_ASSERT_EQUAL(ADXL343_ERROR_ARGUMENT, adxl343_merge_add(&merge, 100.0f));
+    TEST_ASSERT_EQUAL(ADXL343_ERROR_ARGUMENT, adxl343_merge_push(&merge, ADXL343_MERGE_MAX_CHANNELS, block, 1, 0));
+}
+
+void test_stamps_back_from_drain_time(void) {
+    adxl343_merge_add(&merge, 1000.0f);
+    fill(0, 4);
+    TEST_ASSERT_EQUAL(4, adxl343_merge_push(&merge, 0, block, 4, 10000000));
+
+    adxl343_stamped_t out[8];
+    TEST_ASSERT_EQUAL(4, adxl343_merge_pop(&merge, out, 8));
+    TEST_ASSERT_EQUAL_UINT64(7000000, out[0].t_ns);
+    TEST_ASSERT_EQUAL_UINT64(10000000, out[3].t_ns);
+
+    // Later drains continue at the nominal period whatever their jitter
+    fill(4, 2);
+    adxl343_merge_push(&merge, 0, block, 2, 12300000);
+    TEST_ASSERT_EQUAL(2, adxl343_merge_pop(&merge, out, 8));
+    TEST_ASSERT_EQUAL_UINT64(11000000, out[0].t_ns);
+    TEST_ASSERT_EQUAL_UINT64(12000000, out[1].t_ns);
+}
+
+void test_long_gap_reanchors(void) {
+    adxl343_merge_add(&merge, 1000.0f);
+    fill(0, 2);
+    adxl343_merge_push(&merge, 0, block, 2, 2000000);
+    adxl343_merge_push(&merge, 0, block, 2, 500000000);
+
+    adxl343_stamped_t out[4];
+    TEST_ASSERT_EQUAL(4, adxl343_merge_pop(&merge, out, 4));
+    TEST_ASSERT_EQUAL_UINT64(499000000, out[2].t_ns);
+    TEST_ASSERT_EQUAL_UINT64(500000000, out[3].t_ns);
+}
+
+void test_channels_merge_in_time_order(void) {
+    adxl343_merge_add(&merge, 1000.0f);
+    adxl343_merge_add(&merge, 400.0f);
+
+    // 1 kHz channel: 1..20 ms, 400 Hz channel: 2.5..20 ms
+    fill(0, 20);
+    adxl343_merge_push(&merge, 0, block, 20, 20000000);
+    adxl343_stamped_t out[64];
+    TEST_ASSERT_EQUAL(0, adxl343_merge_pop(&merge, out, 64));
+
+    fill(100, 8);
+    adxl343_merge_push(&merge, 1, block, 8, 20000000);
+    TEST_ASSERT_EQUAL(28, adxl343_merge_pop(&merge, out, 64));
+    for (size_t i = 1; i < 28; i++) {
+        TEST_ASSERT_TRUE(out[i].t_ns >= out[i - 1].t_ns);
+    }
+    TEST_ASSERT_EQUAL(0, out[0].channel);
+    TEST_ASSERT_EQUAL(1, out[2].channel);
+    TEST_ASSERT_EQUAL_INT16(100, out[2].sample.x);
+}
+
+void test_pop_stops_at_slowest_channel(void) {
+    adxl343_merge_add(&merge, 1000.0f);
+    adxl343_merge_add(&merge, 1000.0f);
+
+    fill(0, 10);
+    adxl343_merge_push(&merge, 0, block, 10, 10000000);
+    adxl343_merge_push(&merge, 1, block, 5, 5000000);
+
+    adxl343_stamped_t out[32];
+    TEST_ASSERT_EQUAL(10, adxl343_merge_pop(&merge, out, 32));
+    TEST_ASSERT_EQUAL_UINT64(5000000, out[9].t_ns);
+    TEST_ASSERT_EQUAL(5, merge.channels[0].count);
+}
+
+void test_full_ring_counts_drops(void) {
+    adxl343_merge_add(&merge, 1000.0f);
+    adxl343_merge_add(&merge, 1000.0f);
+
+    fill(0, 32);
+    uint64_t now = 0;
+    int queued = 0;
+    for (int i = 0; i < 3; i++) {
+        now += 32000000;
+        queued += adxl343_merge_push(&merge, 0, block, 32, now);
+    }
+    TEST_ASSERT_EQUAL(ADXL343_MERGE_DEPTH, queued);
+    TEST_ASSERT_EQUAL(96 - ADXL343_MERGE_DEPTH, merge.channels[0].dropped);
+}
+
+static void still(void *ctx, double t, double mg[3]) {
+    (void)ctx;
+    (void)t;
+    mg[0] = 0.0;
+    mg[1] = 0.0;
+    mg[2] = 1000.0;
+}
+
+void test_skewed_clocks_stay_on_the_host_clock(void) {
+    // One sensor 1% fast, one 1% slow, drained every 20 ms for 100 s
+    static const double ppm[2] = {10000.0, -10000.0};
+    static const uint8_t addresses[2] = {ADXL343_ADDRESS, ADXL343_ADDRESS_ALT};
+    static adxl343_sim_t sims[2];
+    static adxl343_sim_bus_t bus;
+    adxl343_dev_t devs[2];
+
+    adxl343_sim_bus_init(&bus);
+    for (int i = 0; i < 2; i++) {
+        adxl343_sim_init(&sims[i], addresses[i]);
+        sims[i].clock_ppm = ppm[i];
+        adxl343_sim_set_source(&sims[i], still, NULL);
+        adxl343_sim_bus_attach(&bus, &sims[i]);
+        adxl343_dev_set_bus(&devs[i], &bus.bus, addresses[i]);
+        TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_dev_init(&devs[i]));
+        adxl343_dev_write_reg(&devs[i], ADXL343_REG_BW_RATE, ADXL343_RATE_800HZ);
+        adxl343_dev_write_reg(&devs[i], ADXL343_REG_FIFO_CTL, ADXL343_FIFO_STREAM);
+        TEST_ASSERT_EQUAL(i, adxl343_merge_add(&merge, 800.0f));
+    }
+
+    adxl343_stamped_t out[64];
+    uint64_t last_ns = 0;
+    size_t popped = 0;
+    for (int step = 0; step < 5000; step++) {
+        adxl343_sim_advance_us(&sims[0], 20000);
+        adxl343_sim_advance_us(&sims[1], 20000);
+        uint64_t now_ns = sims[0].now_ns;
+        for (size_t i = 0; i < 2; i++) {
+            int n = adxl343_dev_read_fifo(&devs[i], block, 32);
+            TEST_ASSERT_TRUE(n > 0);
+            TEST_ASSERT_EQUAL(n, adxl343_merge_push(&merge, i, block, (size_t)n, now_ns));
+
+            // Within a block plus a FIFO's worth of periods behind the drain
+            // and never ahead of it
+            uint64_t stamp = merge.channels[i].last_ns;
+            TEST_ASSERT_TRUE(stamp <= now_ns);
+            TEST_ASSERT_TRUE(now_ns - stamp <= 20000000u + 32u * 1250000u);
+        }
+
+        size_t n;
+        while ((n = adxl343_merge_pop(&merge, out, 64)) > 0) {
+            for (size_t i = 0; i < n; i++) {
+                TEST_ASSERT_TRUE(out[i].t_ns >= last_ns);
+                last_ns = out[i].t_ns;
+            }
+            popped += n;
+        }
+    }
+    TEST_ASSERT_TRUE(popped > 100 * 1600 * 98 / 100);
+    TEST_ASSERT_EQUAL(0, merge.channels[0].dropped + merge.channels[1].dropped);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_add_rejects_bad_channels);
+    RUN_TEST(test_stamps_back_from_drain_time);
+    RUN_TEST(test_long_gap_reanchors);
+    RUN_TEST(test_channels_merge_in_time_order);
+    RUN_TEST(test_pop_stops_at_slowest_channel);
+    RUN_TEST(test_full_ring_counts_drops);
+    RUN_TEST(test_skewed_clocks_stay_on_the_host_clock);
+    return UNITY_END();
+}
@@ -0,0 +1,282 @@
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "unity.h"
+#include "ADXL343_offset.h"
+#include "adxl343_sim.h"
+
+// Flat on the bench with a bias injected on every axis and a few mg of
+// dither, so the average has to be taken over many samples.
+static adxl343_sim_t sim;
+static adxl343_sim_bus_t bus;
+static adxl343_dev_t dev;
+static double bias_mg[3];
+static double shake_mg;
+
+static void source(void *ctx, double t, double mg[3]) {
+    (void)ctx;
+    double dither = 6.0 * sin(2.0 * M_PI * 37.0 * t) + shake_mg * sin(2.0 * M_PI * 3.0 * t);
+    mg[0] = bias_mg[0] + dither;
+    mg[1] = bias_mg[1] - dither;
+    mg[2] = 1000.0 + bias_mg[2] + dither;
+}
+
+static const adxl343_offset_config_t config = {
+    .expected_mg = {0, 0, 1000},
+    .samples = 256,
+    .max_spread_mg = 50,
+};
+
+void setUp(void) {
+    memset(bias_mg, 0, sizeof(bias_mg));
+    shake_mg = 0.0;
+    adxl343_sim_init(&sim, ADXL343_ADDRESS);
+    adxl343_sim_set_source(&sim, source, NULL);
+    adxl343_sim_bus_init(&bus);
+    adxl343_sim_bus_attach(&bus, &sim);
+    adxl343_dev_set_bus(&dev, &bus.bus, ADXL343_ADDRESS);
+
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_dev_init(&dev));
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_dev_write_reg(&dev, ADXL343_REG_BW_RATE, ADXL343_RATE_800HZ));
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_dev_write_reg(&dev, ADXL343_REG_FIFO_CTL, ADXL343_FIFO_STREAM));
+}
+
+void tearDown(void) {
+}
+
+// Drain the FIFO every 20 ms into the calibration until it has enough
+static void feed(adxl343_offset_cal_t *cal) {
+    adxl343_sample_t block[ADXL343_FIFO_DEPTH];
+    for (int i = 0; i < 100; i++) {
+        adxl343_sim_advance_us(&sim, 20000);
+        int n = adxl343_dev_read_fifo(&dev, block, ADXL343_FIFO_DEPTH);
+        TEST_ASSERT_TRUE(n >= 0);
+        if (adxl343_offset_feed(cal, block, (size_t)n)) {
+            return;
+        }
+    }
+    TEST_FAIL_MESSAGE("calibration never got enough samples");
+}
+
+static int calibrate(adxl343_offset_t *result) {
+    adxl343_offset_cal_t cal;
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_offset_begin(&cal, &dev, &config));
+    feed(&cal);
+    return adxl343_offset_finish(&cal, result);
+}
+
+// Average reading of 256 fresh samples in mg, after the residual
+// correction when `offset` is given
+static void measure(const adxl343_offset_t *offset, double mg[3]) {
+    adxl343_sample_t block[ADXL343_FIFO_DEPTH];
+    double sum[3] = {0.0, 0.0, 0.0};
+    uint8_t format;
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_dev_read_reg(&dev, ADXL343_REG_DATA_FORMAT, &format));
+
+    adxl343_dev_read_fifo(&dev, block, ADXL343_FIFO_DEPTH);
+    for (int b = 0; b < 8; b++) {
+        adxl343_sim_advance_us(&sim, 40000);
+        TEST_ASSERT_EQUAL(ADXL343_FIFO_DEPTH, adxl343_dev_read_fifo(&dev, block, ADXL343_FIFO_DEPTH));
+        if (offset != NULL) {
+            adxl343_offset_correct(offset, format, block, ADXL343_FIFO_DEPTH);
+        }
+        for (int i = 0; i < ADXL343_FIFO_DEPTH; i++) {
+            sum[0] += block[i].x;
+            sum[1] += block[i].y;
+            sum[2] += block[i].z;
+        }
+    }
+    for (int i = 0; i < 3; i++) {
+        mg[i] = sum[i] / (8 * ADXL343_FIFO_DEPTH) * adxl343_mg_per_lsb(format);
+    }
+}
+
+void test_injected_bias_goes_to_the_offset_registers(void) {
+    bias_mg[0] = 120.0;
+    bias_mg[1] = -47.0;
+    bias_mg[2] = 33.0;
+
+    adxl343_offset_t result;
+    TEST_ASSERT_EQUAL(ADXL343_OK, calibrate(&result));
+    TEST_ASSERT_EQUAL_INT8(-8, result.ofs[0]);
+    TEST_ASSERT_EQUAL_INT8(3, result.ofs[1]);
+    TEST_ASSERT_EQUAL_INT8(-2, result.ofs[2]);
+
+    uint8_t ofs[3];
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_dev_read_regs(&dev, ADXL343_REG_OFSX, ofs, 3));
+    TEST_ASSERT_EQUAL_INT8(-8, (int8_t)ofs[0]);
+    TEST_ASSERT_EQUAL_INT8(3, (int8_t)ofs[1]);
+    TEST_ASSERT_EQUAL_INT8(-2, (int8_t)ofs[2]);
+
+    // What the registers cannot take is below one step
+    for (int i = 0; i < 3; i++) {
+        TEST_ASSERT_TRUE(abs(result.residual_ug[i]) <= 7813);
+    }
+    TEST_ASSERT_INT_WITHIN(500, 120000 - 125000, result.residual_ug[0]);
+    TEST_ASSERT_INT_WITHIN(500, -47000 + 46875, result.residual_ug[1]);
+    TEST_ASSERT_INT_WITHIN(500, 33000 - 31250, result.residual_ug[2]);
+
+    // The sensor now reads within half a register step, and within one
+    // sample LSB once the residual is taken off too
+    double mg[3];
+    measure(NULL, mg);
+    TEST_ASSERT_FLOAT_WITHIN(7.9f, 0.0f, (float)mg[0]);
+    TEST_ASSERT_FLOAT_WITHIN(7.9f, 0.0f, (float)mg[1]);
+    TEST_ASSERT_FLOAT_WITHIN(7.9f, 1000.0f, (float)mg[2]);
+    measure(&result, mg);
+    TEST_ASSERT_FLOAT_WITHIN(3.9f, 0.0f, (float)mg[0]);
+    TEST_ASSERT_FLOAT_WITHIN(3.9f, 0.0f, (float)mg[1]);
+    TEST_ASSERT_FLOAT_WITHIN(3.9f, 1000.0f, (float)mg[2]);
+}
+
+void test_second_run_accounts_for_offsets_already_written(void) {
+    bias_mg[0] = -300.0;
+    bias_mg[1] = 210.0;
+    bias_mg[2] = -95.0;
+
+    adxl343_offset_t first, second;
+    TEST_ASSERT_EQUAL(ADXL343_OK, calibrate(&first));
+    TEST_ASSERT_EQUAL(ADXL343_OK, calibrate(&second));
+    TEST_ASSERT_EQUAL_INT8_ARRAY(first.ofs, second.ofs, 3);
+    for (int i = 0; i < 3; i++) {
+        TEST_ASSERT_INT_WITHIN(1000, first.residual_ug[i], second.residual_ug[i]);
+    }
+}
+
+void test_left_justified_samples_calibrate_the_same(void) {
+    bias_mg[0] = 120.0;
+    bias_mg[1] = -47.0;
+    bias_mg[2] = 33.0;
+    const uint8_t format = ADXL343_FORMAT_FULL_RES | ADXL343_FORMAT_JUSTIFY | ADXL343_RANGE_4G;
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_dev_write_reg(&dev, ADXL343_REG_DATA_FORMAT, format));
+
+    adxl343_offset_t result;
+    TEST_ASSERT_EQUAL(ADXL343_OK, calibrate(&result));
+    TEST_ASSERT_EQUAL_INT8(-8, result.ofs[0]);
+    TEST_ASSERT_EQUAL_INT8(3, result.ofs[1]);
+    TEST_ASSERT_EQUAL_INT8(-2, result.ofs[2]);
+}
+
+void test_moving_sensor_is_refused(void) {
+    bias_mg[0] = 120.0;
+    shake_mg = 200.0;
+
+    adxl343_offset_t result;
+    TEST_ASSERT_EQUAL(ADXL343_ERROR_STATE, calibrate(&result));
+
+    uint8_t ofs[3];
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_dev_read_regs(&dev, ADXL343_REG_OFSX, ofs, 3));
+    TEST_ASSERT_EQUAL_HEX8(0, ofs[0] | ofs[1] | ofs[2]);
+}
+
+void test_second_sensor_is_calibrated_on_its_own(void) {
+    adxl343_sim_t alt;
+    adxl343_dev_t alt_dev;
+    adxl343_sim_init(&alt, ADXL343_ADDRESS_ALT);
+    adxl343_sim_set_source(&alt, source, NULL);
+    adxl343_sim_bus_attach(&bus, &alt);
+    adxl343_dev_set_bus(&alt_dev, &bus.bus, ADXL343_ADDRESS_ALT);
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_dev_init(&alt_dev));
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_dev_write_reg(&alt_dev, ADXL343_REG_BW_RATE, ADXL343_RATE_800HZ));
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_dev_write_reg(&alt_dev, ADXL343_REG_FIFO_CTL, ADXL343_FIFO_STREAM));
+    bias_mg[0] = 120.0;
+
+    adxl343_offset_cal_t cal;
+    adxl343_offset_t result;
+    adxl343_sample_t block[ADXL343_FIFO_DEPTH];
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_offset_begin(&cal, &alt_dev, &config));
+    bool done = false;
+    while (!done) {
+        adxl343_sim_advance_us(&alt, 20000);
+        int n = adxl343_dev_read_fifo(&alt_dev, block, ADXL343_FIFO_DEPTH);
+        TEST_ASSERT_TRUE(n >= 0);
+        done = adxl343_offset_feed(&cal, block, (size_t)n);
+    }
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_offset_finish(&cal, &result));
+
+    // Only the sensor calibrated has its offsets written
+    TEST_ASSERT_EQUAL_INT8(-8, result.ofs[0]);
+    TEST_ASSERT_EQUAL_INT8(-8, (int8_t)alt.regs[ADXL343_REG_OFSX]);
+    TEST_ASSERT_EQUAL_HEX8(0, sim.regs[ADXL343_REG_OFSX]);
+}
+
+void test_too_few_samples_are_refused(void) {
+    adxl343_offset_cal_t cal;
+    adxl343_offset_t result;
+    adxl343_sample_t s = {0, 0, 256};
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_offset_begin(&cal, &dev, &config));
+    TEST_ASSERT_FALSE(adxl343_offset_feed(&cal, &s, 1));
+    TEST_ASSERT_EQUAL(ADXL343_ERROR_STATE, adxl343_offset_finish(&cal, &result));
+}
+
+void test_bias_beyond_the_registers_is_refused(void) {
+    bias_mg[2] = -2500.0;
+
+    adxl343_offset_t result;
+    TEST_ASSERT_EQUAL(ADXL343_ERROR_DEVICE, calibrate(&result));
+}
+
+void test_saved_record_restores_the_calibration(void) {
+    bias_mg[0] = 120.0;
+    bias_mg[1] = -47.0;
+    bias_mg[2] = 33.0;
+
+    adxl343_offset_t result;
+    uint8_t record[ADXL343_OFFSET_RECORD_SIZE];
+    TEST_ASSERT_EQUAL(ADXL343_OK, calibrate(&result));
+    adxl343_offset_save(&result, record);
+
+    // Power cycle: the registers come back cleared
+    setUp();
+    bias_mg[0] = 120.0;
+    bias_mg[1] = -47.0;
+    bias_mg[2] = 33.0;
+
+    adxl343_offset_t loaded;
+    TEST_ASSERT_TRUE(adxl343_offset_load(&loaded, record));
+    TEST_ASSERT_EQUAL_INT8_ARRAY(result.ofs, loaded.ofs, 3);
+    TEST_ASSERT_EQUAL_INT16_ARRAY(result.residual_ug, loaded.residual_ug, 3);
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_offset_apply(&dev, &loaded));
+    adxl343_sim_advance_us(&sim, 100000);
+
+    double mg[3];
+    measure(&loaded, mg);
+    TEST_ASSERT_FLOAT_WITHIN(3.9f, 0.0f, (float)mg[0]);
+    TEST_ASSERT_FLOAT_WITHIN(3.9f, 0.0f, (float)mg[1]);
+    TEST_ASSERT_FLOAT_WITHIN(3.9f, 1000.0f, (float)mg[2]);
+}
+
+void test_blank_or_damaged_records_are_rejected(void) {
+    adxl343_offset_t offset = {{1, 2, 3}, {4, 5, 6}};
+    adxl343_offset_t loaded = offset;
+    uint8_t record[ADXL343_OFFSET_RECORD_SIZE];
+
+    memset(record, 0xFF, sizeof(record));
+    TEST_ASSERT_FALSE(adxl343_offset_load(&loaded, record));
+    memset(record, 0x00, sizeof(record));
+    TEST_ASSERT_FALSE(adxl343_offset_load(&loaded, record));
+
+    adxl343_offset_save(&offset, record);
+    for (size_t byte = 0; byte < sizeof(record); byte++) {
+        record[byte] ^= 0x10;
+        TEST_ASSERT_FALSE(adxl343_offset_load(&loaded, record));
+        record[byte] ^= 0x10;
+    }
+    TEST_ASSERT_EQUAL_INT8_ARRAY(offset.ofs, loaded.ofs, 3);
+    TEST_ASSERT_TRUE(adxl343_offset_load(&loaded, record));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_injected_bias_goes_to_the_offset_registers);
+    RUN_TEST(test_second_run_accounts_for_offsets_already_written);
+    RUN_TEST(test_left_justified_samples_calibrate_the_same);
+    RUN_TEST(test_moving_sensor_is_refused);
+    RUN_TEST(test_second_sensor_is_calibrated_on_its_own);
+    RUN_TEST(test_too_few_samples_are_refused);
+    RUN_TEST(test_bias_beyond_the_registers_is_refused);
+    RUN_TEST(test_saved_record_restores_the_calibration);
+    RUN_TEST(test_blank_or_damaged_records_are_rejected);
+    return UNITY_END();
+}
@@ -0,0 +1,182 @@
+#include <stdlib.h>
+
+#include "unity.h"
+#include "ADXL343_op.h"
+#include "adxl343_sim.h"
+
+static adxl343_sim_t sim;
+static adxl343_sim_bus_t bus;
+static adxl343_dev_t dev;
+static adxl343_op_t op;
+
+static void still(void *ctx, double t, double mg[3]) {
+    (void)ctx;
+    mg[0] = 20.0 + 3.0 * t;
+    mg[1] = -40.0;
+    mg[2] = 1000.0;
+}
+
+// Drive `op` like a superloop would: one poll, then `us` of other work.
+// Fails if any poll does more than one transfer. Returns the poll count.
+static int run(int expect, uint64_t us, int limit) {
+    int polls = 0;
+    int status;
+    do {
+        uint64_t before = bus.transactions;
+        status = adxl343_op_poll(&op);
+        TEST_ASSERT_TRUE(bus.transactions - before <= 1);
+        adxl343_sim_advance_us(&sim, us);
+        polls++;
+    } while (status == ADXL343_PENDING && polls < limit);
+    TEST_ASSERT_EQUAL(expect, status);
+    return polls;
+}
+
+void setUp(void) {
+    adxl343_sim_init(&sim, ADXL343_ADDRESS);
+    adxl343_sim_set_source(&sim, still, NULL);
+    adxl343_sim_bus_init(&bus);
+    adxl343_sim_bus_attach(&bus, &sim);
+    adxl343_dev_set_bus(&dev, &bus.bus, ADXL343_ADDRESS);
+}
+
+void tearDown(void) {
+}
+
+void test_init_steps_one_transfer_at_a_time(void) {
+    adxl343_op_begin_init(&op, &dev);
+    TEST_ASSERT_EQUAL(7, run(ADXL343_OK, 0, 100));
+
+    TEST_ASSERT_EQUAL_HEX8(ADXL343_RATE_100HZ, sim.regs[ADXL343_REG_BW_RATE]);
+    TEST_ASSERT_EQUAL_HEX8(ADXL343_FORMAT_FULL_RES | ADXL343_RANGE_16G, sim.regs[ADXL343_REG_DATA_FORMAT]);
+    TEST_ASSERT_EQUAL_HEX8(ADXL343_POWER_MEASURE, sim.regs[ADXL343_REG_POWER_CTL]);
+
+    // Finished operations stay finished without touching the bus
+    uint64_t before = bus.transactions;
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_op_poll(&op));
+    TEST_ASSERT_EQUAL(before, bus.transactions);
+}
+
+void test_init_rejects_wrong_device(void) {
+    sim.regs[ADXL343_REG_DEVID] = 0x00;
+    adxl343_op_begin_init(&op, &dev);
+    TEST_ASSERT_EQUAL(1, run(ADXL343_ERROR_DEVICE, 0, 100));
+    TEST_ASSERT_EQUAL(ADXL343_ERROR_DEVICE, adxl343_op_poll(&op));
+    TEST_ASSERT_EQUAL(1, bus.transactions);
+}
+
+void test_configure_writes_in_order(void) {
+    static const uint8_t writes[][2] = {
+        {ADXL343_REG_POWER_CTL, 0},
+        {ADXL343_REG_BW_RATE, ADXL343_RATE_800HZ},
+        {ADXL343_REG_FIFO_CTL, ADXL343_FIFO_STREAM | 16},
+        {ADXL343_REG_POWER_CTL, ADXL343_POWER_MEASURE},
+    };
+
+    adxl343_op_begin_configure(&op, &dev, writes, 4);
+    TEST_ASSERT_EQUAL(4, run(ADXL343_OK, 0, 100));
+    TEST_ASSERT_EQUAL(4, bus.transactions);
+    TEST_ASSERT_EQUAL_HEX8(ADXL343_RATE_800HZ, sim.regs[ADXL343_REG_BW_RATE]);
+    TEST_ASSERT_EQUAL_HEX8(ADXL343_FIFO_STREAM | 16, sim.regs[ADXL343_REG_FIFO_CTL]);
+
+    adxl343_op_begin_configure(&op, &dev, writes, 0);
+    TEST_ASSERT_EQUAL(1, run(ADXL343_OK, 0, 100));
+}
+
+void test_drain_pops_one_entry_per_poll(void) {
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_dev_init(&dev));
+    adxl343_dev_write_reg(&dev, ADXL343_REG_FIFO_CTL, ADXL343_FIFO_STREAM);
+    adxl343_sim_advance_us(&sim, 100000);
+    TEST_ASSERT_EQUAL(10, sim.fifo_count);
+
+    adxl343_sample_t dst[8];
+    adxl343_op_begin_drain(&op, &dev, dst, 8);
+    TEST_ASSERT_EQUAL(9, run(ADXL343_OK, 0, 100));
+    TEST_ASSERT_EQUAL(8, op.count);
+    TEST_ASSERT_EQUAL(2, sim.fifo_count);
+    TEST_ASSERT_INT_WITHIN(2, -10, dst[0].y);
+
+    adxl343_op_begin_drain(&op, &dev, dst, 8);
+    run(ADXL343_OK, 0, 100);
+    adxl343_op_begin_drain(&op, &dev, dst, 8);
+    TEST_ASSERT_EQUAL(1, run(ADXL343_OK, 0, 100));
+    TEST_ASSERT_EQUAL(0, op.count);
+}
+
+void test_self_test_measures_force_and_restores(void) {
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_dev_init(&dev));
+    adxl343_dev_write_reg(&dev, ADXL343_REG_BW_RATE, ADXL343_RATE_400HZ);
+    adxl343_dev_write_reg(&dev, ADXL343_REG_DATA_FORMAT, ADXL343_RANGE_4G);
+    adxl343_dev_write_reg(&dev, ADXL343_REG_FIFO_CTL, ADXL343_FIFO_STREAM | 8);
+
+    // Superloop ticking every millisecond; at 100 Hz most polls find no
+    // data and return straight away
+    adxl343_op_begin_self_test(&op, &dev);
+    int polls = run(ADXL343_OK, 1000, 10000);
+    TEST_ASSERT_TRUE(polls > 2 * (ADXL343_OP_SELF_TEST_SAMPLES + ADXL343_OP_SELF_TEST_SETTLE));
+
+    // 1 g, -1 g and 1.5 g at 256 LSB/g
+    TEST_ASSERT_INT_WITHIN(2, 256, op.delta[0]);
+    TEST_ASSERT_INT_WITHIN(2, -256, op.delta[1]);
+    TEST_ASSERT_INT_WITHIN(2, 384, op.delta[2]);
+
+    TEST_ASSERT_EQUAL_HEX8(ADXL343_RATE_400HZ, sim.regs[ADXL343_REG_BW_RATE]);
+    TEST_ASSERT_EQUAL_HEX8(ADXL343_RANGE_4G, sim.regs[ADXL343_REG_DATA_FORMAT]);
+    TEST_ASSERT_EQUAL_HEX8(ADXL343_FIFO_STREAM | 8, sim.regs[ADXL343_REG_FIFO_CTL]);
+}
+
+void test_self_test_waits_for_data(void) {
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_dev_init(&dev));
+    adxl343_op_begin_self_test(&op, &dev);
+
+    // Without time passing the operation never gets past the first sample
+    for (int i = 0; i < 50; i++) {
+        TEST_ASSERT_EQUAL(ADXL343_PENDING, adxl343_op_poll(&op));
+    }
+    adxl343_sim_advance_us(&sim, 20000);
+    run(ADXL343_OK, 1000, 10000);
+}
+
+void test_self_test_restores_after_bus_error(void) {
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_dev_init(&dev));
+    adxl343_dev_write_reg(&dev, ADXL343_REG_BW_RATE, ADXL343_RATE_400HZ);
+    adxl343_dev_write_reg(&dev, ADXL343_REG_DATA_FORMAT, ADXL343_RANGE_4G);
+    adxl343_dev_write_reg(&dev, ADXL343_REG_FIFO_CTL, ADXL343_FIFO_STREAM | 8);
+    adxl343_op_begin_self_test(&op, &dev);
+    while (!(sim.regs[ADXL343_REG_DATA_FORMAT] & ADXL343_FORMAT_SELF_TEST)) {
+        TEST_ASSERT_EQUAL(ADXL343_PENDING, adxl343_op_poll(&op));
+        adxl343_sim_advance_us(&sim, 1000);
+    }
+
+    // The failure is reported only once the registers are back
+    dev.address = 0x2A;
+    TEST_ASSERT_EQUAL(ADXL343_PENDING, adxl343_op_poll(&op));
+    dev.address = ADXL343_ADDRESS;
+    run(ADXL343_ERROR_BUS, 1000, 100);
+
+    TEST_ASSERT_EQUAL_HEX8(ADXL343_RATE_400HZ, sim.regs[ADXL343_REG_BW_RATE]);
+    TEST_ASSERT_EQUAL_HEX8(ADXL343_RANGE_4G, sim.regs[ADXL343_REG_DATA_FORMAT]);
+    TEST_ASSERT_EQUAL_HEX8(ADXL343_FIFO_STREAM | 8, sim.regs[ADXL343_REG_FIFO_CTL]);
+}
+
+void test_bus_error_sticks(void) {
+    adxl343_op_begin_init(&op, &dev);
+    TEST_ASSERT_EQUAL(ADXL343_PENDING, adxl343_op_poll(&op));
+    dev.address = 0x2A;
+    TEST_ASSERT_EQUAL(ADXL343_ERROR_BUS, adxl343_op_poll(&op));
+    dev.address = ADXL343_ADDRESS;
+    TEST_ASSERT_EQUAL(ADXL343_ERROR_BUS, adxl343_op_poll(&op));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_init_steps_one_transfer_at_a_time);
+    RUN_TEST(test_init_rejects_wrong_device);
+    RUN_TEST(test_configure_writes_in_order);
+    RUN_TEST(test_drain_pops_one_entry_per_poll);
+    RUN_TEST(test_self_test_measures_force_and_restores);
+    RUN_TEST(test_self_test_waits_for_data);
+    RUN_TEST(test_self_test_restores_after_bus_error);
+    RUN_TEST(test_bus_error_sticks);
+    return UNITY_END();
+}
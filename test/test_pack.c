@@ -0,0 +1,165 @@
+#include <stdlib.h>
+
+#include "unity.h"
+#include "ADXL343_pack.h"
+#include "adxl343_sim.h"
+
+#define BLOCK 256
+
+static adxl343_sample_t in[BLOCK];
+static adxl343_sample_t out[BLOCK];
+
+static void fill_random(int16_t lo, int16_t hi) {
+    for (size_t i = 0; i < BLOCK; i++) {
+        in[i].x = (int16_t)(lo + rand() % (hi - lo + 1));
+        in[i].y = (int16_t)(lo + rand() % (hi - lo + 1));
+        in[i].z = (int16_t)(lo + rand() % (hi - lo + 1));
+    }
+}
+
+static void assert_same(size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        TEST_ASSERT_EQUAL_INT16(in[i].x, out[i].x);
+        TEST_ASSERT_EQUAL_INT16(in[i].y, out[i].y);
+        TEST_ASSERT_EQUAL_INT16(in[i].z, out[i].z);
+    }
+}
+
+static void shake(void *ctx, double t, double mg[3]) {
+    (void)ctx;
+    mg[0] = 15000.0 * ((t * 37.0) - (int)(t * 37.0) - 0.5) * 2.0;
+    mg[1] = -12000.0 + 24000.0 * ((t * 11.0) - (int)(t * 11.0));
+    mg[2] = 1000.0;
+}
+
+void setUp(void) {
+    srand(7);
+}
+
+void tearDown(void) {
+}
+
+void test_sizes(void) {
+    TEST_ASSERT_EQUAL(4, sizeof(adxl343_packed10_t));
+    TEST_ASSERT_EQUAL(5, sizeof(adxl343_packed13_t));
+    TEST_ASSERT_EQUAL(5 * BLOCK, sizeof(adxl343_packed13_t[BLOCK]));
+}
+
+void test_packed10_every_value_round_trips(void) {
+    adxl343_packed10_t packed[BLOCK];
+    for (int base = -512; base < 512; base += BLOCK) {
+        for (size_t i = 0; i < BLOCK; i++) {
+            in[i].x = (int16_t)(base + (int)i);
+            in[i].y = (int16_t)(-1 - base - (int)i);
+            in[i].z = (int16_t)(i & 1 ? 511 : -512);
+        }
+        TEST_ASSERT_EQUAL(0, adxl343_pack10(in, BLOCK, packed));
+        adxl343_unpack10(packed, BLOCK, out);
+        assert_same(BLOCK);
+    }
+}
+
+void test_packed13_every_value_round_trips(void) {
+    adxl343_packed13_t packed[BLOCK];
+    for (int base = -4096; base < 4096; base += BLOCK) {
+        for (size_t i = 0; i < BLOCK; i++) {
+            in[i].x = (int16_t)(base + (int)i);
+            in[i].y = (int16_t)(-1 - base - (int)i);
+            in[i].z = (int16_t)(base + (int)(i * 31 % BLOCK));
+        }
+        TEST_ASSERT_EQUAL(0, adxl343_pack13(in, BLOCK, packed));
+        adxl343_unpack13(packed, BLOCK, out);
+        assert_same(BLOCK);
+    }
+}
+
+void test_random_round_trips(void) {
+    adxl343_packed10_t p10[BLOCK];
+    adxl343_packed13_t p13[BLOCK];
+    for (int round = 0; round < 64; round++) {
+        fill_random(-512, 511);
+        TEST_ASSERT_EQUAL(0, adxl343_pack10(in, BLOCK, p10));
+        adxl343_unpack10(p10, BLOCK, out);
+        assert_same(BLOCK);
+
+        fill_random(-4096, 4095);
+        TEST_ASSERT_EQUAL(0, adxl343_pack13(in, BLOCK, p13));
+        adxl343_unpack13(p13, BLOCK, out);
+        assert_same(BLOCK);
+    }
+}
+
+void test_out_of_range_saturates(void) {
+    adxl343_packed10_t p10[3];
+    adxl343_packed13_t p13[3];
+    in[0] = (adxl343_sample_t){600, -600, 5};
+    in[1] = (adxl343_sample_t){1, 2, 3};
+    in[2] = (adxl343_sample_t){-32768, 32767, 4096};
+
+    TEST_ASSERT_EQUAL(2, adxl343_pack10(in, 3, p10));
+    adxl343_unpack10(p10, 3, out);
+    TEST_ASSERT_EQUAL_INT16(511, out[0].x);
+    TEST_ASSERT_EQUAL_INT16(-512, out[0].y);
+    TEST_ASSERT_EQUAL_INT16(5, out[0].z);
+    TEST_ASSERT_EQUAL_INT16(3, out[1].z);
+    TEST_ASSERT_EQUAL_INT16(511, out[2].z);
+
+    TEST_ASSERT_EQUAL(1, adxl343_pack13(in, 3, p13));
+    adxl343_unpack13(p13, 3, out);
+    TEST_ASSERT_EQUAL_INT16(600, out[0].x);
+    TEST_ASSERT_EQUAL_INT16(-4096, out[2].x);
+    TEST_ASSERT_EQUAL_INT16(4095, out[2].y);
+    TEST_ASSERT_EQUAL_INT16(4095, out[2].z);
+}
+
+// Real streams: 10-bit mode at 16 g and full resolution at 16 g
+static void capture(uint8_t format, size_t count) {
+    adxl343_sim_t sim;
+    adxl343_sim_bus_t bus;
+    adxl343_sim_init(&sim, ADXL343_ADDRESS);
+    adxl343_sim_set_source(&sim, shake, NULL);
+    adxl343_sim_bus_init(&bus);
+    adxl343_sim_bus_attach(&bus, &sim);
+    adxl343_set_bus(&bus.bus, ADXL343_ADDRESS);
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_init());
+    adxl343_write_reg(ADXL343_REG_DATA_FORMAT, format);
+    adxl343_write_reg(ADXL343_REG_BW_RATE, ADXL343_RATE_800HZ);
+    adxl343_write_reg(ADXL343_REG_FIFO_CTL, ADXL343_FIFO_STREAM);
+
+    size_t n = 0;
+    while (n < count) {
+        adxl343_sim_advance_us(&sim, 10000);
+        int got = adxl343_read_fifo(&in[n], count - n);
+        TEST_ASSERT_TRUE(got >= 0);
+        n += (size_t)got;
+    }
+}
+
+void test_sensor_streams_fit_their_format(void) {
+    adxl343_packed10_t p10[BLOCK];
+    adxl343_packed13_t p13[BLOCK];
+
+    capture(ADXL343_RANGE_16G, BLOCK);
+    TEST_ASSERT_EQUAL(0, adxl343_pack10(in, BLOCK, p10));
+    adxl343_unpack10(p10, BLOCK, out);
+    assert_same(BLOCK);
+
+    capture(ADXL343_FORMAT_FULL_RES | ADXL343_RANGE_16G, BLOCK);
+    TEST_ASSERT_EQUAL(0, adxl343_pack13(in, BLOCK, p13));
+    adxl343_unpack13(p13, BLOCK, out);
+    assert_same(BLOCK);
+
+    // Full resolution at 16 g needs the 13-bit format
+    TEST_ASSERT_TRUE(adxl343_pack10(in, BLOCK, p10) > 0);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_sizes);
+    RUN_TEST(test_packed10_every_value_round_trips);
+    RUN_TEST(test_packed13_every_value_round_trips);
+    RUN_TEST(test_random_round_trips);
+    RUN_TEST(test_out_of_range_saturates);
+    RUN_TEST(test_sensor_streams_fit_their_format);
+    return UNITY_END();
+}
@@ -0,0 +1,235 @@
+#include <math.h>
+
+extern "C" {
+    #include "unity.h"
+    #include "adxl343_sim.h"
+}
+
+#include "ADXL343.hpp"
+
+// Z sits at 1 g and vibrates from `motion_from` seconds on.
+static adxl343_sim_t sim;
+static adxl343_sim_bus_t bus;
+static double motion_from;
+
+static void source(void *ctx, double t, double mg[3]) {
+    (void)ctx;
+    mg[0] = 0.0;
+    mg[1] = 0.0;
+    mg[2] = 1000.0 + (t >= motion_from ? 800.0 * sin(2.0 * M_PI * 13.0 * t + 0.5) : 0.0);
+}
+
+static ADXL343::PowerConfig auto_sleep_config(ADXL343::WakeupRate wakeup) {
+    ADXL343::PowerConfig config;
+    config.autoSleep = true;
+    config.wakeup = wakeup;
+    config.activityThreshold = 6;       // 375 mg
+    config.inactivityThreshold = 2;     // 125 mg
+    config.inactivityTime = 3;
+    config.activityAxes = ADXL343::Axes::All;
+    config.activityCoupling = ADXL343::Coupling::AC;
+    config.inactivityAxes = ADXL343::Axes::All;
+    config.inactivityCoupling = ADXL343::Coupling::AC;
+    return config;
+}
+
+static bool is_asleep(ADXL343 &accel) {
+    bool asleep = false;
+    TEST_ASSERT_EQUAL(ADXL343_OK, accel.asleep(asleep));
+    return asleep;
+}
+
+static void run_s(double seconds) {
+    adxl343_sim_advance_ns(&sim, (uint64_t)llround(seconds * 1e9));
+}
+
+void setUp(void) {
+    motion_from = 1e9;
+    adxl343_sim_init(&sim, ADXL343_ADDRESS);
+    adxl343_sim_set_source(&sim, source, NULL);
+    adxl343_sim_bus_init(&bus);
+    adxl343_sim_bus_attach(&bus, &sim);
+    adxl343_set_bus(&bus.bus, ADXL343_ADDRESS);
+}
+
+void tearDown(void) {
+}
+
+void test_auto_sleep_after_inactivity(void) {
+    ADXL343 accel;
+    TEST_ASSERT_EQUAL(ADXL343_OK, accel.init());
+    TEST_ASSERT_EQUAL(ADXL343_OK, accel.configurePower(auto_sleep_config(ADXL343::WakeupRate::Hz8)));
+
+    run_s(2.9);
+    TEST_ASSERT_FALSE(is_asleep(accel));
+    TEST_ASSERT_EQUAL_FLOAT(100.0f, (float)adxl343_sim_odr_hz(&sim));
+
+    run_s(0.2);
+    TEST_ASSERT_TRUE(is_asleep(accel));
+    TEST_ASSERT_EQUAL_FLOAT(8.0f, (float)adxl343_sim_odr_hz(&sim));
+}
+
+void test_wakeup_latency_is_bounded_by_wakeup_rate(void) {
+    static const ADXL343::WakeupRate rates[] = {
+        ADXL343::WakeupRate::Hz8,
+        ADXL343::WakeupRate::Hz4,
+        ADXL343::WakeupRate::Hz2,
+        ADXL343::WakeupRate::Hz1,
+    };
+
+    for (int i = 0; i < 4; i++) {
+        setUp();
+        ADXL343 accel;
+        TEST_ASSERT_EQUAL(ADXL343_OK, accel.init());
+        TEST_ASSERT_EQUAL(ADXL343_OK, accel.configurePower(auto_sleep_config(rates[i])));
+        run_s(5.0);
+        TEST_ASSERT_TRUE(is_asleep(accel));
+
+        motion_from = 5.0 + 0.0371;
+        double period = 1.0 / (8.0 / (1 << i));
+        double woke = -1.0;
+        for (int ms = 0; ms < 2000 && woke < 0.0; ms++) {
+            run_s(0.001);
+            if (!is_asleep(accel)) {
+                woke = (double)sim.now_ns / 1e9;
+            }
+        }
+
+        TEST_ASSERT_TRUE(woke > motion_from);
+        TEST_ASSERT_TRUE(woke - motion_from <= period + 0.001);
+        TEST_ASSERT_EQUAL_FLOAT(100.0f, (float)adxl343_sim_odr_hz(&sim));
+    }
+}
+
+void test_auto_sleep_without_link_stays_awake(void) {
+    // The hand written sequence that shipped: AUTO_SLEEP without LINK
+    ADXL343 accel;
+    TEST_ASSERT_EQUAL(ADXL343_OK, accel.init());
+    const uint8_t detectors[] = {6, 2, 3, 0xFF};
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_write_regs(ADXL343_REG_THRESH_ACT, detectors, sizeof(detectors)));
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_write_reg(ADXL343_REG_INT_ENABLE, ADXL343_INT_ACTIVITY | ADXL343_INT_INACTIVITY));
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_write_reg(ADXL343_REG_POWER_CTL, ADXL343_POWER_AUTO_SLEEP | ADXL343_POWER_MEASURE));
+    run_s(10.0);
+    TEST_ASSERT_FALSE(is_asleep(accel));
+
+    // The typed API always pairs AUTO_SLEEP with LINK
+    TEST_ASSERT_EQUAL(ADXL343_OK, accel.configurePower(auto_sleep_config(ADXL343::WakeupRate::Hz8)));
+    run_s(3.2);
+    TEST_ASSERT_TRUE(is_asleep(accel));
+}
+
+void test_disabling_auto_sleep_while_asleep_wakes(void) {
+    ADXL343 accel;
+    TEST_ASSERT_EQUAL(ADXL343_OK, accel.init());
+    TEST_ASSERT_EQUAL(ADXL343_OK, accel.configurePower(auto_sleep_config(ADXL343::WakeupRate::Hz1)));
+    run_s(4.0);
+    TEST_ASSERT_TRUE(is_asleep(accel));
+
+    // Clearing AUTO_SLEEP in place leaves the sensor at the wakeup rate
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_write_reg(ADXL343_REG_POWER_CTL, ADXL343_POWER_LINK | ADXL343_POWER_MEASURE));
+    run_s(1.0);
+    TEST_ASSERT_TRUE(is_asleep(accel));
+
+    ADXL343::PowerConfig awake;
+    TEST_ASSERT_EQUAL(ADXL343_OK, accel.configurePower(awake));
+    TEST_ASSERT_FALSE(is_asleep(accel));
+    TEST_ASSERT_EQUAL_FLOAT(100.0f, (float)adxl343_sim_odr_hz(&sim));
+}
+
+void test_forced_sleep_and_wake(void) {
+    ADXL343 accel;
+    TEST_ASSERT_EQUAL(ADXL343_OK, accel.init());
+
+    TEST_ASSERT_EQUAL(ADXL343_OK, accel.sleep(ADXL343::WakeupRate::Hz2));
+    TEST_ASSERT_TRUE(is_asleep(accel));
+    TEST_ASSERT_EQUAL_FLOAT(2.0f, (float)adxl343_sim_odr_hz(&sim));
+
+    uint64_t before = sim.samples;
+    run_s(2.0);
+    TEST_ASSERT_EQUAL(4, sim.samples - before);
+
+    TEST_ASSERT_EQUAL(ADXL343_OK, accel.wake());
+    TEST_ASSERT_FALSE(is_asleep(accel));
+    before = sim.samples;
+    run_s(1.0);
+    TEST_ASSERT_EQUAL(100, sim.samples - before);
+}
+
+void test_configure_power_batches_writes(void) {
+    ADXL343 accel;
+    TEST_ASSERT_EQUAL(ADXL343_OK, accel.init());
+
+    uint64_t before = bus.transactions;
+    TEST_ASSERT_EQUAL(ADXL343_OK, accel.configurePower(auto_sleep_config(ADXL343::WakeupRate::Hz4)));
+
+    // standby, detector burst, INT_ENABLE read-modify-write, POWER_CTL
+    TEST_ASSERT_EQUAL(5, bus.transactions - before);
+    TEST_ASSERT_EQUAL_HEX8(6, sim.regs[ADXL343_REG_THRESH_ACT]);
+    TEST_ASSERT_EQUAL_HEX8(2, sim.regs[ADXL343_REG_THRESH_INACT]);
+    TEST_ASSERT_EQUAL_HEX8(3, sim.regs[ADXL343_REG_TIME_INACT]);
+    TEST_ASSERT_EQUAL_HEX8(0xFF, sim.regs[ADXL343_REG_ACT_INACT_CTL]);
+    TEST_ASSERT_EQUAL_HEX8(ADXL343_INT_ACTIVITY | ADXL343_INT_INACTIVITY, sim.regs[ADXL343_REG_INT_ENABLE]);
+    TEST_ASSERT_EQUAL_HEX8(ADXL343_POWER_LINK | ADXL343_POWER_AUTO_SLEEP | ADXL343_POWER_MEASURE | 1,
+                           sim.regs[ADXL343_REG_POWER_CTL]);
+}
+
+void test_second_sensor_on_the_bus(void) {
+    adxl343_sim_t alt;
+    adxl343_sim_init(&alt, ADXL343_ADDRESS_ALT);
+    adxl343_sim_set_source(&alt, source, NULL);
+    adxl343_sim_bus_attach(&bus, &alt);
+    adxl343_dev_t dev;
+    adxl343_dev_set_bus(&dev, &bus.bus, ADXL343_ADDRESS_ALT);
+
+    ADXL343 first;
+    ADXL343 second(&dev);
+    TEST_ASSERT_EQUAL(ADXL343_OK, first.init());
+    TEST_ASSERT_EQUAL(ADXL343_OK, second.init());
+
+    // Only the sensor the object was given goes to sleep
+    TEST_ASSERT_EQUAL(ADXL343_OK, second.sleep(ADXL343::WakeupRate::Hz2));
+    TEST_ASSERT_TRUE(is_asleep(second));
+    TEST_ASSERT_FALSE(is_asleep(first));
+    TEST_ASSERT_EQUAL_FLOAT(2.0f, (float)adxl343_sim_odr_hz(&alt));
+    TEST_ASSERT_EQUAL_FLOAT(100.0f, (float)adxl343_sim_odr_hz(&sim));
+
+    TEST_ASSERT_EQUAL(ADXL343_OK, second.wake());
+    TEST_ASSERT_FALSE(is_asleep(second));
+    TEST_ASSERT_EQUAL_FLOAT(100.0f, (float)adxl343_sim_odr_hz(&alt));
+}
+
+void test_register_encodings(void) {
+    ADXL343::PowerConfig config;
+    config.activityAxes = ADXL343::Axes::X | ADXL343::Axes::Z;
+    config.inactivityAxes = ADXL343::Axes::Y;
+    config.inactivityCoupling = ADXL343::Coupling::AC;
+    TEST_ASSERT_EQUAL_HEX8(ADXL343_ACT_X | ADXL343_ACT_Z | ADXL343_INACT_AC | ADXL343_INACT_Y,
+                           ADXL343::actInactControl(config));
+
+    config.link = true;
+    config.wakeup = ADXL343::WakeupRate::Hz1;
+    TEST_ASSERT_EQUAL_HEX8(ADXL343_POWER_LINK | 3, ADXL343::powerControl(config));
+}
+
+void test_auto_sleep_needs_detector_axes(void) {
+    ADXL343 accel;
+    TEST_ASSERT_EQUAL(ADXL343_OK, accel.init());
+
+    ADXL343::PowerConfig config = auto_sleep_config(ADXL343::WakeupRate::Hz8);
+    config.inactivityAxes = ADXL343::Axes::None;
+    TEST_ASSERT_EQUAL(ADXL343_ERROR_ARGUMENT, accel.configurePower(config));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_auto_sleep_after_inactivity);
+    RUN_TEST(test_wakeup_latency_is_bounded_by_wakeup_rate);
+    RUN_TEST(test_auto_sleep_without_link_stays_awake);
+    RUN_TEST(test_disabling_auto_sleep_while_asleep_wakes);
+    RUN_TEST(test_forced_sleep_and_wake);
+    RUN_TEST(test_configure_power_batches_writes);
+    RUN_TEST(test_second_sensor_on_the_bus);
+    RUN_TEST(test_register_encodings);
+    RUN_TEST(test_auto_sleep_needs_detector_axes);
+    return UNITY_END();
+}
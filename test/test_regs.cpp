@@ -0,0 +1,164 @@
+extern "C" {
+    #include "unity.h"
+    #include "ADXL343_op.h"
+    #include "adxl343_sim.h"
+}
+
+#include "ADXL343_regs.hpp"
+
+using namespace adxl343;
+
+// The map agrees with the C register constants the driver is written in
+static_assert(reg::DevId::address == ADXL343_REG_DEVID, "");
+static_assert(reg::ThreshTap::address == ADXL343_REG_THRESH_TAP, "");
+static_assert(reg::ActTapStatus::address == ADXL343_REG_ACT_TAP_STATUS, "");
+static_assert(reg::DataFormat::address == ADXL343_REG_DATA_FORMAT, "");
+static_assert(reg::FifoStatus::address == ADXL343_REG_FIFO_STATUS, "");
+static_assert(consecutive<reg::Ofsx, reg::Ofsy, reg::Ofsz, reg::Dur, reg::Latent, reg::Window, reg::ThreshAct>(), "");
+static_assert(consecutive<reg::DataX0, reg::DataX1, reg::DataY0, reg::DataY1, reg::DataZ0, reg::DataZ1,
+                          reg::FifoCtl, reg::FifoStatus>(), "");
+static_assert(!consecutive<reg::BwRate, reg::IntEnable>(), "");
+
+static_assert(reg::DataFormat::SelfTest::mask == ADXL343_FORMAT_SELF_TEST, "");
+static_assert(reg::DataFormat::Spi::mask == ADXL343_FORMAT_SPI, "");
+static_assert(reg::DataFormat::IntInvert::mask == ADXL343_FORMAT_INT_INVERT, "");
+static_assert(reg::DataFormat::FullRes::mask == ADXL343_FORMAT_FULL_RES, "");
+static_assert(reg::DataFormat::Justify::mask == ADXL343_FORMAT_JUSTIFY, "");
+static_assert(reg::DataFormat::Range::mask == ADXL343_FORMAT_RANGE_MASK, "");
+static_assert(reg::FifoCtl::Mode::mask == ADXL343_FIFO_MODE_MASK, "");
+static_assert(reg::FifoCtl::TriggerInt2::mask == ADXL343_FIFO_TRIGGER_INT2, "");
+static_assert(reg::FifoCtl::Samples::mask == ADXL343_FIFO_SAMPLES_MASK, "");
+static_assert(reg::FifoStatus::Trig::mask == ADXL343_FIFO_TRIG, "");
+static_assert(reg::FifoStatus::Entries::mask == ADXL343_FIFO_ENTRIES_MASK, "");
+static_assert(reg::BwRate::LowPower::mask == ADXL343_BW_LOW_POWER, "");
+static_assert(reg::BwRate::Rate::mask == ADXL343_BW_RATE_MASK, "");
+static_assert(reg::PowerCtl::Link::mask == ADXL343_POWER_LINK, "");
+static_assert(reg::PowerCtl::AutoSleep::mask == ADXL343_POWER_AUTO_SLEEP, "");
+static_assert(reg::PowerCtl::Measure::mask == ADXL343_POWER_MEASURE, "");
+static_assert(reg::PowerCtl::Sleep::mask == ADXL343_POWER_SLEEP, "");
+static_assert(reg::PowerCtl::Wakeup::mask == ADXL343_POWER_WAKEUP_MASK, "");
+static_assert(reg::ActInactCtl::ActAc::mask == ADXL343_ACT_AC, "");
+static_assert(reg::ActInactCtl::ActAxes::mask == (ADXL343_ACT_X | ADXL343_ACT_Y | ADXL343_ACT_Z), "");
+static_assert(reg::ActInactCtl::InactAc::mask == ADXL343_INACT_AC, "");
+static_assert(reg::ActInactCtl::InactAxes::mask == (ADXL343_INACT_X | ADXL343_INACT_Y | ADXL343_INACT_Z), "");
+static_assert(reg::TapAxes::Suppress::mask == ADXL343_TAP_SUPPRESS, "");
+static_assert(reg::ActTapStatus::Asleep::mask == ADXL343_STATUS_ASLEEP, "");
+static_assert(reg::IntSource::DataReady::mask == ADXL343_INT_DATA_READY, "");
+static_assert(reg::IntSource::SingleTap::mask == ADXL343_INT_SINGLE_TAP, "");
+static_assert(reg::IntSource::DoubleTap::mask == ADXL343_INT_DOUBLE_TAP, "");
+static_assert(reg::IntSource::Activity::mask == ADXL343_INT_ACTIVITY, "");
+static_assert(reg::IntSource::Inactivity::mask == ADXL343_INT_INACTIVITY, "");
+static_assert(reg::IntSource::FreeFall::mask == ADXL343_INT_FREE_FALL, "");
+static_assert(reg::IntSource::Watermark::mask == ADXL343_INT_WATERMARK, "");
+static_assert(reg::IntSource::Overrun::mask == ADXL343_INT_OVERRUN, "");
+
+// Datasheet reset values and access
+static_assert(reg::DevId::reset == 0xE5 && reg::DevId::access == Access::Read, "");
+static_assert(reg::BwRate::reset == 0x0A && reg::BwRate::access == Access::ReadWrite, "");
+static_assert(reg::IntSource::reset == 0x02 && reg::IntSource::access == Access::Read, "");
+static_assert(reg::FifoCtl::reset == 0x00 && reg::FifoCtl::access == Access::ReadWrite, "");
+
+// Values fold to the bytes the C constants give
+constexpr uint8_t format = Value<reg::DataFormat>()
+    .with<reg::DataFormat::FullRes>(true)
+    .with<reg::DataFormat::Range>(ADXL343_RANGE_16G)
+    .raw;
+static_assert(format == (ADXL343_FORMAT_FULL_RES | ADXL343_RANGE_16G), "");
+
+constexpr uint8_t fifo = Value<reg::FifoCtl>()
+    .with<reg::FifoCtl::Mode>(FifoMode::Stream)
+    .with<reg::FifoCtl::Samples>(16)
+    .raw;
+static_assert(fifo == (ADXL343_FIFO_STREAM | 16), "");
+
+constexpr uint8_t trigger = Value<reg::FifoCtl>(fifo)
+    .with<reg::FifoCtl::Mode>(FifoMode::Trigger)
+    .with<reg::FifoCtl::TriggerInt2>(true)
+    .raw;
+static_assert(trigger == (ADXL343_FIFO_TRIGGER | ADXL343_FIFO_TRIGGER_INT2 | 16), "");
+
+static_assert(Value<reg::BwRate>().raw == ADXL343_RATE_100HZ, "");
+static_assert(Value<reg::BwRate>().with<reg::BwRate::Rate>(ADXL343_RATE_3200HZ).with<reg::BwRate::LowPower>(true).raw ==
+              (ADXL343_RATE_3200HZ | ADXL343_BW_LOW_POWER), "");
+static_assert(Value<reg::FifoStatus>(0xA5).get<reg::FifoStatus::Entries>() == 0x25, "");
+static_assert(Value<reg::FifoStatus>(0xA5).get<reg::FifoStatus::Trig>(), "");
+static_assert(Value<reg::DataFormat>(0xFF).with<reg::DataFormat::Range>(ADXL343_RANGE_2G).raw == 0xFC, "");
+static_assert(Value<reg::DataFormat>(0xFF).with<reg::DataFormat::SelfTest>(false).raw == 0x7F, "");
+
+constexpr auto detectors = burst(Value<reg::ThreshAct>(6), Value<reg::ThreshInact>(2), Value<reg::TimeInact>(3));
+static_assert(detectors.address == ADXL343_REG_THRESH_ACT && detectors.count == 3, "");
+static_assert(detectors.data[0] == 6 && detectors.data[1] == 2 && detectors.data[2] == 3, "");
+
+constexpr auto setup = writes(
+    Value<reg::PowerCtl>(),
+    Value<reg::BwRate>().with<reg::BwRate::Rate>(ADXL343_RATE_800HZ),
+    Value<reg::DataFormat>(format),
+    Value<reg::FifoCtl>(fifo),
+    Value<reg::PowerCtl>().with<reg::PowerCtl::Measure>(true));
+static_assert(setup.count == 5, "");
+static_assert(setup.data[1][0] == ADXL343_REG_BW_RATE && setup.data[1][1] == ADXL343_RATE_800HZ, "");
+static_assert(setup.data[4][0] == ADXL343_REG_POWER_CTL && setup.data[4][1] == ADXL343_POWER_MEASURE, "");
+
+static adxl343_sim_t sim;
+static adxl343_sim_bus_t bus;
+static adxl343_dev_t dev;
+
+void setUp(void) {
+    adxl343_sim_init(&sim, ADXL343_ADDRESS);
+    adxl343_sim_bus_init(&bus);
+    adxl343_sim_bus_attach(&bus, &sim);
+    adxl343_dev_set_bus(&dev, &bus.bus, ADXL343_ADDRESS);
+}
+
+void tearDown(void) {
+}
+
+void test_writes_table_configures_the_sensor(void) {
+    adxl343_op_t op;
+    adxl343_op_begin_configure(&op, &dev, setup.data, setup.count);
+    while (adxl343_op_poll(&op) == ADXL343_PENDING) {
+    }
+    TEST_ASSERT_EQUAL(ADXL343_OK, op.status);
+    TEST_ASSERT_EQUAL_HEX8(ADXL343_RATE_800HZ, sim.regs[ADXL343_REG_BW_RATE]);
+    TEST_ASSERT_EQUAL_HEX8(ADXL343_FORMAT_FULL_RES | ADXL343_RANGE_16G, sim.regs[ADXL343_REG_DATA_FORMAT]);
+    TEST_ASSERT_EQUAL_HEX8(ADXL343_FIFO_STREAM | 16, sim.regs[ADXL343_REG_FIFO_CTL]);
+    TEST_ASSERT_EQUAL_HEX8(ADXL343_POWER_MEASURE, sim.regs[ADXL343_REG_POWER_CTL]);
+}
+
+void test_burst_is_one_transfer(void) {
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_dev_write_regs(&dev, detectors.address, detectors.data, detectors.count));
+    TEST_ASSERT_EQUAL(1, bus.transactions);
+    TEST_ASSERT_EQUAL_HEX8(6, sim.regs[ADXL343_REG_THRESH_ACT]);
+    TEST_ASSERT_EQUAL_HEX8(2, sim.regs[ADXL343_REG_THRESH_INACT]);
+    TEST_ASSERT_EQUAL_HEX8(3, sim.regs[ADXL343_REG_TIME_INACT]);
+}
+
+void test_read_modify_write_keeps_other_fields(void) {
+    sim.regs[ADXL343_REG_DATA_FORMAT] = ADXL343_FORMAT_INT_INVERT | ADXL343_FORMAT_FULL_RES | ADXL343_RANGE_4G;
+
+    Value<reg::DataFormat> value;
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_dev_read_reg(&dev, reg::DataFormat::address, &value.raw));
+    TEST_ASSERT_EQUAL(ADXL343_RANGE_4G, value.get<reg::DataFormat::Range>());
+    TEST_ASSERT_TRUE(value.get<reg::DataFormat::IntInvert>());
+
+    value = value.with<reg::DataFormat::Range>(ADXL343_RANGE_8G).with<reg::DataFormat::SelfTest>(true);
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_dev_write_reg(&dev, reg::DataFormat::address, value.raw));
+    TEST_ASSERT_EQUAL_HEX8(ADXL343_FORMAT_SELF_TEST | ADXL343_FORMAT_INT_INVERT | ADXL343_FORMAT_FULL_RES |
+                           ADXL343_RANGE_8G, sim.regs[ADXL343_REG_DATA_FORMAT]);
+}
+
+void test_out_of_range_is_masked_at_run_time(void) {
+    // Would not compile as a constant expression
+    volatile uint8_t samples = 40;
+    uint8_t raw = Value<reg::FifoCtl>(ADXL343_FIFO_STREAM).with<reg::FifoCtl::Samples>(samples).raw;
+    TEST_ASSERT_EQUAL_HEX8(ADXL343_FIFO_STREAM | (40 & ADXL343_FIFO_SAMPLES_MASK), raw);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_writes_table_configures_the_sensor);
+    RUN_TEST(test_burst_is_one_transfer);
+    RUN_TEST(test_read_modify_write_keeps_other_fields);
+    RUN_TEST(test_out_of_range_is_masked_at_run_time);
+    return UNITY_END();
+}
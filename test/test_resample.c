@@ -0,0 +1,161 @@
+#include <math.h>
+#include <stdlib.h>
+
+#include "unity.h"
+#include "ADXL343_resample.h"
+
+// A sensor nominally at 800 Hz running 1.2% fast, resampled to exactly
+// 800 Hz.
+#define NOMINAL_HZ 800.0
+#define ACTUAL_HZ (NOMINAL_HZ * 1.012)
+#define TONE_HZ 37.0
+#define AMPLITUDE 8000.0
+#define INPUTS 4096
+
+static adxl343_resampler_t rs;
+static adxl343_sample_t input[INPUTS];
+static adxl343_sample_t output[INPUTS + 16];
+static adxl343_sample_t reference[INPUTS + 16];
+
+static void tone(adxl343_sample_t *dst, size_t count, double rate_hz, double phase) {
+    for (size_t i = 0; i < count; i++) {
+        double w = 2.0 * M_PI * TONE_HZ * (double)i / rate_hz + phase;
+        dst[i].x = (int16_t)lround(AMPLITUDE * sin(w));
+        dst[i].y = (int16_t)lround(AMPLITUDE * cos(w));
+        dst[i].z = (int16_t)(256 + (int)(i % 7));
+    }
+}
+
+// Phase and amplitude of the tone in `x` at `rate_hz` by correlation
+static void measure(const adxl343_sample_t *x, size_t count, double rate_hz, double *phase, double *amplitude) {
+    double re = 0.0;
+    double im = 0.0;
+    // Whole cycles only
+    size_t n = (size_t)(floor((double)count * TONE_HZ / rate_hz) * rate_hz / TONE_HZ);
+    for (size_t i = 0; i < n; i++) {
+        double w = 2.0 * M_PI * TONE_HZ * (double)i / rate_hz;
+        re += x[i].x * cos(w);
+        im += x[i].x * sin(w);
+    }
+    *phase = atan2(re, im);
+    *amplitude = 2.0 * sqrt(re * re + im * im) / (double)n;
+}
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+void test_rejects_bad_rates(void) {
+    TEST_ASSERT_FALSE(adxl343_resampler_init(&rs, 0.0f, 800.0f));
+    TEST_ASSERT_FALSE(adxl343_resampler_init(&rs, 800.0f, -1.0f));
+    TEST_ASSERT_FALSE(adxl343_resampler_init(&rs, 3200.0f, 0.01f));
+    TEST_ASSERT_TRUE(adxl343_resampler_init(&rs, 800.0f, 800.0f));
+}
+
+void test_unit_ratio_passes_samples_through(void) {
+    tone(input, INPUTS, NOMINAL_HZ, 0.3);
+    adxl343_resampler_init(&rs, (float)NOMINAL_HZ, (float)NOMINAL_HZ);
+
+    size_t n = adxl343_resampler_process(&rs, input, INPUTS, output, INPUTS);
+    TEST_ASSERT_EQUAL(INPUTS - 2, n);
+    TEST_ASSERT_EQUAL_MEMORY(input, output, n * sizeof(adxl343_sample_t));
+}
+
+void test_drifting_input_lands_on_exact_rate(void) {
+    tone(input, INPUTS, ACTUAL_HZ, 0.0);
+    tone(reference, INPUTS, NOMINAL_HZ, 0.0);
+    adxl343_resampler_init(&rs, (float)ACTUAL_HZ, (float)NOMINAL_HZ);
+
+    size_t n = adxl343_resampler_process(&rs, input, INPUTS, output, INPUTS + 16);
+    TEST_ASSERT_INT_WITHIN(2, (int)((INPUTS - 2) * NOMINAL_HZ / ACTUAL_HZ), (int)n);
+
+    // Sample by sample against the tone sampled at exactly 800 Hz
+    int worst = 0;
+    for (size_t i = 0; i < n; i++) {
+        int e = abs(output[i].x - reference[i].x);
+        worst = e > worst ? e : worst;
+        e = abs(output[i].y - reference[i].y);
+        worst = e > worst ? e : worst;
+    }
+    TEST_ASSERT_TRUE(worst <= 4);
+
+    double phase, amplitude;
+    measure(output, n, NOMINAL_HZ, &phase, &amplitude);
+    TEST_ASSERT_FLOAT_WITHIN(0.0005f, 0.0f, (float)phase);        // radians
+    TEST_ASSERT_FLOAT_WITHIN((float)(AMPLITUDE * 0.001), (float)AMPLITUDE, (float)amplitude);
+
+    // Without resampling the 1.2% rate error shows as a frequency error
+    measure(input, n, NOMINAL_HZ, &phase, &amplitude);
+    TEST_ASSERT_TRUE(amplitude < AMPLITUDE * 0.5);
+}
+
+void test_blocks_match_one_pass(void) {
+    tone(input, INPUTS, ACTUAL_HZ, 1.0);
+    adxl343_resampler_init(&rs, (float)ACTUAL_HZ, (float)NOMINAL_HZ);
+    size_t whole = adxl343_resampler_process(&rs, input, INPUTS, reference, INPUTS + 16);
+
+    adxl343_resampler_init(&rs, (float)ACTUAL_HZ, (float)NOMINAL_HZ);
+    size_t n = 0;
+    size_t i = 0;
+    srand(7);
+    while (i < INPUTS) {
+        size_t block = 1 + (size_t)(rand() % 40);
+        if (block > INPUTS - i) {
+            block = INPUTS - i;
+        }
+        n += adxl343_resampler_process(&rs, &input[i], block, &output[n], INPUTS + 16 - n);
+        i += block;
+    }
+
+    TEST_ASSERT_EQUAL(whole, n);
+    TEST_ASSERT_EQUAL_MEMORY(reference, output, n * sizeof(adxl343_sample_t));
+}
+
+void test_rate_update_keeps_phase(void) {
+    // Rate estimate refined halfway through: the output stays continuous
+    tone(input, INPUTS, ACTUAL_HZ, 0.0);
+    tone(reference, INPUTS, NOMINAL_HZ, 0.0);
+    adxl343_resampler_init(&rs, (float)(ACTUAL_HZ * 1.0005), (float)NOMINAL_HZ);
+
+    size_t n = adxl343_resampler_process(&rs, input, 64, output, INPUTS);
+    adxl343_resampler_set_rate(&rs, (float)ACTUAL_HZ, (float)NOMINAL_HZ);
+    n += adxl343_resampler_process(&rs, &input[64], INPUTS - 64, &output[n], INPUTS + 16 - n);
+
+    // No step at the switch: consecutive outputs differ by no more than
+    // the tone's slope of 2325 LSB per output allows
+    int steepest = 0;
+    for (size_t i = 1; i < n; i++) {
+        int d = abs(output[i].x - output[i - 1].x);
+        steepest = d > steepest ? d : steepest;
+    }
+    TEST_ASSERT_TRUE(steepest <= 2330);
+
+    // The early 0.05% error over 64 samples leaves a 0.03 sample offset,
+    // about 75 LSB at the steepest point, that is held rather than undone
+    int worst = 0;
+    for (size_t i = 0; i < n; i++) {
+        int e = abs(output[i].x - reference[i].x);
+        worst = e > worst ? e : worst;
+    }
+    TEST_ASSERT_TRUE(worst <= 80);
+}
+
+void test_full_output_drops_excess(void) {
+    tone(input, INPUTS, ACTUAL_HZ, 0.0);
+    adxl343_resampler_init(&rs, (float)NOMINAL_HZ, (float)(NOMINAL_HZ * 2.0));
+    TEST_ASSERT_EQUAL(10, adxl343_resampler_process(&rs, input, 64, output, 10));
+    TEST_ASSERT_EQUAL(128, adxl343_resampler_process(&rs, &input[64], 64, output, INPUTS));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_rejects_bad_rates);
+    RUN_TEST(test_unit_ratio_passes_samples_through);
+    RUN_TEST(test_drifting_input_lands_on_exact_rate);
+    RUN_TEST(test_blocks_match_one_pass);
+    RUN_TEST(test_rate_update_keeps_phase);
+    RUN_TEST(test_full_output_drops_excess);
+    return UNITY_END();
+}
@@ -0,0 +1,207 @@
+#include <math.h>
+
+#include "unity.h"
+#include "ADXL343_op.h"
+#include "ADXL343_selftest.h"
+#include "adxl343_sim.h"
+
+static adxl343_sim_t sim;
+static adxl343_sim_bus_t bus;
+static adxl343_dev_t dev;
+static adxl343_selftest_t st;
+
+static void still(void *ctx, double t, double mg[3]) {
+    (void)ctx;
+    (void)t;
+    mg[0] = 30.0;
+    mg[1] = -50.0;
+    mg[2] = 1000.0;
+}
+
+// Handled roughly, 2 g at 13 Hz on every axis
+static void shaken(void *ctx, double t, double mg[3]) {
+    (void)ctx;
+    for (int i = 0; i < 3; i++) {
+        mg[i] = 2000.0 * sin(2.0 * M_PI * 13.0 * t + i);
+    }
+}
+
+// Poll once per `us` of virtual time, checking each poll does at most one
+// transfer. Returns the time taken in microseconds.
+static uint64_t run(int expect, uint64_t us) {
+    uint64_t start = sim.now_ns;
+    int status;
+    int polls = 0;
+    do {
+        uint64_t before = bus.transactions;
+        status = adxl343_selftest_poll(&st);
+        TEST_ASSERT_TRUE(bus.transactions - before <= 1);
+        adxl343_sim_advance_us(&sim, us);
+        polls++;
+    } while (status == ADXL343_PENDING && polls < 100000);
+    TEST_ASSERT_EQUAL(expect, status);
+    return (sim.now_ns - start) / 1000;
+}
+
+void setUp(void) {
+    adxl343_sim_init(&sim, ADXL343_ADDRESS);
+    adxl343_sim_set_source(&sim, still, NULL);
+    adxl343_sim_bus_init(&bus);
+    adxl343_sim_bus_attach(&bus, &sim);
+    adxl343_dev_set_bus(&dev, &bus.bus, ADXL343_ADDRESS);
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_dev_init(&dev));
+}
+
+void tearDown(void) {}
+
+void test_healthy_part_passes_and_restores(void) {
+    adxl343_dev_write_reg(&dev, ADXL343_REG_BW_RATE, ADXL343_RATE_50HZ);
+    adxl343_dev_write_reg(&dev, ADXL343_REG_DATA_FORMAT, ADXL343_RANGE_4G);
+    adxl343_dev_write_reg(&dev, ADXL343_REG_FIFO_CTL, ADXL343_FIFO_STREAM | 8);
+    adxl343_sim_advance_us(&sim, 100000);
+
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_selftest_begin(&st, &dev, &adxl343_selftest_default));
+    run(ADXL343_OK, 1000);
+    TEST_ASSERT_EQUAL_HEX8(0, st.failed);
+    TEST_ASSERT_EQUAL_HEX8(0, st.uncertain);
+    TEST_ASSERT_FLOAT_WITHIN(4.0f, 1000.0f, st.delta_mg[0]);
+    TEST_ASSERT_FLOAT_WITHIN(4.0f, -1000.0f, st.delta_mg[1]);
+    TEST_ASSERT_FLOAT_WITHIN(4.0f, 1500.0f, st.delta_mg[2]);
+
+    TEST_ASSERT_EQUAL_HEX8(ADXL343_RATE_50HZ, sim.regs[ADXL343_REG_BW_RATE]);
+    TEST_ASSERT_EQUAL_HEX8(ADXL343_RANGE_4G, sim.regs[ADXL343_REG_DATA_FORMAT]);
+    TEST_ASSERT_EQUAL_HEX8(ADXL343_FIFO_STREAM | 8, sim.regs[ADXL343_REG_FIFO_CTL]);
+
+    // Nothing measured with the force is left behind in the FIFO
+    TEST_ASSERT_TRUE(sim.fifo_count <= 1);
+    adxl343_sample_t s;
+    adxl343_sim_advance_us(&sim, 40000);
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_dev_read_sample(&dev, &s));
+    TEST_ASSERT_INT_WITHIN(2, 128, s.z);
+}
+
+void test_noisy_part_passes_with_a_margin(void) {
+    sim.noise_mg = 40.0;
+    adxl343_selftest_begin(&st, &dev, &adxl343_selftest_default);
+    run(ADXL343_OK, 1000);
+    for (int i = 0; i < 3; i++) {
+        // Two blocks of 28: sqrt(2 / 28) * 40 mg
+        TEST_ASSERT_FLOAT_WITHIN(4.0f, 10.7f, st.sigma_mg[i]);
+        TEST_ASSERT_FLOAT_WITHIN(4.0f * st.sigma_mg[i], sim.self_test_mg[i], st.delta_mg[i]);
+    }
+}
+
+void test_faulty_parts_fail(void) {
+    static const struct {
+        double mg[3];
+        uint8_t failed;
+    } faults[] = {
+        {{1000.0, -1000.0, 0.0}, 0x04},      // Z stuck
+        {{100.0, -1000.0, 1500.0}, 0x01},    // X weak
+        {{1000.0, -1000.0, 4000.0}, 0x04},   // Z excessive
+        {{1000.0, 1000.0, 1500.0}, 0x02},    // Y reversed
+        {{0.0, 0.0, 0.0}, 0x07},             // no force at all
+    };
+
+    for (size_t f = 0; f < sizeof(faults) / sizeof(faults[0]); f++) {
+        setUp();
+        sim.noise_mg = 10.0;
+        for (int i = 0; i < 3; i++) {
+            sim.self_test_mg[i] = faults[f].mg[i];
+        }
+        adxl343_selftest_begin(&st, &dev, &adxl343_selftest_default);
+        run(ADXL343_ERROR_DEVICE, 1000);
+        TEST_ASSERT_EQUAL_HEX8(faults[f].failed, st.failed);
+        TEST_ASSERT_EQUAL_HEX8(ADXL343_FORMAT_FULL_RES | ADXL343_RANGE_16G, sim.regs[ADXL343_REG_DATA_FORMAT]);
+    }
+}
+
+void test_motion_is_inconclusive(void) {
+    adxl343_sim_set_source(&sim, shaken, NULL);
+    adxl343_selftest_begin(&st, &dev, &adxl343_selftest_default);
+    run(ADXL343_ERROR_STATE, 1000);
+    TEST_ASSERT_EQUAL_HEX8(0, st.failed);
+    TEST_ASSERT_NOT_EQUAL(0, st.uncertain);
+    TEST_ASSERT_TRUE(st.sigma_mg[0] > 100.0f);
+}
+
+void test_faster_than_the_polled_self_test(void) {
+    adxl343_sim_advance_us(&sim, 100000);
+    adxl343_selftest_begin(&st, &dev, &adxl343_selftest_default);
+    // Polling back to back, about as fast as 400 kHz I2C allows
+    uint64_t batched_us = run(ADXL343_OK, 200);
+
+    adxl343_op_t op;
+    uint64_t start = sim.now_ns;
+    adxl343_op_begin_self_test(&op, &dev);
+    while (adxl343_op_poll(&op) == ADXL343_PENDING) {
+        adxl343_sim_advance_us(&sim, 200);
+    }
+    uint64_t polled_us = (sim.now_ns - start) / 1000;
+
+    // 2 * 32 samples at 800 Hz is 80 ms, against 2 * 20 at 100 Hz
+    TEST_ASSERT_TRUE(batched_us < 110000);
+    TEST_ASSERT_TRUE(polled_us > 3 * batched_us);
+}
+
+void test_waits_for_the_fifo(void) {
+    adxl343_selftest_begin(&st, &dev, &adxl343_selftest_default);
+    for (int i = 0; i < 50; i++) {
+        TEST_ASSERT_EQUAL(ADXL343_PENDING, adxl343_selftest_poll(&st));
+    }
+    run(ADXL343_OK, 1000);
+}
+
+void test_bus_error_still_restores(void) {
+    adxl343_dev_write_reg(&dev, ADXL343_REG_BW_RATE, ADXL343_RATE_50HZ);
+    adxl343_dev_write_reg(&dev, ADXL343_REG_DATA_FORMAT, ADXL343_RANGE_4G);
+    adxl343_dev_write_reg(&dev, ADXL343_REG_FIFO_CTL, ADXL343_FIFO_STREAM | 8);
+    adxl343_selftest_begin(&st, &dev, &adxl343_selftest_default);
+    while (!(sim.regs[ADXL343_REG_DATA_FORMAT] & ADXL343_FORMAT_SELF_TEST)) {
+        TEST_ASSERT_EQUAL(ADXL343_PENDING, adxl343_selftest_poll(&st));
+        adxl343_sim_advance_us(&sim, 1000);
+    }
+
+    // One transfer lost with the force on, then the bus comes back
+    dev.address = 0x2A;
+    TEST_ASSERT_EQUAL(ADXL343_PENDING, adxl343_selftest_poll(&st));
+    dev.address = ADXL343_ADDRESS;
+    run(ADXL343_ERROR_BUS, 1000);
+
+    TEST_ASSERT_EQUAL_HEX8(ADXL343_RATE_50HZ, sim.regs[ADXL343_REG_BW_RATE]);
+    TEST_ASSERT_EQUAL_HEX8(ADXL343_RANGE_4G, sim.regs[ADXL343_REG_DATA_FORMAT]);
+    TEST_ASSERT_EQUAL_HEX8(ADXL343_FIFO_STREAM | 8, sim.regs[ADXL343_REG_FIFO_CTL]);
+}
+
+void test_rejects_bad_config(void) {
+    adxl343_selftest_config_t config = adxl343_selftest_default;
+    config.rate = ADXL343_RATE_1600HZ;
+    TEST_ASSERT_EQUAL(ADXL343_ERROR_ARGUMENT, adxl343_selftest_begin(&st, &dev, &config));
+    config.rate = ADXL343_RATE_3200HZ;
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_selftest_begin(&st, &dev, &config));
+
+    config = adxl343_selftest_default;
+    config.settle = 5;
+    TEST_ASSERT_EQUAL(ADXL343_ERROR_ARGUMENT, adxl343_selftest_begin(&st, &dev, &config));
+    config.settle = 0;
+    config.samples = 1;
+    TEST_ASSERT_EQUAL(ADXL343_ERROR_ARGUMENT, adxl343_selftest_begin(&st, &dev, &config));
+
+    config = adxl343_selftest_default;
+    config.min_mg[1] = 0;
+    config.max_mg[1] = -100;
+    TEST_ASSERT_EQUAL(ADXL343_ERROR_ARGUMENT, adxl343_selftest_begin(&st, &dev, &config));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_healthy_part_passes_and_restores);
+    RUN_TEST(test_noisy_part_passes_with_a_margin);
+    RUN_TEST(test_faulty_parts_fail);
+    RUN_TEST(test_motion_is_inconclusive);
+    RUN_TEST(test_faster_than_the_polled_self_test);
+    RUN_TEST(test_waits_for_the_fifo);
+    RUN_TEST(test_bus_error_still_restores);
+    RUN_TEST(test_rejects_bad_config);
+    return UNITY_END();
+}
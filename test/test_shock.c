@@ -0,0 +1,248 @@
+#include <math.h>
+#include <string.h>
+
+#include "unity.h"
+#include "ADXL343_shock.h"
+#include "adxl343_sim.h"
+
+#define ODR_HZ 800.0
+#define RAMP 200
+#define SHOCK_MG 6000.0
+#define SHOCK_S 0.004
+#define MAX_SHOCKS 8
+
+// X carries a ramp of the sample index so records can be checked for
+// continuity and position; Z sits at 1 g with half-sine shocks on top.
+typedef struct {
+    double at[MAX_SHOCKS];
+    size_t count;
+} shocks_t;
+
+static adxl343_sim_t sim;
+static adxl343_sim_bus_t bus;
+static shocks_t shocks;
+static adxl343_shock_t rec;
+
+static double shock_mg(const shocks_t *s, double t) {
+    double mg = 0.0;
+    for (size_t i = 0; i < s->count; i++) {
+        double dt = t - s->at[i];
+        if (dt >= 0.0 && dt < SHOCK_S) {
+            mg += SHOCK_MG * sin(M_PI * dt / SHOCK_S);
+        }
+    }
+    return mg;
+}
+
+static void source(void *ctx, double t, double mg[3]) {
+    long index = lround(t * ODR_HZ);
+    mg[0] = (double)(index % RAMP) * 1000.0 / 256.0;
+    mg[1] = 0.0;
+    mg[2] = 1000.0 + shock_mg((const shocks_t *)ctx, t);
+}
+
+// First sample index whose Z reading exceeds the threshold
+static long expected_edge(double at, uint8_t threshold) {
+    for (long k = lround(at * ODR_HZ); ; k++) {
+        double z = 1000.0 + shock_mg(&shocks, (double)k / ODR_HZ);
+        if (lround(z * 256.0 / 1000.0) > lround(threshold * 62.5 * 256.0 / 1000.0)) {
+            return k;
+        }
+    }
+}
+
+static long ramp_index(const adxl343_sample_t *s) {
+    return s->x;
+}
+
+void setUp(void) {
+    memset(&shocks, 0, sizeof(shocks));
+    adxl343_sim_init(&sim, ADXL343_ADDRESS);
+    adxl343_sim_set_source(&sim, source, &shocks);
+    adxl343_sim_bus_init(&bus);
+    adxl343_sim_bus_attach(&bus, &sim);
+    adxl343_set_bus(&bus.bus, ADXL343_ADDRESS);
+
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_init());
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_write_reg(ADXL343_REG_BW_RATE, ADXL343_RATE_800HZ));
+}
+
+void tearDown(void) {
+}
+
+static void run(double seconds, double service_s) {
+    uint64_t steps = (uint64_t)llround(seconds / service_s);
+    for (uint64_t i = 0; i < steps; i++) {
+        adxl343_sim_advance_ns(&sim, (uint64_t)llround(service_s * 1e9));
+        TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_shock_service(&rec));
+    }
+}
+
+static void check_record(const adxl343_shock_record_t *r, double at, uint16_t pre, uint16_t post) {
+    long edge = expected_edge(at, 32);
+
+    TEST_ASSERT_EQUAL(pre, r->pre);
+    TEST_ASSERT_EQUAL(pre + post, r->count);
+    TEST_ASSERT_EQUAL(0, r->flags);
+    TEST_ASSERT_EQUAL(edge % RAMP, ramp_index(&r->samples[r->pre]));
+
+    // Leading edge: everything before the trigger sample is quiet
+    for (uint16_t i = 0; i < r->pre; i++) {
+        TEST_ASSERT_TRUE(r->samples[i].z <= 512);
+    }
+    TEST_ASSERT_TRUE(r->samples[r->pre].z > 512);
+
+    // No gaps anywhere in the record
+    for (uint16_t i = 1; i < r->count; i++) {
+        TEST_ASSERT_EQUAL((ramp_index(&r->samples[i - 1]) + 1) % RAMP, ramp_index(&r->samples[i]));
+    }
+}
+
+static const adxl343_shock_config_t config = {
+    .pre = 64,
+    .post = 96,
+    .threshold = 32, // 2 g
+    .axes = ADXL343_ACT_Z,
+};
+
+void test_records_pre_and_post_trigger_samples(void) {
+    shocks.at[shocks.count++] = 0.5003;
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_shock_init(&rec, adxl343_default_device(), &config));
+
+    run(1.0, 0.010);
+
+    adxl343_shock_record_t *r = adxl343_shock_take(&rec);
+    TEST_ASSERT_NOT_NULL(r);
+    check_record(r, shocks.at[0], 64, 96);
+    adxl343_shock_release(&rec, r);
+
+    TEST_ASSERT_NULL(adxl343_shock_take(&rec));
+    TEST_ASSERT_EQUAL(1, rec.events);
+    TEST_ASSERT_EQUAL(0, rec.dropped);
+}
+
+void test_late_service_keeps_leading_edge(void) {
+    // 36 ms between services is 28.8 samples, inside the 31 kept by the FIFO
+    shocks.at[shocks.count++] = 0.7117;
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_shock_init(&rec, adxl343_default_device(), &config));
+
+    run(1.08, 0.036);
+
+    adxl343_shock_record_t *r = adxl343_shock_take(&rec);
+    TEST_ASSERT_NOT_NULL(r);
+    check_record(r, shocks.at[0], 64, 96);
+}
+
+void test_multiple_shocks_are_recorded_in_order(void) {
+    shocks.at[shocks.count++] = 0.3;
+    shocks.at[shocks.count++] = 0.8;
+    shocks.at[shocks.count++] = 1.4;
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_shock_init(&rec, adxl343_default_device(), &config));
+
+    run(2.0, 0.010);
+
+    for (size_t i = 0; i < shocks.count; i++) {
+        adxl343_shock_record_t *r = adxl343_shock_take(&rec);
+        TEST_ASSERT_NOT_NULL(r);
+        TEST_ASSERT_EQUAL(i + 1, r->sequence);
+        check_record(r, shocks.at[i], 64, 96);
+        adxl343_shock_release(&rec, r);
+    }
+}
+
+void test_pool_exhaustion_drops_events(void) {
+    for (size_t i = 0; i < 6; i++) {
+        shocks.at[shocks.count++] = 0.3 + 0.4 * (double)i;
+    }
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_shock_init(&rec, adxl343_default_device(), &config));
+
+    run(3.0, 0.010);
+
+    TEST_ASSERT_EQUAL(6, rec.events);
+    TEST_ASSERT_EQUAL(6 - ADXL343_SHOCK_POOL_SIZE, rec.dropped);
+    for (size_t i = 0; i < ADXL343_SHOCK_POOL_SIZE; i++) {
+        adxl343_shock_record_t *r = adxl343_shock_take(&rec);
+        TEST_ASSERT_NOT_NULL(r);
+        check_record(r, shocks.at[i], 64, 96);
+    }
+    TEST_ASSERT_NULL(adxl343_shock_take(&rec));
+}
+
+void test_history_after_overrun_is_shortened_not_gapped(void) {
+    shocks.at[shocks.count++] = 0.5;
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_shock_init(&rec, adxl343_default_device(), &config));
+
+    run(0.4, 0.010);
+    // Stall for 100 ms so the FIFO overruns, then service normally
+    adxl343_sim_advance_ns(&sim, 100000000);
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_shock_service(&rec));
+    run(0.5, 0.010);
+
+    adxl343_shock_record_t *r = adxl343_shock_take(&rec);
+    TEST_ASSERT_NOT_NULL(r);
+    TEST_ASSERT_TRUE(r->pre < 64);
+    TEST_ASSERT_TRUE(r->pre > 0);
+    TEST_ASSERT_EQUAL(r->pre + 96, r->count);
+    for (uint16_t i = 1; i < r->count; i++) {
+        TEST_ASSERT_EQUAL((ramp_index(&r->samples[i - 1]) + 1) % RAMP, ramp_index(&r->samples[i]));
+    }
+    TEST_ASSERT_EQUAL(expected_edge(shocks.at[0], 32) % RAMP, ramp_index(&r->samples[r->pre]));
+}
+
+void test_trigger_leaves_fifo_in_trigger_mode(void) {
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_shock_init(&rec, adxl343_default_device(), &config));
+
+    uint8_t ctl;
+    uint8_t map;
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_read_reg(ADXL343_REG_FIFO_CTL, &ctl));
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_read_reg(ADXL343_REG_INT_MAP, &map));
+    TEST_ASSERT_EQUAL_HEX8(ADXL343_FIFO_TRIGGER | 31, ctl);
+    TEST_ASSERT_EQUAL(0, map & ADXL343_INT_ACTIVITY);
+}
+
+void test_left_justified_samples_trigger_at_the_same_sample(void) {
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_write_reg(ADXL343_REG_DATA_FORMAT,
+                                                    ADXL343_FORMAT_FULL_RES | ADXL343_FORMAT_JUSTIFY | ADXL343_RANGE_16G));
+    shocks.at[shocks.count++] = 0.5003;
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_shock_init(&rec, adxl343_default_device(), &config));
+    TEST_ASSERT_EQUAL(4096, rec.threshold_lsb);
+
+    run(1.0, 0.010);
+
+    // 13 significant bits at the top of 16: eight times the raw values
+    adxl343_shock_record_t *r = adxl343_shock_take(&rec);
+    TEST_ASSERT_NOT_NULL(r);
+    TEST_ASSERT_EQUAL(expected_edge(shocks.at[0], 32) % RAMP, r->samples[r->pre].x / 8);
+    for (uint16_t i = 0; i < r->pre; i++) {
+        TEST_ASSERT_TRUE(r->samples[i].z <= 4096);
+    }
+    TEST_ASSERT_TRUE(r->samples[r->pre].z > 4096);
+    adxl343_shock_release(&rec, r);
+}
+
+void test_invalid_config_is_rejected(void) {
+    adxl343_shock_config_t bad = config;
+    bad.pre = ADXL343_SHOCK_MAX_PRE + 1;
+    TEST_ASSERT_EQUAL(ADXL343_ERROR_ARGUMENT, adxl343_shock_init(&rec, adxl343_default_device(), &bad));
+
+    bad = config;
+    bad.post = 0;
+    TEST_ASSERT_EQUAL(ADXL343_ERROR_ARGUMENT, adxl343_shock_init(&rec, adxl343_default_device(), &bad));
+
+    bad = config;
+    bad.axes = 0;
+    TEST_ASSERT_EQUAL(ADXL343_ERROR_ARGUMENT, adxl343_shock_init(&rec, adxl343_default_device(), &bad));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_records_pre_and_post_trigger_samples);
+    RUN_TEST(test_late_service_keeps_leading_edge);
+    RUN_TEST(test_multiple_shocks_are_recorded_in_order);
+    RUN_TEST(test_pool_exhaustion_drops_events);
+    RUN_TEST(test_history_after_overrun_is_shortened_not_gapped);
+    RUN_TEST(test_trigger_leaves_fifo_in_trigger_mode);
+    RUN_TEST(test_left_justified_samples_trigger_at_the_same_sample);
+    RUN_TEST(test_invalid_config_is_rejected);
+    return UNITY_END();
+}
@@ -0,0 +1,242 @@
+#include <math.h>
+#include <string.h>
+
+#include "unity.h"
+#include "ADXL343_stats.h"
+
+#define MAX_SAMPLES ADXL343_STATS_MAX_WINDOW
+
+static adxl343_sample_t samples[MAX_SAMPLES];
+static uint32_t rng_state;
+
+void setUp(void) {
+    rng_state = 12345;
+    memset(samples, 0, sizeof(samples));
+}
+
+void tearDown(void) {
+}
+
+static int16_t rand_range(int16_t lo, int16_t hi) {
+    rng_state = rng_state * 1664525u + 1013904223u;
+    return (int16_t)(lo + (int32_t)((rng_state >> 8) % (uint32_t)(hi - lo + 1)));
+}
+
+static int16_t axis_value(const adxl343_sample_t *s, int axis) {
+    return axis == 0 ? s->x : axis == 1 ? s->y : s->z;
+}
+
+// Naive two-pass reference in double precision.
+static void reference(const adxl343_sample_t *data, size_t n, int axis, adxl343_axis_stats_t *out) {
+    double mean = 0.0;
+    double min = axis_value(&data[0], axis);
+    double max = min;
+    for (size_t i = 0; i < n; i++) {
+        double v = axis_value(&data[i], axis);
+        mean += v;
+        min = v < min ? v : min;
+        max = v > max ? v : max;
+    }
+    mean /= (double)n;
+
+    double m2 = 0.0;
+    double m4 = 0.0;
+    double peak = 0.0;
+    for (size_t i = 0; i < n; i++) {
+        double d = axis_value(&data[i], axis) - mean;
+        m2 += d * d;
+        m4 += d * d * d * d;
+        peak = fabs(d) > peak ? fabs(d) : peak;
+    }
+    m2 /= (double)n;
+    m4 /= (double)n;
+
+    out->mean = (float)mean;
+    out->rms = (float)sqrt(m2);
+    out->peak = (float)peak;
+    out->peak_to_peak = (float)(max - min);
+    out->crest = m2 > 0.0 ? (float)(peak / sqrt(m2)) : 0.0f;
+    out->kurtosis = m2 > 0.0 ? (float)(m4 / (m2 * m2)) : 0.0f;
+}
+
+static void assert_close(float expected, float actual) {
+    float tol = 1e-4f * fabsf(expected) + 1e-3f;
+    TEST_ASSERT_FLOAT_WITHIN(tol, expected, actual);
+}
+
+static void check_against_reference(size_t n) {
+    adxl343_stats_t stats;
+    adxl343_stats_report_t report;
+
+    adxl343_stats_init(&stats, (uint16_t)n);
+    TEST_ASSERT_EQUAL(n, adxl343_stats_add(&stats, samples, n));
+    TEST_ASSERT_TRUE(adxl343_stats_ready(&stats));
+    TEST_ASSERT_TRUE(adxl343_stats_finish(&stats, &report));
+    TEST_ASSERT_EQUAL(n, report.count);
+
+    for (int axis = 0; axis < 3; axis++) {
+        adxl343_axis_stats_t ref;
+        reference(samples, n, axis, &ref);
+        assert_close(ref.mean, report.axis[axis].mean);
+        assert_close(ref.rms, report.axis[axis].rms);
+        assert_close(ref.peak, report.axis[axis].peak);
+        assert_close(ref.peak_to_peak, report.axis[axis].peak_to_peak);
+        assert_close(ref.crest, report.axis[axis].crest);
+        assert_close(ref.kurtosis, report.axis[axis].kurtosis);
+    }
+}
+
+void test_random_noise_on_gravity_matches_reference(void) {
+    for (int trial = 0; trial < 20; trial++) {
+        size_t n = (size_t)rand_range(2, MAX_SAMPLES);
+        int16_t spread = rand_range(1, 2000);
+        for (size_t i = 0; i < n; i++) {
+            samples[i].x = rand_range(-spread, spread);
+            samples[i].y = (int16_t)(-256 + rand_range(-spread / 4, spread / 4));
+            samples[i].z = (int16_t)(256 + rand_range(-3, 3));
+        }
+        check_against_reference(n);
+    }
+}
+
+void test_sine_matches_reference(void) {
+    for (size_t i = 0; i < 1000; i++) {
+        double phase = 2.0 * M_PI * 50.0 * (double)i / 1000.0;
+        samples[i].x = (int16_t)lround(1000.0 * sin(phase));
+        samples[i].y = (int16_t)lround(256.0 + 10.0 * sin(phase));
+        samples[i].z = (int16_t)lround(-4000.0 * cos(phase));
+    }
+    check_against_reference(1000);
+
+    adxl343_stats_t stats;
+    adxl343_stats_report_t report;
+    adxl343_stats_init(&stats, 1000);
+    adxl343_stats_add(&stats, samples, 1000);
+    adxl343_stats_finish(&stats, &report);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 1.5f, report.axis[0].kurtosis);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 1.414f, report.axis[0].crest);
+}
+
+void test_impulsive_signal_matches_reference(void) {
+    for (size_t i = 0; i < 2048; i++) {
+        samples[i].x = rand_range(-20, 20);
+        samples[i].y = (int16_t)((i % 256) == 0 ? 3000 : rand_range(-5, 5));
+        samples[i].z = (int16_t)((i % 512) == 7 ? -4000 : 256);
+    }
+    check_against_reference(2048);
+}
+
+void test_full_scale_window_does_not_overflow(void) {
+    for (size_t i = 0; i < MAX_SAMPLES; i++) {
+        int16_t v = (i & 1) ? 4095 : -4096;
+        samples[i].x = v;
+        samples[i].y = (int16_t)-v;
+        samples[i].z = (i % 7) ? 4095 : -4096;
+    }
+    check_against_reference(MAX_SAMPLES);
+}
+
+void test_chunked_input_matches_single_block(void) {
+    for (size_t i = 0; i < 1500; i++) {
+        samples[i].x = rand_range(-500, 500);
+        samples[i].y = rand_range(-50, 50);
+        samples[i].z = rand_range(200, 300);
+    }
+
+    adxl343_stats_t whole;
+    adxl343_stats_t chunked;
+    adxl343_stats_report_t a;
+    adxl343_stats_report_t b;
+
+    adxl343_stats_init(&whole, 1500);
+    adxl343_stats_add(&whole, samples, 1500);
+    adxl343_stats_finish(&whole, &a);
+
+    adxl343_stats_init(&chunked, 1500);
+    size_t done = 0;
+    while (done < 1500) {
+        size_t chunk = 1500 - done < 32 ? 1500 - done : 32;
+        done += adxl343_stats_add(&chunked, &samples[done], chunk);
+    }
+    adxl343_stats_finish(&chunked, &b);
+
+    TEST_ASSERT_EQUAL(a.count, b.count);
+    for (int axis = 0; axis < 3; axis++) {
+        TEST_ASSERT_EQUAL_MEMORY(&a.axis[axis], &b.axis[axis], sizeof(a.axis[axis]));
+    }
+}
+
+void test_add_stops_at_window_boundary(void) {
+    adxl343_stats_t stats;
+    adxl343_stats_report_t report;
+
+    adxl343_stats_init(&stats, 100);
+    TEST_ASSERT_EQUAL(100, adxl343_stats_add(&stats, samples, 150));
+    TEST_ASSERT_TRUE(adxl343_stats_ready(&stats));
+    TEST_ASSERT_EQUAL(0, adxl343_stats_add(&stats, samples, 50));
+
+    TEST_ASSERT_TRUE(adxl343_stats_finish(&stats, &report));
+    TEST_ASSERT_FALSE(adxl343_stats_ready(&stats));
+    TEST_ASSERT_EQUAL(50, adxl343_stats_add(&stats, samples, 50));
+}
+
+void test_constant_signal_has_zero_spread(void) {
+    for (size_t i = 0; i < 64; i++) {
+        samples[i].x = 100;
+        samples[i].y = -256;
+        samples[i].z = 0;
+    }
+
+    adxl343_stats_t stats;
+    adxl343_stats_report_t report;
+    adxl343_stats_init(&stats, 64);
+    adxl343_stats_add(&stats, samples, 64);
+    adxl343_stats_finish(&stats, &report);
+
+    TEST_ASSERT_EQUAL_FLOAT(100.0f, report.axis[0].mean);
+    TEST_ASSERT_EQUAL_FLOAT(-256.0f, report.axis[1].mean);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, report.axis[0].rms);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, report.axis[0].peak_to_peak);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, report.axis[0].crest);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, report.axis[0].kurtosis);
+}
+
+void test_partial_and_empty_windows(void) {
+    adxl343_stats_t stats;
+    adxl343_stats_report_t report;
+
+    adxl343_stats_init(&stats, 10);
+    TEST_ASSERT_FALSE(adxl343_stats_finish(&stats, &report));
+
+    samples[0].x = 10;
+    samples[1].x = 20;
+    adxl343_stats_add(&stats, samples, 2);
+    TEST_ASSERT_FALSE(adxl343_stats_ready(&stats));
+    TEST_ASSERT_TRUE(adxl343_stats_finish(&stats, &report));
+    TEST_ASSERT_EQUAL(2, report.count);
+    TEST_ASSERT_EQUAL_FLOAT(15.0f, report.axis[0].mean);
+    TEST_ASSERT_EQUAL_FLOAT(5.0f, report.axis[0].rms);
+}
+
+void test_window_is_clamped(void) {
+    adxl343_stats_t stats;
+
+    adxl343_stats_init(&stats, 0);
+    TEST_ASSERT_EQUAL(1, stats.window);
+    adxl343_stats_init(&stats, 60000);
+    TEST_ASSERT_EQUAL(ADXL343_STATS_MAX_WINDOW, stats.window);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_random_noise_on_gravity_matches_reference);
+    RUN_TEST(test_sine_matches_reference);
+    RUN_TEST(test_impulsive_signal_matches_reference);
+    RUN_TEST(test_full_scale_window_does_not_overflow);
+    RUN_TEST(test_chunked_input_matches_single_block);
+    RUN_TEST(test_add_stops_at_window_boundary);
+    RUN_TEST(test_constant_signal_has_zero_spread);
+    RUN_TEST(test_partial_and_empty_windows);
+    RUN_TEST(test_window_is_clamped);
+    return UNITY_END();
+}
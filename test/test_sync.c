@@ -0,0 +1,195 @@
+#include <math.h>
+#include <stdlib.h>
+
+#include "unity.h"
+#include "ADXL343_group.h"
+#include "ADXL343_sync.h"
+#include "adxl343_sim.h"
+
+// Three sensors on one bus, all set to 800 Hz but with oscillators off by
+// up to 1.2%, shaken by the same 37 Hz vibration.
+#define SENSORS 3
+#define TONE_HZ 37.0
+#define TONE_MG 500.0
+#define FRAME_HZ 500.0f
+#define STEP_US 5000
+
+static const uint8_t addresses[SENSORS] = {ADXL343_ADDRESS, ADXL343_ADDRESS_ALT, 0x54};
+static const double ppm[SENSORS] = {12000.0, -8000.0, 3000.0};
+
+static adxl343_sim_t sims[SENSORS];
+static adxl343_sim_bus_t bus;
+static adxl343_dev_t devs[SENSORS];
+static adxl343_group_t group;
+static adxl343_sync_t sync;
+static adxl343_frame_t frames[64];
+
+static void source(void *ctx, double t, double mg[3]) {
+    (void)ctx;
+    mg[0] = TONE_MG * sin(2.0 * M_PI * TONE_HZ * t);
+    mg[1] = 0.0;
+    mg[2] = 1000.0;
+}
+
+static void feed(void *ctx, size_t index, const adxl343_sample_t *samples, size_t count) {
+    (void)ctx;
+    adxl343_sync_push(&sync, index, samples, count, group.polled_ns[index]);
+}
+
+static uint64_t sim_clock(void *ctx) {
+    return ((const adxl343_sim_t *)ctx)->now_ns;
+}
+
+static void advance_us(uint64_t us) {
+    for (int i = 0; i < SENSORS; i++) {
+        adxl343_sim_advance_us(&sims[i], us);
+    }
+}
+
+typedef struct {
+    size_t frames;
+    int worst_between;     // largest difference between channels, LSB
+    int worst_truth;       // largest difference from the true signal, LSB
+    uint64_t last_t;
+    bool spaced;
+} result_t;
+
+// Run for `seconds` of virtual time, judging frames from `settle` seconds
+// after the start
+static result_t run(double seconds, double settle) {
+    result_t r = {0, 0, 0, 0, true};
+    double start = (double)sims[0].now_ns / 1e9;
+
+    while ((double)sims[0].now_ns / 1e9 < start + seconds) {
+        advance_us(STEP_US);
+        TEST_ASSERT_TRUE(adxl343_group_service(&group, feed, NULL) >= 0);
+
+        size_t n = adxl343_sync_frames(&sync, frames, 64);
+        for (size_t i = 0; i < n; i++) {
+            const adxl343_frame_t *f = &frames[i];
+            double t = (double)f->t_ns / 1e9;
+            if (t < start + settle) {
+                continue;
+            }
+            if (r.last_t != 0 && f->t_ns - r.last_t != 2000000) {
+                r.spaced = false;
+            }
+            r.last_t = f->t_ns;
+            r.frames++;
+            double truth = TONE_MG * sin(2.0 * M_PI * TONE_HZ * t) * 256.0 / 1000.0;
+            for (int c = 0; c < SENSORS; c++) {
+                int between = abs(f->channels[c].x - f->channels[0].x);
+                int off = (int)fabs(f->channels[c].x - truth);
+                r.worst_between = between > r.worst_between ? between : r.worst_between;
+                r.worst_truth = off > r.worst_truth ? off : r.worst_truth;
+            }
+        }
+    }
+    return r;
+}
+
+void setUp(void) {
+    adxl343_sim_bus_init(&bus);
+    bus.clock_hz = 400000.0;
+    adxl343_group_init(&group);
+    adxl343_group_set_clock(&group, sim_clock, &sims[0]);
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_sync_init(&sync, FRAME_HZ));
+
+    for (int i = 0; i < SENSORS; i++) {
+        adxl343_sim_init(&sims[i], addresses[i]);
+        sims[i].clock_ppm = ppm[i];
+        adxl343_sim_set_source(&sims[i], source, NULL);
+        adxl343_sim_bus_attach(&bus, &sims[i]);
+        adxl343_dev_set_bus(&devs[i], &bus.bus, addresses[i]);
+    }
+    // Staggered start so the channels are out of phase as well
+    for (int i = 0; i < SENSORS; i++) {
+        TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_dev_init(&devs[i]));
+        adxl343_dev_write_reg(&devs[i], ADXL343_REG_POWER_CTL, 0);
+        adxl343_dev_write_reg(&devs[i], ADXL343_REG_BW_RATE, ADXL343_RATE_800HZ);
+        adxl343_dev_write_reg(&devs[i], ADXL343_REG_FIFO_CTL, ADXL343_FIFO_STREAM | 16);
+        adxl343_dev_write_reg(&devs[i], ADXL343_REG_POWER_CTL, ADXL343_POWER_MEASURE);
+        advance_us(317);
+        TEST_ASSERT_EQUAL(i, adxl343_group_add(&group, &devs[i]));
+        TEST_ASSERT_EQUAL(i, adxl343_sync_add(&sync, 800.0f));
+    }
+}
+
+void tearDown(void) {
+}
+
+void test_rejects_bad_arguments(void) {
+    adxl343_sync_t other;
+    TEST_ASSERT_EQUAL(ADXL343_ERROR_ARGUMENT, adxl343_sync_init(&other, 0.0f));
+    TEST_ASSERT_EQUAL(ADXL343_ERROR_ARGUMENT, adxl343_sync_add(&sync, -1.0f));
+    TEST_ASSERT_EQUAL(ADXL343_ERROR_ARGUMENT, adxl343_sync_push(&sync, SENSORS, frames[0].channels, 1, 0));
+}
+
+void test_tracks_oscillator_offsets(void) {
+    run(8.0, 8.0);
+    for (int i = 0; i < SENSORS; i++) {
+        TEST_ASSERT_FLOAT_WITHIN(100.0f, (float)ppm[i], adxl343_sync_drift_ppm(&sync, (size_t)i));
+    }
+}
+
+void test_frames_are_phase_coherent(void) {
+    result_t r = run(10.0, 5.0);
+
+    // Evenly spaced once settled; the early reference points may skip a few
+    TEST_ASSERT_TRUE(r.spaced);
+    TEST_ASSERT_TRUE(r.frames >= (size_t)(4.9 * FRAME_HZ));
+    for (int i = 0; i < SENSORS; i++) {
+        TEST_ASSERT_EQUAL(0, sync.channels[i].dropped);
+    }
+
+    // 37 Hz at 128 LSB moves 30 LSB per ms: 3 LSB is 0.1 ms of skew. The
+    // common poll latency shows up against the true signal only.
+    TEST_ASSERT_TRUE(r.worst_between <= 3);
+    TEST_ASSERT_TRUE(r.worst_truth <= 12);
+}
+
+void test_restart_recovers(void) {
+    run(6.0, 6.0);
+
+    // Lose a FIFO's worth on one channel, as an overrun would
+    adxl343_sample_t lost[32];
+    adxl343_dev_read_fifo(&devs[1], lost, 32);
+    adxl343_sync_restart(&sync, 1);
+
+    result_t r = run(10.0, 6.0);
+    TEST_ASSERT_TRUE(r.frames > 0);
+    TEST_ASSERT_TRUE(r.worst_between <= 3);
+}
+
+void test_frames_resume_after_a_long_stall(void) {
+    // Frames stop being taken after 0.8 s while blocks keep coming up to
+    // 40 s, a lag whose Q28 product no longer fits in 64 bits
+    static const adxl343_sample_t block[8];
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_sync_init(&sync, 1000.0f));
+    TEST_ASSERT_EQUAL(0, adxl343_sync_add(&sync, 1000.0f));
+    TEST_ASSERT_EQUAL(1, adxl343_sync_add(&sync, 1000.0f));
+    for (uint64_t t = 8000000; t <= 40000000000ull; t += 8000000) {
+        adxl343_sync_push(&sync, 0, block, 8, t);
+        adxl343_sync_push(&sync, 1, block, 8, t);
+        if (t == 800000000) {
+            TEST_ASSERT_TRUE(adxl343_sync_frames(&sync, frames, 64) > 0);
+        }
+    }
+
+    // The stalled frames are skipped and the ones still buffered come out
+    size_t n = adxl343_sync_frames(&sync, frames, 64);
+    TEST_ASSERT_TRUE(n > 0);
+    TEST_ASSERT_TRUE(sync.gaps > 39000);
+    TEST_ASSERT_TRUE(frames[0].t_ns > 39900000000ull);
+    TEST_ASSERT_TRUE(frames[n - 1].t_ns <= 40000000000ull);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_rejects_bad_arguments);
+    RUN_TEST(test_tracks_oscillator_offsets);
+    RUN_TEST(test_frames_are_phase_coherent);
+    RUN_TEST(test_restart_recovers);
+    RUN_TEST(test_frames_resume_after_a_long_stall);
+    return UNITY_END();
+}
@@ -0,0 +1,268 @@
+#include "unity.h"
+#include "ADXL343_tap.h"
+#include "adxl343_sim.h"
+
+#define BUS_HZ 400000.0
+#define TAP_WIDTH_S 0.005
+
+// 400 Hz low power with the host asleep; the virtual clock runs in 50 us
+// steps while waiting and every transfer costs its wire time at 400 kHz.
+// A spy in front of the simulated bus counts reads of the data registers.
+static adxl343_sim_t sim;
+static adxl343_sim_bus_t bus;
+static adxl343_bus_t spy;
+static adxl343_dev_t dev;
+static adxl343_tap_t tap;
+static adxl343_sim_pulse_t pulses[4];
+static adxl343_sim_pulses_t trace;
+static int data_reads;
+static int waits;
+
+static int spy_read(void *ctx, uint8_t addr, uint8_t reg, uint8_t *dst, size_t len) {
+    (void)ctx;
+    if (reg <= ADXL343_REG_DATAZ1 && reg + len > ADXL343_REG_DATAX0) {
+        data_reads++;
+    }
+    return bus.bus.read(bus.bus.ctx, addr, reg, dst, len);
+}
+
+static int spy_write(void *ctx, uint8_t addr, uint8_t reg, const uint8_t *src, size_t len) {
+    (void)ctx;
+    return bus.bus.write(bus.bus.ctx, addr, reg, src, len);
+}
+
+static double now_s(void) {
+    return (double)sim.now_ns / 1e9;
+}
+
+static void wait_for_interrupt(void *ctx) {
+    (void)ctx;
+    waits++;
+    while (!adxl343_sim_int_pin(&sim, 1) && now_s() < 10.0) {
+        adxl343_sim_advance_us(&sim, 50);
+    }
+}
+
+static const adxl343_wom_host_t host = {wait_for_interrupt, NULL};
+
+// 3 g, 10 ms, 50 ms latency, 200 ms window, Z only
+static const adxl343_tap_config_t config = {
+    .threshold = 48,
+    .duration = 16,
+    .latent = 40,
+    .window = 160,
+    .axes = ADXL343_TAP_Z,
+    .pin = 1,
+};
+
+// A half-sine knock on Z on top of gravity; with a 4 g peak it is over
+// 3 g for the middle two thirds, which knock_end() assumes
+static void knock(double t, double peak_mg, double width_s) {
+    adxl343_sim_pulse_t *p = &pulses[trace.count++];
+    p->t = t;
+    p->width_s = width_s;
+    p->mg[0] = 0.0;
+    p->mg[1] = 0.0;
+    p->mg[2] = peak_mg;
+}
+
+static double knock_end(size_t n) {
+    return pulses[n].t + pulses[n].width_s * 5.0 / 6.0;
+}
+
+void setUp(void) {
+    data_reads = 0;
+    waits = 0;
+    trace = (adxl343_sim_pulses_t){.base_mg = {0.0, 0.0, 1000.0}, .pulses = pulses, .count = 0};
+    adxl343_sim_init(&sim, ADXL343_ADDRESS);
+    adxl343_sim_set_source(&sim, adxl343_sim_pulses, &trace);
+    adxl343_sim_bus_init(&bus);
+    adxl343_sim_bus_attach(&bus, &sim);
+    bus.clock_hz = BUS_HZ;
+    spy = (adxl343_bus_t){spy_read, spy_write, NULL, NULL};
+    adxl343_dev_set_bus(&dev, &spy, ADXL343_ADDRESS);
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_dev_init(&dev));
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_dev_write_reg(&dev, ADXL343_REG_BW_RATE,
+                                                        ADXL343_RATE_400HZ | ADXL343_BW_LOW_POWER));
+}
+
+void tearDown(void) {}
+
+void test_single_tap_latency(void) {
+    adxl343_tap_config_t single = config;
+    single.latent = 0;
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_tap_init(&tap, &dev, &single));
+    TEST_ASSERT_EQUAL_HEX8(ADXL343_INT_SINGLE_TAP, sim.regs[ADXL343_REG_INT_ENABLE]);
+    knock(0.2, 4000.0, TAP_WIDTH_S);
+
+    adxl343_tap_event_t events[2];
+    uint64_t before = bus.transactions;
+    TEST_ASSERT_EQUAL(1, adxl343_tap_wait(&tap, &host, events, 2));
+    double latency = now_s() - knock_end(0);
+
+    TEST_ASSERT_EQUAL(ADXL343_TAP_SINGLE, events[0].kind);
+    TEST_ASSERT_EQUAL_HEX8(ADXL343_STATUS_TAP_Z, events[0].axes);
+    TEST_ASSERT_EQUAL(1, waits);
+    TEST_ASSERT_EQUAL(1, bus.transactions - before);
+    TEST_ASSERT_EQUAL(0, data_reads);
+
+    // One 2.5 ms sample period to see the knock end, the wake-up poll and
+    // a 9 byte transfer
+    TEST_ASSERT_TRUE(latency > 0.0);
+    TEST_ASSERT_TRUE(latency < 0.0025 + 0.00005 + 0.0003);
+}
+
+void test_double_tap(void) {
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_tap_init(&tap, &dev, &config));
+    knock(0.2, 4000.0, TAP_WIDTH_S);
+    knock(0.35, 4000.0, TAP_WIDTH_S);
+
+    adxl343_tap_event_t events[2];
+    TEST_ASSERT_EQUAL(1, adxl343_tap_wait(&tap, &host, events, 2));
+    TEST_ASSERT_EQUAL(ADXL343_TAP_SINGLE, events[0].kind);
+    TEST_ASSERT_TRUE(now_s() < 0.21);
+
+    TEST_ASSERT_EQUAL(1, adxl343_tap_wait(&tap, &host, events, 2));
+    TEST_ASSERT_EQUAL(ADXL343_TAP_DOUBLE, events[0].kind);
+    TEST_ASSERT_EQUAL_HEX8(ADXL343_STATUS_TAP_Z, events[0].axes);
+    TEST_ASSERT_TRUE(now_s() - knock_end(1) < 0.003);
+    TEST_ASSERT_EQUAL(1, tap.singles);
+    TEST_ASSERT_EQUAL(1, tap.doubles);
+    TEST_ASSERT_EQUAL(0, data_reads);
+}
+
+void test_both_pending_come_in_order(void) {
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_tap_init(&tap, &dev, &config));
+    knock(0.2, 4000.0, TAP_WIDTH_S);
+    knock(0.35, 4000.0, TAP_WIDTH_S);
+
+    // The host was busy through both taps
+    adxl343_sim_advance_us(&sim, 500000);
+    adxl343_tap_event_t events[2];
+    TEST_ASSERT_EQUAL(2, adxl343_tap_service(&tap, events, 2));
+    TEST_ASSERT_EQUAL(ADXL343_TAP_SINGLE, events[0].kind);
+    TEST_ASSERT_EQUAL(ADXL343_TAP_DOUBLE, events[1].kind);
+    TEST_ASSERT_FALSE(adxl343_sim_int_pin(&sim, 1));
+}
+
+void test_second_tap_outside_window(void) {
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_tap_init(&tap, &dev, &config));
+    // Within the latency, then after the window
+    knock(0.2, 4000.0, TAP_WIDTH_S);
+    knock(0.23, 4000.0, TAP_WIDTH_S);
+    knock(0.6, 4000.0, TAP_WIDTH_S);
+
+    adxl343_sim_advance_us(&sim, 800000);
+    adxl343_tap_event_t events[2];
+    TEST_ASSERT_EQUAL(1, adxl343_tap_service(&tap, events, 2));
+    TEST_ASSERT_EQUAL(ADXL343_TAP_SINGLE, events[0].kind);
+    TEST_ASSERT_EQUAL(0, tap.doubles);
+}
+
+void test_suppress_cancels_on_motion_during_latency(void) {
+    // Without SUPPRESS a knock during the latency is ignored
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_tap_init(&tap, &dev, &config));
+    knock(0.2, 4000.0, TAP_WIDTH_S);
+    knock(0.23, 4000.0, TAP_WIDTH_S);
+    knock(0.35, 4000.0, TAP_WIDTH_S);
+    adxl343_sim_advance_us(&sim, 500000);
+    adxl343_tap_event_t events[2];
+    TEST_ASSERT_EQUAL(2, adxl343_tap_service(&tap, events, 2));
+    TEST_ASSERT_EQUAL(ADXL343_TAP_DOUBLE, events[1].kind);
+
+    // With it the double tap is off and the third knock starts afresh
+    setUp();
+    adxl343_tap_config_t suppress = config;
+    suppress.axes |= ADXL343_TAP_SUPPRESS;
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_tap_init(&tap, &dev, &suppress));
+    knock(0.2, 4000.0, TAP_WIDTH_S);
+    knock(0.23, 4000.0, TAP_WIDTH_S);
+    knock(0.35, 4000.0, TAP_WIDTH_S);
+    adxl343_sim_advance_us(&sim, 500000);
+    TEST_ASSERT_EQUAL(1, adxl343_tap_service(&tap, events, 2));
+    TEST_ASSERT_EQUAL(ADXL343_TAP_SINGLE, events[0].kind);
+    TEST_ASSERT_EQUAL(0, tap.doubles);
+}
+
+void test_long_push_and_other_axes_are_not_taps(void) {
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_tap_init(&tap, &dev, &config));
+    // Over 3 g for 27 ms, longer than DUR
+    knock(0.2, 4000.0, 0.04);
+    // A knock on X while only Z takes part
+    adxl343_sim_pulse_t *p = &pulses[trace.count++];
+    *p = (adxl343_sim_pulse_t){.t = 0.5, .width_s = TAP_WIDTH_S, .mg = {5000.0, 0.0, 0.0}};
+
+    for (int i = 0; i < 1000; i++) {
+        adxl343_sim_advance_us(&sim, 1000);
+        TEST_ASSERT_FALSE(adxl343_sim_int_pin(&sim, 1));
+    }
+    adxl343_tap_event_t events[2];
+    TEST_ASSERT_EQUAL(0, adxl343_tap_service(&tap, events, 2));
+
+    // With X taking part the second knock is a tap on X
+    setUp();
+    adxl343_tap_config_t both = config;
+    both.axes = ADXL343_TAP_X | ADXL343_TAP_Z;
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_tap_init(&tap, &dev, &both));
+    pulses[0] = *p;
+    trace.count = 1;
+    adxl343_sim_advance_us(&sim, 600000);
+    TEST_ASSERT_EQUAL(1, adxl343_tap_service(&tap, events, 2));
+    TEST_ASSERT_EQUAL_HEX8(ADXL343_STATUS_TAP_X, events[0].axes);
+}
+
+void test_pin_2_keeps_other_interrupts(void) {
+    adxl343_dev_write_reg(&dev, ADXL343_REG_INT_MAP, ADXL343_INT_WATERMARK);
+    adxl343_dev_write_reg(&dev, ADXL343_REG_INT_ENABLE, ADXL343_INT_WATERMARK | ADXL343_INT_ACTIVITY);
+
+    adxl343_tap_config_t two = config;
+    two.pin = 2;
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_tap_init(&tap, &dev, &two));
+    TEST_ASSERT_EQUAL_HEX8(ADXL343_INT_WATERMARK | ADXL343_INT_SINGLE_TAP | ADXL343_INT_DOUBLE_TAP,
+                           sim.regs[ADXL343_REG_INT_MAP]);
+    TEST_ASSERT_EQUAL_HEX8(ADXL343_INT_WATERMARK | ADXL343_INT_ACTIVITY | ADXL343_INT_SINGLE_TAP |
+                               ADXL343_INT_DOUBLE_TAP,
+                           sim.regs[ADXL343_REG_INT_ENABLE]);
+    TEST_ASSERT_EQUAL_HEX8(48, sim.regs[ADXL343_REG_THRESH_TAP]);
+    TEST_ASSERT_EQUAL_HEX8(16, sim.regs[ADXL343_REG_DUR]);
+    TEST_ASSERT_EQUAL_HEX8(40, sim.regs[ADXL343_REG_LATENT]);
+    TEST_ASSERT_EQUAL_HEX8(160, sim.regs[ADXL343_REG_WINDOW]);
+    TEST_ASSERT_EQUAL_HEX8(ADXL343_TAP_Z, sim.regs[ADXL343_REG_TAP_AXES]);
+
+    knock(0.2, 4000.0, TAP_WIDTH_S);
+    while (!adxl343_sim_int_pin(&sim, 2)) {
+        adxl343_sim_advance_us(&sim, 50);
+    }
+    TEST_ASSERT_TRUE(now_s() - knock_end(0) < 0.0026);
+
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_tap_disable(&tap));
+    TEST_ASSERT_EQUAL_HEX8(ADXL343_INT_WATERMARK | ADXL343_INT_ACTIVITY, sim.regs[ADXL343_REG_INT_ENABLE]);
+}
+
+void test_invalid_config_is_rejected(void) {
+    adxl343_tap_config_t bad = config;
+    bad.threshold = 0;
+    TEST_ASSERT_EQUAL(ADXL343_ERROR_ARGUMENT, adxl343_tap_init(&tap, &dev, &bad));
+    bad = config;
+    bad.duration = 0;
+    TEST_ASSERT_EQUAL(ADXL343_ERROR_ARGUMENT, adxl343_tap_init(&tap, &dev, &bad));
+    bad = config;
+    bad.axes = ADXL343_TAP_SUPPRESS;
+    TEST_ASSERT_EQUAL(ADXL343_ERROR_ARGUMENT, adxl343_tap_init(&tap, &dev, &bad));
+    bad = config;
+    bad.pin = 3;
+    TEST_ASSERT_EQUAL(ADXL343_ERROR_ARGUMENT, adxl343_tap_init(&tap, &dev, &bad));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_single_tap_latency);
+    RUN_TEST(test_double_tap);
+    RUN_TEST(test_both_pending_come_in_order);
+    RUN_TEST(test_second_tap_outside_window);
+    RUN_TEST(test_suppress_cancels_on_motion_during_latency);
+    RUN_TEST(test_long_push_and_other_axes_are_not_taps);
+    RUN_TEST(test_pin_2_keeps_other_interrupts);
+    RUN_TEST(test_invalid_config_is_rejected);
+    return UNITY_END();
+}
@@ -0,0 +1,113 @@
+#include <math.h>
+
+extern "C" {
+    #include "unity.h"
+}
+
+#include "ADXL343_units.hpp"
+
+using namespace adxl343;
+using namespace adxl343::literals;
+
+// Register codes folded at compile time
+static_assert(encode<reg::ThreshTap>(3_g).raw == 0x30, "");
+static_assert(encode<reg::ThreshTap>(62_mg).raw == 1, "");
+static_assert(encode<reg::ThreshTap>(31_mg).raw == 0, "");
+static_assert(encode<reg::ThreshTap>(32_mg).raw == 1, "");
+static_assert(encode<reg::ThreshAct>(15937_mg).raw == 255, "");
+static_assert(encode<reg::ThreshInact>(1.5_g).raw == 24, "");
+static_assert(encode<reg::ThreshFf>(400_mg).raw == 6, "");
+static_assert(encode<reg::ThreshFf>(0.6_g).raw == 10, "");
+static_assert(encode<reg::Dur>(10_ms).raw == 16, "");
+static_assert(encode<reg::Dur>(625_us).raw == 1, "");
+static_assert(encode<reg::Dur>(159375_us).raw == 255, "");
+static_assert(encode<reg::Latent>(20_ms).raw == 16, "");
+static_assert(encode<reg::Window>(300_ms).raw == 240, "");
+static_assert(encode<reg::TimeFf>(350_ms).raw == 70, "");
+static_assert(encode<reg::TimeFf>(1275_ms).raw == 255, "");
+static_assert(encode<reg::TimeFf>(2_us).raw == 0, "");
+static_assert(encode<reg::TimeInact>(30_s).raw == 30, "");
+static_assert(encode<reg::Ofsx>(-250_mg).raw == 0xF0, "");
+static_assert(encode<reg::Ofsy>(16_mg).raw == 1, "");
+static_assert(encode<reg::Ofsz>(-8_mg).raw == 0xFF, "");
+static_assert(encode<reg::Ofsz>(-7_mg).raw == 0x00, "");
+static_assert(encode<reg::Ofsx>(-2000_mg).raw == 0x80, "");
+static_assert(encode<reg::Ofsx>(1984_mg).raw == 0x7F, "");
+
+static_assert(decode(encode<reg::ThreshTap>(3_g)).value == 3000, "");
+static_assert(decode(encode<reg::Ofsx>(-250_mg)).value == -250, "");
+static_assert(decode(encode<reg::TimeFf>(350_ms)).value == 350000, "");
+
+static_assert(rate(3200_hz) == ADXL343_RATE_3200HZ, "");
+static_assert(rate(100_hz) == ADXL343_RATE_100HZ, "");
+static_assert(rate(12.5_hz) == ADXL343_RATE_12_5HZ, "");
+static_assert(rate(3.13_hz) == ADXL343_RATE_3_13HZ, "");
+static_assert(rate(0.10_hz) == ADXL343_RATE_0_10HZ, "");
+
+// Whole configurations fold into the burst the detectors take
+constexpr auto detectors = burst(encode<reg::ThreshAct>(375_mg), encode<reg::ThreshInact>(125_mg),
+                                 encode<reg::TimeInact>(3_s));
+static_assert(detectors.data[0] == 6 && detectors.data[1] == 2 && detectors.data[2] == 3, "");
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+// Expected code from floating point: nearest LSB, halves away from zero,
+// saturated to the register range
+static int expected(double value, double lsb, int lo, int hi) {
+    double code = round(value / lsb);
+    return code < lo ? lo : code > hi ? hi : (int)code;
+}
+
+void test_thresholds_encode_matrix(void) {
+    for (int32_t mg = -500; mg <= 17000; mg += 7) {
+        int want = expected(mg, 62.5, 0, 255);
+        TEST_ASSERT_EQUAL_UINT8(want, encode<reg::ThreshTap>(Mg{mg}).raw);
+        TEST_ASSERT_EQUAL_UINT8(want, encode<reg::ThreshAct>(Mg{mg}).raw);
+        TEST_ASSERT_EQUAL_UINT8(want, encode<reg::ThreshInact>(Mg{mg}).raw);
+        TEST_ASSERT_EQUAL_UINT8(want, encode<reg::ThreshFf>(Mg{mg}).raw);
+    }
+}
+
+void test_offsets_encode_matrix(void) {
+    for (int32_t mg = -2500; mg <= 2500; mg += 3) {
+        int want = expected(mg, 15.625, -128, 127);
+        TEST_ASSERT_EQUAL_INT8(want, (int8_t)encode<reg::Ofsx>(Mg{mg}).raw);
+        TEST_ASSERT_EQUAL_INT8(want, (int8_t)encode<reg::Ofsz>(Mg{mg}).raw);
+    }
+}
+
+void test_durations_encode_matrix(void) {
+    for (uint32_t us = 0; us <= 2000000; us += 311) {
+        TEST_ASSERT_EQUAL_UINT8(expected(us, 625.0, 0, 255), encode<reg::Dur>(Us{us}).raw);
+        TEST_ASSERT_EQUAL_UINT8(expected(us, 1250.0, 0, 255), encode<reg::Latent>(Us{us}).raw);
+        TEST_ASSERT_EQUAL_UINT8(expected(us, 1250.0, 0, 255), encode<reg::Window>(Us{us}).raw);
+        TEST_ASSERT_EQUAL_UINT8(expected(us, 5000.0, 0, 255), encode<reg::TimeFf>(Us{us}).raw);
+    }
+    for (uint32_t ms = 0; ms <= 300000; ms += 97) {
+        TEST_ASSERT_EQUAL_UINT8(expected(ms, 1000.0, 0, 255), encode<reg::TimeInact>(Ms{ms}).raw);
+    }
+}
+
+void test_rates_pick_the_nearest_code(void) {
+    for (int code = ADXL343_RATE_0_10HZ; code <= ADXL343_RATE_3200HZ; code++) {
+        double odr = 3200.0 / (double)(1 << (ADXL343_RATE_3200HZ - code));
+        TEST_ASSERT_EQUAL(code, rate(Hz{odr}));
+        TEST_ASSERT_EQUAL(code, rate(Hz{odr * 1.3}));
+        TEST_ASSERT_EQUAL(code, rate(Hz{odr / 1.3}));
+    }
+    TEST_ASSERT_EQUAL(ADXL343_RATE_3200HZ, rate(Hz{10000.0}));
+    TEST_ASSERT_EQUAL(ADXL343_RATE_0_10HZ, rate(Hz{0.01}));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_thresholds_encode_matrix);
+    RUN_TEST(test_offsets_encode_matrix);
+    RUN_TEST(test_durations_encode_matrix);
+    RUN_TEST(test_rates_pick_the_nearest_code);
+    return UNITY_END();
+}
@@ -0,0 +1,177 @@
+#include <math.h>
+
+#include "unity.h"
+#include "ADXL343_velocity.h"
+
+#define ODR_HZ 3200.0f
+#define MG_PER_LSB 3.90625f
+#define G_MM_S2 9806.65
+
+static adxl343_sample_t block[32];
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+static void init_stage(adxl343_velocity_t *vel, float highpass_hz, uint16_t window) {
+    adxl343_velocity_config_t config = {
+        .odr_hz = ODR_HZ,
+        .highpass_hz = highpass_hz,
+        .window = window,
+    };
+    TEST_ASSERT_TRUE(adxl343_velocity_init(vel, &config));
+}
+
+// Feed `seconds` of a(t) = offset + amp * sin(2 pi f t) in mg on X, a
+// quarter of it on Y and only the offset on Z, returning the last report.
+static adxl343_velocity_report_t run_sine(adxl343_velocity_t *vel, double amp_mg, double freq_hz,
+                                          double offset_mg, int seconds) {
+    adxl343_velocity_report_t report = {0};
+    uint32_t n = 0;
+    uint32_t total = (uint32_t)(seconds * ODR_HZ);
+
+    while (n < total) {
+        for (int i = 0; i < 32; i++, n++) {
+            double a = amp_mg * sin(2.0 * M_PI * freq_hz * n / ODR_HZ);
+            block[i].x = (int16_t)lround((offset_mg + a) / MG_PER_LSB);
+            block[i].y = (int16_t)lround((offset_mg + a / 4.0) / MG_PER_LSB);
+            block[i].z = (int16_t)lround(offset_mg / MG_PER_LSB);
+        }
+        size_t done = 0;
+        while (done < 32) {
+            done += adxl343_velocity_add(vel, &block[done], 32 - done);
+            if (adxl343_velocity_ready(vel)) {
+                TEST_ASSERT_TRUE(adxl343_velocity_finish(vel, &report));
+            }
+        }
+    }
+
+    return report;
+}
+
+// Velocity RMS of a sinusoid, including the two first order high-pass
+// sections of the stage.
+static double analytic_rms(double amp_mg, double freq_hz, double highpass_hz) {
+    double ideal = amp_mg * 1e-3 * G_MM_S2 / (2.0 * M_PI * freq_hz) / sqrt(2.0);
+    double r2 = (freq_hz / highpass_hz) * (freq_hz / highpass_hz);
+    return ideal * r2 / (1.0 + r2);
+}
+
+void test_sinusoids_match_analytic_velocity(void) {
+    // Trapezoidal integration reads low as the tone approaches Nyquist,
+    // about 3% at ODR / 8.
+    static const double freqs[] = {40.0, 80.0, 160.0, 400.0};
+    static const double tolerance[] = {0.02, 0.02, 0.02, 0.04};
+
+    for (size_t i = 0; i < sizeof(freqs) / sizeof(freqs[0]); i++) {
+        adxl343_velocity_t vel;
+        init_stage(&vel, 10.0f, 3200);
+
+        adxl343_velocity_report_t report = run_sine(&vel, 2000.0, freqs[i], 0.0, 3);
+        double expected = analytic_rms(2000.0, freqs[i], 10.0);
+
+        TEST_ASSERT_EQUAL(3200, report.count);
+        TEST_ASSERT_FLOAT_WITHIN(tolerance[i] * expected, expected, report.rms_mm_s[0]);
+        TEST_ASSERT_FLOAT_WITHIN(tolerance[i] * expected / 4.0, expected / 4.0, report.rms_mm_s[1]);
+    }
+}
+
+void test_gravity_offset_does_not_drift(void) {
+    adxl343_velocity_t vel;
+    init_stage(&vel, 10.0f, 3200);
+
+    adxl343_velocity_report_t report = run_sine(&vel, 1000.0, 80.0, 1000.0, 10);
+    double expected = analytic_rms(1000.0, 80.0, 10.0);
+
+    TEST_ASSERT_FLOAT_WITHIN(0.02 * expected, expected, report.rms_mm_s[0]);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 0.0f, report.rms_mm_s[2]);
+}
+
+void test_static_offset_reports_zero(void) {
+    adxl343_velocity_t vel;
+    init_stage(&vel, 2.0f, 3200);
+
+    adxl343_velocity_report_t report = run_sine(&vel, 0.0, 80.0, -750.0, 5);
+
+    for (int axis = 0; axis < 3; axis++) {
+        TEST_ASSERT_FLOAT_WITHIN(0.01f, 0.0f, report.rms_mm_s[axis]);
+    }
+}
+
+void test_below_band_is_suppressed(void) {
+    adxl343_velocity_t vel;
+    init_stage(&vel, 10.0f, 3200);
+
+    // 2 Hz sits a factor 5 below the corner, two sections give ~1/26
+    adxl343_velocity_report_t report = run_sine(&vel, 100.0, 2.0, 0.0, 8);
+    double unfiltered = 100.0 * 1e-3 * G_MM_S2 / (2.0 * M_PI * 2.0) / sqrt(2.0);
+
+    TEST_ASSERT_TRUE(report.rms_mm_s[0] < unfiltered / 15.0);
+}
+
+void test_invalid_config_is_rejected(void) {
+    adxl343_velocity_t vel;
+    adxl343_velocity_config_t config = {
+        .odr_hz = 100.0f,
+        .highpass_hz = 30.0f,
+        .window = 100,
+    };
+
+    TEST_ASSERT_FALSE(adxl343_velocity_init(&vel, &config));
+    config.highpass_hz = 0.0f;
+    TEST_ASSERT_FALSE(adxl343_velocity_init(&vel, &config));
+    config.highpass_hz = 1.0f;
+    config.odr_hz = 0.0f;
+    TEST_ASSERT_FALSE(adxl343_velocity_init(&vel, &config));
+}
+
+void test_window_boundaries(void) {
+    adxl343_velocity_t vel;
+    adxl343_velocity_report_t report;
+    init_stage(&vel, 10.0f, 20);
+
+    TEST_ASSERT_FALSE(adxl343_velocity_finish(&vel, &report));
+    TEST_ASSERT_EQUAL(20, adxl343_velocity_add(&vel, block, 32));
+    TEST_ASSERT_TRUE(adxl343_velocity_ready(&vel));
+    TEST_ASSERT_EQUAL(0, adxl343_velocity_add(&vel, block, 32));
+    TEST_ASSERT_TRUE(adxl343_velocity_finish(&vel, &report));
+    TEST_ASSERT_EQUAL(20, report.count);
+    TEST_ASSERT_FALSE(adxl343_velocity_ready(&vel));
+}
+
+void test_saturated_window_does_not_wrap(void) {
+    adxl343_velocity_t vel;
+    static adxl343_sample_t step[ADXL343_VELOCITY_MAX_WINDOW];
+    adxl343_velocity_report_t report;
+    init_stage(&vel, 0.01f, ADXL343_VELOCITY_MAX_WINDOW);
+
+    // A full-scale step with next to no leak drives the integrator into its
+    // limit within the first window and holds it there through the second
+    step[0].x = -4096;
+    for (size_t i = 1; i < ADXL343_VELOCITY_MAX_WINDOW; i++) {
+        step[i].x = 4095;
+    }
+    TEST_ASSERT_EQUAL(ADXL343_VELOCITY_MAX_WINDOW, adxl343_velocity_add(&vel, step, ADXL343_VELOCITY_MAX_WINDOW));
+    TEST_ASSERT_TRUE(adxl343_velocity_finish(&vel, &report));
+    step[0].x = 4095;
+    TEST_ASSERT_EQUAL(ADXL343_VELOCITY_MAX_WINDOW, adxl343_velocity_add(&vel, step, ADXL343_VELOCITY_MAX_WINDOW));
+    TEST_ASSERT_TRUE(adxl343_velocity_finish(&vel, &report));
+
+    // The limit is 2^22 LSB * sample
+    double limit = 4194304.0 * MG_PER_LSB * 1e-3 * G_MM_S2 / ODR_HZ;
+    TEST_ASSERT_FLOAT_WITHIN(0.01 * limit, limit, report.rms_mm_s[0]);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_sinusoids_match_analytic_velocity);
+    RUN_TEST(test_gravity_offset_does_not_drift);
+    RUN_TEST(test_static_offset_reports_zero);
+    RUN_TEST(test_below_band_is_suppressed);
+    RUN_TEST(test_invalid_config_is_rejected);
+    RUN_TEST(test_window_boundaries);
+    RUN_TEST(test_saturated_window_does_not_wrap);
+    return UNITY_END();
+}
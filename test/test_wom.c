@@ -0,0 +1,182 @@
+#include <math.h>
+
+#include "unity.h"
+#include "ADXL343_wom.h"
+#include "adxl343_sim.h"
+
+#define BUS_HZ 400000.0
+
+// The host harness: the virtual clock runs in 50 us steps while "dormant"
+// and every bus transfer costs its wire time at 400 kHz.
+static adxl343_sim_t sim;
+static adxl343_sim_bus_t bus;
+static adxl343_dev_t dev;
+static double motion_at;
+static double woke_at;
+static int waits;
+
+static void source(void *ctx, double t, double mg[3]) {
+    (void)ctx;
+    mg[0] = 0.0;
+    mg[1] = t >= motion_at ? 700.0 * sin(2.0 * M_PI * 20.0 * (t - motion_at)) + 500.0 : 0.0;
+    mg[2] = 1000.0;
+}
+
+static double now_s(void) {
+    return (double)sim.now_ns / 1e9;
+}
+
+static void wait_for_interrupt(void *ctx) {
+    (void)ctx;
+    waits++;
+    while (!adxl343_sim_int_pin(&sim, 1) && now_s() < 100.0) {
+        adxl343_sim_advance_us(&sim, 50);
+    }
+    woke_at = now_s();
+}
+
+static const adxl343_wom_host_t host = {wait_for_interrupt, NULL};
+
+static const adxl343_wom_config_t config = {
+    .threshold = 4,
+    .axes = ADXL343_ACT_AC | ADXL343_ACT_X | ADXL343_ACT_Y | ADXL343_ACT_Z,
+    .rate = ADXL343_RATE_12_5HZ,
+    .low_power = true,
+};
+
+// Acquisition setup the application runs with: 800 Hz, stream FIFO with a
+// watermark interrupt on INT1 and data ready on INT2.
+static void start_acquisition(void) {
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_dev_init(&dev));
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_dev_write_reg(&dev, ADXL343_REG_BW_RATE, ADXL343_RATE_800HZ));
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_dev_write_reg(&dev, ADXL343_REG_FIFO_CTL, ADXL343_FIFO_STREAM | 16));
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_dev_write_reg(&dev, ADXL343_REG_INT_MAP, ADXL343_INT_DATA_READY));
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_dev_write_reg(&dev, ADXL343_REG_INT_ENABLE,
+                                                        ADXL343_INT_WATERMARK | ADXL343_INT_DATA_READY));
+}
+
+void setUp(void) {
+    motion_at = 1e9;
+    woke_at = -1.0;
+    waits = 0;
+    adxl343_sim_init(&sim, ADXL343_ADDRESS);
+    adxl343_sim_set_source(&sim, source, NULL);
+    adxl343_sim_bus_init(&bus);
+    adxl343_sim_bus_attach(&bus, &sim);
+    bus.clock_hz = BUS_HZ;
+    adxl343_dev_set_bus(&dev, &bus.bus, ADXL343_ADDRESS);
+    start_acquisition();
+}
+
+void tearDown(void) {
+}
+
+void test_wakes_on_motion_and_restores_acquisition(void) {
+    adxl343_sim_advance_us(&sim, 100000);
+    motion_at = 2.5;
+
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_wom_sleep(&dev, &config, &host));
+    TEST_ASSERT_EQUAL(1, waits);
+    TEST_ASSERT_TRUE(woke_at >= motion_at);
+    TEST_ASSERT_TRUE(woke_at - motion_at <= 1.0 / 12.5 + 0.0001);
+
+    TEST_ASSERT_EQUAL_HEX8(ADXL343_RATE_800HZ, sim.regs[ADXL343_REG_BW_RATE]);
+    TEST_ASSERT_EQUAL_HEX8(ADXL343_FIFO_STREAM | 16, sim.regs[ADXL343_REG_FIFO_CTL]);
+    TEST_ASSERT_EQUAL_HEX8(ADXL343_INT_DATA_READY, sim.regs[ADXL343_REG_INT_MAP]);
+    TEST_ASSERT_EQUAL_HEX8(ADXL343_INT_WATERMARK | ADXL343_INT_DATA_READY, sim.regs[ADXL343_REG_INT_ENABLE]);
+    TEST_ASSERT_EQUAL_HEX8(ADXL343_POWER_MEASURE, sim.regs[ADXL343_REG_POWER_CTL]);
+}
+
+void test_wake_to_first_sample_latency(void) {
+    motion_at = 1.2345;
+
+    uint64_t before = bus.transactions;
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_wom_sleep(&dev, &config, &host));
+    uint64_t restore = bus.transactions - before;
+
+    // The FIFO kept sampling through the dormant period, so the first
+    // sample is available as soon as the registers are back.
+    uint8_t fifo;
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_dev_fifo_status(&dev, &fifo));
+    TEST_ASSERT_TRUE((fifo & ADXL343_FIFO_ENTRIES_MASK) > 0);
+    adxl343_sample_t first;
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_dev_read_sample(&dev, &first));
+    double first_sample_at = now_s();
+
+    double wake_to_sample = first_sample_at - woke_at;
+    TEST_ASSERT_TRUE(wake_to_sample < 0.001);
+    TEST_ASSERT_TRUE(first_sample_at - motion_at < 1.0 / 12.5 + 0.001);
+
+    // Save (2), arm (5) and restore (3) transfers
+    TEST_ASSERT_EQUAL(10, restore);
+}
+
+void test_stale_activity_does_not_wake_early(void) {
+    // Activity latched by the application before going to sleep
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_dev_write_reg(&dev, ADXL343_REG_THRESH_ACT, 1));
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_dev_write_reg(&dev, ADXL343_REG_ACT_INACT_CTL, ADXL343_ACT_Z));
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_dev_write_reg(&dev, ADXL343_REG_INT_ENABLE, ADXL343_INT_ACTIVITY));
+    adxl343_sim_advance_us(&sim, 50000);
+    TEST_ASSERT_TRUE(sim.regs[ADXL343_REG_INT_SOURCE] & ADXL343_INT_ACTIVITY);
+    start_acquisition();
+
+    motion_at = 3.0;
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_wom_sleep(&dev, &config, &host));
+    TEST_ASSERT_TRUE(woke_at >= motion_at);
+
+    // The application's own detector settings are back
+    TEST_ASSERT_EQUAL_HEX8(1, sim.regs[ADXL343_REG_THRESH_ACT]);
+    TEST_ASSERT_EQUAL_HEX8(ADXL343_ACT_Z, sim.regs[ADXL343_REG_ACT_INACT_CTL]);
+}
+
+void test_forced_sleep_is_left_for_the_armed_rate(void) {
+    // The application had put the sensor to sleep at 1 Hz
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_dev_write_reg(&dev, ADXL343_REG_POWER_CTL,
+                                                    ADXL343_POWER_SLEEP | ADXL343_POWER_MEASURE | 3));
+    adxl343_sim_advance_us(&sim, 100000);
+    TEST_ASSERT_TRUE(sim.regs[ADXL343_REG_ACT_TAP_STATUS] & ADXL343_STATUS_ASLEEP);
+
+    // Detected at the armed rate, not the wakeup rate
+    motion_at = 2.5;
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_wom_sleep(&dev, &config, &host));
+    TEST_ASSERT_TRUE(woke_at >= motion_at);
+    TEST_ASSERT_TRUE(woke_at - motion_at <= 1.0 / 12.5 + 0.0001);
+
+    // and put back to sleep afterwards
+    TEST_ASSERT_EQUAL_HEX8(ADXL343_POWER_SLEEP | ADXL343_POWER_MEASURE | 3, sim.regs[ADXL343_REG_POWER_CTL]);
+}
+
+void test_linked_setup_still_wakes_on_motion(void) {
+    // Link mode as left by the rate governor: activity is only reported
+    // once inactivity has been seen
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_dev_write_reg(&dev, ADXL343_REG_POWER_CTL, 0));
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_dev_write_reg(&dev, ADXL343_REG_POWER_CTL,
+                                                        ADXL343_POWER_LINK | ADXL343_POWER_MEASURE));
+    adxl343_sim_advance_us(&sim, 100000);
+
+    motion_at = 2.5;
+    TEST_ASSERT_EQUAL(ADXL343_OK, adxl343_wom_sleep(&dev, &config, &host));
+    TEST_ASSERT_TRUE(woke_at >= motion_at);
+    TEST_ASSERT_TRUE(woke_at - motion_at <= 1.0 / 12.5 + 0.0001);
+    TEST_ASSERT_EQUAL_HEX8(ADXL343_POWER_LINK | ADXL343_POWER_MEASURE, sim.regs[ADXL343_REG_POWER_CTL]);
+}
+
+void test_invalid_config_is_rejected(void) {
+    adxl343_wom_config_t bad = config;
+    bad.axes = ADXL343_ACT_AC;
+    TEST_ASSERT_EQUAL(ADXL343_ERROR_ARGUMENT, adxl343_wom_sleep(&dev, &bad, &host));
+    bad.axes = ADXL343_INACT_X | ADXL343_ACT_X;
+    TEST_ASSERT_EQUAL(ADXL343_ERROR_ARGUMENT, adxl343_wom_sleep(&dev, &bad, &host));
+    TEST_ASSERT_EQUAL(0, waits);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_wakes_on_motion_and_restores_acquisition);
+    RUN_TEST(test_wake_to_first_sample_latency);
+    RUN_TEST(test_stale_activity_does_not_wake_early);
+    RUN_TEST(test_forced_sleep_is_left_for_the_armed_rate);
+    RUN_TEST(test_linked_setup_still_wakes_on_motion);
+    RUN_TEST(test_invalid_config_is_rejected);
+    return UNITY_END();
+}
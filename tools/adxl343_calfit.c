@@ -0,0 +1,234 @@
+#include <math.h>
+
+#include "adxl343_calfit.h"
+
+#define MAX_TERMS 9
+
+// Solve the n x n system `a` x = `b` in place by Gaussian elimination with
+// partial pivoting; the solution replaces `b`. False if `a` is singular.
+static bool solve(double a[][MAX_TERMS], double b[], size_t n) {
+    double scale = 0.0;
+    for (size_t i = 0; i < n; i++) {
+        scale = fmax(scale, fabs(a[i][i]));
+    }
+
+    for (size_t col = 0; col < n; col++) {
+        size_t pivot = col;
+        for (size_t row = col + 1; row < n; row++) {
+            if (fabs(a[row][col]) > fabs(a[pivot][col])) {
+                pivot = row;
+            }
+        }
+        if (fabs(a[pivot][col]) <= 1e-9 * scale) {
+            return false;
+        }
+        if (pivot != col) {
+            for (size_t k = 0; k < n; k++) {
+                double t = a[col][k];
+                a[col][k] = a[pivot][k];
+                a[pivot][k] = t;
+            }
+            double t = b[col];
+            b[col] = b[pivot];
+            b[pivot] = t;
+        }
+        for (size_t row = col + 1; row < n; row++) {
+            double f = a[row][col] / a[col][col];
+            for (size_t k = col; k < n; k++) {
+                a[row][k] -= f * a[col][k];
+            }
+            b[row] -= f * b[col];
+        }
+    }
+    for (size_t i = n; i-- > 0;) {
+        for (size_t k = i + 1; k < n; k++) {
+            b[i] -= a[i][k] * b[k];
+        }
+        b[i] /= a[i][i];
+    }
+    return true;
+}
+
+// Eigenvalues `w` and eigenvectors, the columns of `v`, of the symmetric
+// matrix `s` by cyclic Jacobi rotations
+static void eigen(const double s[3][3], double w[3], double v[3][3]) {
+    double a[3][3];
+    for (int r = 0; r < 3; r++) {
+        for (int c = 0; c < 3; c++) {
+            a[r][c] = s[r][c];
+            v[r][c] = r == c ? 1.0 : 0.0;
+        }
+    }
+
+    for (int sweep = 0; sweep < 50; sweep++) {
+        double off = fabs(a[0][1]) + fabs(a[0][2]) + fabs(a[1][2]);
+        if (off < 1e-15) {
+            break;
+        }
+        for (int p = 0; p < 2; p++) {
+            for (int q = p + 1; q < 3; q++) {
+                if (a[p][q] == 0.0) {
+                    continue;
+                }
+                double theta = (a[q][q] - a[p][p]) / (2.0 * a[p][q]);
+                double t = (theta >= 0.0 ? 1.0 : -1.0) / (fabs(theta) + sqrt(theta * theta + 1.0));
+                double c = 1.0 / sqrt(t * t + 1.0);
+                double sn = t * c;
+                for (int k = 0; k < 3; k++) {
+                    double akp = a[k][p], akq = a[k][q];
+                    a[k][p] = c * akp - sn * akq;
+                    a[k][q] = sn * akp + c * akq;
+                }
+                for (int k = 0; k < 3; k++) {
+                    double apk = a[p][k], aqk = a[q][k];
+                    a[p][k] = c * apk - sn * aqk;
+                    a[q][k] = sn * apk + c * aqk;
+                }
+                for (int k = 0; k < 3; k++) {
+                    double vkp = v[k][p], vkq = v[k][q];
+                    v[k][p] = c * vkp - sn * vkq;
+                    v[k][q] = sn * vkp + c * vkq;
+                }
+            }
+        }
+    }
+    for (int i = 0; i < 3; i++) {
+        w[i] = a[i][i];
+    }
+}
+
+int adxl343_calfit_fit(const double (*mg)[3], size_t count, adxl343_calfit_t *fit) {
+    if (count < 6) {
+        return ADXL343_ERROR_ARGUMENT;
+    }
+    bool full = count >= 9;
+    size_t n = full ? 9 : 6;
+
+    // Least squares for the quadric
+    //     A x^2 + B y^2 + C z^2 + 2D xy + 2E xz + 2F yz + 2G x + 2H y + 2I z = 1
+    // in g, without the cross terms D, E, F for six to eight orientations
+    double ata[MAX_TERMS][MAX_TERMS] = {{0.0}};
+    double atb[MAX_TERMS] = {0.0};
+    for (size_t i = 0; i < count; i++) {
+        double x = mg[i][0] / 1000.0, y = mg[i][1] / 1000.0, z = mg[i][2] / 1000.0;
+        double row[MAX_TERMS];
+        if (full) {
+            const double terms[9] = {x * x, y * y, z * z, 2 * x * y, 2 * x * z, 2 * y * z, 2 * x, 2 * y, 2 * z};
+            for (size_t k = 0; k < 9; k++) {
+                row[k] = terms[k];
+            }
+        } else {
+            const double terms[6] = {x * x, y * y, z * z, 2 * x, 2 * y, 2 * z};
+            for (size_t k = 0; k < 6; k++) {
+                row[k] = terms[k];
+            }
+        }
+        for (size_t r = 0; r < n; r++) {
+            for (size_t c = 0; c < n; c++) {
+                ata[r][c] += row[r] * row[c];
+            }
+            atb[r] += row[r];
+        }
+    }
+    if (!solve(ata, atb, n)) {
+        return ADXL343_ERROR_ARGUMENT;
+    }
+
+    double q[3][3] = {
+        {atb[0], full ? atb[3] : 0.0, full ? atb[4] : 0.0},
+        {full ? atb[3] : 0.0, atb[1], full ? atb[5] : 0.0},
+        {full ? atb[4] : 0.0, full ? atb[5] : 0.0, atb[2]},
+    };
+    const double *g = &atb[full ? 6 : 3];
+
+    // Centre c = -Q^-1 g; about it the quadric reads (v - c)' Q (v - c) = 1 + c' Q c
+    double a[MAX_TERMS][MAX_TERMS];
+    double centre[MAX_TERMS];
+    for (int r = 0; r < 3; r++) {
+        for (int c = 0; c < 3; c++) {
+            a[r][c] = q[r][c];
+        }
+        centre[r] = -g[r];
+    }
+    if (!solve(a, centre, 3)) {
+        return ADXL343_ERROR_ARGUMENT;
+    }
+    double k = 1.0;
+    for (int r = 0; r < 3; r++) {
+        for (int c = 0; c < 3; c++) {
+            k += centre[r] * q[r][c] * centre[c];
+        }
+    }
+    if (!(k > 0.0)) {
+        return ADXL343_ERROR_ARGUMENT;
+    }
+
+    // M is the symmetric square root of Q / k, which has to be positive
+    // definite for the quadric to be an ellipsoid
+    double s[3][3], w[3], v[3][3];
+    for (int r = 0; r < 3; r++) {
+        for (int c = 0; c < 3; c++) {
+            s[r][c] = q[r][c] / k;
+        }
+    }
+    eigen(s, w, v);
+    for (int i = 0; i < 3; i++) {
+        if (!(w[i] > 0.0)) {
+            return ADXL343_ERROR_ARGUMENT;
+        }
+        w[i] = sqrt(w[i]);
+    }
+    for (int r = 0; r < 3; r++) {
+        for (int c = 0; c < 3; c++) {
+            fit->m[r][c] = v[r][0] * w[0] * v[c][0] + v[r][1] * w[1] * v[c][1] + v[r][2] * w[2] * v[c][2];
+        }
+        fit->offset_mg[r] = centre[r] * 1000.0;
+    }
+    fit->full = full;
+
+    double sum = 0.0;
+    for (size_t i = 0; i < count; i++) {
+        double out[3];
+        adxl343_calfit_apply(fit, mg[i], out);
+        double err = sqrt(out[0] * out[0] + out[1] * out[1] + out[2] * out[2]) - 1000.0;
+        sum += err * err;
+    }
+    fit->rms_mg = sqrt(sum / (double)count);
+
+    return ADXL343_OK;
+}
+
+void adxl343_calfit_apply(const adxl343_calfit_t *fit, const double mg[3], double out[3]) {
+    double d[3] = {mg[0] - fit->offset_mg[0], mg[1] - fit->offset_mg[1], mg[2] - fit->offset_mg[2]};
+    for (int r = 0; r < 3; r++) {
+        out[r] = fit->m[r][0] * d[0] + fit->m[r][1] * d[1] + fit->m[r][2] * d[2];
+    }
+}
+
+int adxl343_calfit_to_device(const adxl343_calfit_t *fit, uint8_t data_format, adxl343_cal_t *cal) {
+    double one = (double)(1 << ADXL343_CAL_FRAC_BITS);
+    double lsb_mg = adxl343_mg_per_lsb(data_format);
+    adxl343_cal_t out;
+
+    for (int r = 0; r < 3; r++) {
+        double row = 0.0;
+        for (int c = 0; c < 3; c++) {
+            double q = round(fit->m[r][c] * one);
+            if (q < INT16_MIN || q > INT16_MAX) {
+                return ADXL343_ERROR_ARGUMENT;
+            }
+            out.m[r][c] = (int16_t)q;
+            row += fabs(q);
+        }
+        if (row >= 4.0 * one) {
+            return ADXL343_ERROR_ARGUMENT;
+        }
+        double o = round(fit->offset_mg[r] / lsb_mg);
+        if (o < INT16_MIN || o > INT16_MAX) {
+            return ADXL343_ERROR_ARGUMENT;
+        }
+        out.offset[r] = (int16_t)o;
+    }
+    *cal = out;
+    return ADXL343_OK;
+}
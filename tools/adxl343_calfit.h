@@ -0,0 +1,46 @@
+#ifndef ADXL343_CALFIT_H
+#define ADXL343_CALFIT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ADXL343_cal.h"
+
+// Host side calibration fit for ADXL343_cal.h.
+//
+// Input is the mean reading, in mg, of the sensor held still in several
+// orientations; each one sees exactly 1 g. The readings are fitted with an
+// ellipsoid, and the correction maps that ellipsoid back onto the 1 g
+// sphere:
+//
+//     corrected = M * (reading - offset)
+//
+// Nine or more orientations fit the full symmetric M, covering scale and
+// cross-axis sensitivity; six to eight (the six-position method) fit
+// scale and offset per axis only. Gravity alone cannot reveal a rotation
+// of all three axes together, so of the corrections that give 1 g
+// everywhere the symmetric one is returned. Doubles throughout; this is
+// not meant for the sensor's MCU.
+
+typedef struct {
+    double m[3][3];
+    double offset_mg[3];
+    double rms_mg;            // of |corrected| - 1 g over the inputs
+    bool full;                // cross-axis terms fitted
+} adxl343_calfit_t;
+
+// Fit `count` mean readings. Returns ADXL343_ERROR_ARGUMENT for fewer than
+// six, or for orientations that do not pin the ellipsoid down, e.g. all in
+// one plane.
+int adxl343_calfit_fit(const double (*mg)[3], size_t count, adxl343_calfit_t *fit);
+
+// Correct one reading in mg.
+void adxl343_calfit_apply(const adxl343_calfit_t *fit, const double mg[3], double out[3]);
+
+// Convert to the fixed-point stage for samples read with `data_format`.
+// Returns ADXL343_ERROR_ARGUMENT if an entry of M reaches 2, a row's
+// absolute sum reaches 4 or the offset does not fit in a sample.
+int adxl343_calfit_to_device(const adxl343_calfit_t *fit, uint8_t data_format, adxl343_cal_t *cal);
+
+#endif // ADXL343_CALFIT_H
@@ -0,0 +1,77 @@
+// adxl343-calfit: fit the fixed-point correction of ADXL343_cal.h.
+//
+//     adxl343-calfit [DATA_FORMAT] < readings.txt
+//
+// Each input line holds the mean reading of one still orientation in mg,
+// as "x y z" or "x,y,z"; blank lines and lines starting with '#' are
+// skipped. DATA_FORMAT (default 0x0B, full resolution +-16 g) is the
+// format the device will sample with. Prints the fit quality and an
+// adxl343_cal_t initialiser.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "adxl343_calfit.h"
+
+#define MAX_ORIENTATIONS 256
+
+static double readings[MAX_ORIENTATIONS][3];
+
+int main(int argc, char **argv) {
+    uint8_t format = ADXL343_FORMAT_FULL_RES | ADXL343_RANGE_16G;
+    if (argc > 2) {
+        fprintf(stderr, "usage: %s [DATA_FORMAT] < readings\n", argv[0]);
+        return 2;
+    }
+    if (argc == 2) {
+        format = (uint8_t)strtoul(argv[1], NULL, 0);
+    }
+
+    size_t count = 0;
+    char line[256];
+    while (fgets(line, sizeof(line), stdin) != NULL) {
+        char *p = line + strspn(line, " \t");
+        if (*p == '#' || *p == '\n' || *p == '\0') {
+            continue;
+        }
+        for (char *c = p; *c != '\0'; c++) {
+            if (*c == ',') {
+                *c = ' ';
+            }
+        }
+        if (count == MAX_ORIENTATIONS) {
+            fprintf(stderr, "more than %d orientations\n", MAX_ORIENTATIONS);
+            return 1;
+        }
+        double *r = readings[count];
+        if (sscanf(p, "%lf %lf %lf", &r[0], &r[1], &r[2]) != 3) {
+            fprintf(stderr, "cannot parse: %s", line);
+            return 1;
+        }
+        count++;
+    }
+
+    adxl343_calfit_t fit;
+    if (adxl343_calfit_fit((const double (*)[3])readings, count, &fit) != ADXL343_OK) {
+        fprintf(stderr, "%zu orientations do not determine a fit; six or more, not all in one plane\n", count);
+        return 1;
+    }
+    adxl343_cal_t cal;
+    if (adxl343_calfit_to_device(&fit, format, &cal) != ADXL343_OK) {
+        fprintf(stderr, "correction out of the fixed-point range\n");
+        return 1;
+    }
+
+    printf("// %zu orientations, %s fit, rms %.2f mg, DATA_FORMAT 0x%02X\n", count,
+           fit.full ? "cross-axis" : "per-axis", fit.rms_mg, format);
+    printf("// M = [% .5f % .5f % .5f; % .5f % .5f % .5f; % .5f % .5f % .5f], offset = [%.1f %.1f %.1f] mg\n",
+           fit.m[0][0], fit.m[0][1], fit.m[0][2], fit.m[1][0], fit.m[1][1], fit.m[1][2], fit.m[2][0], fit.m[2][1],
+           fit.m[2][2], fit.offset_mg[0], fit.offset_mg[1], fit.offset_mg[2]);
+    printf("static const adxl343_cal_t cal = {\n");
+    printf("    .m = {{%d, %d, %d}, {%d, %d, %d}, {%d, %d, %d}},\n", cal.m[0][0], cal.m[0][1], cal.m[0][2],
+           cal.m[1][0], cal.m[1][1], cal.m[1][2], cal.m[2][0], cal.m[2][1], cal.m[2][2]);
+    printf("    .offset = {%d, %d, %d},\n", cal.offset[0], cal.offset[1], cal.offset[2]);
+    printf("};\n");
+    return 0;
+}